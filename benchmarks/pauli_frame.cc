@@ -0,0 +1,43 @@
+/** \file
+ * Benchmarks the Pauli frame optimizer on Pauli-twirled distance-3 surface
+ * code syndrome extraction with echo pulses.
+ *
+ * Usage: bench_pauli_frame [rounds]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+#include "ql/pass/tests/helpers.h"
+#include "ql/pass/opt/clifford/tests/surface_code.h"
+
+using namespace ql;
+using namespace ql::pass::tests;
+
+int main(int argc, char *argv[]) {
+    utils::UInt rounds = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200;
+    auto plat = ir::compat::Platform::build("bench_plat", utils::Str("cc_light.s17"));
+
+    auto bare = utils::make<ir::compat::Kernel>("bare", plat, 17, 32, 32);
+    syndrome_extraction(bare, rounds, false);
+
+    auto program = utils::make<ir::compat::Program>("bench_prog", plat, 17, 32, 32);
+    auto kernel = utils::make<ir::compat::Kernel>("twirled", plat, 17, 32, 32);
+    syndrome_extraction(kernel, rounds, true);
+    program->add(kernel);
+    auto twirled_gates = kernel->gates.size();
+
+    auto start = std::chrono::steady_clock::now();
+    auto optimized_gates = run_pass(program, "opt.clifford.PauliFrame")->kernels[0]->gates.size();
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start
+    ).count();
+    QL_ASSERT_EQ(optimized_gates, bare->gates.size());
+
+    std::cout << "surface-17 syndrome extraction, " << rounds << " rounds: ";
+    std::cout << twirled_gates << " -> " << optimized_gates << " gates ";
+    std::cout << "(bare: " << bare->gates.size() << ") in " << elapsed << " ms" << std::endl;
+
+    return 0;
+}
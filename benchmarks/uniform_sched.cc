@@ -0,0 +1,51 @@
+/** \file
+ * Compares the priority queue and scan implementations of uniform scheduling
+ * on tests/test_uniform_sched.py-style circuits with wide bundles.
+ *
+ * Usage: bench_uniform_sched [max_layers]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+#include "ql/pass/sch/schedule/tests/uniform.h"
+
+using namespace ql;
+using namespace ql::pass::tests;
+
+/**
+ * Schedules the given program with the given uniform scheduling
+ * implementation, and returns the resulting schedule. The time taken is
+ * returned via elapsed_ms.
+ */
+static Schedule time_schedule(
+    const ir::compat::ProgramRef &program,
+    const utils::Str &algorithm,
+    utils::Int &elapsed_ms
+) {
+    auto start = std::chrono::steady_clock::now();
+    auto result = schedule_uniform(program, "uniform", algorithm);
+    elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start
+    ).count();
+    return result;
+}
+
+int main(int argc, char *argv[]) {
+    utils::UInt max_layers = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000;
+    auto plat = ir::compat::Platform::build("bench_plat", utils::Str("cc_light.s17"));
+
+    std::cout << "layers\tgates\tqueue [ms]\tscan [ms]" << std::endl;
+    for (utils::UInt layers = 250; layers <= max_layers; layers *= 2) {
+        utils::Int elapsed_queue, elapsed_scan;
+        auto program = make_uniform_program(plat, layers);
+        auto gates = program->kernels[0]->gates.size();
+        auto queue = time_schedule(program, "queue", elapsed_queue);
+        auto scan = time_schedule(make_uniform_program(plat, layers), "scan", elapsed_scan);
+        QL_ASSERT(queue == scan);
+        std::cout << layers << "\t" << gates << "\t" << elapsed_queue << "\t" << elapsed_scan << std::endl;
+    }
+
+    return 0;
+}
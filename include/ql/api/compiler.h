@@ -140,6 +140,21 @@ public:
 #endif
     std::string get_option(const std::string &path) const;
 
+    /**
+     * Sets one of the global options (see set_option() in the openql module)
+     * for compilations using this compiler only. The first call gives the
+     * compiler a private copy of the current global options, after which
+     * changes to the global options no longer affect it. Compilers with
+     * private options can compile concurrently in different threads.
+     */
+    void set_context_option(const std::string &option, const std::string &value);
+
+    /**
+     * Returns the value of one of the global options (see get_option() in the
+     * openql module) as used for compilations using this compiler.
+     */
+    std::string get_context_option(const std::string &option) const;
+
 #ifdef QL_HIERARCHICAL_PASS_MANAGEMENT
     /**
      * Appends a pass to the end of the pass list. If type_name is empty
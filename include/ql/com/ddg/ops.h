@@ -42,6 +42,12 @@ NodeCRef get_sink_node(const ir::BlockBaseRef &block);
  */
 EdgeCRef get_edge(const ir::StatementRef &from, const ir::StatementRef &to);
 
+/**
+ * Returns the dense index of the given statement, i.e. the absolute value of
+ * the order of its DDG node. The statement must have a DDG node.
+ */
+utils::UInt get_index(const ir::StatementRef &statement);
+
 /**
  * Returns the effective scheduling direction when scheduling using this DDG.
  */
@@ -68,6 +74,13 @@ void clear(const ir::BlockBaseRef &block);
  */
 void reverse(const ir::BlockBaseRef &block);
 
+/**
+ * Makes a compact, index-based snapshot of the data dependency graph
+ * associated with the given block in its current direction. The snapshot is
+ * not updated when the graph is reversed or cleared.
+ */
+DenseGraphCRef make_dense(const ir::BlockBaseRef &block);
+
 } // namespace ddg
 } // namespace com
 } // namespace ql
@@ -423,6 +423,67 @@ struct Graph {
 
 };
 
+/**
+ * Compact, index-based snapshot of the data dependency graph of a block, in
+ * compressed sparse row form. Statements are identified by their dense index,
+ * which is the absolute value of the order field of their DDG node; the source
+ * and sink are thus at index 0 and N + 1 for a block of N statements,
+ * regardless of direction. The edges are stored in the direction of the DDG at
+ * the time the snapshot was made, so it must be remade after reverse().
+ *
+ * This is not a replacement for the annotation-based representation, which
+ * remains the authoritative form and carries the causes of the edges; it just
+ * allows algorithms that traverse the graph many times (like the list
+ * scheduler) to do so in contiguous memory without map lookups.
+ */
+struct DenseGraph {
+
+    /**
+     * The statements by dense index.
+     */
+    utils::Vec<ir::StatementRef> statements;
+
+    /**
+     * The successors of the statement with dense index i are stored at
+     * successor_offsets[i] up to (but excluding) successor_offsets[i + 1] in
+     * successor_indices and successor_weights. Thus, this has one more entry
+     * than there are statements.
+     */
+    utils::Vec<utils::UInt> successor_offsets;
+
+    /**
+     * Flat array of the dense indices of the successors of each statement.
+     */
+    utils::Vec<utils::UInt> successor_indices;
+
+    /**
+     * Flat array of the weights of the edges to the successors of each
+     * statement.
+     */
+    utils::Vec<utils::Int> successor_weights;
+
+    /**
+     * The number of predecessors of each statement.
+     */
+    utils::Vec<utils::UInt> predecessor_counts;
+
+    /**
+     * Dense index of the source statement.
+     */
+    utils::UInt source;
+
+    /**
+     * Dense index of the sink statement.
+     */
+    utils::UInt sink;
+
+};
+
+/**
+ * Shared reference to a dense DDG snapshot.
+ */
+using DenseGraphCRef = utils::Ptr<const DenseGraph>;
+
 } // namespace ddg
 } // namespace com
 } // namespace ql
@@ -22,14 +22,31 @@ utils::Options make_ql_options();
 QL_GLOBAL extern utils::Options global;
 
 /**
- * Convenience function for getting an option value as a string from the global
- * options record.
+ * Returns the options record that is active for the calling thread, i.e. the
+ * options of the compilation context it is running (see Scope), or the global
+ * options if there is none. Code that runs as part of a compilation must read
+ * the options through this function rather than through global.
+ */
+utils::Options &current();
+
+/**
+ * Makes the given options record the active one for the calling thread until
+ * this object is destroyed, after which the previously active record (if any)
+ * is restored. Passing nullptr keeps the previously active record (or the
+ * global options, if there is none) active. This allows independent
+ * compilations to run concurrently with their own options.
+ */
+using Scope = utils::OptionsScope;
+
+/**
+ * Convenience function for getting an option value as a string from the
+ * options record that is active for the calling thread.
  */
 const utils::Str &get(const utils::Str &key);
 
 /**
- * Convenience function for setting an option value for the global options
- * record.
+ * Convenience function for setting an option value for the options record
+ * that is active for the calling thread.
  */
 void set(const utils::Str &key, const utils::Str &value);
 
@@ -56,8 +56,9 @@ struct CriticalPathHeuristic {
  * equal: in this case, the criticality of the most critical successor is
  * recursively checked, until a difference is found.
  *
- * Deep criticality requires preprocessing to be performant. The usage pattern
- * is as followed:
+ * Deep criticality requires preprocessing to be performant: compute() ranks
+ * all statements by deep criticality once, such that the heuristic only has to
+ * compare two integers. The usage pattern is as followed:
  *
  *  - pre-schedule in the same way as you would for CriticalPathHeuristic;
  *  - call DeepCriticality::compute();
@@ -80,6 +81,14 @@ public:
      */
     ir::StatementRef most_critical_dependent;
 
+    /**
+     * Rank of the statement in terms of deep criticality, as computed by
+     * compute(). Statements with equal deep criticality have equal rank, and
+     * more critical statements have a higher rank. Ranks start at 1; 0 is used
+     * for statements that have no annotation.
+     */
+    utils::UInt rank = 0;
+
     /**
      * Returns the Criticality annotation for the given statement, or returns
      * zero criticality if no statement exist.
@@ -87,7 +96,7 @@ public:
     static const DeepCriticality &get(const ir::StatementRef &statement);
 
     /**
-     * Compares the criticality of two Criticality annotations.
+     * Compares the criticality of two Criticality annotations by their rank.
      */
     utils::Bool operator<(const DeepCriticality &other) const;
 
@@ -96,23 +105,6 @@ public:
      */
     friend std::ostream &operator<<(std::ostream &os, const DeepCriticality &dc);
 
-private:
-
-    /**
-     * Ensures that a valid criticality annotation exists for the given
-     * statement. This will recursively ensure that dependent statements are
-     * annotated, because this is needed to compute which of the dependent
-     * statements is the most critical for deep criticality. The set tracks
-     * which statements have valid annotations (there may be stray annotations
-     * from previous scheduling operations that we must be sure to override).
-     */
-    static void ensure_annotation(
-        const ir::StatementRef &statement,
-        utils::Set<ir::StatementRef> &annotated
-    );
-
-public:
-
     /**
      * Annotates the instructions in block with DeepCriticality structures, such
      * that DeepCriticality::Heuristic() can be used as scheduling heuristic.
@@ -116,9 +116,15 @@ class Scheduler {
     utils::Opt<rmgr::State> resource_state;
 
     /**
-     * Set of statements that have been scheduled.
+     * Index-based snapshot of the data dependency graph. This is shared
+     * between copies of the scheduler, as it is never modified.
      */
-    utils::Set<ir::StatementRef> scheduled;
+    com::ddg::DenseGraphCRef graph;
+
+    /**
+     * Number of statements that have been scheduled.
+     */
+    utils::UInt num_scheduled;
 
     /**
      * List of available statements, i.e. statements we can immediately schedule
@@ -140,10 +146,23 @@ class Scheduler {
     utils::Map<utils::Int, utils::List<ir::StatementRef>, AbsoluteComparator> available_in;
 
     /**
-     * Set of statements that are still blocked, because their data
+     * Number of statements that are still blocked, because their data
      * dependencies have not yet been scheduled.
      */
-    utils::Set<ir::StatementRef> waiting;
+    utils::UInt num_waiting;
+
+    /**
+     * For each statement by dense index, the number of its predecessors that
+     * have not been scheduled yet. A statement is blocked until this reaches
+     * zero.
+     */
+    utils::Vec<utils::UInt> remaining_predecessors;
+
+    /**
+     * For each statement by dense index, the earliest cycle in which it may be
+     * scheduled given the predecessors scheduled thus far.
+     */
+    utils::Vec<utils::Int> available_from_cycle;
 
     /**
      * Schedules the given statement in the current cycle, updating all state
@@ -159,61 +178,50 @@ class Scheduler {
 
         // Move the statement from available to scheduled.
         QL_ASSERT(available.erase(statement));
-        QL_ASSERT(scheduled.insert(statement).second);
-
-        // The DDG successors of the statement should all still be in the
-        // waiting list, but some may be unblocked now. Check for that, and
-        // move the unblocked statements to available_in or available
-        // accordingly.
-        for (const auto &successor_ep : com::ddg::get_node(statement)->successors) {
-            const auto &successor_stmt = successor_ep.first;
-            auto successor_node = com::ddg::get_node(successor_stmt);
-
-            // Check if this successor of the statement we just scheduled is
-            // now available.
-            utils::Bool is_now_available = true;
-            utils::Int available_from_cycle = 0;
-            for (const auto &predecessor_ep : successor_node->predecessors) {
-                const auto &predecessor_stmt = predecessor_ep.first;
-                const auto &edge = predecessor_ep.second;
-
-                // Ensure that all predecessors have been scheduled.
-                if (!scheduled.count(predecessor_stmt)) {
-                    is_now_available = false;
-                    break;
-                }
-
-                // Compute the minimum cycle for which this statement will
-                // become available.
-                available_from_cycle = abs_max(
-                    available_from_cycle,
-                    predecessor_stmt->cycle + edge->weight
-                );
+        num_scheduled++;
+
+        // The DDG successors of the statement should all still be blocked, but
+        // some may be unblocked now. Update their predecessor counters and
+        // earliest cycles, and move the unblocked statements to available_in or
+        // available accordingly.
+        auto index = com::ddg::get_index(statement);
+        auto begin = graph->successor_offsets[index];
+        auto end = graph->successor_offsets[index + 1];
+        for (auto edge = begin; edge < end; edge++) {
+            auto successor = graph->successor_indices[edge];
+
+            // Compute the minimum cycle for which this statement will become
+            // available.
+            available_from_cycle[successor] = abs_max(
+                available_from_cycle[successor],
+                cycle + graph->successor_weights[edge]
+            );
 
+            // If this was the last predecessor to be scheduled, actually make
+            // the statement available by moving it to the appropriate list.
+            QL_ASSERT(remaining_predecessors[successor] > 0);
+            if (--remaining_predecessors[successor] > 0) {
+                continue;
             }
+            const auto &successor_stmt = graph->statements[successor];
+            if (available_from_cycle[successor] == cycle) {
 
-            // If the statement is now available, actually make it available by
-            // moving it to the appropriate list.
-            if (is_now_available) {
-                if (available_from_cycle == cycle) {
+                // The statement is immediately available.
+                QL_ASSERT(available.insert(successor_stmt).second);
 
-                    // The statement is immediately available.
-                    QL_ASSERT(available.insert(successor_stmt).second);
+            } else {
 
-                } else {
-
-                    // The statement is not immediately available, so we have
-                    // to move it to available_in.
-                    auto it = available_in.insert({available_from_cycle, {}});
-                    it.first->second.push_back(successor_stmt);
-
-                }
-
-                // Remove the statement from the waiting list.
-                QL_ASSERT(waiting.erase(successor_stmt));
+                // The statement is not immediately available, so we have to
+                // move it to available_in.
+                auto it = available_in.insert({available_from_cycle[successor], {}});
+                it.first->second.push_back(successor_stmt);
 
             }
 
+            // Remove the statement from the waiting list.
+            QL_ASSERT(num_waiting > 0);
+            num_waiting--;
+
         }
 
         // If no more instructions are available in this cycle, advance to the
@@ -231,6 +239,34 @@ class Scheduler {
 
     }
 
+    /**
+     * Returns the number of cycles to advance by when none of the available
+     * statements can be scheduled in the current cycle due to resource
+     * constraints. This advances to the nearest cycle in which either one of
+     * them fits the resources or more statements become available w.r.t. data
+     * dependencies, rather than trying every cycle in between. Returns 0 if
+     * neither will ever happen, i.e. the resources are deadlocked.
+     */
+    utils::UInt get_cycles_to_skip() const {
+        auto search_direction = direction > 0 ? rmgr::Direction::FORWARD : rmgr::Direction::BACKWARD;
+        auto never = direction > 0 ? utils::MAX : utils::MIN;
+        auto target = never;
+        auto it = available_in.begin();
+        if (it != available_in.end()) {
+            target = it->first;
+        }
+        for (const auto &statement : available) {
+            auto candidate = resource_state->earliest_available(cycle + direction, statement, search_direction);
+            if (direction > 0 ? candidate < target : candidate > target) {
+                target = candidate;
+            }
+        }
+        if (target == never) {
+            return 0;
+        }
+        return (target - cycle) * direction;
+    }
+
 public:
 
     /**
@@ -265,13 +301,15 @@ public:
             resource_state = resources->build(rmgr::Direction::BACKWARD);
         }
 
-        // Initialize by putting the source statement in the available list and
-        // all other statements in the waiting list.
+        // Make an index-based snapshot of the DDG, and initialize by putting
+        // the source statement in the available list and all other statements
+        // in the waiting list.
+        graph = com::ddg::make_dense(block);
+        num_scheduled = 0;
+        num_waiting = graph->statements.size() - 1;
+        remaining_predecessors = graph->predecessor_counts;
+        available_from_cycle.assign(graph->statements.size(), 0);
         QL_ASSERT(available.insert(com::ddg::get_source(block)).second);
-        for (const auto &statement : block->statements) {
-            QL_ASSERT(waiting.insert(statement).second);
-        }
-        QL_ASSERT(waiting.insert(com::ddg::get_sink(block)).second);
 
         // Start by scheduling the source node.
         schedule(com::ddg::get_source(block));
@@ -380,8 +418,8 @@ public:
     utils::Bool is_done() const {
         if (!available.empty()) return false;
         if (!available_in.empty()) return false;
-        if (!waiting.empty()) return false;
-        QL_ASSERT(scheduled.size() == block->statements.size() + 2);
+        if (num_waiting) return false;
+        QL_ASSERT(num_scheduled == block->statements.size() + 2);
         return true;
     }
 
@@ -394,7 +432,9 @@ public:
      * for resources to become available when there is nothing else to do; this
      * is used to detect resource deadlocks and should simply be set to a high
      * enough number to prevent false deadlock detection. It may also be set to
-     * 0 to disable the check.
+     * 0 to disable the check. Note that cycles in which none of the available
+     * statements fit the resources are skipped over, and that deadlocks that
+     * the resources can detect directly are always reported.
      *
      * This function does *not* make all cycle numbers positive (cycle numbers
      * are referenced such that the source node has cycle 0) or sort statements
@@ -409,18 +449,19 @@ public:
         while (!is_done()) {
             QL_DOUT(
                 "cycle " << cycle << ", " <<
-                scheduled.size() << " scheduled, " <<
+                num_scheduled << " scheduled, " <<
                 available.size() << " available w.r.t. data dependencies, " <<
                 available_in.size() << " batches available later, " <<
-                waiting.size() << " waiting"
+                num_waiting << " waiting"
             );
             QL_ASSERT(!available.empty());
             utils::UInt advanced = 0;
             while (!try_schedule()) {
-                advance();
-                advanced++;
+                auto skip = get_cycles_to_skip();
+                advance(skip);
+                advanced += skip;
                 QL_DOUT("nothing is available, advancing to cycle " << cycle);
-                if (max_resource_block_cycles && advanced > max_resource_block_cycles) {
+                if (!skip || (max_resource_block_cycles && advanced > max_resource_block_cycles)) {
                     utils::StrStrm ss;
                     ss << "scheduling resources seem to be deadlocked! ";
                     ss << "The current cycle is " << cycle << ", ";
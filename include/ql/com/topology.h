@@ -193,13 +193,36 @@ private:
      */
     void generate_neighbors_list(utils::UInt qs, Neighbors &qubits) const;
 
+    /**
+     * Returns whether the given table holds the distances between all qubits
+     * for the neighbor lists of this topology, i.e. whether it is what the
+     * all-pairs shortest path computation would return.
+     */
+    utils::Bool is_distance_table(const utils::Vec<utils::Vec<utils::UInt>> &table) const;
+
 public:
 
     /**
      * Constructs the grid for the given number of qubits from the given JSON
-     * object. Refer to dump_docs() for details.
+     * object. Refer to dump_docs() for details. If precomputed_distance is
+     * given, it should be the distance table previously returned by
+     * get_distance_table() for a topology constructed from the same data; the
+     * all-pairs shortest path computation is then replaced by a cheaper check
+     * of the table against the neighbor lists. If the check fails, the table
+     * is ignored and the distances are computed as usual.
+     */
+    Topology(
+        utils::UInt num_qubits,
+        const utils::Json &topology,
+        const utils::Vec<utils::Vec<utils::UInt>> &precomputed_distance = {}
+    );
+
+    /**
+     * Returns the distance table computed for specified connectivity, which
+     * may be saved and passed to the constructor later to skip computing it
+     * again. Empty for full connectivity.
      */
-    Topology(utils::UInt num_qubits, const utils::Json &topology);
+    const utils::Vec<utils::Vec<utils::UInt>> &get_distance_table() const;
 
     /**
      * Returns the number of qubits for this topology.
@@ -4,6 +4,9 @@
 
 #pragma once
 
+#include <functional>
+#include <memory>
+#include <mutex>
 #include "ql/utils/num.h"
 #include "ql/utils/str.h"
 #include "ql/utils/opt.h"
@@ -15,6 +18,14 @@
 
 namespace ql {
 namespace ir {
+
+/**
+ * Instruction set data derived from a legacy platform by convert_old_to_new().
+ * Defined in old_to_new.cc; only forward-declared here such that it can be
+ * cached along with the platform.
+ */
+struct ParsedInstructionSet;
+
 namespace compat {
 
 using CustomGateRef = utils::One<gate_types::Custom>;
@@ -23,6 +34,25 @@ using InstructionMap = utils::Map<utils::Str, CustomGateRef>;
 
 class Platform;
 
+/**
+ * Cache slot for data derived from the instruction set of a platform by
+ * convert_old_to_new(). Shared between all platforms built from the same
+ * configuration, as they share their instruction set.
+ */
+struct InstructionSetCache {
+
+    /**
+     * Mutex protecting the cached value.
+     */
+    std::mutex mutex;
+
+    /**
+     * The cached value, or empty if it has not been computed yet.
+     */
+    std::shared_ptr<const ParsedInstructionSet> parsed;
+
+};
+
 /**
  * Smart pointer reference to a platform.
  */
@@ -148,6 +178,13 @@ public:
      */
     utils::Json platform_config;
 
+    /**
+     * Cache for convert_old_to_new(), such that the instruction set does not
+     * have to be parsed again every time the platform is converted. This is
+     * valid because the instruction set cannot change after construction.
+     */
+    std::shared_ptr<InstructionSetCache> instruction_set_cache;
+
 public:
 
     /**
@@ -168,25 +205,58 @@ private:
     );
 
     /**
-     * Constructs a platform from the given configuration filename.
+     * Constructs the topology from the given JSON data, using the on-disk
+     * distance table cache if the platform_cache_dir option is set.
+     */
+    void load_topology(const utils::Json &topology_cfg);
+
+    /**
+     * Constructs a prototype platform from the given configuration data. If
+     * architecture is given, it is used unless the configuration specifies
+     * another one.
      */
     Platform(
-        const utils::Str &name,
-        const utils::Str &platform_config,
+        const arch::CArchitectureRef &architecture,
+        utils::Json &platform_config,
+        const utils::Str &platform_config_fname,
         const utils::Str &compiler_config
     );
 
     /**
-     * Constructs a platform from the given configuration *data*.
+     * Constructs a platform with the given name from a prototype platform
+     * returned by get_prototype(). The immutable components of the prototype
+     * (instruction set and topology) are shared rather than copied.
      */
-    Platform(
+    Platform(const utils::Str &name, const Platform &prototype);
+
+    /**
+     * Returns the prototype platform for the given cache key, using construct
+     * to make it if it is not in the process-wide platform cache yet (or if
+     * the cache is disabled via the platform_cache option). The key must
+     * capture everything the prototype depends on.
+     */
+    static std::shared_ptr<const Platform> get_prototype(
+        const utils::Str &key,
+        const std::function<Platform*()> &construct
+    );
+
+    /**
+     * Constructs a platform with the given name from the given prototype and
+     * runs the architecture-specific post-processing on it.
+     */
+    static PlatformRef build_from_prototype(
         const utils::Str &name,
-        const utils::Json &platform_config,
-        const utils::Str &compiler_config
+        const std::shared_ptr<const Platform> &prototype
     );
 
 public:
 
+    /**
+     * Drops all prototypes from the process-wide platform cache. Platforms
+     * that were built from them remain valid.
+     */
+    static void clear_prototype_cache();
+
     /**
      * Constructs a platform from the given configuration filename.
      */
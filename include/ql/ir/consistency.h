@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include "ql/utils/map.h"
 #include "ql/ir/ir.h"
 
 namespace ql {
@@ -17,5 +18,89 @@ namespace ir {
  */
 void check_consistency(const Ref &ir);
 
+/**
+ * Levels for the consistency_checks option, in increasing order of
+ * thoroughness.
+ */
+enum class ConsistencyCheckLevel {
+
+    /**
+     * No consistency checks are performed.
+     */
+    OFF,
+
+    /**
+     * The IR is only checked at the boundaries of the compiler, i.e. when it
+     * enters or leaves the pass manager or is read from a file.
+     */
+    BOUNDARY,
+
+    /**
+     * The IR is additionally checked after every pass and at every legacy
+     * pass boundary.
+     */
+    PARANOID
+
+};
+
+/**
+ * Returns the consistency check level selected via the consistency_checks
+ * option.
+ */
+ConsistencyCheckLevel get_consistency_check_level();
+
+/**
+ * Same as check_consistency(const Ref&), but only performs the check if the
+ * level selected via the consistency_checks option is at least the given
+ * level.
+ */
+void check_consistency(const Ref &ir, ConsistencyCheckLevel level);
+
+/**
+ * Incremental consistency checker, used for the paranoid check level. On
+ * construction and after each check, it records a fingerprint of the
+ * platform, the program structure, and each block. check() then only visits
+ * the blocks for which the fingerprint changed, unless the platform or
+ * program structure changed, in which case everything is checked.
+ *
+ * The fingerprint of a block is a structural hash over the identity of every
+ * statement and expression node in it (recursively), along with the cycle
+ * numbers, links, and literal values they contain, so nodes that are modified
+ * in-place are detected as well. Matrix and JSON literal values are not
+ * covered. The well-formedness check of tree-gen still runs over the whole
+ * tree, because links may cross block boundaries.
+ */
+class IncrementalConsistencyChecker {
+private:
+
+    /**
+     * Fingerprint of the platform and program structure at the time of the
+     * previous check.
+     */
+    utils::UInt structure_fingerprint;
+
+    /**
+     * Fingerprint of each block at the time of the previous check.
+     */
+    utils::Map<const Block*, utils::UInt> block_fingerprints;
+
+public:
+
+    /**
+     * Constructs an incremental checker, recording the current state of the
+     * given IR as the reference point. The IR is assumed to be consistent.
+     */
+    explicit IncrementalConsistencyChecker(const Ref &ir);
+
+    /**
+     * Checks the parts of the given IR that changed since construction or
+     * the previous call to check(). An exception is thrown if a problem is
+     * found. Well-formedness (in the tree-gen sense) is always checked for
+     * the complete tree, because links may cross block boundaries.
+     */
+    void check(const Ref &ir);
+
+};
+
 } // namespace ir
 } // namespace ql
@@ -0,0 +1,65 @@
+/** \file
+ * Defines the Pauli frame optimizer pass.
+ */
+
+#pragma once
+
+#include "ql/pmgr/pass_types/specializations.h"
+
+namespace ql {
+namespace pass {
+namespace opt {
+namespace clifford {
+namespace pauli_frame {
+
+/**
+ * Pauli frame optimizer pass.
+ */
+class PauliFrameOptimizePass : public pmgr::pass_types::KernelTransformation {
+protected:
+
+    /**
+     * Dumps docs for the Pauli frame optimizer.
+     */
+    void dump_docs(
+        std::ostream &os,
+        const utils::Str &line_prefix
+    ) const override;
+
+public:
+
+    /**
+     * Returns a user-friendly type name for this pass.
+     */
+    utils::Str get_friendly_type() const override;
+
+    /**
+     * Constructs a Pauli frame optimizer.
+     */
+    PauliFrameOptimizePass(
+        const utils::Ptr<const pmgr::Factory> &pass_factory,
+        const utils::Str &instance_name,
+        const utils::Str &type_name
+    );
+
+    /**
+     * Runs the Pauli frame optimizer.
+     */
+    utils::Int run(
+        const ir::compat::ProgramRef &program,
+        const ir::compat::KernelRef &kernel,
+        const pmgr::pass_types::Context &context
+    ) const override;
+
+};
+
+/**
+ * Shorthand for referring to the pass using namespace notation.
+ */
+using Pass = PauliFrameOptimizePass;
+
+} // namespace pauli_frame
+} // namespace clifford
+} // namespace opt
+} // namespace pass
+} // namespace ql
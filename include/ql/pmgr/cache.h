@@ -0,0 +1,141 @@
+/** \file
+ * Content-addressed compile cache for pass results.
+ *
+ * Results are keyed by a hash of everything that determines them: the OpenQL
+ * version, the configuration of the pass (or pass group), the global options,
+ * the platform, and the input program or kernel. The IR is serialized via
+ * cQASM for both the key and the stored result, so only results that survive
+ * a round trip through cQASM are stored; annotations and other information
+ * that cQASM cannot represent is neither part of the key nor restored on a
+ * cache hit.
+ */
+
+#pragma once
+
+#include "ql/utils/num.h"
+#include "ql/utils/str.h"
+#include "ql/ir/ir.h"
+
+namespace ql {
+namespace pmgr {
+namespace cache {
+
+/**
+ * Returns a stable 128-bit hash of the given data as a hexadecimal string.
+ * Unlike std::hash, this is stable across processes and platforms, so it can
+ * be used for naming cache files.
+ */
+utils::Str digest(const utils::Str &data);
+
+/**
+ * Returns a summary of the platform contents. The pass results are only
+ * stored when a pass does not change this summary, since only the program is
+ * restored from the cache.
+ */
+utils::Str summarize_platform(const ir::Ref &ir);
+
+/**
+ * Builds the key text for the given pass configuration and input. The
+ * returned string is the data to be hashed; it includes the OpenQL version,
+ * the global options that may affect compilation, and the platform
+ * configuration of the given IR.
+ */
+utils::Str make_key(
+    const utils::Str &pass_config,
+    const ir::Ref &ir,
+    const utils::Str &input
+);
+
+/**
+ * Serializes the program of the given IR to cQASM.
+ */
+utils::Str serialize(const ir::Ref &ir);
+
+/**
+ * Reads the given serialized program into a new IR root that shares the
+ * platform of the given IR. Returns an empty reference if the data could
+ * not be read.
+ */
+ir::Ref deserialize(const ir::Ref &ir, const utils::Str &data);
+
+/**
+ * Returns the IR read from the given serialized program if it serializes to
+ * exactly the same data again, or an empty reference if it does not. Only
+ * data for which this holds is stored in the cache.
+ */
+ir::Ref verify_round_trip(const ir::Ref &ir, const utils::Str &data);
+
+/**
+ * On-disk store of cached pass results, configured via the cache_dir and
+ * cache_size_limit global options. Each entry is a file named after the
+ * digest of its key, that starts with a header line containing the digest,
+ * the length of the key, and the return value of the pass, followed by the
+ * full key and the result data. An entry is only used when its key matches
+ * exactly, so hash collisions result in a miss. Entries are written to a
+ * temporary file first, such that concurrent readers never see a partial
+ * entry, so the directory may be shared by any number of processes. When an
+ * entry is saved and the total size of the entries exceeds the size limit,
+ * the least recently used entries are removed.
+ */
+class Store {
+private:
+
+    /**
+     * The cache directory, or an empty string if caching is disabled.
+     */
+    utils::Str dir;
+
+    /**
+     * The size limit for the cache directory in bytes.
+     */
+    utils::UInt size_limit;
+
+    /**
+     * Returns the filename for the entry with the given digest.
+     */
+    utils::Str get_filename(const utils::Str &hash) const;
+
+    /**
+     * Removes the least recently used entries other than the given one until
+     * the total size of the entries is within the size limit. Returns the
+     * total size of the remaining entries.
+     */
+    utils::UInt evict(const utils::Str &keep) const;
+
+public:
+
+    /**
+     * Constructs the store from the current global options.
+     */
+    Store();
+
+    /**
+     * Returns whether caching is enabled, i.e. whether cache_dir is set.
+     */
+    utils::Bool is_enabled() const;
+
+    /**
+     * Looks up the entry for the given key. Returns whether it was found; if
+     * so, retval and data are set to the stored return value and result data.
+     */
+    utils::Bool load(
+        const utils::Str &key,
+        utils::Int &retval,
+        utils::Str &data
+    ) const;
+
+    /**
+     * Stores the given return value and result data for the given key.
+     * Failure to write the entry is not an error, but results in a warning.
+     */
+    void save(
+        const utils::Str &key,
+        utils::Int retval,
+        const utils::Str &data
+    ) const;
+
+};
+
+} // namespace cache
+} // namespace pmgr
+} // namespace ql
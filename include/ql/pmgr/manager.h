@@ -14,6 +14,7 @@
 #include "ql/utils/set.h"
 #include "ql/utils/pair.h"
 #include "ql/utils/options.h"
+#include "ql/utils/logger.h"
 #include "ql/utils/compat.h"
 #include "ql/ir/ir.h"
 #include "ql/pmgr/declarations.h"
@@ -73,6 +74,35 @@ private:
      */
     PassRef root;
 
+    /**
+     * Private copy of OpenQL's global options for compilations using this
+     * pass manager, made by the first call to set_context_option() or
+     * set_log_streams(). While empty, the global options are used.
+     */
+    utils::Ptr<utils::Options> context_options;
+
+    /**
+     * Logging context for compilations using this pass manager, created along
+     * with context_options. While empty, the process-wide log level and the
+     * standard output streams are used.
+     */
+    utils::Ptr<utils::logger::Context> context_logger;
+
+    /**
+     * Whether the compatibility-mode global options (see
+     * convert_global_to_pass_options() in manager.cc) apply to the passes of
+     * this pass manager. They are converted to pass options when the passes
+     * are constructed rather than when the pass manager is built, such that
+     * options set via set_context_option() in the meantime are respected.
+     */
+    utils::Bool compatibility_mode = false;
+
+    /**
+     * Creates context_options and context_logger from the current global
+     * options and log level if they don't exist yet.
+     */
+    void ensure_context();
+
 public:
 
     /**
@@ -299,6 +329,30 @@ public:
      */
     void clear_passes();
 
+    /**
+     * Sets one of OpenQL's global options (see com::options) for compilations
+     * using this pass manager only. The first call gives this pass manager a
+     * private copy of the current global options and log level, after which
+     * changes to the global options no longer affect it. This allows
+     * independent pass managers to compile concurrently in different threads.
+     */
+    void set_context_option(const utils::Str &option, const utils::Str &value);
+
+    /**
+     * Returns the value of one of OpenQL's global options as used for
+     * compilations using this pass manager.
+     */
+    utils::Str get_context_option(const utils::Str &option) const;
+
+    /**
+     * Redirects the log output of compilations using this pass manager to the
+     * given streams, for debug/info messages and warnings/errors respectively.
+     * Like set_context_option(), this gives the pass manager a private copy of
+     * the global options. The streams must outlive the pass manager or the
+     * next call to this function, whichever comes first.
+     */
+    void set_log_streams(std::ostream &out, std::ostream &err);
+
     /**
      * Constructs all passes recursively. This freezes the pass options, but
      * allows subtrees to be modified.
@@ -307,7 +361,8 @@ public:
 
     /**
      * Ensures that all passes have been constructed, and then runs the passes
-     * on the given program.
+     * on the given program. Different pass managers may compile concurrently
+     * in different threads, but a single pass manager may not.
      */
     void compile(const ir::Ref &ir);
 
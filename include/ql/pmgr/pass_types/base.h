@@ -258,6 +258,23 @@ protected:
      */
     virtual utils::Bool is_legacy() const;
 
+    /**
+     * Returns whether this pass operates on each kernel independently, such
+     * that its results can be cached per kernel. Returns false unless
+     * overridden.
+     */
+    virtual utils::Bool is_kernel_local() const;
+
+    /**
+     * Returns the key text for the compile cache for running this pass or pass
+     * group on the given input, using the platform of the given IR. The input
+     * is normally the serialized program or kernel.
+     */
+    utils::Str make_cache_key(
+        const ir::Ref &ir,
+        const utils::Str &input
+    ) const;
+
     /**
      * Returns `pass "<name>"` for normal passes and `root` for the root pass.
      * Used for error messages.
@@ -602,6 +619,30 @@ private:
         const Context &context
     ) const;
 
+    /**
+     * Dumps the complete configuration of this pass and all sub-passes,
+     * including the options that were not explicitly set, for use as part of
+     * the compile cache key.
+     */
+    void dump_cache_config(std::ostream &os) const;
+
+    /**
+     * Traverses our level of the pass tree based on our node type.
+     */
+    void run_node(
+        const ir::Ref &ir,
+        const Context &context
+    ) const;
+
+    /**
+     * Wrapper around run_node() that takes the resulting program from the
+     * compile cache if it is there, and stores it in the cache otherwise.
+     */
+    void run_node_cached(
+        const ir::Ref &ir,
+        const Context &context
+    ) const;
+
 public:
 
     /**
@@ -176,6 +176,20 @@ protected:
  * using the old IR.
  */
 class KernelTransformation : public Normal {
+private:
+
+    /**
+     * Wrapper around run() for a single kernel that takes the resulting kernel
+     * from the compile cache if it is there, and stores it in the cache
+     * otherwise.
+     */
+    utils::Int run_cached(
+        const ir::Ref &ir,
+        const ir::compat::ProgramRef &program,
+        const ir::compat::KernelRef &kernel,
+        const Context &context
+    ) const;
+
 protected:
 
     /**
@@ -220,6 +234,11 @@ protected:
      */
     utils::Bool is_legacy() const override;
 
+    /**
+     * Returns that this pass operates on each kernel independently.
+     */
+    utils::Bool is_kernel_local() const override;
+
 };
 
 /**
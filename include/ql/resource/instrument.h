@@ -7,6 +7,7 @@
 
 #include "ql/utils/set.h"
 #include "ql/utils/rangemap.h"
+#include "ql/utils/cow.h"
 #include "ql/rmgr/resource_types/base.h"
 
 namespace ql {
@@ -30,15 +31,43 @@ class InstrumentResource : public rmgr::resource_types::Base {
 private:
 
     /**
-     * The reservations made for each instrument.
+     * The reservations made for each instrument. Each instrument's
+     * reservations are shared with clones of this resource until either copy
+     * reserves that instrument.
      */
-    utils::Vec<State> state;
+    utils::Vec<utils::Cow<State>> state;
 
     /**
      * Shared pointer to the configuration structure.
      */
     utils::Ptr<Config> config;
 
+    /**
+     * Determines which instruments are affected by the given gate, and (if the
+     * instruments are not mutually exclusive) which function the gate needs
+     * them for. Returns false if the resource does not care about the gate at
+     * all.
+     */
+    utils::Bool get_affected(
+        const rmgr::resource_types::GateData &gate,
+        utils::Set<utils::UInt> &affected,
+        utils::UInt &function
+    );
+
+    /**
+     * Returns the nearest start cycle from the given cycle onward (or
+     * backward) for which the given instrument can be used for a gate with
+     * the given duration and function, or a cycle closer to that; the
+     * instrument is not available in any of the cycles in between.
+     */
+    utils::Int find_free(
+        utils::UInt index,
+        utils::Int cycle,
+        utils::UInt duration,
+        utils::UInt function,
+        utils::Bool forward
+    ) const;
+
 protected:
 
     /**
@@ -55,6 +84,16 @@ protected:
         utils::Bool commit
     ) override;
 
+    /**
+     * Returns the nearest cycle in which all affected instruments are free for
+     * the function of the given gate.
+     */
+    utils::Int on_earliest_available(
+        utils::Int from_cycle,
+        const rmgr::resource_types::GateData &gate,
+        rmgr::Direction search_direction
+    ) override;
+
     /**
      * Dumps documentation for this resource.
      */
@@ -5,7 +5,9 @@
 
 #pragma once
 
+#include "ql/utils/set.h"
 #include "ql/utils/rangemap.h"
+#include "ql/utils/cow.h"
 #include "ql/rmgr/resource_types/base.h"
 
 namespace ql {
@@ -30,15 +32,26 @@ class InterCoreChannelResource : public rmgr::resource_types::Base {
 private:
 
     /**
-     * The reservations for each [core][channel].
+     * The reservations for each [core][channel]. The reservations of each core
+     * are shared with clones of this resource until either copy reserves a
+     * channel of that core.
      */
-    utils::Vec<utils::Vec<State>> state;
+    utils::Vec<utils::Cow<utils::Vec<State>>> state;
 
     /**
      * Shared pointer to the configuration structure.
      */
     utils::Ptr<Config> config;
 
+    /**
+     * Determines which cores are affected by the given gate. Returns false if
+     * the resource does not care about the gate at all.
+     */
+    utils::Bool get_affected(
+        const rmgr::resource_types::GateData &gate,
+        utils::Set<utils::UInt> &affected
+    ) const;
+
 protected:
 
     /**
@@ -55,6 +68,16 @@ protected:
         utils::Bool commit
     ) override;
 
+    /**
+     * Returns the nearest cycle in which all affected cores have a free
+     * channel.
+     */
+    utils::Int on_earliest_available(
+        utils::Int from_cycle,
+        const rmgr::resource_types::GateData &gate,
+        rmgr::Direction search_direction
+    ) override;
+
     /**
      * Dumps documentation for this resource.
      */
@@ -6,6 +6,7 @@
 #pragma once
 
 #include "ql/utils/rangemap.h"
+#include "ql/utils/cow.h"
 #include "ql/rmgr/resource_types/base.h"
 
 namespace ql {
@@ -25,9 +26,11 @@ class QubitResource : public rmgr::resource_types::Base {
 private:
 
     /**
-     * The reservations for each qubit.
+     * The reservations for each qubit. Each qubit's reservations are shared
+     * with clones of this resource until either copy reserves that qubit, such
+     * that cloning only copies pointers.
      */
-    utils::Vec<State> state;
+    utils::Vec<utils::Cow<State>> state;
 
     /**
      * When set, there is a defined scheduling direction, which means it's
@@ -51,6 +54,15 @@ protected:
         utils::Bool commit
     ) override;
 
+    /**
+     * Returns the nearest cycle in which all qubit operands are free.
+     */
+    utils::Int on_earliest_available(
+        utils::Int from_cycle,
+        const rmgr::resource_types::GateData &gate,
+        rmgr::Direction search_direction
+    ) override;
+
     /**
      * Dumps documentation for this resource.
      */
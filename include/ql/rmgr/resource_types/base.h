@@ -111,7 +111,11 @@ protected:
     virtual void on_initialize(Direction direction);
 
     /**
-     * Abstract implementation for gate().
+     * Abstract implementation for gate(). The state of the resource must only
+     * be modified when commit is set, because rmgr::State shares resource
+     * objects between its copies until something is reserved. Likewise, the
+     * resource should be cheap to copy if possible, as it is cloned whenever a
+     * shared copy reserves something.
      */
     virtual utils::Bool on_gate(
         utils::Int cycle,
@@ -119,6 +123,23 @@ protected:
         utils::Bool commit
     ) = 0;
 
+    /**
+     * Abstract implementation for earliest_available(). This must return
+     * from_cycle if the gate is available in that cycle. Otherwise, it must
+     * return a cycle further along in search_direction (which is either
+     * FORWARD or BACKWARD), such that the gate is not available in any of the
+     * cycles in between; the returned cycle itself need not be available.
+     * Return utils::MAX (forward) or utils::MIN (backward) if the gate will
+     * never be available. The default implementation just checks from_cycle
+     * using on_gate() and returns the next cycle if it's not available;
+     * resources should override this to skip over their reservations directly.
+     */
+    virtual utils::Int on_earliest_available(
+        utils::Int from_cycle,
+        const GateData &gate,
+        Direction search_direction
+    );
+
     /**
      * Abstract implementation for dump_docs().
      */
@@ -228,6 +249,38 @@ public:
         utils::Bool commit
     );
 
+    /**
+     * Converts the given old-IR gate to the gate data structure that gate() and
+     * earliest_available() operate on. This only depends on the platform, so
+     * it can be reused for all resources of the same manager.
+     */
+    GateData get_gate_data(const ir::compat::GateRef &gate) const;
+
+    /**
+     * Converts the given new-IR statement to the gate data structure that
+     * gate() and earliest_available() operate on. This only depends on the
+     * platform, so it can be reused for all resources of the same manager.
+     */
+    GateData get_gate_data(const ir::StatementRef &statement) const;
+
+    /**
+     * Returns the cycle nearest to from_cycle in search_direction (either
+     * FORWARD or BACKWARD, including from_cycle itself) in which the given gate
+     * data structure could be scheduled as far as this resource is concerned,
+     * or a cycle that is closer to it in case the resource cannot determine
+     * this directly. Either way, the gate is guaranteed to not be available in
+     * any of the cycles that were skipped over, so calling this until the
+     * returned value no longer changes yields the nearest available cycle.
+     * Returns utils::MAX (forward) or utils::MIN (backward) if the gate will
+     * never be available, for instance because the cycles in search_direction
+     * precede the last reservation in the scheduling direction.
+     */
+    utils::Int earliest_available(
+        utils::Int from_cycle,
+        const GateData &data,
+        Direction search_direction
+    );
+
     /**
      * Dumps a debug representation of the current resource state.
      */
@@ -5,6 +5,7 @@
 
 #pragma once
 
+#include <functional>
 #include "ql/utils/num.h"
 #include "ql/utils/vec.h"
 #include "ql/ir/compat/compat.h"
@@ -26,7 +27,11 @@ private:
     friend class Manager;
 
     /**
-     * The list of resources and their state.
+     * The list of resources and their state. Copies of a State share the
+     * resource objects until either copy reserves something, at which point
+     * the shared resources are cloned (see make_unique()). Cloning a resource
+     * is itself cheap for the builtin resources, as they share their
+     * per-qubit, per-instrument, or per-core state in the same way.
      */
     utils::Vec<ResourceRef> resources;
 
@@ -42,12 +47,33 @@ private:
      */
     State();
 
+    /**
+     * Clones the resources that are still shared with other copies of this
+     * state, such that they can be modified. Called before anything is
+     * reserved.
+     */
+    void make_unique();
+
+    /**
+     * Implementation for the earliest_available() overloads, considering the
+     * given resources. Each resource reports the nearest cycle it might be
+     * available in, which the next resource then starts from, until all
+     * resources agree.
+     */
+    static utils::Int earliest_available(
+        const utils::Vec<ResourceRef> &of,
+        utils::Int from_cycle,
+        const resource_types::GateData &data,
+        Direction direction
+    );
+
 public:
 
     /**
-     * Copy constructor that clones the resource states.
+     * Copy constructor. The resource states are shared with src until either
+     * state is modified, so this only copies pointers.
      */
-    State(const State &src);
+    State(const State &src) = default;
 
     /**
      * Move constructor.
@@ -55,9 +81,10 @@ public:
     State(State &&src) = default;
 
     /**
-     * Copy assignment operator that clones the resource states.
+     * Copy assignment operator. The resource states are shared with src until
+     * either state is modified, so this only copies pointers.
      */
-    State &operator=(const State &src);
+    State &operator=(const State &src) = default;
 
     /**
      * Move assignment operator.
@@ -82,6 +109,45 @@ public:
         const ir::StatementRef &statement
     ) const;
 
+    /**
+     * Returns the cycle nearest to from_cycle in the given search direction
+     * (either FORWARD or BACKWARD, including from_cycle itself) in which the
+     * given old-IR gate can be scheduled, i.e. the first cycle for which
+     * available() would return true. Returns utils::MAX (forward) or utils::MIN
+     * (backward) if there is no such cycle.
+     */
+    utils::Int earliest_available(
+        utils::Int from_cycle,
+        const ir::compat::GateRef &gate,
+        Direction direction
+    ) const;
+
+    /**
+     * Like earliest_available() for old-IR gates, but only considers the
+     * resources for which the given predicate returns true. This can be used
+     * to determine how long a particular kind of resource alone would delay a
+     * gate.
+     */
+    utils::Int earliest_available(
+        utils::Int from_cycle,
+        const ir::compat::GateRef &gate,
+        Direction direction,
+        const std::function<utils::Bool(const resource_types::Base &resource)> &filter
+    ) const;
+
+    /**
+     * Returns the cycle nearest to from_cycle in the given search direction
+     * (either FORWARD or BACKWARD, including from_cycle itself) in which the
+     * given new-IR statement can be scheduled, i.e. the first cycle for which
+     * available() would return true. Returns utils::MAX (forward) or utils::MIN
+     * (backward) if there is no such cycle.
+     */
+    utils::Int earliest_available(
+        utils::Int from_cycle,
+        const ir::StatementRef &statement,
+        Direction direction
+    ) const;
+
     /**
      * Schedules the given old-IR gate at the given (start) cycle. Throws an
      * exception if this is not possible. When an exception is thrown, the
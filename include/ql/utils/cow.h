@@ -0,0 +1,100 @@
+/** \file
+ * Provides a copy-on-write value container.
+ */
+
+#pragma once
+
+#include <utility>
+#include "ql/utils/num.h"
+#include "ql/utils/ptr.h"
+
+namespace ql {
+namespace utils {
+
+/**
+ * Copy-on-write container for a value of type T. Copying the container only
+ * copies a pointer, such that the copies share the value; the value itself is
+ * only copied when it is mutated through mut() while it is shared. This is
+ * useful for large, mostly-unchanged state that is copied often, such as the
+ * per-qubit or per-instrument state of scheduling resources.
+ *
+ * Note that different containers sharing the same value may be used from
+ * different threads, but a single container may not be.
+ */
+template <class T>
+class Cow {
+private:
+
+    /**
+     * The contained value, shared between copies of this container until one
+     * of them is mutated.
+     */
+    Ptr<T> v;
+
+public:
+
+    /**
+     * Constructs a container for a default-constructed value.
+     */
+    Cow() {
+        v.emplace();
+    }
+
+    /**
+     * Constructs a container for a copy of the given value.
+     */
+    explicit Cow(const T &value) {
+        v.emplace(value);
+    }
+
+    /**
+     * Constructs a container by moving the given value into it.
+     */
+    explicit Cow(T &&value) {
+        v.emplace(std::move(value));
+    }
+
+    /**
+     * Returns a const reference to the contained value.
+     */
+    const T &get() const {
+        return *v;
+    }
+
+    /**
+     * Returns a const reference to the contained value.
+     */
+    const T &operator*() const {
+        return *v;
+    }
+
+    /**
+     * Returns a const pointer to the contained value.
+     */
+    const T *operator->() const {
+        return v.operator->();
+    }
+
+    /**
+     * Returns a mutable reference to the contained value, copying it first if
+     * it is shared with other containers.
+     */
+    T &mut() {
+        if (is_shared()) {
+            v.emplace(*v);
+        }
+        return *v;
+    }
+
+    /**
+     * Returns whether the contained value is currently shared with other
+     * containers.
+     */
+    Bool is_shared() const {
+        return v.unwrap().use_count() > 1;
+    }
+
+};
+
+} // namespace utils
+} // namespace ql
@@ -178,8 +178,8 @@ public:
         auto _b = (b);                                                                                      \
         if (_a != _b) {                                                                                     \
             QL_THROW(ASSERT,                                                                                \
-                "assert \"" << try_to_string(_a) << "\" (" #a ") == "                                       \
-                "\"" << try_to_string(_b) << "\" (" #b ") "                                                 \
+                "assert \"" << ::ql::utils::try_to_string(_a) << "\" (" #a ") == "                          \
+                "\"" << ::ql::utils::try_to_string(_b) << "\" (" #b ") "                                    \
                 "failed in file " __FILE__ " at line " << __LINE__                                          \
             );                                                                                              \
         }                                                                                                   \
@@ -9,20 +9,11 @@
 #include "ql/utils/exception.h"
 #include "ql/utils/compat.h"
 #include "ql/utils/list.h"
+#include "ql/utils/vec.h"
 
 namespace ql {
 namespace utils {
 
-namespace {
-
-/**
- * Stack of working directories. Private; use push_working_directory(),
- * pop_working_directory(), and get_working_directory() to access.
- */
-QL_GLOBAL extern List<Str> working_directory_stack;
-
-} // anonymous namespace
-
 /**
  * Sets OpenQL's working directory to the given directory. If the directory
  * looks like a relative path, it is appended to the previous working directory.
@@ -77,6 +68,14 @@ Bool path_exists(const Str &path);
  */
 Str path_relative_to(const Str &base, const Str &path);
 
+/**
+ * Returns the given path as an absolute path. If path looks like a relative
+ * path, it is interpreted as relative to the current OpenQL working
+ * directory, which in turn is interpreted as relative to the working
+ * directory of the process if it is relative. The path is not normalized.
+ */
+Str get_absolute_path(const Str &path);
+
 /**
  * Returns the directory of the given path. On Linux and MacOS, this just maps
  * to dirname() from libgen.h. On Windows, the string is stripped from the last
@@ -92,6 +91,66 @@ Str dir_name(const Str &path);
  */
 void make_dirs(const Str &path);
 
+/**
+ * Information about a regular file, as returned by list_files().
+ */
+struct FileInfo {
+
+    /**
+     * Path to the file, consisting of the directory passed to list_files(),
+     * a slash, and the name of the file.
+     */
+    Str path;
+
+    /**
+     * Size of the file in bytes.
+     */
+    UInt size;
+
+    /**
+     * Modification time of the file in seconds since the epoch.
+     */
+    Int modified;
+
+};
+
+/**
+ * Returns information about the regular files in the given directory. Hidden
+ * files and subdirectories are not listed. An empty list is returned if the
+ * directory does not exist or cannot be read. If path looks like a relative
+ * path, it is interpreted as relative to the current OpenQL working directory.
+ */
+Vec<FileInfo> list_files(const Str &path);
+
+/**
+ * Sets the modification time of the given file to the current time. Returns
+ * whether this succeeded. If path looks like a relative path, it is
+ * interpreted as relative to the current OpenQL working directory.
+ */
+Bool touch_file(const Str &path);
+
+/**
+ * Removes the given file. Returns whether this succeeded. If path looks like
+ * a relative path, it is interpreted as relative to the current OpenQL
+ * working directory.
+ */
+Bool remove_file(const Str &path);
+
+/**
+ * Renames the given file, replacing the destination if it already exists.
+ * Returns whether this succeeded. If the paths look like relative paths,
+ * they are interpreted as relative to the current OpenQL working directory.
+ */
+Bool rename_file(const Str &from, const Str &to);
+
+/**
+ * Returns a name for a temporary file next to the given path, to be renamed
+ * to it with rename_file() once complete. The name includes the process ID
+ * and a counter, such that concurrent writers in any number of processes and
+ * threads never use the same temporary file.
+ */
+Str get_temporary_path(const Str &path);
+
 /**
  * Wrapper for std::ofstream that:
  *  - takes care of the insane error handling magic of C++ streams;
@@ -1,5 +1,6 @@
 /** \file
- * Provides macros for logging and the global loglevel variable.
+ * Provides macros for logging, the global loglevel variable, per-thread
+ * logging contexts, and the backend that formats and writes log records.
  */
 
 #pragma once
@@ -18,38 +19,44 @@
         std::cout << "[OPENQL] " << x << std::endl;                                                         \
     } while (false)
 
-#define QL_EOUT(content) \
+// helper macro: logs a single record with the given level and label (the text
+// between the source location and the message in the text format) if the log
+// level of the calling thread permits
+#define QL_LOG_RECORD(level, label, content) \
     do {                                                                                                    \
-        if (::ql::utils::logger::log_level >= ::ql::utils::logger::LogLevel::LOG_ERROR) {                   \
-            ::std::cerr << "[OPENQL] " __FILE__ ":" << __LINE__ << " Error: " << content << ::std::endl;    \
+        if (::ql::utils::logger::get_log_level() >= (level)) {                                              \
+            ::ql::utils::logger::Record ql_log_record((level), (label), __FILE__, __LINE__);                \
+            ql_log_record.stream() << content;                                                              \
+            ql_log_record.commit();                                                                         \
         }                                                                                                   \
     } while (false)
 
+#define QL_EOUT(content) \
+    QL_LOG_RECORD(::ql::utils::logger::LogLevel::LOG_ERROR, " Error: ", content)
+
 #define QL_WOUT(content) \
-    do {                                                                                                    \
-        if (::ql::utils::logger::log_level >= ::ql::utils::logger::LogLevel::LOG_WARNING) {                 \
-            ::std::cerr << "[OPENQL] " __FILE__ ":" << __LINE__ << " Warning: " << content << ::std::endl;  \
-        }                                                                                                   \
-    } while (false)
+    QL_LOG_RECORD(::ql::utils::logger::LogLevel::LOG_WARNING, " Warning: ", content)
 
 #define QL_IOUT(content) \
-    do {                                                                                                    \
-        if (::ql::utils::logger::log_level >= ::ql::utils::logger::LogLevel::LOG_INFO) {                    \
-            ::std::cout << "[OPENQL] " __FILE__ ":" << __LINE__ << " Info: "<< content << ::std::endl;      \
-        }                                                                                                   \
-    } while (false)
+    QL_LOG_RECORD(::ql::utils::logger::LogLevel::LOG_INFO, " Info: ", content)
 
+// When QL_STRIP_DEBUG_LOGGING is defined, debug messages are compiled out
+// entirely. The content is still type-checked, so variables that are only used
+// for debug output don't result in warnings.
+#ifdef QL_STRIP_DEBUG_LOGGING
 #define QL_DOUT(content) \
     do {                                                                                                    \
-        if (::ql::utils::logger::log_level >= ::ql::utils::logger::LogLevel::LOG_DEBUG) {                   \
-            ::std::cout << "[OPENQL] " __FILE__ ":" << __LINE__ << " " << content << ::std::endl;           \
+        if (false) {                                                                                        \
+            ::ql::utils::logger::out() << content;                                                          \
         }                                                                                                   \
     } while (false)
+#else
+#define QL_DOUT(content) \
+    QL_LOG_RECORD(::ql::utils::logger::LogLevel::LOG_DEBUG, " ", content)
+#endif
 
 #define QL_COUT(content) \
-    do {                                                                                                    \
-        ::std::cout << "[OPENQL] " __FILE__ ":" << __LINE__ << " " << content << ::std::endl;               \
-    } while (false)
+    QL_LOG_RECORD(::ql::utils::logger::LogLevel::LOG_NOTHING, " ", content)
 
 #define QL_FATAL(content) \
     do {                                                                                                    \
@@ -60,8 +67,13 @@
         QL_ICE(fatal_s);                                                                                    \
     } while (false)
 
+#ifdef QL_STRIP_DEBUG_LOGGING
 #define QL_IS_LOG_DEBUG \
-    (::ql::utils::logger::log_level >= ::ql::utils::logger::LogLevel::LOG_DEBUG)
+    (false)
+#else
+#define QL_IS_LOG_DEBUG \
+    (::ql::utils::logger::get_log_level() >= ::ql::utils::logger::LogLevel::LOG_DEBUG)
+#endif
 
 #define QL_IF_LOG_DEBUG \
     if QL_IS_LOG_DEBUG
@@ -79,11 +91,224 @@ enum LogLevel {
     LOG_DEBUG
 };
 
+/**
+ * The process-wide log level (verbosity), used by threads that have no logging
+ * context.
+ */
 QL_GLOBAL extern LogLevel log_level;
 
+/**
+ * Output formats for log records.
+ */
+enum class LogFormat {
+
+    /**
+     * Human-readable text, one line per record, prefixed with [OPENQL] and
+     * the source location.
+     */
+    TEXT,
+
+    /**
+     * JSON lines: one JSON object per record, with level, file, line, and
+     * message keys.
+     */
+    JSON
+
+};
+
+/**
+ * Logging configuration for a compilation context. While a context is active
+ * for a thread (see Scope), the logging macros use its log level and streams
+ * instead of the process-wide log level and std::cout/std::cerr, such that
+ * independent compilations can run concurrently with their own verbosity and
+ * output.
+ */
+struct Context {
+
+    /**
+     * The log level (verbosity) for this context.
+     */
+    LogLevel log_level;
+
+    /**
+     * The stream that debug and info messages are written to.
+     */
+    std::ostream *out;
+
+    /**
+     * The stream that warnings and errors are written to.
+     */
+    std::ostream *err;
+
+    /**
+     * The format in which records are written.
+     */
+    LogFormat format;
+
+    /**
+     * Whether records are collected in per-thread buffers and written by a
+     * background thread, rather than being written to the streams by the
+     * logging thread itself.
+     */
+    Bool async;
+
+    /**
+     * Constructs a context with the current log level, format, and
+     * asynchronicity of the calling thread and the standard output streams.
+     */
+    Context();
+
+};
+
+/**
+ * Makes the given logging context the active one for the calling thread
+ * until this object is destroyed, after which the previously active context
+ * (if any) is restored. Passing nullptr keeps the previously active context
+ * (or the process-wide defaults, if there is none) active.
+ */
+class Scope {
+private:
+
+    /**
+     * The context that was active before this scope.
+     */
+    Context *previous;
+
+public:
+
+    /**
+     * Activates the given context for the calling thread.
+     */
+    explicit Scope(Context *context);
+
+    /**
+     * Restores the previously active context, after writing out all records
+     * logged asynchronously by the calling thread.
+     */
+    ~Scope();
+
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+};
+
+/**
+ * Returns the logging context that is active for the calling thread, or
+ * nullptr if the process-wide defaults are used. Threads spawned as part of a
+ * compilation can activate it using Scope to log to the same context.
+ */
+Context *get_context();
+
+/**
+ * Returns the log level for the calling thread, i.e. that of its active
+ * context or the process-wide log level if there is none.
+ */
+LogLevel get_log_level();
+
+/**
+ * Returns the stream that debug and info messages should be written to for
+ * the calling thread.
+ */
+std::ostream &out();
+
+/**
+ * Returns the stream that warnings and errors should be written to for the
+ * calling thread.
+ */
+std::ostream &err();
+
+/**
+ * A single log record that is being constructed. Used by the logging macros:
+ * the message is written to stream(), after which commit() formats the record
+ * and writes it out, either directly or via the per-thread buffer and the
+ * background writer, depending on the active context. The message streams are
+ * reused, so constructing a record normally does not allocate.
+ */
+class Record {
+private:
+
+    /**
+     * The level of this record.
+     */
+    LogLevel level;
+
+    /**
+     * Label written between the source location and the message in the text
+     * format.
+     */
+    const char *label;
+
+    /**
+     * Source file that logged the record.
+     */
+    const char *file;
+
+    /**
+     * Source line that logged the record.
+     */
+    int line;
+
+    /**
+     * Per-thread stream that the message is written to.
+     */
+    StrStrm *message;
+
+public:
+
+    /**
+     * Starts constructing a log record.
+     */
+    Record(LogLevel level, const char *label, const char *file, int line);
+
+    /**
+     * Releases the message stream for reuse.
+     */
+    ~Record();
+
+    Record(const Record &) = delete;
+    Record &operator=(const Record &) = delete;
+
+    /**
+     * Returns the stream that the message should be written to.
+     */
+    std::ostream &stream();
+
+    /**
+     * Formats the record and writes it out.
+     */
+    void commit();
+
+};
+
+/**
+ * Writes out all records that were logged asynchronously by the calling
+ * thread, and waits for the background writer to write them to their streams.
+ * Records logged asynchronously by other threads are written when their
+ * buffer is full, when they call flush(), or when they exit.
+ */
+void flush();
+
 LogLevel log_level_from_string(const Str &level);
+
+/**
+ * Sets the log level of the active context of the calling thread, or the
+ * process-wide log level if there is none, using its string representation.
+ */
 void set_log_level(const Str &level);
 
+/**
+ * Sets the log format of the active context of the calling thread, or the
+ * process-wide log format if there is none, using its string representation
+ * (text or json).
+ */
+void set_log_format(const Str &format);
+
+/**
+ * Sets whether the active context of the calling thread, or the process as a
+ * whole if there is none, logs asynchronously.
+ */
+void set_log_async(Bool async);
+
 } // namespace logger
 } // namespace utils
 } // namespace ql
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include "ql/utils/num.h"
+
 // get the number of elements in an array
 #define ELEM_CNT(x) (sizeof(x)/sizeof(x[0]))
 
@@ -16,5 +18,12 @@ inline void zero(T(&arr)[SIZE]) {
     memset(arr, 0, SIZE * sizeof(T));
 }
 
+/**
+ * Returns the peak resident set size of this process in bytes, i.e. the
+ * largest amount of physical memory it has used so far, or 0 if this is not
+ * known on this platform.
+ */
+UInt get_peak_memory_usage();
+
 } // namespace utils
 } // namespace ql
@@ -495,5 +495,41 @@ public:
  */
 std::ostream &operator<<(std::ostream &os, const Options &options);
 
+/**
+ * Returns the options record that is active for the calling thread (see
+ * OptionsScope), or nullptr if there is none.
+ */
+Options *get_active_options();
+
+/**
+ * Makes the given options record the active one for the calling thread until
+ * this object is destroyed, after which the previously active record (if any)
+ * is restored. Passing nullptr keeps the previously active record active.
+ */
+class OptionsScope {
+private:
+
+    /**
+     * The options record that was active before this scope.
+     */
+    Options *previous;
+
+public:
+
+    /**
+     * Activates the given options record for the calling thread.
+     */
+    explicit OptionsScope(Options *options);
+
+    /**
+     * Restores the previously active options record.
+     */
+    ~OptionsScope();
+
+    OptionsScope(const OptionsScope &) = delete;
+    OptionsScope &operator=(const OptionsScope &) = delete;
+
+};
+
 } // namespace utils
 } // namespace ql
@@ -0,0 +1,30 @@
+/** \file
+ * Provides a simple way to run independent tasks on a number of threads.
+ */
+
+#pragma once
+
+#include <functional>
+#include "ql/utils/num.h"
+
+namespace ql {
+namespace utils {
+
+/**
+ * Runs task(thread, index) for indices 0 to count-1 on the given number of
+ * threads, where thread identifies the thread running the task (0 being the
+ * calling thread). The tasks use the logging context and the options record
+ * that are active for the calling thread. When more than one thread is used,
+ * the records logged by each task are collected and written out in index
+ * order once all tasks are done, such that the log does not depend on how
+ * the tasks were distributed over the threads. The first exception thrown by
+ * a task is rethrown on the calling thread once all threads have stopped.
+ */
+void run_parallel(
+    UInt count,
+    UInt threads,
+    const std::function<void(UInt thread, UInt index)> &task
+);
+
+} // namespace utils
+} // namespace ql
@@ -463,6 +463,34 @@ public:
         };
     }
 
+    /**
+     * Returns the start of the range of the same length as the given range
+     * that is nearest to it without overlapping with any range in the map,
+     * searching only in the direction of increasing keys if forward is set, or
+     * only in the direction of decreasing keys otherwise. Ranges that are
+     * skipped over are thus guaranteed to overlap with a range in the map.
+     * This requires the key type to support addition and subtraction.
+     */
+    Key find_free(const Range &range, utils::Bool forward) const {
+        if (!range_valid(range)) {
+            throw utils::Exception(
+                "Invalid range presented to find_free(): " + utils::try_to_string(range)
+            );
+        }
+        auto length = range.second - range.first;
+        auto first = range.first;
+        while (true) {
+            auto its = find_internal({first, first + length});
+            if (its.first == its.second) {
+                return first;
+            } else if (forward) {
+                first = std::prev(its.second)->first.second;
+            } else {
+                first = its.first->first.first - length;
+            }
+        }
+    }
+
     /**
      * Returns an iterator to the range that contains the given key, or end() if
      * no such range exists.
@@ -165,6 +165,25 @@ std::string Compiler::get_option(const std::string &path) const {
     return pass_manager->get_option(path).as_str();
 }
 
+/**
+ * Sets one of the global options (see set_option() in the openql module)
+ * for compilations using this compiler only. The first call gives the
+ * compiler a private copy of the current global options, after which
+ * changes to the global options no longer affect it. Compilers with
+ * private options can compile concurrently in different threads.
+ */
+void Compiler::set_context_option(const std::string &option, const std::string &value) {
+    pass_manager->set_context_option(option, value);
+}
+
+/**
+ * Returns the value of one of the global options (see get_option() in the
+ * openql module) as used for compilations using this compiler.
+ */
+std::string Compiler::get_context_option(const std::string &option) const {
+    return pass_manager->get_context_option(option);
+}
+
 #ifdef QL_HIERARCHICAL_PASS_MANAGEMENT
 /**
  * Appends a pass to the end of the pass list. If type_name is empty
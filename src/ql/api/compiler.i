@@ -210,6 +210,45 @@ str
 #endif
 
 
+%feature("docstring") ql::api::Compiler::set_context_option
+"""
+Sets one of the global options (see set_option() in the openql module) for
+compilations using this compiler only. The first call gives the compiler a
+private copy of the current global options, after which changes to the global
+options no longer affect it. Compilers with private options can compile
+concurrently in different threads.
+
+Parameters
+----------
+option : str
+    The name of the global option.
+value : str
+    The new value for the option.
+
+Returns
+-------
+None
+"""
+
+
+%feature("docstring") ql::api::Compiler::get_context_option
+"""
+Returns the value of one of the global options (see get_option() in the openql
+module) as used for compilations using this compiler.
+
+Parameters
+----------
+option : str
+    The name of the global option.
+
+Returns
+-------
+str
+    The value of the option. If the option has not been set, the default value
+    is returned.
+"""
+
+
 #ifdef QL_HIERARCHICAL_PASS_MANAGEMENT
 %feature("docstring") ql::api::Compiler::append_pass
 """
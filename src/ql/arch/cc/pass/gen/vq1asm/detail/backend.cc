@@ -24,10 +24,14 @@
 
 #include "ql/utils/str.h"
 #include "ql/utils/filesystem.h"
+#include "ql/utils/parallel.h"
 #include "ql/ir/compat/platform.h"
 #include "ql/com/options.h"
 
 #include <regex>
+#include <chrono>
+#include <algorithm>
+#include <thread>
 
 
 // define classical QASM instructions as generated by classical.h
@@ -71,36 +75,74 @@ void Backend::compile(const ir::compat::ProgramRef &program, const OptionsRef &o
     QL_DOUT("Compiling " << program->kernels.size() << " kernels to generate Central Controller program ... ");
 
     // init
+    this->options = options;
     loadHwSettings(program->platform);
     codegen.init(program->platform, options);
-    bundleIdx = 0;
 
-    // generate program header
-    codegen.programStart(program->unique_name);
-
-    // generate code for all kernels
-    for (auto &kernel : program->kernels) {
-        QL_IOUT("Compiling kernel: " << kernel->name);
-        codegenKernelPrologue(kernel);
-
-        if (!kernel->gates.empty()) {
-            ir::compat::Bundles bundles = ir::compat::bundler(kernel);
-            codegen.kernelStart();
-            codegenBundles(bundles, program->platform);
-            codegen.kernelFinish(kernel->name, bundles.back().start_cycle+bundles.back().duration_in_cycles);
-        } else {
-            QL_DOUT("Empty kernel: " << kernel->name);                      // NB: normal situation for kernels with classical control
+    Vec<ir::compat::KernelRef> kernels;
+    for (const auto &kernel : program->kernels) {
+        kernels.push_back(kernel);
+    }
+    UInt threads = options->kernel_threads > 0 ? options->kernel_threads : std::thread::hardware_concurrency();
+    threads = max<UInt>(1, min<UInt>(threads, kernels.size()));
+
+    // bundle all kernels, and number their bundles over the whole program
+    Vec<ir::compat::Bundles> bundles(kernels.size());
+    run_parallel(kernels.size(), threads, [&](UInt thread, UInt k) {
+        if (!kernels[k]->gates.empty()) {
+            bundles[k] = ir::compat::bundler(kernels[k]);
         }
+    });
+    Vec<Int> firstBundleIdx;
+    Int bundleCount = 0;
+    for (const auto &kernelBundles : bundles) {
+        firstBundleIdx.push_back(bundleCount);
+        bundleCount += kernelBundles.size();
+    }
 
-        codegenKernelEpilogue(kernel);
+    // generate code for all kernels in parallel, each into its own fragment. Every thread uses its own backend, and thus
+    // its own code generator
+    QL_IOUT("Generating code for " << kernels.size() << " kernels using " << threads << " thread(s)");
+    Vec<Ptr<Backend>> workers;
+    for (UInt thread = 0; thread < threads; thread++) {
+        auto worker = Ptr<Backend>::make();
+        worker->options = options;
+        worker->codegen.init(program->platform, options);
+        workers.push_back(worker);
+    }
+    Vec<Fragment> fragments(kernels.size());
+    run_parallel(kernels.size(), threads, [&](UInt thread, UInt k) {
+        fragments[k] = workers[thread]->codegenKernel(kernels[k], bundles[k], firstBundleIdx[k], program->platform);
+    });
+    for (const auto &worker : workers) {
+        repeatCount += worker->repeatCount;
+        foldedBundles += worker->foldedBundles;
+        totalBundles += worker->totalBundles;
+        repeatSeconds += worker->repeatSeconds;
     }
 
+    // link the fragments into the program, which assigns the datapath resources in program order
+    codegen.programStart(program->unique_name);
+    for (const auto &fragment : fragments) {
+        codegen.link(fragment);
+    }
     codegen.programFinish(program->unique_name);
 
     // write program to file
     Str file_name(options->output_prefix + ".vq1asm");
     QL_IOUT("Writing Central Controller program to " << file_name);
-    OutFile(file_name).write(codegen.getProgram());
+    Str prog = codegen.getProgram();
+    OutFile(file_name).write(prog);
+
+    // report result of loop compression
+    if (options->loop_compression) {
+        QL_IOUT(
+            "Loop compression: generated " << repeatCount << " loops, folding "
+            << foldedBundles << " of " << totalBundles << " bundles, search took "
+            << repeatSeconds << " s; program size is " << prog.size() << " bytes, "
+            << std::count(prog.begin(), prog.end(), '\n') << " lines"
+        );
+    }
 
     // write instrument map to file (unless we were using input file)
     Str map_input_file = options->map_input_file;
@@ -114,6 +156,33 @@ void Backend::compile(const ir::compat::ProgramRef &program, const OptionsRef &o
 }
 
 
+// generate the code for a single kernel into a fragment, numbering its bundles from firstBundleIdx
+Fragment Backend::codegenKernel(
+    const ir::compat::KernelRef &kernel,
+    ir::compat::Bundles &bundles,
+    Int firstBundleIdx,
+    const ir::compat::PlatformRef &platform
+) {
+    codegen.fragmentStart();
+    bundleIdx = firstBundleIdx;
+
+    QL_IOUT("Compiling kernel: " << kernel->name);
+    codegenKernelPrologue(kernel);
+
+    if (!kernel->gates.empty()) {
+        codegen.kernelStart();
+        UInt durationInCycles = codegenBundles(bundles, platform);
+        codegen.kernelFinish(kernel->name, durationInCycles);
+    } else {
+        QL_DOUT("Empty kernel: " << kernel->name);                      // NB: normal situation for kernels with classical control
+    }
+
+    codegenKernelEpilogue(kernel);
+
+    return codegen.fragmentFinish();
+}
+
+
 // based on cc_light_eqasm_compiler.h::classical_instruction2qisa/decompose_instructions
 // NB: input instructions defined in classical.h::classical
 void Backend::codegenClassicalInstruction(const ir::compat::GateRef &classical_ins) {
@@ -282,76 +351,243 @@ void Backend::codegenKernelEpilogue(const ir::compat::KernelRef &k) {
 
 
 // based on cc_light_eqasm_compiler.h::bundles2qisa()
-void Backend::codegenBundles(ir::compat::Bundles &bundles, const ir::compat::PlatformRef &platform) {
+// returns the duration of the bundles, which is longer than that of the generated code if loops were generated
+UInt Backend::codegenBundles(ir::compat::Bundles &bundles, const ir::compat::PlatformRef &platform) {
     QL_IOUT("Generating .vq1asm for bundles");
 
+    Vec<const ir::compat::Bundle*> vb;
     for (const auto &bundle : bundles) {
-        // generate bundle header
-        QL_DOUT(QL_SS2S("Bundle " << bundleIdx << ": start_cycle=" << bundle.start_cycle << ", duration_in_cycles=" << bundle.duration_in_cycles));
-        codegen.bundleStart(QL_SS2S(
-            "## Bundle " << bundleIdx++
-            << ": start_cycle=" << bundle.start_cycle
-            << ", duration_in_cycles=" << bundle.duration_in_cycles << ":"
-        ));
-        // NB: the "wait" instruction never makes it into the bundle. It is accounted for in scheduling though,
-        // and if a non-zero duration is specified that duration is reflected in 'start_cycle' of the subsequent instruction
-
-        // generate code for this bundle
-        for (const auto &instr : bundle.gates) {
-            // check whether section defines classical gate
-            if (instr->type() == ir::compat::GateType::CLASSICAL) {
-                QL_DOUT(QL_SS2S("Classical bundle: instr='" << instr->name << "'"));
-                codegenClassicalInstruction(instr);
+        vb.push_back(&bundle);
+    }
+    totalBundles += vb.size();
+
+    Vec<UInt> signatures;
+    if (options->loop_compression) {
+        signatures = bundleSignatures(vb);
+    }
+
+    // cycleOffset: number of cycles saved by the loops generated so far, i.e. the difference between the timeline
+    // of the bundles and that of the generated code
+    UInt cycleOffset = 0;
+    UInt i = 0;
+    while (i < vb.size()) {
+        UInt bodySize = 0;
+        UInt iterations = 0;
+        Bool found = false;
+        if (options->loop_compression) {
+            auto searchStart = std::chrono::steady_clock::now();
+            found = findRepeat(vb, signatures, i, bodySize, iterations)
+                && codegen.canRepeatFrom(vb[i]->start_cycle - cycleOffset);
+            repeatSeconds += std::chrono::duration<Real>(std::chrono::steady_clock::now() - searchStart).count();
+        }
+
+        if (found) {
+            UInt startCycle = vb[i]->start_cycle - cycleOffset;
+            UInt period = vb[i+bodySize]->start_cycle - vb[i]->start_cycle;
+            Str label = QL_SS2S("__repeat" << bundleIdx);           // NB: bundle numbers are unique over the program
+            repeatCount++;
+            QL_IOUT(
+                "Folding " << iterations << " repetitions of " << bodySize
+                << " bundles with period " << period << " into loop '" << label << "'"
+            );
+
+            codegen.repeatStart(label, iterations, startCycle);
+            for (UInt b = i; b < i+bodySize; b++) {
+                codegenBundle(*vb[b], vb[b]->start_cycle - cycleOffset, false, platform);
+            }
+            codegen.repeatEnd(label, startCycle + period);
+
+            foldedBundles += (iterations-1) * bodySize;
+            bundleIdx += (iterations-1) * bodySize;     // keep bundle numbering in sync with the bundles
+            cycleOffset += (iterations-1) * period;
+            i += iterations * bodySize;
+        } else {
+            codegenBundle(*vb[i], vb[i]->start_cycle - cycleOffset, i == vb.size()-1, platform);
+            i++;
+        }
+    }
+
+    QL_IOUT("Generating .vq1asm for bundles [Done]");
+    return vb.back()->start_cycle + vb.back()->duration_in_cycles;
+}
+
+
+// generate code for a single bundle, starting at startCycle
+void Backend::codegenBundle(
+    const ir::compat::Bundle &bundle,
+    UInt startCycle,
+    Bool isLastBundle,
+    const ir::compat::PlatformRef &platform
+) {
+    // generate bundle header
+    QL_DOUT(QL_SS2S("Bundle " << bundleIdx << ": start_cycle=" << startCycle << ", duration_in_cycles=" << bundle.duration_in_cycles));
+    codegen.bundleStart(QL_SS2S(
+        "## Bundle " << bundleIdx++
+        << ": start_cycle=" << startCycle
+        << ", duration_in_cycles=" << bundle.duration_in_cycles << ":"
+    ));
+    // NB: the "wait" instruction never makes it into the bundle. It is accounted for in scheduling though,
+    // and if a non-zero duration is specified that duration is reflected in 'start_cycle' of the subsequent instruction
+
+    // generate code for this bundle
+    for (const auto &instr : bundle.gates) {
+        // check whether section defines classical gate
+        if (instr->type() == ir::compat::GateType::CLASSICAL) {
+            QL_DOUT(QL_SS2S("Classical bundle: instr='" << instr->name << "'"));
+            codegenClassicalInstruction(instr);
+        } else {
+            ir::compat::GateType itype = instr->type();
+            Str iname = instr->name;
+            QL_DOUT(QL_SS2S("Bundle section: instr='" << iname << "'"));
+
+            switch (itype) {
+                case ir::compat::GateType::NOP:       // a quantum "nop", see gate.h
+                    codegen.nopGate();
+                    break;
+
+                case ir::compat::GateType::CLASSICAL:
+                    QL_FATAL("Inconsistency detected in bundle contents: classical gate found after first section (which itself was non-classical)");
+                    break;
+
+                case ir::compat::GateType::CUSTOM:
+                    QL_DOUT(QL_SS2S("Custom gate: instr='" << iname << "'" << ", duration=" << instr->duration) << " ns");
+                    codegen.customGate(
+                        iname,
+                        instr->operands,            // qubit operands (FKA qops)
+                        instr->creg_operands,        // classic operands (FKA cops)
+                        instr->breg_operands,         // bit operands e.g. assigned to by measure
+                        instr->condition,
+                        instr->cond_operands,        // 0, 1 or 2 bit operands of condition
+                           instr->angle,
+                           startCycle, platform->time_to_cycles(instr->duration)
+                    );
+                    break;
+
+                case ir::compat::GateType::DISPLAY:
+                    QL_FATAL("Gate type __display__ not supported");           // QX specific, according to openql.pdf
+                    break;
+
+                case ir::compat::GateType::MEASURE:
+                    QL_FATAL("Gate type __measure_gate__ not supported");      // no use, because there is no way to define CC-specifics
+                    break;
+
+                default:
+                    QL_FATAL(
+                        "Unsupported builtin gate, type: " << itype
+                        << ", instruction: '" << instr->qasm() << "'");
+            }   // switch(itype)
+        }
+    }
+
+    // generate bundle trailer, and code for classical gates
+    codegen.bundleFinish(startCycle, bundle.duration_in_cycles, isLastBundle);
+}
+
+
+// compute a signature per bundle, such that bundles with the same signature generate the same code (apart from their
+// start cycle). Bundles that may not be part of a loop get signature 0, which never matches
+Vec<UInt> Backend::bundleSignatures(const Vec<const ir::compat::Bundle*> &bundles) {
+    Map<Str, UInt> ids;
+    Vec<UInt> signatures;
+    for (const auto bundle : bundles) {
+        Bool loopable = true;
+        StrStrm ss;
+        ss << bundle->duration_in_cycles;
+        for (const auto &instr : bundle->gates) {
+            if (
+                instr->type() != ir::compat::GateType::CUSTOM
+                || instr->condition != ir::compat::ConditionType::ALWAYS
+                || !codegen.isLoopable(instr->name)
+            ) {
+                loopable = false;
+                break;
+            }
+            ss << "|" << instr->name
+               << ":" << instr->operands
+               << ":" << instr->creg_operands
+               << ":" << instr->breg_operands
+               << ":" << instr->angle
+               << ":" << instr->duration;
+        }
+
+        if (loopable) {
+            Str key = ss.str();
+            auto it = ids.find(key);
+            if (it == ids.end()) {
+                UInt id = ids.size() + 1;
+                ids.set(key) = id;
+                signatures.push_back(id);
             } else {
-                ir::compat::GateType itype = instr->type();
-                Str iname = instr->name;
-                QL_DOUT(QL_SS2S("Bundle section: instr='" << iname << "'"));
-
-                switch (itype) {
-                    case ir::compat::GateType::NOP:       // a quantum "nop", see gate.h
-                        codegen.nopGate();
-                        break;
-
-                    case ir::compat::GateType::CLASSICAL:
-                        QL_FATAL("Inconsistency detected in bundle contents: classical gate found after first section (which itself was non-classical)");
-                        break;
-
-                    case ir::compat::GateType::CUSTOM:
-                        QL_DOUT(QL_SS2S("Custom gate: instr='" << iname << "'" << ", duration=" << instr->duration) << " ns");
-                        codegen.customGate(
-                            iname,
-                            instr->operands,            // qubit operands (FKA qops)
-                            instr->creg_operands,        // classic operands (FKA cops)
-                            instr->breg_operands,         // bit operands e.g. assigned to by measure
-                            instr->condition,
-                            instr->cond_operands,        // 0, 1 or 2 bit operands of condition
-                               instr->angle,
-                               bundle.start_cycle, platform->time_to_cycles(instr->duration)
-                        );
-                        break;
-
-                    case ir::compat::GateType::DISPLAY:
-                        QL_FATAL("Gate type __display__ not supported");           // QX specific, according to openql.pdf
-                        break;
-
-                    case ir::compat::GateType::MEASURE:
-                        QL_FATAL("Gate type __measure_gate__ not supported");      // no use, because there is no way to define CC-specifics
-                        break;
-
-                    default:
-                        QL_FATAL(
-                            "Unsupported builtin gate, type: " << itype
-                            << ", instruction: '" << instr->qasm() << "'");
-                }   // switch(itype)
+                signatures.push_back(it->second);
             }
+        } else {
+            signatures.push_back(0);
         }
+    }
+    return signatures;
+}
 
-        // generate bundle trailer, and code for classical gates
-        Bool isLastBundle = &bundle == &bundles.back();
-        codegen.bundleFinish(bundle.start_cycle, bundle.duration_in_cycles, isLastBundle);
-    }   // for(bundles)
 
-    QL_IOUT("Generating .vq1asm for bundles [Done]");
+// find the sequence of bundles starting at 'first' that repeats most often (in terms of bundles saved), subject to
+// the limits set by the options. The sequence must repeat with a constant period, all its bundles must finish within
+// that period, and the kernel's last bundle (which pads the outputs) is never included
+Bool Backend::findRepeat(
+    const Vec<const ir::compat::Bundle*> &bundles,
+    const Vec<UInt> &signatures,
+    UInt first,
+    UInt &bodySize,
+    UInt &iterations
+) const {
+    UInt n = bundles.size() - 1;                // exclude last bundle
+    UInt s = bundles[first]->start_cycle;
+    UInt bestSaved = 0;
+
+    for (UInt len = 1; len <= options->loop_compression_max_body; len++) {
+        if (first + len*options->loop_compression_min_iterations > n) break;
+        if (signatures[first+len-1] == 0) break;    // longer bodies contain this bundle as well
+
+        // determine period, and check that the body finishes within it
+        UInt period = bundles[first+len]->start_cycle - s;
+        if (period == 0) continue;
+        Bool fits = true;
+        for (UInt b = first; b < first+len; b++) {
+            if (bundles[b]->start_cycle + bundles[b]->duration_in_cycles > s + period) {
+                fits = false;
+                break;
+            }
+        }
+        if (!fits) continue;
+
+        // count repetitions
+        UInt k = 1;
+        while (first + (k+1)*len <= n) {
+            Bool match = true;
+            for (UInt m = 0; m < len; m++) {
+                UInt b = first + k*len + m;
+                if (
+                    signatures[b] != signatures[first+m]
+                    || bundles[b]->start_cycle != bundles[first+m]->start_cycle + k*period
+                ) {
+                    match = false;
+                    break;
+                }
+            }
+            if (!match) break;
+            k++;
+        }
+
+        // the bundle following the loop must not start before the last iteration ends
+        if (bundles[first + k*len]->start_cycle < s + k*period) {
+            k--;
+        }
+
+        if (k >= options->loop_compression_min_iterations && (k-1)*len > bestSaved) {
+            bestSaved = (k-1)*len;
+            bodySize = len;
+            iterations = k;
+        }
+    }
+    return bestSaved > 0;
 }
 
 
@@ -29,16 +29,27 @@ public:
     void compile(const ir::compat::ProgramRef &program, const OptionsRef &options);
 
 private:
+    Fragment codegenKernel(const ir::compat::KernelRef &kernel, ir::compat::Bundles &bundles, Int firstBundleIdx, const ir::compat::PlatformRef &platform);
     static Str loopLabel(const ir::compat::KernelRef &k);
     void codegenClassicalInstruction(const ir::compat::GateRef &classical_ins);
     void codegenKernelPrologue(const ir::compat::KernelRef &k);
     void codegenKernelEpilogue(const ir::compat::KernelRef &k);
-    void codegenBundles(ir::compat::Bundles &bundles, const ir::compat::PlatformRef &platform);
+    UInt codegenBundles(ir::compat::Bundles &bundles, const ir::compat::PlatformRef &platform);
+    void codegenBundle(const ir::compat::Bundle &bundle, UInt startCycle, Bool isLastBundle, const ir::compat::PlatformRef &platform);
+    Vec<UInt> bundleSignatures(const Vec<const ir::compat::Bundle*> &bundles);
+    Bool findRepeat(const Vec<const ir::compat::Bundle*> &bundles, const Vec<UInt> &signatures, UInt first, UInt &bodySize, UInt &iterations) const;
     void loadHwSettings(const ir::compat::PlatformRef &platform);
 
 private: // vars
+    OptionsRef options;
     Codegen codegen;
-    Int bundleIdx;
+    Int bundleIdx = 0;
+
+    // loop compression statistics
+    UInt repeatCount = 0;                       // number of loops generated
+    UInt foldedBundles = 0;                     // number of bundles not emitted because they were folded into a loop
+    UInt totalBundles = 0;
+    Real repeatSeconds = 0.0;                   // time spent searching for repeated bundle sequences
 }; // class
 
 } // namespace detail
@@ -35,13 +35,21 @@ void Codegen::init(const ir::compat::PlatformRef &platform, const OptionsRef &op
     this->options = options;
     settings.loadBackendSettings(platform);
 
-    // optionally preload codewordTable
-    Str map_input_file = options->map_input_file;
-    if (!map_input_file.empty()) {
-        QL_DOUT("loading map_input_file='" << map_input_file << "'");
-        Json map = load_json(map_input_file);
-        codewordTable = map["codeword_table"];      // FIXME: use json_get
-        mapPreloaded = true;
+    // check instrument slots, and create 'matrix' of BundleInfo with proper vector size per instrument
+    bundleInfo.clear();
+    bundleInstruments.clear();
+    for (UInt instrIdx = 0; instrIdx < settings.getInstrumentsSize(); instrIdx++) {
+        const Settings::InstrumentControl ic = settings.getInstrumentControl(instrIdx);
+        if (ic.ii.slot >= MAX_SLOTS) {
+            QL_JSON_FATAL(
+                "illegal slot " << ic.ii.slot
+                << " on instrument '" << ic.ii.instrumentName
+            );
+        }
+        bundleInfo.emplace_back(
+            ic.controlModeGroupCnt,     // one BundleInfo per group in the control mode selected for instrument
+            BundleInfo()                // empty BundleInfo
+        );
     }
 
 #if OPT_FEEDBACK
@@ -49,10 +57,14 @@ void Codegen::init(const ir::compat::PlatformRef &platform, const OptionsRef &op
     for (UInt instrIdx = 0; instrIdx < settings.getInstrumentsSize(); instrIdx++) {
         const Settings::InstrumentControl ic = settings.getInstrumentControl(instrIdx);
         if (QL_JSON_EXISTS(ic.controlMode, "result_bits")) {  // this instrument mode produces results (i.e. it is a measurement device)
-            QL_IOUT("instrument '" << ic.ii.instrumentName << "' (index " << instrIdx << ") is used for feedback");
+            QL_DOUT("instrument '" << ic.ii.instrumentName << "' (index " << instrIdx << ") is used for feedback");
         }
     }
 #endif
+
+    // NB: the VCD variables are registered by every instance, such that the variables referred to by fragments match
+    // those of the program
+    vcd.programStart(platform->qubit_count, platform->cycle_time, MAX_GROUPS, settings);
 }
 
 Str Codegen::getProgram() {
@@ -77,11 +89,18 @@ Str Codegen::getMap() {
 \************************************************************************/
 
 void Codegen::programStart(const Str &progName) {
+    // optionally preload codewordTable
+    Str map_input_file = options->map_input_file;
+    if (!map_input_file.empty()) {
+        QL_DOUT("loading map_input_file='" << map_input_file << "'");
+        Json map = load_json(map_input_file);
+        codewordTable = map["codeword_table"];      // FIXME: use json_get
+        mapPreloaded = true;
+    }
+
     emitProgramStart(progName);
 
     dp.programStart();
-
-    vcd.programStart(platform->qubit_count, platform->cycle_time, MAX_GROUPS, settings);
 }
 
 
@@ -93,6 +112,43 @@ void Codegen::programFinish(const Str &progName) {
     vcd.programFinish(options->output_prefix + ".vcd");
 }
 
+/************************************************************************\
+| 'Fragment' level functions
+\************************************************************************/
+
+// start generating a fragment: all code generated until fragmentFinish() is collected in the fragment instead of the
+// program
+void Codegen::fragmentStart() {
+    fragment = Fragment();
+    codeSection.str("");
+    codeSection << std::left;    // assumed by emit()
+    dp.clearDatapathSection();
+}
+
+Fragment Codegen::fragmentFinish() {
+    fragment.items.push_back(Fragment::Item{codeSection.str(), dp.getDatapathSection(), LinkAction()});
+    codeSection.str("");
+    dp.clearDatapathSection();
+    fragment.vcd = vcd.fragmentFinish();
+
+    Fragment ret = std::move(fragment);
+    fragment = Fragment();
+    return ret;
+}
+
+// append a fragment to the program, executing its link actions
+void Codegen::link(const Fragment &fragment) {
+    symbols.assign(fragment.symbolCount, 0);
+    for (const auto &item : fragment.items) {
+        codeSection << item.code;
+        dp.appendDatapathSection(item.datapath);
+        if (item.action) {
+            item.action(*this);
+        }
+    }
+    vcd.link(fragment.vcd);
+}
+
 /************************************************************************\
 | 'Kernel' level functions
 \************************************************************************/
@@ -123,20 +179,24 @@ void Codegen::kernelFinish(const Str &kernelName, UInt durationInCycles) {
     - bundleFinish():
     generate code for bundle from information collected in bundleInfo (which
     may be empty if no custom gates are present in bundle)
+
+    Since a bundle typically only uses a few of the instruments, we keep track
+    of the instruments touched by customGate() in bundleInstruments, and only
+    clear and process those. Instruments without output are only visited in
+    bundles that need all instruments, i.e. bundles with feedback (which
+    requires all instruments to execute the same number of sequencer
+    instructions) and the last bundle of a kernel (which pads all outputs).
 */
 
 // bundleStart: see 'strategy' above
 void Codegen::bundleStart(const Str &cmnt) {
-    // create 'matrix' of BundleInfo with proper vector size per instrument
-    bundleInfo.clear();
-    BundleInfo empty;
-    for (UInt instrIdx = 0; instrIdx < settings.getInstrumentsSize(); instrIdx++) {
-        const Settings::InstrumentControl ic = settings.getInstrumentControl(instrIdx);
-        bundleInfo.emplace_back(
-            ic.controlModeGroupCnt,     // one BundleInfo per group in the control mode selected for instrument
-            empty                       // empty BundleInfo
-        );
+    // clear the BundleInfo of the instruments used by the previous bundle
+    for (UInt instrIdx : bundleInstruments) {
+        for (BundleInfo &bi : bundleInfo[instrIdx]) {
+            bi = BundleInfo();
+        }
     }
+    bundleInstruments.clear();
 
     // generate source code comments
     comment(cmnt);
@@ -273,16 +333,10 @@ Codegen::CodeGenMap Codegen::collectCodeGenInfo(
 ) {
     CodeGenMap codeGenMap;
 
-    // iterate over instruments
-    for (UInt instrIdx = 0; instrIdx < settings.getInstrumentsSize(); instrIdx++) {
+    // iterate over instruments touched by this bundle (NB: slots were checked in init())
+    for (UInt instrIdx : bundleInstruments) {
         // get control info from instrument settings
         const Settings::InstrumentControl ic = settings.getInstrumentControl(instrIdx);
-        if (ic.ii.slot >= MAX_SLOTS) {
-            QL_JSON_FATAL(
-                "illegal slot " << ic.ii.slot
-                << " on instrument '" << ic.ii.instrumentName
-            );
-        }
 
         /************************************************************************\
         | collect code generation info from all groups within one instrument
@@ -339,7 +393,11 @@ Codegen::CodeGenMap Codegen::collectCodeGenInfo(
                 // FIXME: use breg_operands if present? How about qubit (operand) then?
                 UInt breg_operand = bi.operands[0];                    // implicit classic bit for qubit. FIXME: perform checks
                 // get SM bit for classic operand (allocated during readout)
-                codeGenInfo.pragmaSmBit = dp.getSmBit(breg_operand, instrIdx);
+                UInt smBit = newSymbol();
+                addLinkAction([smBit, breg_operand, instrIdx](Codegen &prog) {
+                    prog.symbols[smBit] = prog.dp.getSmBit(breg_operand, instrIdx);
+                });
+                codeGenInfo.pragmaSmBit = smBit;
             }
 #endif
 
@@ -380,7 +438,10 @@ Codegen::CodeGenMap Codegen::collectCodeGenInfo(
                 }
 
                 // allocate SM bit for classic operand
-                UInt smBit = dp.allocateSmBit(breg_operand, instrIdx);
+                UInt smBit = newSymbol();
+                addLinkAction([smBit, breg_operand, instrIdx](Codegen &prog) {
+                    prog.symbols[smBit] = prog.dp.allocateSmBit(breg_operand, instrIdx);
+                });
 
                 // remind mapping of bit -> smBit for setting MUX
                 codeGenInfo.feedbackMap.emplace(group, FeedbackInfo{smBit, resultBit, bi});
@@ -416,12 +477,31 @@ void Codegen::bundleFinish(
         }
     }
 
-    // turn code generation info collected above into actual code
-    for (UInt instrIdx = 0; instrIdx < settings.getInstrumentsSize(); instrIdx++) {
-        CodeGenInfo codeGenInfo = codeGenMap.at(instrIdx);
+    // determine the instruments to generate code for: normally only those touched by the bundle, but feedback and
+    // padding at the end of the kernel involve all instruments
+    Vec<UInt> instruments;
+    if (bundleHasFeedback || isLastBundle) {
+        for (UInt instrIdx = 0; instrIdx < settings.getInstrumentsSize(); instrIdx++) {
+            instruments.push_back(instrIdx);
+        }
+    } else {
+        instruments.assign(bundleInstruments.begin(), bundleInstruments.end());
+    }
+
+    if (isLastBundle) {
+        comment(QL_SS2S(" # last bundle of kernel, will pad outputs to match durations"));
+    }
 
-        if (isLastBundle && instrIdx == 0) {
-            comment(QL_SS2S(" # last bundle of kernel, will pad outputs to match durations"));
+    // turn code generation info collected above into actual code
+    for (UInt instrIdx : instruments) {
+        CodeGenInfo codeGenInfo = {false};
+        auto it = codeGenMap.find(instrIdx);
+        if (it != codeGenMap.end()) {
+            codeGenInfo = it->second;
+        } else {    // instrument not used by this bundle
+            const Settings::InstrumentInfo ii = settings.getInstrumentInfo(instrIdx);
+            codeGenInfo.instrumentName = ii.instrumentName;
+            codeGenInfo.slot = ii.slot;
         }
 
         // generate code for instrument output
@@ -473,12 +553,14 @@ void Codegen::bundleFinish(
             );        // FIXME: use instrMaxDurationInCycles and/or check consistency
         }
 
-        vcd.bundleFinish(
-            startCycle,
-            codeGenInfo.digOut,
-            codeGenInfo.instrMaxDurationInCycles,
-            instrIdx
-        );    // FIXME: conditional gates, etc
+        if (codeGenInfo.instrHasOutput) {
+            vcd.bundleFinish(
+                startCycle,
+                codeGenInfo.digOut,
+                codeGenInfo.instrMaxDurationInCycles,
+                instrIdx
+            );    // FIXME: conditional gates, etc
+        }
     } // for(instrIdx)
 
     comment("");    // blank line to separate bundles
@@ -538,6 +620,7 @@ void Codegen::customGate(
         CalcSignalValue csv = calcSignalValue(sd, s, operands, iname);
 
         // store signal value, checking for conflicts
+        touchInstrument(csv.si.instrIdx);
         BundleInfo &bi = bundleInfo[csv.si.instrIdx][csv.si.group];         // shorthand
         if (!csv.signalValueString.empty()) {                               // empty implies no signal
             if (bi.signalValue.empty()) {                                   // signal not yet used
@@ -619,7 +702,9 @@ void Codegen::customGate(
 #if OPT_PRAGMA
     RawPtr<const Json> pragma = settings.getPragma(iname);
     if (pragma) {
-        for (Vec<BundleInfo> &vbi : bundleInfo) {
+        for (UInt instrIdx = 0; instrIdx < bundleInfo.size(); instrIdx++) {
+            touchInstrument(instrIdx);
+            Vec<BundleInfo> &vbi = bundleInfo[instrIdx];
             // FIXME: for now we just store the JSON of the pragma statement in bundleInfo[*][0]
             if(vbi[0].pragma) {
                 QL_FATAL("Bundle contains more than one gate with 'pragma' key");    // FIXME: provide context
@@ -657,20 +742,23 @@ void Codegen::elseStart(UInt op0, const Str &opName, UInt op1) {
 void Codegen::forStart(const Str &label, UInt iterations) {
     comment(QL_SS2S("# FOR_START(" << iterations << ")"));
     // FIXME: reserve register
-    emit("", "move", QL_SS2S(iterations << ",R62"), "# R62 is the 'for loop counter'");        // FIXME: fixed reg, no nested for loops (not supported by program.cc either)
-    emit((label+":"), "", "", "# ");
+    emitLoopStart(label, iterations, "R62", "# R62 is the 'for loop counter'");        // FIXME: fixed reg, no nested for loops (not supported by program.cc either)
 #if OPT_PRAGMA
-    pragmaLoopLabel.push_back(label);        // remind label for pragma/break FIXME: implement properly later on
+    addLinkAction([label](Codegen &prog) {
+        prog.pragmaLoopLabel.push_back(label);        // remind label for pragma/break FIXME: implement properly later on
+    });
 #endif
 }
 
 void Codegen::forEnd(const Str &label) {
     comment("# FOR_END");
     // FIXME: free register
-    emit("", "loop", QL_SS2S("R62,@" << label), "# R62 is the 'for loop counter'");        // FIXME: fixed reg, no nested for loops (not supported by program.cc either)
+    emitLoopEnd(label, "R62", "# R62 is the 'for loop counter'");        // FIXME: fixed reg, no nested for loops (not supported by program.cc either)
 #if OPT_PRAGMA
     emit((label+"_end:"), "", "", "# ");    // label for 'break'
-    pragmaLoopLabel.pop_back();
+    addLinkAction([](Codegen &prog) {
+        prog.pragmaLoopLabel.pop_back();
+    });
 #endif
 }
 
@@ -678,7 +766,9 @@ void Codegen::doWhileStart(const Str &label) {
     comment("# DO_WHILE_START");
     emit((label+":"), "", "", "# ");
 #if OPT_PRAGMA
-    pragmaLoopLabel.push_back(label);        // remind label for pragma/break FIXME: implement properly later on
+    addLinkAction([label](Codegen &prog) {
+        prog.pragmaLoopLabel.push_back(label);        // remind label for pragma/break FIXME: implement properly later on
+    });
 #endif
 }
 
@@ -688,10 +778,63 @@ void Codegen::doWhileEnd(const Str &label, UInt op0, const Str &opName, UInt op1
     QL_WOUT("CC backend ignores condition of do while loop");
 #if OPT_PRAGMA
     emit((label+"_end:"), "", "", "# ");    // label for 'break'
-    pragmaLoopLabel.pop_back();
+    addLinkAction([](Codegen &prog) {
+        prog.pragmaLoopLabel.pop_back();
+    });
 #endif
 }
 
+/************************************************************************\
+| Loop compression of repeated bundles
+\************************************************************************/
+
+/*
+    A sequence of bundles that is repeated within a kernel can be emitted once,
+    wrapped in a hardware loop (see Backend::codegenBundles). To make every
+    iteration take the same time on every instrument, all instruments are
+    padded to the start of the loop before entering it, and to the end of the
+    loop period before jumping back. The loop counter lives in R63, so these
+    loops may be nested inside a FOR_START/FOR_END pair, which uses R62. The
+    VCD still shows every iteration, see Vcd::repeatStart().
+*/
+
+// determine whether gate 'iname' may be part of a compressed loop body: gates that involve feedback or pragmas
+// generate code that depends on all instruments and/or on loop labels, so we leave these unrolled
+Bool Codegen::isLoopable(const Str &iname) {
+    if (settings.isPragma(iname)) {
+        return false;
+    }
+    if (settings.isReadout(iname) && settings.getReadoutMode(iname) == "feedback") {
+        return false;
+    }
+    return true;
+}
+
+// determine whether all instruments are idle at startCycle, i.e. whether a loop can start there
+Bool Codegen::canRepeatFrom(UInt startCycle) const {
+    for (UInt instrIdx = 0; instrIdx < settings.getInstrumentsSize(); instrIdx++) {
+        if (lastEndCycle[instrIdx] > startCycle) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void Codegen::repeatStart(const Str &label, UInt iterations, UInt startCycle) {
+    comment(QL_SS2S("# REPEAT_START(" << iterations << ")"));
+    padAllToCycle(startCycle);
+    emitLoopStart(label, iterations, "R63", "# R63 is the 'repeat loop counter'");
+    vcd.repeatStart(iterations, startCycle);
+}
+
+void Codegen::repeatEnd(const Str &label, UInt endCycle) {
+    padAllToCycle(endCycle);
+    comment("# REPEAT_END");
+    emitLoopEnd(label, "R63", "# R63 is the 'repeat loop counter'");
+    comment("");
+    vcd.repeatEnd(endCycle);
+}
+
 void Codegen::comment(const Str &c) {
     if (options->verbose) emit(c);
 }
@@ -799,18 +942,27 @@ void Codegen::emitFeedback(
 
     // code generation for participating and non-participating instruments (NB: must take equal number of sequencer cycles)
     if (!feedbackMap.empty()) {    // this instrument performs readout for feedback now
-        UInt mux = dp.getOrAssignMux(instrIdx, feedbackMap);
-        dp.emitMux(mux, feedbackMap, instrIdx, slot);
+        // NB: the MUX and the SM bits are assigned when linking, feedbackMap refers to the SM bits through symbols
+        Str cmnt = QL_SS2S("# cycle " << lastEndCycle[instrIdx] << "-" << lastEndCycle[instrIdx]+1 << ": feedback on '" << instrumentName+"'");
+        addLinkAction([feedbackMap, instrIdx, slot, cmnt](Codegen &prog) {
+            FeedbackMap linkedFeedbackMap = feedbackMap;
+            for (auto &feedback : linkedFeedbackMap) {
+                feedback.second.smBit = prog.symbols[feedback.second.smBit];
+            }
 
-        // emit code for slot input
-        UInt sizeTag = Datapath::getSizeTag(feedbackMap.size());        // compute DSM transfer size tag (for 'seq_in_sm' instruction)
-        UInt smAddr = Datapath::getMuxSmAddr(feedbackMap);
-        emit(
-            slot,
-            "seq_in_sm",
-            QL_SS2S("S" << smAddr << ","  << mux << "," << sizeTag),
-            QL_SS2S("# cycle " << lastEndCycle[instrIdx] << "-" << lastEndCycle[instrIdx]+1 << ": feedback on '" << instrumentName+"'")
-        );
+            UInt mux = prog.dp.getOrAssignMux(instrIdx, linkedFeedbackMap);
+            prog.dp.emitMux(mux, linkedFeedbackMap, instrIdx, slot);
+
+            // emit code for slot input
+            UInt sizeTag = Datapath::getSizeTag(linkedFeedbackMap.size());        // compute DSM transfer size tag (for 'seq_in_sm' instruction)
+            UInt smAddr = Datapath::getMuxSmAddr(linkedFeedbackMap);
+            prog.emit(
+                slot,
+                "seq_in_sm",
+                QL_SS2S("S" << smAddr << ","  << mux << "," << sizeTag),
+                cmnt
+            );
+        });
         lastEndCycle[instrIdx]++;
     } else {    // this instrument does not perform readout for feedback now
         // emit code for non-participating instrument
@@ -856,17 +1008,21 @@ void Codegen::emitOutput(
             QL_SS2S("# cycle " << startCycle << "-" << startCycle + instrMaxDurationInCycles << ": code word/mask on '" << instrumentName + "'")
         );
     } else {    // at least one group conditional
-        // configure datapath PL
-        UInt pl = dp.getOrAssignPl(instrIdx, condGateMap);
-        UInt smAddr = dp.emitPl(pl, condGateMap, instrIdx, slot);
-
-        // emit code for conditional gate
-        emit(
-            slot,
-            "seq_out_sm",
-            QL_SS2S("S" << smAddr << "," << pl << "," << instrMaxDurationInCycles),
-            QL_SS2S("# cycle " << startCycle << "-" << startCycle + instrMaxDurationInCycles << ": conditional code word/mask on '" << instrumentName << "'")
-        );
+        // NB: the PL is assigned when linking
+        Str cmnt = QL_SS2S("# cycle " << startCycle << "-" << startCycle + instrMaxDurationInCycles << ": conditional code word/mask on '" << instrumentName << "'");
+        addLinkAction([condGateMap, instrMaxDurationInCycles, instrIdx, slot, cmnt](Codegen &prog) {
+            // configure datapath PL
+            UInt pl = prog.dp.getOrAssignPl(instrIdx, condGateMap);
+            UInt smAddr = prog.dp.emitPl(pl, condGateMap, instrIdx, slot);
+
+            // emit code for conditional gate
+            prog.emit(
+                slot,
+                "seq_out_sm",
+                QL_SS2S("S" << smAddr << "," << pl << "," << instrMaxDurationInCycles),
+                cmnt
+            );
+        });
     }
 
     // update lastEndCycle
@@ -887,32 +1043,37 @@ void Codegen::emitPragma(
 
     // FIXME: the only pragma possible is "break" for now
     Int pragmaBreakVal = json_get<Int>(pragma, "break", "pragma of unknown instruction");        // FIXME: we don't know which instruction we're dealing with, so better move
-    UInt smAddr = pragmaSmBit / 32;    // 'seq_cl_sm' is addressable in 32 bit words
-    UInt mask = 1ul << (pragmaSmBit % 32);
-    std::string label = pragmaLoopLabel.back() + "_end";        // FIXME: must match label set in forEnd(), assumes we are actually inside a for loop
 
-    // emit code for pragma "break". NB: code is identical for all instruments
-    // FIXME: verify that instruction duration matches actual time
+    // NB: the SM bit and the label of the enclosing loop are only known when linking
+    addLinkAction([pragmaBreakVal, pragmaSmBit, slot, instrumentName](Codegen &prog) {
+        UInt smBit = prog.symbols[pragmaSmBit];
+        UInt smAddr = smBit / 32;    // 'seq_cl_sm' is addressable in 32 bit words
+        UInt mask = 1ul << (smBit % 32);
+        std::string label = prog.pragmaLoopLabel.back() + "_end";        // FIXME: must match label set in forEnd(), assumes we are actually inside a for loop
+
+        // emit code for pragma "break". NB: code is identical for all instruments
+        // FIXME: verify that instruction duration matches actual time
 /*
-    seq_cl_sm   S<address>          ; pass 32 bit SM-data to Q1 ...
-    seq_wait    3                   ; prevent starvation of real time part during instructions below: 4 classic instructions + 1 branch
-    move_sm     R0                  ; ... and move to register
-    nop                             ; register dependency R0
-    and         R0,<mask>,R1        ; mask depends on DSM bit location
-    nop                             ; register dependency R1
-    jlt         R1,1,@loop
+        seq_cl_sm   S<address>          ; pass 32 bit SM-data to Q1 ...
+        seq_wait    3                   ; prevent starvation of real time part during instructions below: 4 classic instructions + 1 branch
+        move_sm     R0                  ; ... and move to register
+        nop                             ; register dependency R0
+        and         R0,<mask>,R1        ; mask depends on DSM bit location
+        nop                             ; register dependency R1
+        jlt         R1,1,@loop
 */
-    emit(slot, "seq_cl_sm", QL_SS2S("S" << smAddr), QL_SS2S("# 'break if " << pragmaBreakVal << "' on '" << instrumentName << "'"));
-    emit(slot, "seq_wait", "3", "");
-    emit(slot, "move_sm", "R0", "");
-    emit(slot, "nop", "", "");
-    emit(slot, "and", QL_SS2S("R0," << mask << "," << "R1"), "");    // results in '0' for 'bit==0' and 'mask' for 'bit==1'
-    emit(slot, "nop", "", "");
-    if (pragmaBreakVal == 0) {
-        emit(slot, "jlt", QL_SS2S("R1,1,@" << label), "");
-    } else {
-        emit(slot, "jge", QL_SS2S("R1,1,@" << label), "");
-    }
+        prog.emit(slot, "seq_cl_sm", QL_SS2S("S" << smAddr), QL_SS2S("# 'break if " << pragmaBreakVal << "' on '" << instrumentName << "'"));
+        prog.emit(slot, "seq_wait", "3", "");
+        prog.emit(slot, "move_sm", "R0", "");
+        prog.emit(slot, "nop", "", "");
+        prog.emit(slot, "and", QL_SS2S("R0," << mask << "," << "R1"), "");    // results in '0' for 'bit==0' and 'mask' for 'bit==1'
+        prog.emit(slot, "nop", "", "");
+        if (pragmaBreakVal == 0) {
+            prog.emit(slot, "jlt", QL_SS2S("R1,1,@" << label), "");
+        } else {
+            prog.emit(slot, "jge", QL_SS2S("R1,1,@" << label), "");
+        }
+    });
 }
 
 
@@ -945,6 +1106,47 @@ void Codegen::emitPadToCycle(UInt instrIdx, UInt startCycle, Int slot, const Str
 }
 
 
+// pad all instruments to startCycle
+void Codegen::padAllToCycle(UInt startCycle) {
+    for (UInt instrIdx = 0; instrIdx < settings.getInstrumentsSize(); instrIdx++) {
+        const Settings::InstrumentInfo ii = settings.getInstrumentInfo(instrIdx);
+        emitPadToCycle(instrIdx, startCycle, ii.slot, ii.instrumentName);
+    }
+}
+
+
+void Codegen::emitLoopStart(const Str &label, UInt iterations, const Str &reg, const Str &comment) {
+    emit("", "move", QL_SS2S(iterations << "," << reg), comment);
+    emit((label+":"), "", "", "# ");
+}
+
+
+void Codegen::emitLoopEnd(const Str &label, const Str &reg, const Str &comment) {
+    emit("", "loop", QL_SS2S(reg << ",@" << label), comment);
+}
+
+
+// end the current item of the fragment being generated, and let action generate the code that follows it when linking
+void Codegen::addLinkAction(const LinkAction &action) {
+    fragment.items.push_back(Fragment::Item{codeSection.str(), dp.getDatapathSection(), action});
+    codeSection.str("");
+    dp.clearDatapathSection();
+}
+
+
+// allocate a symbol for a value that is only known when linking, see link()
+UInt Codegen::newSymbol() {
+    return fragment.symbolCount++;
+}
+
+
+// remind that instrument instrIdx is used by the current bundle, such that bundleFinish() processes it and the next
+// bundleStart() clears its bundleInfo
+void Codegen::touchInstrument(UInt instrIdx) {
+    bundleInstruments.insert(instrIdx);
+}
+
+
 // compute signalValueString, and some meta information, for sd[s] (i.e. one of the signals in the JSON definition of an instruction)
 Codegen::CalcSignalValue Codegen::calcSignalValue(
     const Settings::SignalDef &sd,
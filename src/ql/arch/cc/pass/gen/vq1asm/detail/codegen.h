@@ -9,6 +9,7 @@
 
 #pragma once
 
+#include <functional>
 #include "ql/ir/compat/platform.h"
 #include "types.h"
 #include "options.h"
@@ -25,6 +26,27 @@ namespace gen {
 namespace vq1asm {
 namespace detail {
 
+class Codegen;
+
+/*
+    Code generated for a single kernel. Kernels are generated independently of each other (and possibly concurrently),
+    and are then linked into the program in order. Code that depends on state shared between kernels (allocation of
+    DSM bits, MUXes and PLs, and the labels of enclosing loops) cannot be generated for a kernel in isolation, and is
+    recorded as a link action instead. Link actions are executed in order by Codegen::link(), after appending the code
+    preceding them, and refer to the DSM bits allocated by earlier link actions of the fragment through symbols.
+*/
+struct Fragment {
+    struct Item {
+        Str code;                                               // code section generated before action
+        Str datapath;                                           // datapath section generated before action
+        std::function<void(Codegen &)> action;                  // link action, empty for the last item
+    };
+
+    Vec<Item> items;
+    UInt symbolCount = 0;                                       // number of symbols used by the link actions
+    Vcd::Fragment vcd;                                          // VCD changes of the kernel
+};
+
 class Codegen {
 public: //  functions
     Codegen() = default;
@@ -38,6 +60,9 @@ public: //  functions
     // Compile support
     void programStart(const Str &progName);
     void programFinish(const Str &progName);
+    void fragmentStart();
+    Fragment fragmentFinish();
+    void link(const Fragment &fragment);
     void kernelStart();
     void kernelFinish(const Str &kernelName, UInt durationInCycles);
     void bundleStart(const Str &cmnt);
@@ -65,6 +90,12 @@ public: //  functions
     void doWhileStart(const Str &label);
     void doWhileEnd(const Str &label, UInt op0, const std::string &opName, UInt op1);
 
+    // Loop compression of repeated bundles
+    Bool isLoopable(const Str &iname);
+    Bool canRepeatFrom(UInt startCycle) const;
+    void repeatStart(const Str &label, UInt iterations, UInt startCycle);
+    void repeatEnd(const Str &label, UInt endCycle);
+
     void comment(const Str &c);
 
 private:    // types
@@ -78,7 +109,7 @@ private:    // types
 #endif
 #if OPT_PRAGMA
         RawPtr<const Json> pragma;
-        Int pragmaSmBit;
+        Int pragmaSmBit;                                        // NB: link symbol holding the SM bit
 #endif
         // info copied from tInstrumentInfo
         Str instrumentName;
@@ -94,6 +125,8 @@ private:    // types
     }; // return type for calcSignalValue()
 
 
+    using LinkAction = std::function<void(Codegen &)>;
+
 private:    // vars
     static const Int MAX_SLOTS = 12;                            // physical maximum of CC
     static const Int MAX_GROUPS = 32;                           // based on VSM, which currently has the largest number of groups
@@ -108,16 +141,21 @@ private:    // vars
 
     // codegen state, program scope
     Json codewordTable;                                         // codewords versus signals per instrument group
-    StrStrm codeSection;                                        // the code generated
+    StrStrm codeSection;                                        // the code generated (of the current fragment while generating one)
+#if OPT_PRAGMA
+    Vec<Str> pragmaLoopLabel;                                   // stack for loop labels (in conjunction with 'break' instruction), maintained by link actions
+#endif
+
+    // codegen state, fragment scope
+    Fragment fragment;                                          // fragment being generated
+    Vec<UInt> symbols;                                          // values of the symbols of the fragment being linked
 
     // codegen state, kernel scope FIXME: create class
     UInt lastEndCycle[MAX_INSTRS];                              // vector[instrIdx], maintain where we got per slot
-#if OPT_PRAGMA
-    Vec<Str> pragmaLoopLabel;                                   // stack for loop labels (in conjunction with 'break' instruction)
-#endif
 
     // codegen state, bundle scope
-    Vec<Vec<BundleInfo>> bundleInfo;                            // matrix[instrIdx][group]
+    Vec<Vec<BundleInfo>> bundleInfo;                            // matrix[instrIdx][group], only entries in bundleInstruments are valid
+    Set<UInt> bundleInstruments;                                // instruments touched since bundleStart, in instrIdx order
 
 
 private:    // funcs
@@ -134,8 +172,14 @@ private:    // funcs
     void emitOutput(const CondGateMap &condGateMap, Digital digOut, UInt instrMaxDurationInCycles, UInt instrIdx, UInt startCycle, Int slot, const Str &instrumentName);
     void emitPragma(const Json &pragma, Int pragmaSmBit, UInt instrIdx, UInt startCycle, Int slot, const Str &instrumentName);
     void emitPadToCycle(UInt instrIdx, UInt startCycle, Int slot, const Str &instrumentName);
+    void padAllToCycle(UInt startCycle);
+    void emitLoopStart(const Str &label, UInt iterations, const Str &reg, const Str &comment);
+    void emitLoopEnd(const Str &label, const Str &reg, const Str &comment);
 
     // generic helpers
+    void addLinkAction(const LinkAction &action);
+    UInt newSymbol();
+    void touchInstrument(UInt instrIdx);
     CodeGenMap collectCodeGenInfo(UInt startCycle, UInt durationInCycles);
     CalcSignalValue calcSignalValue(const Settings::SignalDef &sd, UInt s, const Vec<UInt> &operands, const Str &iname);
 #if !OPT_SUPPORT_STATIC_CODEWORDS
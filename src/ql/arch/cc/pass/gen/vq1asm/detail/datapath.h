@@ -24,7 +24,7 @@ namespace detail {
 
 // NB: types shared with codegen_cc. FIXME: move
 struct FeedbackInfo {                                       // information for feedback on single instrument group
-    UInt smBit;
+    UInt smBit;                                             // NB: link symbol holding the SM bit while generating a Fragment
     UInt bit;
     Ptr<const BundleInfo> bi;                               // used for annotation only
 };
@@ -61,6 +61,8 @@ public: // functions
     UInt emitPl(UInt pl, const CondGateMap &condGateMap, UInt instrIdx, Int slot);
 
     Str getDatapathSection() { return datapathSection.str(); }
+    void clearDatapathSection() { datapathSection.str(""); }
+    void appendDatapathSection(const Str &section) { datapathSection << section; }
 
     void comment(const Str &cmnt, Bool verboseCode) {
         if (verboseCode) datapathSection << cmnt << std::endl;
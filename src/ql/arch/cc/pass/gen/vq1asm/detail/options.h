@@ -63,6 +63,27 @@ struct Options {
      */
     Bool run_once;
 
+    /**
+     * Whether repeated bundle sequences should be emitted as loops.
+     */
+    Bool loop_compression;
+
+    /**
+     * Maximum number of bundles in the body of a compressed loop.
+     */
+    UInt loop_compression_max_body;
+
+    /**
+     * Minimum number of repetitions for a bundle sequence to be compressed.
+     */
+    UInt loop_compression_min_iterations;
+
+    /**
+     * Number of threads used to generate code for kernels, 0 meaning one per
+     * hardware thread.
+     */
+    UInt kernel_threads;
+
 };
 
 /**
@@ -13,6 +13,7 @@
 #include "ql/utils/ptr.h"
 #include "ql/utils/vec.h"
 #include "ql/utils/map.h"
+#include "ql/utils/set.h"
 
 namespace ql {
 namespace arch {
@@ -46,6 +47,9 @@ using Vec = utils::Vec<T>;
 template <class K, class V>
 using Map = utils::Map<K, V>;
 
+template <class T>
+using Set = utils::Set<T>;
+
 } // namespace detail
 } // namespace vq1asm
 } // namespace gen
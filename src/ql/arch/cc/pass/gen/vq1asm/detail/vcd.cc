@@ -83,12 +83,30 @@ void Vcd::programFinish(const Str &filename) {
 }
 
 
+// return the changes recorded since the previous call, for the kernel just generated
+Vcd::Fragment Vcd::fragmentFinish() {
+    Fragment ret = std::move(fragment);
+    fragment = Fragment();
+    return ret;
+}
+
+
+// add the changes of a kernel to the VCD, directly after the kernels linked before
+void Vcd::link(const Fragment &kernel) {
+    for (const auto &c : kernel.changes) {
+        change(c.var, kernelStartTime + c.time, c.value);
+    }
+    kernelStartTime += kernel.durationInNs;
+}
+
+
 void Vcd::kernelFinish(const Str &kernelName, UInt durationInCycles) {
     // NB: timing starts anew for every kernel
     UInt durationInNs = durationInCycles * cycleTime;
-    change(vcdVarKernel, kernelStartTime, kernelName);          // start of kernel
-    change(vcdVarKernel, kernelStartTime + durationInNs, "");   // end of kernel
-    kernelStartTime += durationInNs;
+    record(vcdVarKernel, 0, kernelName);                        // start of kernel
+    record(vcdVarKernel, durationInNs, "");                     // end of kernel
+    fragment.durationInNs += durationInNs;
+    repeatOffset = 0;
 }
 
 
@@ -101,36 +119,69 @@ void Vcd::bundleFinishGroup(
     Int group
 ) {
     // generate signal output for group
-    UInt startTime = kernelStartTime + startCycle * cycleTime;
+    UInt startTime = startCycle * cycleTime + repeatOffset;
     UInt durationInNs = durationInCycles * cycleTime;
     Int var = vcdVarSignal[instrIdx][group];
     Str val = QL_SS2S(groupDigOut) + "=" + signalValue;
-    change(var, startTime, val);                                // start of signal
-    change(var, startTime + durationInNs, "");                  // end of signal
+    record(var, startTime, val);                                // start of signal
+    record(var, startTime + durationInNs, "");                  // end of signal
 }
 
 
 void Vcd::bundleFinish(UInt startCycle, Digital digOut, UInt maxDurationInCycles, UInt instrIdx) {
     // generate codeword output for instrument
-    UInt startTime = kernelStartTime + startCycle * cycleTime;
+    UInt startTime = startCycle * cycleTime + repeatOffset;
     UInt durationInNs = maxDurationInCycles * cycleTime;
     Int var = vcdVarCodeword[instrIdx];
     Str val = QL_SS2S("0x" << std::hex << std::setfill('0') << std::setw(8) << digOut);
-    change(var, startTime, val);                                // start of signal
-    change(var, startTime+durationInNs, "");                    // end of signal
+    record(var, startTime, val);                                // start of signal
+    record(var, startTime+durationInNs, "");                    // end of signal
 }
 
 
 void Vcd::customGate(const Str &iname, const Vec<UInt> &qops, UInt startCycle, UInt durationInCycles) {
     // generate qubit VCD output
-    UInt startTime = kernelStartTime + startCycle*cycleTime;
+    UInt startTime = startCycle*cycleTime + repeatOffset;
     UInt durationInNs = durationInCycles*cycleTime;
     for (UInt i = 0; i < qops.size(); i++) {
         Int var = vcdVarQubit[qops[i]];
         Str name = iname;                                       // FIXME: improve name for 2q gates
-        change(var, startTime, name);                           // start of instruction
-        change(var, startTime + durationInNs, "");              // end of instruction
+        record(var, startTime, name);                           // start of instruction
+        record(var, startTime + durationInNs, "");              // end of instruction
+    }
+}
+
+
+/*
+    The code generator emits a compressed loop body only once, with start cycles on the compressed timeline of the
+    generated code. The VCD however shows the timeline of the bundles, as if the loop were unrolled: the changes
+    recorded for the body are replicated for the remaining iterations, and the changes recorded after the loop are
+    shifted by the time folded into it.
+*/
+void Vcd::repeatStart(UInt iterations, UInt startCycle) {
+    repeatIterations = iterations;
+    repeatStartCycle = startCycle;
+    repeatFirstChange = fragment.changes.size();
+}
+
+
+void Vcd::repeatEnd(UInt endCycle) {
+    UInt periodInNs = (endCycle - repeatStartCycle) * cycleTime;
+    UInt lastChange = fragment.changes.size();
+    for (UInt it = 1; it < repeatIterations; it++) {
+        for (UInt i = repeatFirstChange; i < lastChange; i++) {
+            Change c = fragment.changes[i];
+            c.time += it * periodInNs;
+            fragment.changes.push_back(c);
+        }
     }
+    repeatOffset += (repeatIterations - 1) * periodInNs;
+}
+
+
+// remind a change at the given time relative to the start of the kernel, see link()
+void Vcd::record(Int var, UInt time, const Str &value) {
+    fragment.changes.push_back(Change{var, time, value});
 }
 
 } // namespace detail
@@ -22,20 +22,47 @@ namespace vq1asm {
 namespace detail {
 
 class Vcd : private utils::Vcd {
+public:     // types
+    struct Change {
+        Int var;
+        UInt time;                                              // relative to the start of the kernel
+        Str value;
+    };
+
+    // the changes of a single kernel, recorded while generating its code fragment and added to the VCD by link()
+    struct Fragment {
+        Vec<Change> changes;
+        UInt durationInNs = 0;
+    };
+
 public:     // funcs
     Vcd() = default;
     ~Vcd() = default;
 
     void programStart(UInt qubitNumber, Int cycleTime, Int maxGroups, const Settings &settings);
     void programFinish(const Str &filename);
+    Fragment fragmentFinish();
+    void link(const Fragment &kernel);
     void kernelFinish(const Str &kernelName, UInt durationInCycles);
     void bundleFinishGroup(UInt startCycle, UInt durationInCycles, Digital groupDigOut, const Str &signalValue, UInt instrIdx, Int group);
     void bundleFinish(UInt startCycle, Digital digOut, UInt maxDurationInCycles, UInt instrIdx);
     void customGate(const Str &iname, const Vec<UInt> &qops, UInt startCycle, UInt durationInCycles);
+    void repeatStart(UInt iterations, UInt startCycle);
+    void repeatEnd(UInt endCycle);
+
+private:    // funcs
+    void record(Int var, UInt time, const Str &value);
 
 private:    // vars
+    Fragment fragment;                                          // changes recorded for the current kernel
     UInt cycleTime = 1;
     UInt kernelStartTime = 0;
+
+    // compressed loops, see repeatStart()
+    UInt repeatOffset = 0;                                      // time [ns] folded into the loops of the current kernel
+    UInt repeatIterations = 0;
+    UInt repeatStartCycle = 0;
+    UInt repeatFirstChange = 0;                                 // index of first change recorded for current loop body
     Int vcdVarKernel = 0;
     Vec<Int> vcdVarQubit;
     Vec<Vec<Int>> vcdVarSignal;
@@ -75,6 +75,38 @@ GenerateVQ1AsmPass::GenerateVQ1AsmPass(
         "indefinitely."
     );
 
+    options.add_bool(
+        "loop_compression",
+        "When set, sequences of bundles that repeat with identical gates, "
+        "operands and relative timing within a kernel are emitted once, "
+        "wrapped in a hardware loop, instead of being unrolled. This reduces "
+        "the size of the program that must be uploaded to the CC."
+    );
+
+    options.add_int(
+        "loop_compression_max_body",
+        "Maximum number of bundles in the body of a loop detected by "
+        "loop_compression. Larger values find more repetitions, at the cost "
+        "of compile time.",
+        "16", 1, utils::MAX
+    );
+
+    options.add_int(
+        "loop_compression_min_iterations",
+        "Minimum number of repetitions of a bundle sequence before "
+        "loop_compression emits it as a loop.",
+        "3", 2, utils::MAX
+    );
+
+    options.add_int(
+        "kernel_threads",
+        "Number of threads used to generate the code for the kernels of the "
+        "program in parallel. The code of the kernels is linked serially "
+        "afterwards, so the result does not depend on this value. 0 uses one "
+        "thread per hardware thread.",
+        "0", 0, utils::MAX
+    );
+
 }
 
 /**
@@ -100,6 +132,10 @@ utils::Int GenerateVQ1AsmPass::run(
     parsed_options->map_input_file = options["map_input_file"].as_str();
     parsed_options->run_once = options["run_once"].as_bool();
     parsed_options->verbose = options["verbose"].as_bool();
+    parsed_options->loop_compression = options["loop_compression"].as_bool();
+    parsed_options->loop_compression_max_body = options["loop_compression_max_body"].as_uint();
+    parsed_options->loop_compression_min_iterations = options["loop_compression_min_iterations"].as_uint();
+    parsed_options->kernel_threads = options["kernel_threads"].as_uint();
 
     // Run the backend.
     detail::Backend().compile(program, parsed_options.as_const());
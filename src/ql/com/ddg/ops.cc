@@ -73,6 +73,14 @@ EdgeCRef get_edge(const ir::StatementRef &from, const ir::StatementRef &to) {
     }
 }
 
+/**
+ * Returns the dense index of the given statement, i.e. the absolute value of
+ * the order of its DDG node. The statement must have a DDG node.
+ */
+utils::UInt get_index(const ir::StatementRef &statement) {
+    return utils::abs(statement->get_annotation<NodeRef>()->order);
+}
+
 /**
  * Returns the effective scheduling direction when scheduling using this DDG.
  */
@@ -134,6 +142,55 @@ void reverse(const ir::BlockBaseRef &block) {
     reverse_statement(graph.sink);
 }
 
+/**
+ * Makes a compact, index-based snapshot of the data dependency graph
+ * associated with the given block in its current direction. The snapshot is
+ * not updated when the graph is reversed or cleared.
+ */
+DenseGraphCRef make_dense(const ir::BlockBaseRef &block) {
+    const auto &graph = block->get_annotation<Graph>();
+    utils::Ptr<DenseGraph> dense;
+    dense.emplace();
+
+    // Gather the statements by dense index, and count the edges so we can
+    // allocate the flat arrays in one go.
+    utils::UInt num_statements = block->statements.size() + 2;
+    dense->statements.resize(num_statements);
+    dense->predecessor_counts.resize(num_statements);
+    utils::UInt num_edges = 0;
+    auto gather = [&](const ir::StatementRef &statement) {
+        const auto &node = statement->get_annotation<NodeRef>();
+        auto index = utils::abs(node->order);
+        QL_ASSERT((utils::UInt)index < num_statements);
+        QL_ASSERT(dense->statements[index].empty());
+        dense->statements[index] = statement;
+        dense->predecessor_counts[index] = node->predecessors.size();
+        num_edges += node->successors.size();
+    };
+    gather(graph.source);
+    for (const auto &statement : block->statements) {
+        gather(statement);
+    }
+    gather(graph.sink);
+    dense->source = get_index(graph.source);
+    dense->sink = get_index(graph.sink);
+
+    // Fill the successor arrays in index order.
+    dense->successor_offsets.reserve(num_statements + 1);
+    dense->successor_indices.reserve(num_edges);
+    dense->successor_weights.reserve(num_edges);
+    for (const auto &statement : dense->statements) {
+        dense->successor_offsets.push_back(dense->successor_indices.size());
+        for (const auto &it : statement->get_annotation<NodeRef>()->successors) {
+            dense->successor_indices.push_back(get_index(it.first));
+            dense->successor_weights.push_back(it.second->weight);
+        }
+    }
+    dense->successor_offsets.push_back(dense->successor_indices.size());
+
+    return dense.as_const();
+}
+
 } // namespace ddg
 } // namespace com
 } // namespace ql
@@ -31,6 +31,23 @@ int main() {
     com::ddg::build(ir, ir->program->blocks[0]);
     com::ddg::check_consistency(ir->program->blocks[0]);
     com::ddg::dump_dot(ir->program->blocks[0]);
+
+    // Check that the dense snapshot agrees with the annotations.
+    auto dense = com::ddg::make_dense(ir->program->blocks[0]);
+    QL_ASSERT(dense->statements.size() == ir->program->blocks[0]->statements.size() + 2);
+    QL_ASSERT(dense->successor_offsets.size() == dense->statements.size() + 1);
+    QL_ASSERT(dense->source == 0);
+    QL_ASSERT(dense->sink == dense->statements.size() - 1);
+    for (utils::UInt i = 0; i < dense->statements.size(); i++) {
+        const auto &node = com::ddg::get_node(dense->statements[i]);
+        QL_ASSERT(com::ddg::get_index(dense->statements[i]) == i);
+        QL_ASSERT(dense->predecessor_counts[i] == node->predecessors.size());
+        QL_ASSERT(dense->successor_offsets[i + 1] - dense->successor_offsets[i] == node->successors.size());
+        for (auto e = dense->successor_offsets[i]; e < dense->successor_offsets[i + 1]; e++) {
+            const auto &successor = dense->statements[dense->successor_indices[e]];
+            QL_ASSERT(com::ddg::get_edge(dense->statements[i], successor)->weight == dense->successor_weights[e]);
+        }
+    }
     com::ddg::reverse(ir->program->blocks[0]);
     com::ddg::check_consistency(ir->program->blocks[0]);
     com::ddg::dump_dot(ir->program->blocks[0]);
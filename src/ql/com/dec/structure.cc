@@ -699,7 +699,7 @@ ir::ProgramRef decompose_structure(const ir::Ref &ir, utils::Bool check) {
     if (QL_IS_LOG_DEBUG || check) {
         auto new_ir = ir.copy();
         new_ir->program = program;
-        ir::check_consistency(new_ir);
+        ir::check_consistency(new_ir, ir::ConsistencyCheckLevel::PARANOID);
         check_basic_block_form(program);
     };
 
@@ -36,6 +36,26 @@ Options make_ql_options() {
         }
     ).with_callback([](Option &x){logger::set_log_level(x.as_str());});
 
+    options.add_enum(
+        "log_format",
+        "Format of the log output. `text` writes human-readable lines, `json` "
+        "writes one JSON object per line with level, file, line, and message "
+        "keys, for processing by log analysis tools.",
+        "text",
+        {"text", "json"}
+    ).with_callback([](Option &x){logger::set_log_format(x.as_str());});
+
+    options.add_bool(
+        "log_async",
+        "When set, log messages are collected in per-thread buffers and "
+        "written by a background thread, such that logging does not slow down "
+        "compilation as much at high verbosity. Warnings and errors are still "
+        "written before compilation continues, and all messages are written "
+        "by the time a compilation finishes. Note that messages may then be "
+        "interleaved differently with output written directly to stdout.",
+        false
+    ).with_callback([](Option &x){logger::set_log_async(x.as_bool());});
+
     //========================================================================//
     // Kernel/gate and other global behavior not related to passes            //
     //========================================================================//
@@ -78,6 +98,69 @@ Options make_ql_options() {
         "only used when %N is used in the `output_prefix` common pass option."
     );
 
+    options.add_bool(
+        "platform_cache",
+        "Controls whether platforms constructed from the same configuration "
+        "share their parsed, immutable components (instruction set, topology "
+        "and its distance table) within this process. The cache is keyed by "
+        "the contents of the platform configuration and compiler configuration "
+        "files rather than their names, so modified files are picked up. This "
+        "includes compiler configuration files referenced from within a "
+        "platform configuration file, which are keyed by their absolute path "
+        "and contents. At most 32 configurations are kept; the least recently "
+        "used one is dropped when another one is loaded.",
+        true
+    );
+
+    options.add_str(
+        "platform_cache_dir",
+        "When nonempty, the distance tables of platform topologies are "
+        "additionally cached in this directory, such that they can be reused "
+        "by later processes. The files are named by a hash of the topology, "
+        "and a loaded file is only used if its complete key matches the "
+        "topology and its table satisfies the shortest path equations for the "
+        "topology's edges; otherwise the table is computed again and the file "
+        "is replaced. The directory may thus be shared by any number of "
+        "processes and platforms.",
+        ""
+    );
+
+    options.add_str(
+        "cache_dir",
+        "When nonempty, passes for which the `cache` pass option is set store "
+        "their results in this directory, keyed by a hash of the platform, the "
+        "pass configuration, the global options, and the input program (or "
+        "kernel). When the same pass is later run on the same input, the "
+        "stored result is used instead of running the pass again, also across "
+        "processes. Only results that can be represented losslessly in cQASM "
+        "are stored.",
+        ""
+    );
+
+    options.add_int(
+        "cache_size_limit",
+        "Size limit for the compile cache directory in MiB. When a result is "
+        "stored and the total size of the cache entries exceeds this limit, "
+        "the least recently used entries are removed. The entry that was just "
+        "stored is never removed, so 0 keeps only the most recent entry.",
+        "1024", 0, utils::MAX
+    );
+
+    options.add_enum(
+        "consistency_checks",
+        "Controls when the internal consistency of the IR is checked. `off` "
+        "disables the checks entirely. `boundary` only checks the IR when it "
+        "enters and leaves the pass manager and when it is read from cQASM. "
+        "`paranoid` additionally checks after every pass, but only the blocks "
+        "that the pass changed (and everything if the platform or program "
+        "structure changed), as well as at every legacy pass boundary. Note "
+        "that the well-formedness check of the IR tree itself still runs "
+        "over the whole tree in this mode; only the IR-specific consistency "
+        "rules are limited to the changed blocks.",
+        "boundary",
+        {"off", "boundary", "paranoid"}
+    );
+
     //========================================================================//
     // Default pass order                                                     //
     //========================================================================//
@@ -477,19 +560,29 @@ Options make_ql_options() {
 Options global = make_ql_options();
 
 /**
- * Convenience function for getting an option value as a string from the global
- * options record.
+ * Returns the options record that is active for the calling thread, i.e. the
+ * options of the compilation context it is running (see Scope), or the global
+ * options if there is none.
+ */
+Options &current() {
+    auto active = utils::get_active_options();
+    return active ? *active : global;
+}
+
+/**
+ * Convenience function for getting an option value as a string from the
+ * options record that is active for the calling thread.
  */
 const Str &get(const Str &key) {
-    return global[key].as_str();
+    return current()[key].as_str();
 }
 
 /**
- * Convenience function for setting an option value for the global options
- * record.
+ * Convenience function for setting an option value for the options record
+ * that is active for the calling thread.
  */
 void set(const Str &key, const Str &value) {
-    global[key] = value;
+    current()[key] = value;
 }
 
 } // namespace options
@@ -4,6 +4,7 @@
 
 #include "ql/com/sch/heuristics.h"
 
+#include <algorithm>
 #include "ql/com/ddg/ops.h"
 
 namespace ql {
@@ -65,20 +66,7 @@ const DeepCriticality &DeepCriticality::get(const ir::StatementRef &statement) {
  * Compares the criticality of two Criticality annotations.
  */
 utils::Bool DeepCriticality::operator<(const DeepCriticality &other) const {
-
-    // The node with the largest shallow criticality wins.
-    if (critical_path_length > other.critical_path_length) return false;
-    if (critical_path_length < other.critical_path_length) return true;
-
-    // The nodes have equal shallow criticality. The one with dependent
-    // nodes wins.
-    if (other.most_critical_dependent.empty()) return false;
-    if (most_critical_dependent.empty()) return true;
-
-    // Both nodes have dependent nodes. Recursively check their
-    // criticality.
-    return get(most_critical_dependent) < get(other.most_critical_dependent);
-
+    return rank < other.rank;
 }
 
 /**
@@ -92,63 +80,191 @@ std::ostream &operator<<(std::ostream &os, const DeepCriticality &dc) {
     return os;
 }
 
+namespace {
+
 /**
- * Ensures that a valid criticality annotation exists for the given
- * statement. This will recursively ensure that dependent statements are
- * annotated, because this is needed to compute which of the dependent
- * statements is the most critical for deep criticality. The set tracks
- * which statements have valid annotations (there may be stray annotations
- * from previous scheduling operations that we must be sure to override).
+ * Sentinel for a missing statement index.
  */
-void DeepCriticality::ensure_annotation(
-    const ir::StatementRef &statement,
-    utils::Set<ir::StatementRef> &annotated
-) {
-
-    // If insertion into the set succeeds, we haven't annotated this
-    // statement yet.
-    if (annotated.insert(statement).second) {
-        DeepCriticality criticality;
+const utils::UInt NONE = utils::UMAX;
+
+/**
+ * Helper for DeepCriticality::compute(), operating on a dense snapshot of the
+ * DDG.
+ *
+ * The deep criticality of a statement is the sequence of critical path lengths
+ * along the chain of most critical dependent statements starting at it,
+ * compared lexicographically, with a chain that ends being less critical than
+ * one that continues. Because the critical path length of a dependent
+ * statement is never greater than that of the statement itself, ranks can be
+ * assigned one critical path length at a time, in increasing order: all
+ * dependent statements with a smaller critical path length then already have
+ * their final rank. Dependent statements with the same critical path length
+ * (i.e. via edges with zero weight) are resolved recursively, and are more
+ * critical than any dependent statement with a smaller critical path length.
+ * Within a group of equal critical path length, the deep criticality of a
+ * statement is thus determined by the number of statements along its chain
+ * that remain in the group, and the rank of the statement the chain exits the
+ * group to.
+ */
+class RankBuilder {
+public:
+
+    /**
+     * The dense DDG.
+     */
+    const com::ddg::DenseGraph &graph;
+
+    /**
+     * Critical path length per statement.
+     */
+    utils::Vec<utils::UInt> critical_path_length;
+
+    /**
+     * Most critical dependent statement per statement, or NONE.
+     */
+    utils::Vec<utils::UInt> most_critical_dependent;
+
+    /**
+     * Number of statements along the chain of each statement that have the
+     * same critical path length as the statement itself, including itself.
+     */
+    utils::Vec<utils::UInt> run_length;
+
+    /**
+     * The first statement along the chain of each statement that has a
+     * smaller critical path length, or NONE if the chain ends first.
+     */
+    utils::Vec<utils::UInt> exit;
+
+    /**
+     * Rank per statement, or 0 if not yet ranked.
+     */
+    utils::Vec<utils::UInt> rank;
+
+    /**
+     * Whether most_critical_dependent, run_length, and exit have been
+     * determined for each statement.
+     */
+    utils::Vec<utils::Bool> resolved;
+
+    /**
+     * Initializes the builder for the given dense DDG.
+     */
+    explicit RankBuilder(const com::ddg::DenseGraph &graph) :
+        graph(graph),
+        critical_path_length(graph.statements.size()),
+        most_critical_dependent(graph.statements.size(), NONE),
+        run_length(graph.statements.size(), 1),
+        exit(graph.statements.size(), NONE),
+        rank(graph.statements.size(), 0),
+        resolved(graph.statements.size(), false)
+    {
+        for (utils::UInt i = 0; i < graph.statements.size(); i++) {
+            critical_path_length[i] = utils::abs(graph.statements[i]->cycle);
+        }
+    }
+
+    /**
+     * Returns the rank of the statement that the chain of statement i exits
+     * its group to, or 0 if there is none.
+     */
+    utils::UInt exit_rank(utils::UInt i) const {
+        return exit[i] == NONE ? 0 : rank[exit[i]];
+    }
+
+    /**
+     * Returns whether statement i is less critical than statement j, assuming
+     * both are resolved and in the same group.
+     */
+    utils::Bool group_less(utils::UInt i, utils::UInt j) const {
+        if (run_length[i] != run_length[j]) return run_length[i] < run_length[j];
+        return exit_rank(i) < exit_rank(j);
+    }
 
-        // Determine the critical path length for shallow criticality.
-        // Because the schedule used to determine criticality is constructed
-        // in reverse order from the list scheduler it is intended for,
-        // instructions that could be scheduled quickly have lower
-        // criticality. So, the criticality of an instruction is simply its
-        // distance from the source node of the reversed DDG, which is 0 by
-        // definition before the cycles adjusted, so this is just the
-        // absolute value.
-        criticality.critical_path_length = utils::abs(statement->cycle);
-
-        // Find the most critical dependent statement for the given
-        // scheduling direction.
-        for (const auto &dependent : com::ddg::get_node(statement)->successors) {
-            const auto &dependent_stmt = dependent.first;
-
-            // Make sure the dependent statement has a criticality
-            // annotation already.
-            ensure_annotation(dependent_stmt, annotated);
-
-            // If the dependent statement is more critical than the most
-            // critical dependent found thus far, replace it.
-            if (
-                criticality.most_critical_dependent.empty() ||
-                DeepCriticality::Heuristic()(criticality.most_critical_dependent, dependent_stmt)
-            ) {
-                criticality.most_critical_dependent = dependent_stmt;
+    /**
+     * Determines the most critical dependent statement of statement i, as well
+     * as its run length and exit. All statements with a smaller critical path
+     * length must already have been ranked.
+     */
+    void resolve(utils::UInt i) {
+        if (resolved[i]) return;
+        auto cpl = critical_path_length[i];
+        utils::UInt best = NONE;
+        utils::Bool best_in_group = false;
+        for (
+            auto e = graph.successor_offsets[i];
+            e < graph.successor_offsets[i + 1];
+            e++
+        ) {
+            auto j = graph.successor_indices[e];
+            QL_ASSERT(critical_path_length[j] <= cpl);
+            utils::Bool in_group = critical_path_length[j] == cpl;
+            if (in_group) {
+                resolve(j);
             }
 
+            // Replace the most critical dependent found thus far only if this
+            // one is strictly more critical.
+            utils::Bool more_critical;
+            if (best == NONE) {
+                more_critical = true;
+            } else if (in_group != best_in_group) {
+                more_critical = in_group;
+            } else if (in_group) {
+                more_critical = group_less(best, j);
+            } else {
+                more_critical = rank[best] < rank[j];
+            }
+            if (more_critical) {
+                best = j;
+                best_in_group = in_group;
+            }
         }
+        most_critical_dependent[i] = best;
+        if (best != NONE && best_in_group) {
+            run_length[i] = run_length[best] + 1;
+            exit[i] = exit[best];
+        } else {
+            exit[i] = best;
+        }
+        resolved[i] = true;
+    }
 
-        // Attach the annotation.
-        statement->set_annotation<DeepCriticality>(criticality);
-
+    /**
+     * Ranks all statements.
+     */
+    void build() {
+        utils::Vec<utils::UInt> order(graph.statements.size());
+        for (utils::UInt i = 0; i < order.size(); i++) {
+            order[i] = i;
+        }
+        std::stable_sort(order.begin(), order.end(), [this](utils::UInt i, utils::UInt j) {
+            return critical_path_length[i] < critical_path_length[j];
+        });
+        utils::UInt next_rank = 0;
+        for (auto group_begin = order.begin(); group_begin != order.end();) {
+            auto cpl = critical_path_length[*group_begin];
+            auto group_end = group_begin;
+            while (group_end != order.end() && critical_path_length[*group_end] == cpl) {
+                resolve(*group_end);
+                ++group_end;
+            }
+            std::stable_sort(group_begin, group_end, [this](utils::UInt i, utils::UInt j) {
+                return group_less(i, j);
+            });
+            for (auto it = group_begin; it != group_end; ++it) {
+                if (it == group_begin || group_less(*(it - 1), *it)) {
+                    next_rank++;
+                }
+                rank[*it] = next_rank;
+            }
+            group_begin = group_end;
+        }
     }
 
-    // There must now be a criticality annotation.
-    QL_ASSERT(statement->has_annotation<DeepCriticality>());
+};
 
-}
+} // anonymous namespace
 
 /**
  * Annotates the instructions in block with DeepCriticality structures, such
@@ -160,18 +276,24 @@ void DeepCriticality::ensure_annotation(
  */
 void DeepCriticality::compute(const ir::SubBlockRef &block) {
 
-    // Tracks which statements have already been annotated by *this call*
-    // (we can't just check whether the annotation already exists, because
-    // it could be an out-of-date annotation added by an earlier call).
-    utils::Set<ir::StatementRef> annotated;
-
-    // Annotate all the statements in the block. The order doesn't matter:
-    // when a dependent statement doesn't yet have the criticality
-    // annotation needed to determine deep criticality, it will be computed
-    // automatically using recursion, and if criticality has already been
-    // computed the function becomes no-op.
-    for (const auto &statement : block->statements) {
-        ensure_annotation(statement, annotated);
+    // Rank all statements in the DDG, including source and sink, in terms of
+    // deep criticality, such that comparing two statements during scheduling
+    // only requires comparing their ranks, rather than walking their chains of
+    // most critical dependent statements.
+    auto graph = com::ddg::make_dense(block);
+    RankBuilder builder(*graph);
+    builder.build();
+
+    // Attach the annotations. This overrides any stray annotations from
+    // previous scheduling operations.
+    for (utils::UInt i = 0; i < graph->statements.size(); i++) {
+        DeepCriticality criticality;
+        criticality.critical_path_length = builder.critical_path_length[i];
+        if (builder.most_critical_dependent[i] != NONE) {
+            criticality.most_critical_dependent = graph->statements[builder.most_critical_dependent[i]];
+        }
+        criticality.rank = builder.rank[i];
+        graph->statements[i]->set_annotation<DeepCriticality>(criticality);
     }
 
 }
@@ -184,7 +306,7 @@ utils::Bool DeepCriticality::Heuristic::operator()(
     const ir::StatementRef &lhs,
     const ir::StatementRef &rhs
 ) const {
-    return get(lhs) < get(rhs);
+    return get(lhs).rank < get(rhs).rank;
 }
 
 /**
@@ -202,7 +324,7 @@ utils::Str DeepCriticality::Heuristic::operator()(
 void DeepCriticality::clear(const ir::SubBlockRef &block) {
     auto source = com::ddg::get_source(block);
     if (!source.empty()) source->erase_annotation<DeepCriticality>();
-    auto sink = com::ddg::get_source(block);
+    auto sink = com::ddg::get_sink(block);
     if (!sink.empty()) sink->erase_annotation<DeepCriticality>();
     for (const auto &statement : block->statements) {
         statement->erase_annotation<DeepCriticality>();
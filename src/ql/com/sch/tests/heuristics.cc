@@ -0,0 +1,87 @@
+#include <vector>
+
+#include "ql/ir/compat/compat.h"
+#include "ql/ir/old_to_new.h"
+#include "ql/com/ddg/build.h"
+#include "ql/com/ddg/ops.h"
+#include "ql/com/sch/heuristics.h"
+#include "ql/com/sch/scheduler.h"
+
+using namespace ql;
+
+/**
+ * Reference deep criticality key, i.e. the critical path lengths along the
+ * chain of most critical dependent statements, computed by brute force.
+ */
+using Key = std::vector<utils::UInt>;
+
+/**
+ * Computes the reference key for statement i of the given dense DDG.
+ */
+static const Key &reference_key(
+    const com::ddg::DenseGraph &graph,
+    utils::UInt i,
+    utils::Vec<Key> &keys
+) {
+    if (keys[i].empty()) {
+        Key best;
+        for (auto e = graph.successor_offsets[i]; e < graph.successor_offsets[i + 1]; e++) {
+            best = std::max(best, reference_key(graph, graph.successor_indices[e], keys));
+        }
+        keys[i].push_back(utils::abs(graph.statements[i]->cycle));
+        keys[i].insert(keys[i].end(), best.begin(), best.end());
+    }
+    return keys[i];
+}
+
+int main() {
+    auto plat = ir::compat::Platform::build("test_plat", utils::Str("cc_light"));
+    auto program = utils::make<ir::compat::Program>("test_prog", plat, 7, 32, 10);
+
+    // Layers of single-qubit gates separated by CNOTs, such that there are many
+    // statements with equal critical path length.
+    auto kernel = utils::make<ir::compat::Kernel>("kernel", plat, 7, 32, 10);
+    for (utils::UInt layer = 0; layer < 6; layer++) {
+        for (utils::UInt q = 0; q < 7; q++) {
+            if ((q + layer) % 3) {
+                kernel->x(q);
+            }
+        }
+        kernel->cnot(layer % 7, (layer + 2) % 7);
+        kernel->cz((layer + 3) % 7, (layer + 4) % 7);
+    }
+    program->add(kernel);
+    auto ir = ir::convert_old_to_new(program);
+    const auto &block = ir->program->blocks[0];
+
+    // Pre-schedule in reverse and compute deep criticality, as the list
+    // scheduling pass does for forward scheduling.
+    com::ddg::build(ir, block);
+    com::ddg::reverse(block);
+    com::sch::Scheduler<>(block).run();
+    com::ddg::reverse(block);
+    com::sch::DeepCriticality::compute(block);
+
+    // The ranks must order the statements exactly as the reference keys do.
+    auto graph = com::ddg::make_dense(block);
+    auto n = graph->statements.size();
+    utils::Vec<Key> keys(n);
+    for (utils::UInt i = 0; i < n; i++) {
+        const auto &dc = com::sch::DeepCriticality::get(graph->statements[i]);
+        QL_ASSERT(dc.rank > 0);
+        QL_ASSERT(dc.critical_path_length == reference_key(*graph, i, keys)[0]);
+        for (utils::UInt j = 0; j < n; j++) {
+            const auto &other = com::sch::DeepCriticality::get(graph->statements[j]);
+            QL_ASSERT((dc.rank < other.rank) == (reference_key(*graph, i, keys) < reference_key(*graph, j, keys)));
+        }
+    }
+
+    // The list scheduler must be able to use the ranks.
+    com::sch::Scheduler<com::sch::DeepCriticality::Heuristic> scheduler(block);
+    scheduler.run();
+    scheduler.convert_cycles();
+    com::sch::DeepCriticality::clear(block);
+    QL_ASSERT(!graph->statements[1]->has_annotation<com::sch::DeepCriticality>());
+
+    return 0;
+}
@@ -159,11 +159,53 @@ void Topology::generate_neighbors_list(utils::UInt qs, Neighbors &qubits) const
     }
 }
 
+/**
+ * Returns whether the given table holds the distances between all qubits for
+ * the neighbor lists of this topology. Rather than computing the distances
+ * again, this checks that the table satisfies the shortest path equations:
+ * the distance from a qubit to itself is zero, and the distance from any
+ * other qubit is one more than the smallest distance from its neighbors, or
+ * utils::MAX if none of its neighbors can reach the target. Only the true
+ * distance table satisfies these, and checking them takes time proportional
+ * to the number of qubits times the number of edges.
+ */
+utils::Bool Topology::is_distance_table(const utils::Vec<utils::Vec<utils::UInt>> &table) const {
+    if (table.size() != num_qubits) {
+        return false;
+    }
+    for (const auto &row : table) {
+        if (row.size() != num_qubits) {
+            return false;
+        }
+    }
+    for (utils::UInt i = 0; i < num_qubits; i++) {
+        const auto &nbs = neighbors.get(i);
+        for (utils::UInt j = 0; j < num_qubits; j++) {
+            utils::UInt expected = 0;
+            if (i != j) {
+                utils::UInt closest = utils::MAX;
+                for (utils::UInt k : nbs) {
+                    closest = utils::min(closest, table[k][j]);
+                }
+                expected = closest == utils::MAX ? utils::MAX : closest + 1;
+            }
+            if (table[i][j] != expected) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
 /**
  * Constructs the grid for the given number of qubits from the given JSON
  * object. Refer to dump_docs() for details.
  */
-Topology::Topology(utils::UInt num_qubits, const utils::Json &topology) {
+Topology::Topology(
+    utils::UInt num_qubits,
+    const utils::Json &topology,
+    const utils::Vec<utils::Vec<utils::UInt>> &precomputed_distance
+) {
 
     // Shorthand.
     using JsonType = utils::Json::value_t;
@@ -425,43 +467,58 @@ Topology::Topology(utils::UInt num_qubits, const utils::Json &topology) {
             }
         }
 
-        // Compute distances between all qubits using Floyd-Warshall. When not
-        // connected, distance remains set to utils::MAX.
-        distance.resize(num_qubits);
-        for (utils::UInt i = 0; i < num_qubits; i++) {
-
-            // Initialize all distances to maximum value...
-            distance[i].resize(num_qubits, utils::MAX);
-
-            // ... except the self-edge, which is 0 distance...
-            distance[i][i] = 0;
-
-            // ... and the neighbors, which get distance 1.
-            for (utils::UInt j : neighbors.get(i)) {
-                distance[i][j] = 1;
+        // Use the precomputed distance table if we have one for this
+        // topology.
+        utils::Bool precomputed = false;
+        if (!precomputed_distance.empty()) {
+            precomputed = is_distance_table(precomputed_distance);
+            if (!precomputed) {
+                QL_WOUT("ignoring precomputed distance table that does not match the topology");
             }
-
         }
+        if (precomputed) {
+            distance = precomputed_distance;
+        } else {
 
-        // Find shorter distances by gradually including more qubits (k) in path
-        for (utils::UInt k = 0; k < num_qubits; k++) {
+            // Compute distances between all qubits using Floyd-Warshall. When not
+            // connected, distance remains set to utils::MAX.
+            distance.resize(num_qubits);
             for (utils::UInt i = 0; i < num_qubits; i++) {
-                for (utils::UInt j = 0; j < num_qubits; j++) {
 
-                    // Prevent overflow in the sum below by explicitly checking for
-                    // MAX.
-                    if (distance[i][k] == utils::MAX) {
-                        continue;
-                    }
-                    if (distance[k][j] == utils::MAX) {
-                        continue;
-                    }
+                // Initialize all distances to maximum value...
+                distance[i].resize(num_qubits, utils::MAX);
+
+                // ... except the self-edge, which is 0 distance...
+                distance[i][i] = 0;
+
+                // ... and the neighbors, which get distance 1.
+                for (utils::UInt j : neighbors.get(i)) {
+                    distance[i][j] = 1;
+                }
 
-                    if (distance[i][j] > distance[i][k] + distance[k][j]) {
-                        distance[i][j] = distance[i][k] + distance[k][j];
+            }
+
+            // Find shorter distances by gradually including more qubits (k) in path
+            for (utils::UInt k = 0; k < num_qubits; k++) {
+                for (utils::UInt i = 0; i < num_qubits; i++) {
+                    for (utils::UInt j = 0; j < num_qubits; j++) {
+
+                        // Prevent overflow in the sum below by explicitly checking for
+                        // MAX.
+                        if (distance[i][k] == utils::MAX) {
+                            continue;
+                        }
+                        if (distance[k][j] == utils::MAX) {
+                            continue;
+                        }
+
+                        if (distance[i][j] > distance[i][k] + distance[k][j]) {
+                            distance[i][j] = distance[i][k] + distance[k][j];
+                        }
                     }
                 }
             }
+
         }
 
     } else if (connectivity == GridConnectivity::FULL) {
@@ -648,6 +705,15 @@ utils::Bool Topology::is_inter_core_hop(Qubit source, Qubit target) const {
     return get_core_index(source) != get_core_index(target);
 }
 
+/**
+ * Returns the distance table computed for specified connectivity, which may
+ * be saved and passed to the constructor later to skip computing it again.
+ * Empty for full connectivity.
+ */
+const utils::Vec<utils::Vec<utils::UInt>> &Topology::get_distance_table() const {
+    return distance;
+}
+
 /**
  * Returns the distance between the two given qubits in number of hops.
  * Returns 0 iff source == target.
@@ -5,8 +5,12 @@
 #include "ql/ir/compat/platform.h"
 
 #include <regex>
+#include <mutex>
+#include <fstream>
+#include <cstdio>
 #include "ql/config.h"
 #include "ql/utils/filesystem.h"
+#include "ql/com/options.h"
 #include "ql/rmgr/manager.h"
 #include "ql/arch/factory.h"
 
@@ -451,6 +455,105 @@ static GateRef load_instruction(
     return g;
 }
 
+/**
+ * 64-bit FNV-1a hash of the given data. Unlike std::hash, this is stable
+ * across processes and platforms, so it can be used for naming cache files.
+ */
+static utils::UInt fnv1a(const utils::Str &data) {
+    utils::UInt hash = 0xCBF29CE484222325ull;
+    for (auto c : data) {
+        hash ^= (utils::UInt)(unsigned char)c;
+        hash *= 0x100000001B3ull;
+    }
+    return hash;
+}
+
+/**
+ * Constructs the topology from the given JSON data. If the platform_cache_dir
+ * option is set, the distance table is loaded from there if it was cached
+ * before, and saved there otherwise. The Topology constructor checks a loaded
+ * table against the topology, so a corrupt file is recomputed and replaced.
+ */
+void Platform::load_topology(const utils::Json &topology_cfg) {
+    const auto &dir = com::options::current()["platform_cache_dir"].as_str();
+    if (dir.empty()) {
+        topology.emplace(qubit_count, topology_cfg);
+        return;
+    }
+
+    // The first line of the cache file is the complete key, such that hash
+    // collisions are detected. The distance table follows, one row per line.
+    auto key = utils::to_string(qubit_count) + ":" + topology_cfg.dump();
+    utils::StrStrm fname;
+    fname << dir << "/topology_" << std::hex << fnv1a(key) << ".txt";
+
+    // Try to load the distance table from the cache.
+    utils::Vec<utils::Vec<utils::UInt>> distance;
+    std::ifstream ifs(fname.str());
+    utils::Str line;
+    if (ifs.is_open() && std::getline(ifs, line) && line == key) {
+        while (std::getline(ifs, line)) {
+            std::istringstream row(line);
+            distance.emplace_back();
+            utils::UInt d;
+            while (row >> d) {
+                distance.back().push_back(d);
+            }
+        }
+        QL_DOUT("loaded topology distance table from " << fname.str());
+    }
+    ifs.close();
+    topology.emplace(qubit_count, topology_cfg, distance);
+
+    // If it wasn't there or was unusable, save the one we computed. Write to
+    // a temporary file first, such that concurrent readers never see a
+    // partial file.
+    const auto &computed = topology->get_distance_table();
+    if (computed.empty() || computed == distance) {
+        return;
+    }
+    utils::make_dirs(dir);
+    auto tmp_fname = utils::get_temporary_path(fname.str());
+    std::ofstream ofs(tmp_fname);
+    if (!ofs.is_open()) {
+        QL_WOUT("failed to write topology cache file " << tmp_fname);
+        return;
+    }
+    ofs << key << "\n";
+    for (const auto &row : computed) {
+        for (utils::UInt i = 0; i < row.size(); i++) {
+            ofs << (i ? " " : "") << row[i];
+        }
+        ofs << "\n";
+    }
+    ofs.close();
+    if (std::rename(tmp_fname.c_str(), fname.str().c_str())) {
+        std::remove(tmp_fname.c_str());
+    }
+}
+
+/**
+ * Returns the name of the compiler configuration file that the given
+ * "eqasm_compiler" string refers to, or an empty string if there is no such
+ * file. Relative names are tried relative to the platform JSON file first,
+ * falling back to relative to the working directory.
+ */
+static utils::Str find_compiler_config_file(
+    const utils::Str &eqasm_compiler,
+    const utils::Str &platform_config_fname
+) {
+    if (!platform_config_fname.empty()) {
+        auto fname = utils::path_relative_to(utils::dir_name(platform_config_fname), eqasm_compiler);
+        if (utils::path_exists(fname)) {
+            return fname;
+        }
+    }
+    if (utils::path_exists(eqasm_compiler)) {
+        return eqasm_compiler;
+    }
+    return "";
+}
+
 /**
  * Loads the platform members from the given JSON data and optional
  * auxiliary compiler configuration file.
@@ -490,16 +593,10 @@ void Platform::load(
         if (!architecture.has_value()) {
 
             // String is unrecognized, but it could be a filename to a JSON
-            // configuration file (try relative to the platform JSON file or
-            // fall back to relative to the working directory).
-            auto fname = s;
-            if (!platform_config_fname.empty()) {
-                fname = utils::path_relative_to(utils::dir_name(platform_config_fname), s);
-            }
-            if (utils::path_exists(fname)) {
+            // configuration file.
+            auto fname = find_compiler_config_file(s, platform_config_fname);
+            if (!fname.empty()) {
                 compiler_settings = utils::load_json(fname);
-            } else if (utils::path_exists(s)) {
-                compiler_settings = utils::load_json(s);
             } else {
 
                 // Hmmm. Not sure what this is.
@@ -592,7 +689,7 @@ void Platform::load(
         QL_WOUT("'topology' section is not specified in the hardware config file; a fully-connected topology will be generated");
         topology.emplace(qubit_count, "{}"_json);
     } else {
-        topology.emplace(qubit_count, platform_config["topology"]);
+        load_topology(platform_config["topology"]);
     }
 
     // load instructions
@@ -707,51 +804,208 @@ void Platform::load(
 }
 
 /**
- * Constructs a platform from the given configuration filename.
+ * Constructs a prototype platform from the given configuration data. If
+ * architecture is given, it is used unless the configuration specifies
+ * another one.
  */
 Platform::Platform(
-    const utils::Str &name,
-    const utils::Str &platform_config,
+    const arch::CArchitectureRef &architecture,
+    utils::Json &platform_config,
+    const utils::Str &platform_config_fname,
     const utils::Str &compiler_config
-) : name(name) {
+) :
+    architecture(architecture),
+    instruction_set_cache(std::make_shared<InstructionSetCache>())
+{
+    load(platform_config, platform_config_fname, compiler_config);
+}
 
-    arch::Factory arch_factory = {};
+/**
+ * Constructs a platform with the given name from a prototype platform
+ * returned by get_prototype(). The immutable components of the prototype
+ * (instruction set and topology) are shared rather than copied.
+ */
+Platform::Platform(
+    const utils::Str &name,
+    const Platform &prototype
+) :
+    instruction_settings(prototype.instruction_settings),
+    name(name),
+    qubit_count(prototype.qubit_count),
+    creg_count(prototype.creg_count),
+    compat_implicit_creg_count(prototype.compat_implicit_creg_count),
+    breg_count(prototype.breg_count),
+    compat_implicit_breg_count(prototype.compat_implicit_breg_count),
+    cycle_time(prototype.cycle_time),
+    instruction_map(prototype.instruction_map),
+    architecture(prototype.architecture),
+    compiler_settings(prototype.compiler_settings),
+    hardware_settings(prototype.hardware_settings),
+    resources(prototype.resources),
+    platform_config(prototype.platform_config),
+    instruction_set_cache(prototype.instruction_set_cache)
+{
+    topology.unwrap() = prototype.topology.unwrap();
+}
 
-    // If the configuration filename itself is a recognized architecture name,
-    // query the default configuration for that architecture. Otherwise
-    // interpret it as a filename, which it's historically always been.
-    utils::Json config;
-    utils::Str platform_config_fname;
-    architecture = arch_factory.build_from_namespace(platform_config);
-    if (architecture.has_value()) {
-        std::istringstream is{architecture->get_default_platform()};
-        config = utils::parse_json(is);
-        platform_config_fname = "";
-    } else {
-        try {
-            config = utils::load_json(platform_config);
-        } catch (utils::Json::exception &e) {
-            QL_FATAL(
-                "failed to load the hardware config file : malformed json file: \n\t"
-                    << utils::Str(e.what()));
+namespace {
+
+/**
+ * Process-wide cache of prototype platforms, keyed by the contents of their
+ * configuration.
+ */
+struct PrototypeCache {
+
+    /**
+     * Mutex protecting the cache, as platforms may be constructed from
+     * different threads.
+     */
+    std::mutex mutex;
+
+    /**
+     * The cached prototypes, along with the value of uses when they were last
+     * used.
+     */
+    utils::Map<utils::Str, std::pair<std::shared_ptr<const Platform>, utils::UInt>> prototypes;
+
+    /**
+     * Counts cache lookups, to determine which prototype was least recently
+     * used.
+     */
+    utils::UInt uses = 0;
+
+};
+
+/**
+ * Maximum number of prototypes kept in the cache. Platforms that are still
+ * alive keep their prototype alive when it is dropped from the cache.
+ */
+const utils::UInt MAX_PROTOTYPES = 32;
+
+/**
+ * Returns the process-wide prototype cache.
+ */
+PrototypeCache &get_prototype_cache() {
+    static PrototypeCache cache;
+    return cache;
+}
+
+} // anonymous namespace
+
+/**
+ * Returns the prototype platform for the given cache key, using construct to
+ * make it if it is not in the process-wide platform cache yet (or if the
+ * cache is disabled via the platform_cache option). The key must capture
+ * everything the prototype depends on.
+ */
+std::shared_ptr<const Platform> Platform::get_prototype(
+    const utils::Str &key,
+    const std::function<Platform*()> &construct
+) {
+    if (!com::options::current()["platform_cache"].as_bool()) {
+        return std::shared_ptr<const Platform>(construct());
+    }
+    auto &cache = get_prototype_cache();
+    {
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        auto it = cache.prototypes.find(key);
+        if (it != cache.prototypes.end()) {
+            QL_DOUT("using cached platform configuration");
+            it->second.second = ++cache.uses;
+            return it->second.first;
         }
-        platform_config_fname = platform_config;
     }
 
-    load(config, platform_config_fname, compiler_config);
+    // Construct outside the lock, so other platforms can be loaded in the
+    // meantime. If another thread beats us to it, just use its prototype.
+    auto prototype = std::shared_ptr<const Platform>(construct());
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    auto it = cache.prototypes.find(key);
+    if (it != cache.prototypes.end()) {
+        it->second.second = ++cache.uses;
+        return it->second.first;
+    }
+
+    // Make room by dropping the least recently used prototype.
+    if (cache.prototypes.size() >= MAX_PROTOTYPES) {
+        utils::Str lru_key;
+        utils::UInt lru_use = utils::UMAX;
+        for (const auto &entry : cache.prototypes) {
+            if (entry.second.second < lru_use) {
+                lru_key = entry.first;
+                lru_use = entry.second.second;
+            }
+        }
+        cache.prototypes.erase(lru_key);
+    }
+    cache.prototypes.set(key) = {prototype, ++cache.uses};
+    return prototype;
 }
 
 /**
- * Constructs a platform from the given configuration *data*. The dummy
- * argument only serves to differentiate from the previous constructor.
+ * Drops all prototypes from the process-wide platform cache. Platforms that
+ * were built from them remain valid.
  */
-Platform::Platform(
+void Platform::clear_prototype_cache() {
+    auto &cache = get_prototype_cache();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    cache.prototypes.clear();
+}
+
+/**
+ * Constructs a platform with the given name from the given prototype and runs
+ * the architecture-specific post-processing on it.
+ */
+PlatformRef Platform::build_from_prototype(
     const utils::Str &name,
+    const std::shared_ptr<const Platform> &prototype
+) {
+    PlatformRef ref;
+    ref.set(std::shared_ptr<Platform>(new Platform(name, *prototype)));
+    ref->architecture->post_process_platform(ref);
+    return ref;
+}
+
+/**
+ * Reads the complete contents of the given file.
+ */
+static utils::Str read_file(const utils::Str &path) {
+    std::ifstream fs(path);
+    if (!fs.is_open()) {
+        QL_FATAL("failed to open file '" << path << "'");
+    }
+    utils::StrStrm ss;
+    ss << fs.rdbuf();
+    return ss.str();
+}
+
+/**
+ * Describes the given configuration file for the prototype cache key, by its
+ * absolute name (which determines how files it refers to are resolved) and
+ * its contents.
+ */
+static utils::Str describe_file(const utils::Str &fname) {
+    return utils::get_absolute_path(fname) + "\n" + read_file(fname);
+}
+
+/**
+ * Describes the compiler configuration file that the "eqasm_compiler" key of
+ * the given platform configuration refers to for the prototype cache key, or
+ * returns an empty string if it does not refer to a file.
+ */
+static utils::Str describe_eqasm_compiler(
     const utils::Json &platform_config,
-    const utils::Str &compiler_config
-) : name(name) {
-    utils::Json platform_config_mut = platform_config;
-    load(platform_config_mut, compiler_config);
+    const utils::Str &platform_config_fname
+) {
+    auto it = platform_config.find("eqasm_compiler");
+    if (it == platform_config.end() || !it->is_string()) {
+        return "";
+    }
+    auto fname = find_compiler_config_file(it->get<utils::Str>(), platform_config_fname);
+    if (fname.empty()) {
+        return "";
+    }
+    return describe_file(fname);
 }
 
 /**
@@ -762,10 +1016,46 @@ PlatformRef Platform::build(
     const utils::Str &platform_config,
     const utils::Str &compiler_config
 ) {
-    PlatformRef ref;
-    ref.set(std::shared_ptr<Platform>(new Platform(name, platform_config, compiler_config)));
-    ref->architecture->post_process_platform(ref);
-    return ref;
+    arch::Factory arch_factory = {};
+
+    // If the configuration filename itself is a recognized architecture name,
+    // query the default configuration for that architecture. Otherwise
+    // interpret it as a filename, which it's historically always been.
+    utils::Str data;
+    utils::Str platform_config_fname;
+    auto architecture = arch_factory.build_from_namespace(platform_config);
+    if (architecture.has_value()) {
+        data = architecture->get_default_platform();
+        platform_config_fname = "";
+    } else {
+        data = read_file(platform_config);
+        platform_config_fname = platform_config;
+    }
+
+    utils::Json config;
+    try {
+        config = utils::parse_json(data);
+    } catch (utils::Json::exception &e) {
+        QL_FATAL(
+            "failed to load the hardware config file : malformed json file: \n\t"
+                << utils::Str(e.what()));
+    }
+
+    // The key must cover the contents of all configuration files involved.
+    // Relative references to compiler configuration files are resolved
+    // relative to the platform configuration file or the working directory,
+    // so the absolute name of the platform configuration file and of the
+    // referenced file are part of the key as well.
+    utils::StrStrm key;
+    key << "file:" << (platform_config_fname.empty() ? "" : utils::get_absolute_path(platform_config_fname)) << "\n";
+    key << "arch:" << (architecture.has_value() ? platform_config : "") << "\n";
+    key << "compiler:" << (compiler_config.empty() ? "" : describe_file(compiler_config)) << "\n";
+    key << "eqasm_compiler:" << describe_eqasm_compiler(config, platform_config_fname) << "\n";
+    key << data;
+
+    return build_from_prototype(name, get_prototype(key.str(), [&]() {
+        return new Platform(architecture, config, platform_config_fname, compiler_config);
+    }));
 }
 
 /**
@@ -776,10 +1066,15 @@ PlatformRef Platform::build(
     const utils::Json &platform_config,
     const utils::Str &compiler_config
 ) {
-    PlatformRef ref;
-    ref.set(std::shared_ptr<Platform>(new Platform(name, platform_config, compiler_config)));
-    ref->architecture->post_process_platform(ref);
-    return ref;
+    utils::StrStrm key;
+    key << "compiler:" << (compiler_config.empty() ? "" : describe_file(compiler_config)) << "\n";
+    key << "eqasm_compiler:" << describe_eqasm_compiler(platform_config, "") << "\n";
+    key << "data:" << platform_config.dump();
+
+    return build_from_prototype(name, get_prototype(key.str(), [&]() {
+        utils::Json platform_config_mut = platform_config;
+        return new Platform({}, platform_config_mut, "", compiler_config);
+    }));
 }
 
 /**
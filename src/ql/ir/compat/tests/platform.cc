@@ -0,0 +1,133 @@
+#include <sstream>
+
+#include "ql/ir/compat/compat.h"
+#include "ql/com/options.h"
+#include "ql/utils/filesystem.h"
+#include "ql/utils/json.h"
+#include "ql/arch/factory.h"
+
+using namespace ql;
+
+int main() {
+
+    // Platforms built from the same configuration share their topology and
+    // instruction set, but nothing else.
+    auto a = ir::compat::Platform::build("a", utils::Str("cc_light.s17"));
+    auto b = ir::compat::Platform::build("b", utils::Str("cc_light.s17"));
+    QL_ASSERT(a->topology.unwrap() == b->topology.unwrap());
+    QL_ASSERT(a->instruction_map.at("x") == b->instruction_map.at("x"));
+    QL_ASSERT_EQ(a->name, "a");
+    QL_ASSERT_EQ(b->name, "b");
+    a->creg_count = 123;
+    QL_ASSERT(b->creg_count != 123);
+
+    // Different configurations must not share anything.
+    auto c = ir::compat::Platform::build("c", utils::Str("cc_light"));
+    QL_ASSERT(a->topology.unwrap() != c->topology.unwrap());
+    QL_ASSERT(a->qubit_count != c->qubit_count);
+
+    // A platform that refers to a compiler configuration file must be built
+    // again when the contents of that file change.
+    utils::Str dir = "test_output/platform_key";
+    utils::make_dirs(dir);
+    auto config = utils::parse_json(
+        arch::Factory().build_from_namespace("cc_light")->get_default_platform()
+    );
+    config["eqasm_compiler"] = "compiler.json";
+    utils::OutFile(dir + "/platform.json").write(config.dump(4));
+    utils::OutFile(dir + "/compiler.json").write(R"({"architecture": "cc_light", "passes": []})");
+    auto f = ir::compat::Platform::build("f", dir + "/platform.json");
+    auto g = ir::compat::Platform::build("g", dir + "/platform.json");
+    QL_ASSERT(f->topology.unwrap() == g->topology.unwrap());
+    utils::OutFile(dir + "/compiler.json").write(R"({"architecture": "cc_light", "dnu": [], "passes": []})");
+    auto h = ir::compat::Platform::build("h", dir + "/platform.json");
+    QL_ASSERT(f->topology.unwrap() != h->topology.unwrap());
+
+    // Without the in-process cache, the distance table is loaded from the
+    // on-disk cache the second time around, and must be the same.
+    com::options::set("platform_cache", "no");
+    com::options::set("platform_cache_dir", "test_output/platform_cache");
+    auto d = ir::compat::Platform::build("d", utils::Str("cc_light.s17"));
+    auto e = ir::compat::Platform::build("e", utils::Str("cc_light.s17"));
+    QL_ASSERT(d->topology.unwrap() != e->topology.unwrap());
+    QL_ASSERT(utils::is_dir("test_output/platform_cache"));
+    for (utils::UInt i = 0; i < 17; i++) {
+        for (utils::UInt j = 0; j < 17; j++) {
+            QL_ASSERT_EQ(d->topology->get_distance(i, j), a->topology->get_distance(i, j));
+            QL_ASSERT_EQ(e->topology->get_distance(i, j), a->topology->get_distance(i, j));
+        }
+    }
+    QL_ASSERT(e->topology->get_distance_table() == a->topology->get_distance_table());
+
+    // A table that does not match the topology, here because the distance
+    // between two qubits that are not neighbors was tampered with, must not
+    // be used, but replaced by the correct one.
+    utils::UInt source = 0;
+    utils::UInt target = 0;
+    while (a->topology->get_distance(source, target) < 2) {
+        target++;
+    }
+    utils::UInt tampered = 0;
+    for (const auto &file : utils::list_files("test_output/platform_cache")) {
+        auto contents = utils::InFile(file.path).read();
+        if (!utils::starts_with(contents, "17:")) continue;
+        std::istringstream lines(contents);
+        utils::Str line;
+        std::getline(lines, line);
+        utils::StrStrm modified;
+        modified << line << "\n";
+        for (utils::UInt row = 0; std::getline(lines, line); row++) {
+            if (row == source) {
+                std::istringstream values(line);
+                utils::UInt value;
+                for (utils::UInt col = 0; values >> value; col++) {
+                    if (col == target) {
+                        value += 10;
+                    }
+                    modified << (col ? " " : "") << value;
+                }
+                modified << "\n";
+            } else {
+                modified << line << "\n";
+            }
+        }
+        utils::OutFile(file.path).write(modified.str());
+        tampered++;
+    }
+    QL_ASSERT_EQ(tampered, 1u);
+    auto i = ir::compat::Platform::build("i", utils::Str("cc_light.s17"));
+    QL_ASSERT(i->topology->get_distance_table() == a->topology->get_distance_table());
+    utils::UInt repaired = 0;
+    for (const auto &file : utils::list_files("test_output/platform_cache")) {
+        auto contents = utils::InFile(file.path).read();
+        if (!utils::starts_with(contents, "17:")) continue;
+        auto j = ir::compat::Platform::build("j", utils::Str("cc_light.s17"));
+        QL_ASSERT(utils::InFile(file.path).read() == contents);
+        QL_ASSERT(j->topology->get_distance_table() == a->topology->get_distance_table());
+        repaired++;
+    }
+    QL_ASSERT_EQ(repaired, 1u);
+    for (const auto &file : utils::list_files("test_output/platform_cache")) {
+        utils::remove_file(file.path);
+    }
+
+    // The in-process cache keeps a bounded number of configurations. Dropping
+    // them does not affect the platforms that were built from them.
+    com::options::set("platform_cache", "yes");
+    com::options::set("platform_cache_dir", "");
+    auto k = ir::compat::Platform::build("k", utils::Str("cc_light.s17"));
+    QL_ASSERT(k->topology.unwrap() == a->topology.unwrap());
+    for (utils::UInt n = 0; n < 40; n++) {
+        config["unused_key_" + utils::to_string(n)] = n;
+        utils::OutFile(dir + "/platform.json").write(config.dump(4));
+        ir::compat::Platform::build("variant", dir + "/platform.json");
+    }
+    auto l = ir::compat::Platform::build("l", utils::Str("cc_light.s17"));
+    QL_ASSERT(l->topology.unwrap() != a->topology.unwrap());
+    ir::compat::Platform::clear_prototype_cache();
+    auto m = ir::compat::Platform::build("m", utils::Str("cc_light.s17"));
+    QL_ASSERT(m->topology.unwrap() != l->topology.unwrap());
+    QL_ASSERT(a->topology->get_distance_table() == m->topology->get_distance_table());
+
+    return 0;
+}
@@ -5,8 +5,11 @@
 #include "ql/ir/consistency.h"
 
 #include <regex>
+#include <cstdint>
+#include <functional>
 #include "ql/utils/exception.h"
 #include "ql/utils/set.h"
+#include "ql/com/options.h"
 #include "ql/ir/ops.h"
 
 namespace ql {
@@ -33,6 +36,18 @@ private:
      */
     utils::OptLink<DataType> implicit_bit_type;
 
+    /**
+     * Whether the platform is known to be consistent already, such that it
+     * does not need to be traversed.
+     */
+    utils::Bool skip_platform;
+
+    /**
+     * Blocks that are known to be consistent already, such that they do not
+     * need to be traversed. Their names are still checked for uniqueness.
+     */
+    utils::Set<const Block*> skip_blocks;
+
     /**
      * Checks that the given string is a valid identifier.
      */
@@ -134,6 +149,19 @@ private:
 
 public:
 
+    /**
+     * Constructs a consistency checker. By default everything is checked;
+     * skip_platform and skip_blocks can be used to skip parts of the tree
+     * that are known to be consistent.
+     */
+    explicit ConsistencyChecker(
+        utils::Bool skip_platform = false,
+        utils::Set<const Block*> skip_blocks = {}
+    ) :
+        skip_platform(skip_platform),
+        skip_blocks(std::move(skip_blocks))
+    {}
+
     /**
      * Behavior for unknown node types. Assume that means that no check is
      * needed.
@@ -146,6 +174,9 @@ public:
      */
     void visit_platform(Platform &node) override {
         implicit_bit_type = node.implicit_bit_type;
+        if (skip_platform) {
+            return;
+        }
         RecursiveVisitor::visit_platform(node);
 
         // Check uniqueness and ordering of the data type names.
@@ -591,7 +622,9 @@ public:
      * Checks a block.
      */
     void visit_block(Block &node) override {
-        RecursiveVisitor::visit_block(node);
+        if (!skip_blocks.count(&node)) {
+            RecursiveVisitor::visit_block(node);
+        }
 
         // Check name.
         if (!node.name.empty()) {
@@ -931,12 +964,15 @@ public:
 };
 
 /**
- * Performs a consistency check of the IR. An exception is thrown if a problem
- * is found. The constraints checked by this must be met on any interface that
- * passes an IR reference, although actually checking it on every interface
- * might be detrimental for performance.
+ * Checks whether the tree is well-formed, and then runs the consistency
+ * checker returned by make_checker on it. make_checker is only called after
+ * the well-formedness check, so it may assume a well-formed tree. If the check
+ * fails, the tree is dumped before the exception is propagated.
  */
-void check_consistency(const Ref &ir) {
+static void run_checker(
+    const Ref &ir,
+    const std::function<ConsistencyChecker()> &make_checker
+) {
     try {
 
         // First, check whether the tree itself is well-formed according to
@@ -946,7 +982,7 @@ void check_consistency(const Ref &ir) {
         // The well-formedness check doesn't check any of the additional constraints
         // that the IR imposes. The visitor pattern is great for doing checks like
         // this, because it recursively walks through the entire tree by default.
-        ConsistencyChecker consistency_checker;
+        auto consistency_checker = make_checker();
         ir->visit(consistency_checker);
 
     } catch (utils::Exception &e) {
@@ -962,6 +998,295 @@ void check_consistency(const Ref &ir) {
     }
 }
 
+/**
+ * Performs a consistency check of the IR. An exception is thrown if a problem
+ * is found. The constraints checked by this must be met on any interface that
+ * passes an IR reference, although actually checking it on every interface
+ * might be detrimental for performance.
+ */
+void check_consistency(const Ref &ir) {
+    run_checker(ir, []() {
+        return ConsistencyChecker();
+    });
+}
+
+/**
+ * Returns the consistency check level selected via the consistency_checks
+ * option.
+ */
+ConsistencyCheckLevel get_consistency_check_level() {
+    const auto &level = com::options::current()["consistency_checks"].as_str();
+    if (level == "off") {
+        return ConsistencyCheckLevel::OFF;
+    } else if (level == "boundary") {
+        return ConsistencyCheckLevel::BOUNDARY;
+    } else if (level == "paranoid") {
+        return ConsistencyCheckLevel::PARANOID;
+    }
+    QL_ICE("unknown consistency check level " << level);
+}
+
+/**
+ * Same as check_consistency(const Ref&), but only performs the check if the
+ * level selected via the consistency_checks option is at least the given
+ * level.
+ */
+void check_consistency(const Ref &ir, ConsistencyCheckLevel level) {
+    if (get_consistency_check_level() >= level) {
+        check_consistency(ir);
+    }
+}
+
+/**
+ * Mixes the given value into the given fingerprint (FNV-1a style).
+ */
+static utils::UInt fingerprint_mix(utils::UInt fingerprint, utils::UInt value) {
+    return (fingerprint ^ value) * 0x100000001B3ull;
+}
+
+/**
+ * Mixes the identity of the given node into the given fingerprint.
+ */
+static utils::UInt fingerprint_node(utils::UInt fingerprint, const void *node) {
+    return fingerprint_mix(fingerprint, (utils::UInt)reinterpret_cast<std::uintptr_t>(node));
+}
+
+/**
+ * Mixes the identity of the node that the given link points to into the given
+ * fingerprint.
+ */
+template <class T>
+static utils::UInt fingerprint_link(utils::UInt fingerprint, const T &link) {
+    return fingerprint_node(fingerprint, link.empty() ? nullptr : &*link);
+}
+
+/**
+ * Mixes the given expression into the given fingerprint. This covers the
+ * identity of every node in the expression as well as the links and values
+ * they contain, such that expressions that are modified in-place are
+ * detected as well.
+ */
+static utils::UInt fingerprint_expression(
+    utils::UInt fingerprint,
+    const Expression &expression
+) {
+    fingerprint = fingerprint_node(fingerprint, &expression);
+    if (auto literal = expression.as_literal()) {
+        fingerprint = fingerprint_link(fingerprint, literal->data_type);
+        if (auto bit = literal->as_bit_literal()) {
+            fingerprint = fingerprint_mix(fingerprint, bit->value);
+        } else if (auto integer = literal->as_int_literal()) {
+            fingerprint = fingerprint_mix(fingerprint, (utils::UInt)integer->value);
+        } else if (auto real = literal->as_real_literal()) {
+            fingerprint = fingerprint_mix(fingerprint, std::hash<utils::Real>()(real->value));
+        } else if (auto complex = literal->as_complex_literal()) {
+            fingerprint = fingerprint_mix(fingerprint, std::hash<utils::Real>()(complex->value.real()));
+            fingerprint = fingerprint_mix(fingerprint, std::hash<utils::Real>()(complex->value.imag()));
+        } else if (auto string = literal->as_string_literal()) {
+            fingerprint = fingerprint_mix(fingerprint, std::hash<utils::Str>()(string->value));
+        }
+    } else if (auto reference = expression.as_reference()) {
+        fingerprint = fingerprint_link(fingerprint, reference->target);
+        fingerprint = fingerprint_link(fingerprint, reference->data_type);
+        fingerprint = fingerprint_mix(fingerprint, reference->indices.size());
+        for (const auto &index : reference->indices) {
+            fingerprint = fingerprint_expression(fingerprint, *index);
+        }
+    } else if (auto call = expression.as_function_call()) {
+        fingerprint = fingerprint_link(fingerprint, call->function_type);
+        fingerprint = fingerprint_mix(fingerprint, call->operands.size());
+        for (const auto &operand : call->operands) {
+            fingerprint = fingerprint_expression(fingerprint, *operand);
+        }
+    }
+    return fingerprint;
+}
+
+/**
+ * Mixes the given set instruction into the given fingerprint, excluding the
+ * fields common to all statements.
+ */
+static utils::UInt fingerprint_set(
+    utils::UInt fingerprint,
+    const SetInstruction &set
+) {
+    fingerprint = fingerprint_node(fingerprint, &set);
+    fingerprint = fingerprint_expression(fingerprint, *set.condition);
+    fingerprint = fingerprint_expression(fingerprint, *set.lhs);
+    return fingerprint_expression(fingerprint, *set.rhs);
+}
+
+/**
+ * Mixes the given statement list into the given fingerprint, recursing into
+ * the expressions and the sub-blocks of structured control-flow statements.
+ */
+static utils::UInt fingerprint_statements(
+    utils::UInt fingerprint,
+    const utils::Any<Statement> &statements
+) {
+    fingerprint = fingerprint_mix(fingerprint, statements.size());
+    for (const auto &statement : statements) {
+        fingerprint = fingerprint_node(fingerprint, statement.get_ptr().get());
+        fingerprint = fingerprint_mix(fingerprint, (utils::UInt)statement->cycle);
+        if (auto cond = statement->as_conditional_instruction()) {
+            fingerprint = fingerprint_expression(fingerprint, *cond->condition);
+            if (auto custom = cond->as_custom_instruction()) {
+                fingerprint = fingerprint_link(fingerprint, custom->instruction_type);
+                fingerprint = fingerprint_mix(fingerprint, custom->operands.size());
+                for (const auto &operand : custom->operands) {
+                    fingerprint = fingerprint_expression(fingerprint, *operand);
+                }
+            } else if (auto set = cond->as_set_instruction()) {
+                fingerprint = fingerprint_expression(fingerprint, *set->lhs);
+                fingerprint = fingerprint_expression(fingerprint, *set->rhs);
+            } else if (auto go_to = cond->as_goto_instruction()) {
+                fingerprint = fingerprint_link(fingerprint, go_to->target);
+            }
+        } else if (auto wait = statement->as_wait_instruction()) {
+            fingerprint = fingerprint_mix(fingerprint, wait->duration);
+            fingerprint = fingerprint_mix(fingerprint, wait->objects.size());
+            for (const auto &object : wait->objects) {
+                fingerprint = fingerprint_expression(fingerprint, *object);
+            }
+        } else if (auto if_else = statement->as_if_else()) {
+            fingerprint = fingerprint_mix(fingerprint, if_else->branches.size());
+            for (const auto &branch : if_else->branches) {
+                fingerprint = fingerprint_expression(fingerprint, *branch->condition);
+                fingerprint = fingerprint_statements(fingerprint, branch->body->statements);
+            }
+            if (!if_else->otherwise.empty()) {
+                fingerprint = fingerprint_statements(fingerprint, if_else->otherwise->statements);
+            }
+        } else if (auto loop = statement->as_loop()) {
+            if (auto static_loop = loop->as_static_loop()) {
+                fingerprint = fingerprint_expression(fingerprint, *static_loop->lhs);
+                fingerprint = fingerprint_expression(fingerprint, *static_loop->frm);
+                fingerprint = fingerprint_expression(fingerprint, *static_loop->to);
+            } else if (auto dynamic_loop = loop->as_dynamic_loop()) {
+                fingerprint = fingerprint_expression(fingerprint, *dynamic_loop->condition);
+                if (auto for_loop = dynamic_loop->as_for_loop()) {
+                    if (!for_loop->initialize.empty()) {
+                        fingerprint = fingerprint_set(fingerprint, *for_loop->initialize);
+                    }
+                    if (!for_loop->update.empty()) {
+                        fingerprint = fingerprint_set(fingerprint, *for_loop->update);
+                    }
+                }
+            }
+            fingerprint = fingerprint_statements(fingerprint, loop->body->statements);
+        }
+    }
+    return fingerprint;
+}
+
+/**
+ * Returns the fingerprint of the given block. This is a structural hash over
+ * the identities of its nodes and the links and values they contain, so it
+ * is cheap to compute, yet nodes that were modified in-place are detected as
+ * well.
+ */
+static utils::UInt fingerprint_block(const Block &block) {
+    utils::UInt fingerprint = 0xCBF29CE484222325ull;
+    fingerprint = fingerprint_mix(fingerprint, std::hash<utils::Str>()(block.name));
+    fingerprint = fingerprint_link(fingerprint, block.next);
+    return fingerprint_statements(fingerprint, block.statements);
+}
+
+/**
+ * Mixes the identities of the nodes in the given list into the given
+ * fingerprint.
+ */
+template <class T>
+static utils::UInt fingerprint_nodes(utils::UInt fingerprint, const T &nodes) {
+    fingerprint = fingerprint_mix(fingerprint, nodes.size());
+    for (const auto &node : nodes) {
+        fingerprint = fingerprint_node(fingerprint, node.get_ptr().get());
+    }
+    return fingerprint;
+}
+
+/**
+ * Returns the fingerprint of the platform and the structure of the program,
+ * i.e. everything except the contents of the blocks.
+ */
+static utils::UInt fingerprint_structure(const Ref &ir) {
+    utils::UInt fingerprint = 0xCBF29CE484222325ull;
+    fingerprint = fingerprint_node(fingerprint, ir->platform.get_ptr().get());
+    fingerprint = fingerprint_nodes(fingerprint, ir->platform->data_types);
+    fingerprint = fingerprint_nodes(fingerprint, ir->platform->instructions);
+    fingerprint = fingerprint_nodes(fingerprint, ir->platform->functions);
+    fingerprint = fingerprint_nodes(fingerprint, ir->platform->objects);
+    if (!ir->program.empty()) {
+        fingerprint = fingerprint_node(fingerprint, ir->program.get_ptr().get());
+        fingerprint = fingerprint_nodes(fingerprint, ir->program->objects);
+        fingerprint = fingerprint_nodes(fingerprint, ir->program->blocks);
+        fingerprint = fingerprint_link(fingerprint, ir->program->entry_point);
+    }
+    return fingerprint;
+}
+
+/**
+ * Returns the fingerprints of all the blocks in the given IR.
+ */
+static utils::Map<const Block*, utils::UInt> fingerprint_blocks(const Ref &ir) {
+    utils::Map<const Block*, utils::UInt> fingerprints;
+    if (!ir->program.empty()) {
+        for (const auto &block : ir->program->blocks) {
+            fingerprints.set(block.get_ptr().get()) = fingerprint_block(*block);
+        }
+    }
+    return fingerprints;
+}
+
+/**
+ * Constructs an incremental checker, recording the current state of the
+ * given IR as the reference point. The IR is assumed to be consistent.
+ */
+IncrementalConsistencyChecker::IncrementalConsistencyChecker(const Ref &ir) :
+    structure_fingerprint(fingerprint_structure(ir)),
+    block_fingerprints(fingerprint_blocks(ir))
+{}
+
+/**
+ * Checks the parts of the given IR that changed since construction or the
+ * previous call to check(). An exception is thrown if a problem is found.
+ * Well-formedness (in the tree-gen sense) is always checked for the complete
+ * tree, because links may cross block boundaries.
+ */
+void IncrementalConsistencyChecker::check(const Ref &ir) {
+    utils::UInt new_structure_fingerprint;
+    utils::Map<const Block*, utils::UInt> new_block_fingerprints;
+    run_checker(ir, [&]() -> ConsistencyChecker {
+
+        // Fingerprinting assumes a well-formed tree, which is why this is
+        // done here.
+        new_structure_fingerprint = fingerprint_structure(ir);
+        new_block_fingerprints = fingerprint_blocks(ir);
+
+        // If the platform or program structure changed, check everything.
+        if (new_structure_fingerprint != structure_fingerprint) {
+            return ConsistencyChecker();
+        }
+
+        // Otherwise, only check the blocks that changed.
+        utils::Set<const Block*> unchanged;
+        for (const auto &it : new_block_fingerprints) {
+            auto old = block_fingerprints.find(it.first);
+            if (old != block_fingerprints.end() && old->second == it.second) {
+                unchanged.insert(it.first);
+            }
+        }
+        QL_DOUT(
+            "incremental consistency check: " << unchanged.size() << " of " <<
+            new_block_fingerprints.size() << " block(s) unchanged"
+        );
+        return ConsistencyChecker(true, std::move(unchanged));
+
+    });
+    structure_fingerprint = new_structure_fingerprint;
+    block_fingerprints = std::move(new_block_fingerprints);
+}
+
 /**
  * Determines whether the IR is in basic-block form. This returns true only if:
  *  - all statements in the program's blocks are instructions (i.e., no
@@ -1505,7 +1505,7 @@ void read(
     // was not used, otherwise links will be missing. So we just skip the check
     // if operands were specified.
     if (options.operands.empty()) {
-        check_consistency(ir);
+        check_consistency(ir, ConsistencyCheckLevel::BOUNDARY);
     }
 
 }
@@ -5,6 +5,8 @@
 
 #include "ql/ir/old_to_new.h"
 
+#include <cctype>
+#include <cstring>
 #include "ql/ir/ops.h"
 #include "ql/ir/consistency.h"
 #include "ql/ir/cqasm/read.h"
@@ -14,28 +16,44 @@
 namespace ql {
 namespace ir {
 
+/**
+ * Returns whether the given character is whitespace according to the legacy
+ * sanitization rules (equivalent to \s in std::regex).
+ */
+static utils::Bool is_legacy_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
 /**
  * Takes an instruction name from the JSON file, "sanitizes" it according to
  * the legacy platform loading rules, and splits it into the name and its
  * specialization/decomposition template parameters.
+ *
+ * The legacy rules are: convert to lowercase, trim leading and trailing
+ * whitespace, and treat runs of whitespace and commas as a single separator.
+ * This is done in a single pass rather than with regexes, as platforms may
+ * have thousands of instructions.
  */
-static utils::List<utils::Str> parse_instruction_name(utils::Str name) {
+static utils::List<utils::Str> parse_instruction_name(const utils::Str &name) {
 
-    // Sanitize according to the legacy rules.
-    name = utils::to_lower(name);
-    static const std::regex TRIM("^(\\s+)|(\\s+)$");
-    name = std::regex_replace(name, TRIM, "");
-    static const std::regex SPACES("[\\s,]+");
-    name = std::regex_replace(name, SPACES, " ");
+    // Trim leading and trailing whitespace.
+    utils::UInt begin = 0;
+    utils::UInt end = name.size();
+    while (begin < end && is_legacy_space(name[begin])) begin++;
+    while (end > begin && is_legacy_space(name[end - 1])) end--;
 
-    // Split on spaces.
-    utils::UInt pos = 0;
+    // Split on runs of whitespace and commas, converting to lowercase while
+    // we're at it.
     utils::List<utils::Str> template_params;
-    while (true) {
-        auto next = name.find_first_of(' ', pos);
-        template_params.push_back(name.substr(pos, next - pos));
-        if (next == utils::Str::npos) break;
-        pos = next + 1;
+    template_params.emplace_back();
+    for (utils::UInt i = begin; i < end; i++) {
+        auto c = name[i];
+        if (c == ',' || is_legacy_space(c)) {
+            while (i + 1 < end && (name[i + 1] == ',' || is_legacy_space(name[i + 1]))) i++;
+            template_params.emplace_back();
+        } else {
+            template_params.back().push_back((char)std::tolower((unsigned char)c));
+        }
     }
 
     return template_params;
@@ -48,7 +66,11 @@ static ExpressionRef parse_instruction_parameter(
     const Ref &ir,
     const utils::Str &param
 ) {
-    if (std::regex_match(param, std::regex("[qbc][0-9]+"))) {
+    auto is_register_ref = param.size() > 1 && (param[0] == 'q' || param[0] == 'b' || param[0] == 'c');
+    for (utils::UInt i = 1; is_register_ref && i < param.size(); i++) {
+        is_register_ref = std::isdigit((unsigned char)param[i]);
+    }
+    if (is_register_ref) {
         auto name = param.substr(0, 1);
         auto index = utils::parse_uint(param.substr(1));
 
@@ -242,6 +264,250 @@ static void parse_decomposition_rule(
 
 }
 
+/**
+ * Classes of legacy instructions for which the prototype is inferred from the
+ * name of the instruction when no prototype is specified.
+ */
+enum class LegacyGateClass {
+    UNKNOWN,
+    PREP,
+    UPDATE,
+    ROTATE_X,
+    COMMUTE_X,
+    ROTATE_Y,
+    COMMUTE_Y,
+    ROTATE_Z,
+    CONTROLLED_ROTATE_Z,
+    CONTROLLED_ROTATE_Z_INT,
+    COMMUTE_Z,
+    MEASURE,
+    SWAP,
+    CNOT,
+    CZ,
+    CZ_PARK,
+    TOFFOLI
+};
+
+/**
+ * If name starts with prefix at position pos, advances pos past it and
+ * returns true. Otherwise returns false.
+ */
+static utils::Bool consume(const utils::Str &name, utils::UInt &pos, const char *prefix) {
+    auto len = std::char_traits<char>::length(prefix);
+    if (name.compare(pos, len, prefix) != 0) return false;
+    pos += len;
+    return true;
+}
+
+/**
+ * If the character at pos is one of the given characters, advances pos past
+ * it and returns true. Otherwise returns false.
+ */
+static utils::Bool consume_one_of(const utils::Str &name, utils::UInt &pos, const char *chars) {
+    if (pos >= name.size() || !std::strchr(chars, name[pos])) return false;
+    pos++;
+    return true;
+}
+
+/**
+ * Matches move_init|prep(_?[xyz])?
+ */
+static utils::Bool is_prep_name(const utils::Str &name) {
+    if (name == "move_init") return true;
+    utils::UInt pos = 0;
+    if (!consume(name, pos, "prep")) return false;
+    consume(name, pos, "_");
+    if (pos == name.size()) return name.size() == 4;
+    return consume_one_of(name, pos, "xyz") && pos == name.size();
+}
+
+/**
+ * Matches (m|mr|r)?<axis>m?[0-9]*, i.e. the names of the legacy single-qubit
+ * gates that commute on the given axis.
+ */
+static utils::Bool is_axis_name(const utils::Str &name, char axis) {
+    for (const char *prefix : {"", "m", "mr", "r"}) {
+        utils::UInt pos = 0;
+        if (!consume(name, pos, prefix)) continue;
+        if (pos >= name.size() || name[pos] != axis) continue;
+        pos++;
+        consume(name, pos, "m");
+        while (pos < name.size() && std::isdigit((unsigned char)name[pos])) pos++;
+        if (pos == name.size()) return true;
+    }
+    return false;
+}
+
+/**
+ * Matches (m|mr|r)?xm?[0-9]*
+ */
+static utils::Bool is_x_name(const utils::Str &name) {
+    return is_axis_name(name, 'x');
+}
+
+/**
+ * Matches (m|mr|r)?ym?[0-9]*
+ */
+static utils::Bool is_y_name(const utils::Str &name) {
+    return is_axis_name(name, 'y');
+}
+
+/**
+ * Matches [st](dag)?|(m|mr|r)?zm?[0-9]*
+ */
+static utils::Bool is_z_name(const utils::Str &name) {
+    if (name == "s" || name == "t" || name == "sdag" || name == "tdag") return true;
+    return is_axis_name(name, 'z');
+}
+
+/**
+ * Matches meas(ure)?(_?[xyz])?(_keep)?
+ */
+static utils::Bool is_measure_name(const utils::Str &name) {
+    utils::UInt pos = 0;
+    if (!consume(name, pos, "meas")) return false;
+    consume(name, pos, "ure");
+    auto axis_pos = pos;
+    consume(name, axis_pos, "_");
+    if (consume_one_of(name, axis_pos, "xyz")) pos = axis_pos;
+    consume(name, pos, "_keep");
+    return pos == name.size();
+}
+
+/**
+ * Matches (teleport)?(move|swap)
+ */
+static utils::Bool is_swap_name(const utils::Str &name) {
+    utils::UInt pos = 0;
+    consume(name, pos, "teleport");
+    return name.compare(pos, utils::Str::npos, "move") == 0
+        || name.compare(pos, utils::Str::npos, "swap") == 0;
+}
+
+/**
+ * Classifies a legacy instruction name for prototype inference. Exact names
+ * take precedence over the patterns (rx would otherwise be classified as an
+ * X-axis gate, for instance), and the patterns are tried in order.
+ */
+static LegacyGateClass classify_instruction_name(const utils::Str &name) {
+    static const utils::Map<utils::Str, LegacyGateClass> EXACT = {
+        {"h", LegacyGateClass::UPDATE},
+        {"i", LegacyGateClass::UPDATE},
+        {"rx", LegacyGateClass::ROTATE_X},
+        {"ry", LegacyGateClass::ROTATE_Y},
+        {"rz", LegacyGateClass::ROTATE_Z},
+        {"crz", LegacyGateClass::CONTROLLED_ROTATE_Z},
+        {"cr", LegacyGateClass::CONTROLLED_ROTATE_Z},
+        {"crk", LegacyGateClass::CONTROLLED_ROTATE_Z_INT},
+        {"cnot", LegacyGateClass::CNOT},
+        {"cx", LegacyGateClass::CNOT},
+        {"cz", LegacyGateClass::CZ},
+        {"cphase", LegacyGateClass::CZ},
+        {"cz_park", LegacyGateClass::CZ_PARK},
+        {"toffoli", LegacyGateClass::TOFFOLI}
+    };
+    static const struct {
+        utils::Bool (*matches)(const utils::Str &name);
+        LegacyGateClass cls;
+    } PATTERNS[] = {
+        {is_prep_name, LegacyGateClass::PREP},
+        {is_x_name, LegacyGateClass::COMMUTE_X},
+        {is_y_name, LegacyGateClass::COMMUTE_Y},
+        {is_z_name, LegacyGateClass::COMMUTE_Z},
+        {is_measure_name, LegacyGateClass::MEASURE},
+        {is_swap_name, LegacyGateClass::SWAP}
+    };
+    auto it = EXACT.find(name);
+    if (it != EXACT.end()) return it->second;
+    for (const auto &pattern : PATTERNS) {
+        if (pattern.matches(name)) return pattern.cls;
+    }
+    return LegacyGateClass::UNKNOWN;
+}
+
+/**
+ * An instruction from the instructions section of a legacy platform
+ * configuration, with its name parsed and classified.
+ */
+struct ParsedInstruction {
+
+    /**
+     * The original key of the instruction in the JSON data.
+     */
+    utils::Str key;
+
+    /**
+     * The sanitized instruction name followed by its template parameters.
+     */
+    utils::List<utils::Str> name_parts;
+
+    /**
+     * The JSON data for the instruction.
+     */
+    utils::Json data;
+
+    /**
+     * Classification of the instruction name, used when the prototype must
+     * be inferred.
+     */
+    LegacyGateClass cls;
+
+    /**
+     * Ordering for the instruction load process; generalizations (fewer
+     * template parameters) come first.
+     */
+    utils::Bool operator<(const ParsedInstruction &other) const {
+        if (name_parts.size() < other.name_parts.size()) return true;
+        if (name_parts.size() > other.name_parts.size()) return false;
+        return key < other.key;
+    }
+
+};
+
+/**
+ * The sorted, parsed instruction set of a legacy platform. This only depends
+ * on the platform, so it is cached along with it.
+ */
+struct ParsedInstructionSet {
+    utils::List<ParsedInstruction> instructions;
+};
+
+/**
+ * Returns the parsed instruction set for the given legacy platform, parsing
+ * it only if this has not been done before for a platform with the same
+ * configuration.
+ */
+static std::shared_ptr<const ParsedInstructionSet> get_parsed_instructions(
+    const compat::PlatformRef &old
+) {
+    std::shared_ptr<compat::InstructionSetCache> cache = old->instruction_set_cache;
+    if (cache) {
+        std::lock_guard<std::mutex> lock(cache->mutex);
+        if (cache->parsed) {
+            return cache->parsed;
+        }
+    }
+    auto parsed = std::make_shared<ParsedInstructionSet>();
+    for (
+        auto it = old->get_instructions().begin();
+        it != old->get_instructions().end();
+        ++it
+    ) {
+        auto name_parts = parse_instruction_name(it.key());
+        auto cls = classify_instruction_name(name_parts.front());
+        parsed->instructions.push_back({it.key(), std::move(name_parts), *it, cls});
+    }
+    parsed->instructions.sort();
+    if (cache) {
+        std::lock_guard<std::mutex> lock(cache->mutex);
+        if (!cache->parsed) {
+            cache->parsed = parsed;
+        }
+        return cache->parsed;
+    }
+    return parsed;
+}
+
 /**
  * Converts the old platform to the new IR structure.
  *
@@ -292,29 +558,11 @@ Ref convert_old_to_new(const compat::PlatformRef &old) {
     // args. Generalizations must be done first, otherwise the generalization
     // will be inferred from the specialization and any extra data for the
     // generalization will be lost.
-    struct UnparsedGateType {
-        utils::Str name;
-        utils::List<utils::Str> name_parts;
-        utils::Json data;
-        utils::Bool operator<(const UnparsedGateType &other) const {
-            if (name_parts.size() < other.name_parts.size()) return true;
-            if (name_parts.size() > other.name_parts.size()) return false;
-            return name < other.name;
-        }
-    };
-    utils::List<UnparsedGateType> unparsed_gate_types;
-    for (
-        auto it = old->get_instructions().begin();
-        it != old->get_instructions().end();
-        ++it
-    ) {
-        unparsed_gate_types.push_back({
-            it.key(),
-            parse_instruction_name(it.key()),
-            *it
-        });
-    }
-    unparsed_gate_types.sort();
+    //
+    // Parsing the instruction names is done only once for each platform
+    // configuration, because this conversion is done at every legacy pass
+    // boundary.
+    auto parsed_instructions = get_parsed_instructions(old);
 
     // Similarly, we need to postpone the parsing of decomposition rules until
     // we have all the instructions, because in the new IR, we can't just make
@@ -324,18 +572,18 @@ Ref convert_old_to_new(const compat::PlatformRef &old) {
     utils::List<std::function<void()>> todo;
 
     // Now load the sorted instruction list.
-    for (const UnparsedGateType &unparsed_gate_type : unparsed_gate_types) {
+    for (const ParsedInstruction &parsed_instruction : parsed_instructions->instructions) {
         try {
 
             // Create an instruction node for the incoming instruction.
             auto insn = utils::make<InstructionType>();
-            insn->data = unparsed_gate_type.data;
+            insn->data = parsed_instruction.data;
 
             // The instruction name is in it.key(). However:
             //  - this may include specialization parameters; and
             //  - someone thought it'd be a good idea to let people write absolute
             //    garbage and then "sanitize" with some regexes. Ugh.
-            auto template_params = unparsed_gate_type.name_parts;
+            auto template_params = parsed_instruction.name_parts;
             auto name = template_params.front();
             template_params.pop_front();
             insn->name = name;
@@ -471,103 +719,106 @@ Ref convert_old_to_new(const compat::PlatformRef &old) {
 
                 // We have to infer the prototype somehow...
                 prototype_inferred = true;
-                if (std::regex_match(insn->name, std::regex("move_init|prep(_?[xyz])?"))) {
-
-                    // State initialization doesn't commute and kills the qubit
-                    // for liveness analysis.
-                    insn->operand_types.emplace(prim::OperandMode::WRITE, qubit_type);
-
-                } else if (std::regex_match(insn->name, std::regex("h|i"))) {
-
-                    // Single-qubit gate that doesn't commute in any way we can
-                    // represent.
-                    insn->operand_types.emplace(prim::OperandMode::UPDATE, qubit_type);
-
-                } else if (insn->name == "rx") {
-
-                    // Single-qubit X rotation gate.
-                    insn->operand_types.emplace(prim::OperandMode::COMMUTE_X, qubit_type);
-                    insn->operand_types.emplace(prim::OperandMode::LITERAL, real_type);
-
-                } else if (std::regex_match(insn->name, std::regex("(m|mr|r)?xm?[0-9]*"))) {
-
-                    // Single-qubit gate that commutes on the X axis.
-                    insn->operand_types.emplace(prim::OperandMode::COMMUTE_X, qubit_type);
-
-                } else if (insn->name == "ry") {
-
-                    // Single-qubit Y rotation gate.
-                    insn->operand_types.emplace(prim::OperandMode::COMMUTE_Y, qubit_type);
-                    insn->operand_types.emplace(prim::OperandMode::LITERAL, real_type);
-
-                } else if (std::regex_match(insn->name, std::regex("(m|mr|r)?ym?[0-9]*"))) {
-
-                    // Single-qubit gate that commutes on the Y axis.
-                    insn->operand_types.emplace(prim::OperandMode::COMMUTE_Y, qubit_type);
-
-                } else if (insn->name == "rz") {
-
-                    // Single-qubit Z rotation gate.
-                    insn->operand_types.emplace(prim::OperandMode::COMMUTE_Z, qubit_type);
-                    insn->operand_types.emplace(prim::OperandMode::LITERAL, real_type);
-
-                } else if (insn->name == "crz" || insn->name == "cr") {
-
-                    // Controlled Z rotation gate.
-                    insn->operand_types.emplace(prim::OperandMode::COMMUTE_Z, qubit_type);
-                    insn->operand_types.emplace(prim::OperandMode::COMMUTE_Z, qubit_type);
-                    insn->operand_types.emplace(prim::OperandMode::LITERAL, real_type);
-
-                } else if (insn->name == "crk") {
-
-                    // Controlled Z rotation gate.
-                    insn->operand_types.emplace(prim::OperandMode::COMMUTE_Z, qubit_type);
-                    insn->operand_types.emplace(prim::OperandMode::COMMUTE_Z, qubit_type);
-                    insn->operand_types.emplace(prim::OperandMode::LITERAL, int_type);
-
-                } else if (std::regex_match(insn->name, std::regex("[st](dag)?|(m|mr|r)?zm?[0-9]*"))) {
-
-                    // Single-qubit gate that commutes on the Z axis.
-                    insn->operand_types.emplace(prim::OperandMode::COMMUTE_Z, qubit_type);
-
-                } else if (std::regex_match(insn->name, std::regex("meas(ure)?(_?[xyz])?(_keep)?"))) {
-
-                    // Measurements.
-                    duplicate_with_breg_arg = true;
-                    insn->operand_types.emplace(prim::OperandMode::MEASURE, qubit_type);
-
-                } else if (std::regex_match(insn->name, std::regex("(teleport)?(move|swap)"))) {
-
-                    // Swaps.
-                    insn->operand_types.emplace(prim::OperandMode::UPDATE, qubit_type);
-                    insn->operand_types.emplace(prim::OperandMode::UPDATE, qubit_type);
-
-                } else if (insn->name == "cnot" || insn->name == "cx") {
-
-                    // Controlled X.
-                    insn->operand_types.emplace(prim::OperandMode::COMMUTE_Z, qubit_type);
-                    insn->operand_types.emplace(prim::OperandMode::COMMUTE_X, qubit_type);
-
-                } else if (insn->name == "cz" || insn->name == "cphase") {
-
-                    // Controlled phase.
-                    insn->operand_types.emplace(prim::OperandMode::COMMUTE_Z, qubit_type);
-                    insn->operand_types.emplace(prim::OperandMode::COMMUTE_Z, qubit_type);
-
-                } else if (insn->name == "cz_park") {
-
-                    // Parking cz (assume only one parked qubit at the end).
-                    insn->operand_types.emplace(prim::OperandMode::COMMUTE_Z, qubit_type);
-                    insn->operand_types.emplace(prim::OperandMode::COMMUTE_Z, qubit_type);
-                    insn->operand_types.emplace(prim::OperandMode::IGNORE, qubit_type);
-
-                } else if (insn->name == "toffoli") {
-
-                    // Toffoli gate.
-                    insn->operand_types.emplace(prim::OperandMode::COMMUTE_Z, qubit_type);
-                    insn->operand_types.emplace(prim::OperandMode::COMMUTE_Z, qubit_type);
-                    insn->operand_types.emplace(prim::OperandMode::COMMUTE_X, qubit_type);
-
+                switch (parsed_instruction.cls) {
+                    case LegacyGateClass::PREP:
+                        // State initialization doesn't commute and kills the qubit
+                        // for liveness analysis.
+                        insn->operand_types.emplace(prim::OperandMode::WRITE, qubit_type);
+                        break;
+
+                    case LegacyGateClass::UPDATE:
+                        // Single-qubit gate that doesn't commute in any way we can
+                        // represent.
+                        insn->operand_types.emplace(prim::OperandMode::UPDATE, qubit_type);
+                        break;
+
+                    case LegacyGateClass::ROTATE_X:
+                        // Single-qubit X rotation gate.
+                        insn->operand_types.emplace(prim::OperandMode::COMMUTE_X, qubit_type);
+                        insn->operand_types.emplace(prim::OperandMode::LITERAL, real_type);
+                        break;
+
+                    case LegacyGateClass::COMMUTE_X:
+                        // Single-qubit gate that commutes on the X axis.
+                        insn->operand_types.emplace(prim::OperandMode::COMMUTE_X, qubit_type);
+                        break;
+
+                    case LegacyGateClass::ROTATE_Y:
+                        // Single-qubit Y rotation gate.
+                        insn->operand_types.emplace(prim::OperandMode::COMMUTE_Y, qubit_type);
+                        insn->operand_types.emplace(prim::OperandMode::LITERAL, real_type);
+                        break;
+
+                    case LegacyGateClass::COMMUTE_Y:
+                        // Single-qubit gate that commutes on the Y axis.
+                        insn->operand_types.emplace(prim::OperandMode::COMMUTE_Y, qubit_type);
+                        break;
+
+                    case LegacyGateClass::ROTATE_Z:
+                        // Single-qubit Z rotation gate.
+                        insn->operand_types.emplace(prim::OperandMode::COMMUTE_Z, qubit_type);
+                        insn->operand_types.emplace(prim::OperandMode::LITERAL, real_type);
+                        break;
+
+                    case LegacyGateClass::CONTROLLED_ROTATE_Z:
+                        // Controlled Z rotation gate.
+                        insn->operand_types.emplace(prim::OperandMode::COMMUTE_Z, qubit_type);
+                        insn->operand_types.emplace(prim::OperandMode::COMMUTE_Z, qubit_type);
+                        insn->operand_types.emplace(prim::OperandMode::LITERAL, real_type);
+                        break;
+
+                    case LegacyGateClass::CONTROLLED_ROTATE_Z_INT:
+                        // Controlled Z rotation gate.
+                        insn->operand_types.emplace(prim::OperandMode::COMMUTE_Z, qubit_type);
+                        insn->operand_types.emplace(prim::OperandMode::COMMUTE_Z, qubit_type);
+                        insn->operand_types.emplace(prim::OperandMode::LITERAL, int_type);
+                        break;
+
+                    case LegacyGateClass::COMMUTE_Z:
+                        // Single-qubit gate that commutes on the Z axis.
+                        insn->operand_types.emplace(prim::OperandMode::COMMUTE_Z, qubit_type);
+                        break;
+
+                    case LegacyGateClass::MEASURE:
+                        // Measurements.
+                        duplicate_with_breg_arg = true;
+                        insn->operand_types.emplace(prim::OperandMode::MEASURE, qubit_type);
+                        break;
+
+                    case LegacyGateClass::SWAP:
+                        // Swaps.
+                        insn->operand_types.emplace(prim::OperandMode::UPDATE, qubit_type);
+                        insn->operand_types.emplace(prim::OperandMode::UPDATE, qubit_type);
+                        break;
+
+                    case LegacyGateClass::CNOT:
+                        // Controlled X.
+                        insn->operand_types.emplace(prim::OperandMode::COMMUTE_Z, qubit_type);
+                        insn->operand_types.emplace(prim::OperandMode::COMMUTE_X, qubit_type);
+                        break;
+
+                    case LegacyGateClass::CZ:
+                        // Controlled phase.
+                        insn->operand_types.emplace(prim::OperandMode::COMMUTE_Z, qubit_type);
+                        insn->operand_types.emplace(prim::OperandMode::COMMUTE_Z, qubit_type);
+                        break;
+
+                    case LegacyGateClass::CZ_PARK:
+                        // Parking cz (assume only one parked qubit at the end).
+                        insn->operand_types.emplace(prim::OperandMode::COMMUTE_Z, qubit_type);
+                        insn->operand_types.emplace(prim::OperandMode::COMMUTE_Z, qubit_type);
+                        insn->operand_types.emplace(prim::OperandMode::IGNORE, qubit_type);
+                        break;
+
+                    case LegacyGateClass::TOFFOLI:
+                        // Toffoli gate.
+                        insn->operand_types.emplace(prim::OperandMode::COMMUTE_Z, qubit_type);
+                        insn->operand_types.emplace(prim::OperandMode::COMMUTE_Z, qubit_type);
+                        insn->operand_types.emplace(prim::OperandMode::COMMUTE_X, qubit_type);
+                        break;
+
+                    case LegacyGateClass::UNKNOWN:
+                        break;
                 }
 
                 // If the instruction is specialized, we need at least qubit
@@ -690,7 +941,7 @@ Ref convert_old_to_new(const compat::PlatformRef &old) {
             }
 
         } catch (utils::Exception &e) {
-            e.add_context("in gate description for '" + unparsed_gate_type.name + "'");
+            e.add_context("in gate description for '" + parsed_instruction.key + "'");
             throw;
         }
     }
@@ -922,7 +1173,7 @@ Ref convert_old_to_new(const compat::PlatformRef &old) {
     // Check the result.
     QL_DOUT("Result of old->new IR platform conversion:");
     QL_IF_LOG_DEBUG(ir->dump_seq());
-    check_consistency(ir);
+    check_consistency(ir, ConsistencyCheckLevel::PARANOID);
 
     return ir;
 }
@@ -1663,7 +1914,9 @@ Ref convert_old_to_new(const compat::ProgramRef &old) {
         auto name = convert_kernels(ir, old, idx, block);
 
         // Sanitize and uniquify the kernel name.
-        name = std::regex_replace(name, std::regex("[^a-zA-Z0-9_]"), "_");
+        for (auto &c : name) {
+            if (!std::isalnum((unsigned char)c) && c != '_') c = '_';
+        }
         if (!std::regex_match(name, IDENTIFIER_RE)) name = "_" + name;
         auto unique_name = name;
         utils::UInt unique_idx = 1;
@@ -1688,7 +1941,7 @@ Ref convert_old_to_new(const compat::ProgramRef &old) {
     // Check the result.
     QL_DOUT("Result of old->new IR program conversion:");
     QL_IF_LOG_DEBUG(ir->dump_seq());
-    check_consistency(ir);
+    check_consistency(ir, ConsistencyCheckLevel::PARANOID);
 
     return ir;
 }
@@ -0,0 +1,77 @@
+#include "ql/ir/ir.h"
+#include "ql/ir/old_to_new.h"
+#include "ql/ir/consistency.h"
+#include "ql/com/options.h"
+
+using namespace ql;
+
+int main() {
+    auto plat = ir::compat::Platform::build("test_plat", utils::Str("cc_light"));
+    auto program = utils::make<ir::compat::Program>("test_prog", plat, 7, 32, 10);
+    auto kernel = utils::make<ir::compat::Kernel>("a", plat, 7, 32, 10);
+    kernel->x(0);
+    kernel->cnot(0, 1);
+    program->add(kernel);
+    kernel = utils::make<ir::compat::Kernel>("b", plat, 7, 32, 10);
+    kernel->y(1);
+    program->add(kernel);
+    auto ir = ir::convert_old_to_new(program);
+    QL_ASSERT_EQ(ir->program->blocks.size(), 2);
+
+    // The default level only checks at the boundaries.
+    QL_ASSERT(ir::get_consistency_check_level() == ir::ConsistencyCheckLevel::BOUNDARY);
+    com::options::set("consistency_checks", "paranoid");
+    QL_ASSERT(ir::get_consistency_check_level() == ir::ConsistencyCheckLevel::PARANOID);
+
+    // Nothing changed, so nothing should fail.
+    ir::IncrementalConsistencyChecker checker(ir);
+    checker.check(ir);
+
+    // Changing the cycle numbers in a block is fine.
+    ir->program->blocks[1]->statements[0]->cycle = 3;
+    checker.check(ir);
+
+    // Changing the contents of an operand in-place, without changing the
+    // identity of any node, must be detected as well.
+    auto y = ir->program->blocks[1]->statements[0]->as_custom_instruction();
+    QL_ASSERT(y);
+    auto ref = y->operands[0]->as_reference();
+    QL_ASSERT(ref);
+    auto index = ref->indices[0]->as_int_literal();
+    QL_ASSERT(index);
+    auto index_type = index->data_type;
+    index->data_type = ir->platform->qubits->data_type;
+    utils::Bool failed = false;
+    try {
+        checker.check(ir);
+    } catch (utils::Exception &e) {
+        failed = true;
+    }
+    QL_ASSERT(failed);
+    index->data_type = index_type;
+    checker.check(ir);
+
+    // Removing an operand from an instruction in-place must be detected as a
+    // change to the block, and must thus fail the check.
+    auto custom = ir->program->blocks[0]->statements[1]->as_custom_instruction();
+    QL_ASSERT(custom);
+    custom->operands.remove();
+    failed = false;
+    try {
+        checker.check(ir);
+    } catch (utils::Exception &e) {
+        failed = true;
+    }
+    QL_ASSERT(failed);
+
+    // The full check must of course also fail.
+    failed = false;
+    try {
+        ir::check_consistency(ir);
+    } catch (utils::Exception &e) {
+        failed = true;
+    }
+    QL_ASSERT(failed);
+
+    return 0;
+}
@@ -0,0 +1,57 @@
+#include "ql/ir/ir.h"
+#include "ql/ir/old_to_new.h"
+
+using namespace ql;
+
+/**
+ * Returns the operand access modes of the first instruction type with the
+ * given name and no template operands.
+ */
+static utils::Vec<prim::OperandMode> get_modes(const ir::Ref &ir, const utils::Str &name) {
+    for (const auto &insn : ir->platform->instructions) {
+        if (insn->name == name && insn->template_operands.empty()) {
+            utils::Vec<prim::OperandMode> modes;
+            for (const auto &operand_type : insn->operand_types) {
+                modes.push_back(operand_type->mode);
+            }
+            return modes;
+        }
+    }
+    QL_ICE("instruction " << name << " not found");
+}
+
+int main() {
+
+    // Strip the prototypes from the default CC-light configuration, such that
+    // they are inferred from the instruction names.
+    auto config = ir::compat::Platform::build("x", utils::Str("cc_light"))->platform_config;
+    for (auto &insn : config["instructions"]) {
+        insn.erase("prototype");
+    }
+    auto plat = ir::compat::Platform::build("a", config);
+
+    // The prototypes of legacy instructions are inferred from their names.
+    auto ir = ir::convert_old_to_new(plat);
+    using M = prim::OperandMode;
+    QL_ASSERT(get_modes(ir, "prepz") == utils::Vec<M>({M::WRITE}));
+    QL_ASSERT(get_modes(ir, "h") == utils::Vec<M>({M::UPDATE}));
+    QL_ASSERT(get_modes(ir, "x") == utils::Vec<M>({M::COMMUTE_X}));
+    QL_ASSERT(get_modes(ir, "rx90") == utils::Vec<M>({M::COMMUTE_X}));
+    QL_ASSERT(get_modes(ir, "ym90") == utils::Vec<M>({M::COMMUTE_Y}));
+    QL_ASSERT(get_modes(ir, "tdag") == utils::Vec<M>({M::COMMUTE_Z}));
+    QL_ASSERT(get_modes(ir, "measure") == utils::Vec<M>({M::MEASURE}));
+    QL_ASSERT(get_modes(ir, "cnot") == utils::Vec<M>({M::COMMUTE_Z, M::COMMUTE_X}));
+    QL_ASSERT(get_modes(ir, "cz") == utils::Vec<M>({M::COMMUTE_Z, M::COMMUTE_Z}));
+
+    // The parsed instruction set is reused by subsequent conversions, also
+    // for other platforms built from the same configuration.
+    QL_ASSERT(plat->instruction_set_cache->parsed);
+    auto parsed = plat->instruction_set_cache->parsed;
+    auto ir2 = ir::convert_old_to_new(plat);
+    QL_ASSERT(plat->instruction_set_cache->parsed == parsed);
+    QL_ASSERT_EQ(ir2->platform->instructions.size(), ir->platform->instructions.size());
+    auto plat2 = ir::compat::Platform::build("b", config);
+    QL_ASSERT(plat2->instruction_set_cache->parsed == parsed);
+
+    return 0;
+}
@@ -57,7 +57,11 @@ void VisualizeCircuitPass::dump_docs(
       NOTE: when the to-be-visualized circuit is very large, the interactive
       window may have trouble rendering the circuit even when zoomed in.
       Therefore, it is recommended to use non-interactive mode and view the
-      generated bitmap with a more capable external viewer.
+      generated bitmap with a more capable external viewer. For circuits that
+      are too large to render as a single image at all, set the `tile_size`
+      option to render the circuit as a grid of tiles in parallel, either
+      saved as separate files or streamed into a single bitmap (see the
+      `tile_output` option).
 
       The `"circuit"` section has several child sections.
 
@@ -358,7 +362,51 @@ VisualizeCircuitPass::VisualizeCircuitPass(
     options.add_bool(
         "interactive",
         "When yes, the visualizer will open a window when the pass is run. "
-        "When no, an image will be saved as <output_prefix>.bmp instead."
+        "When no, an image will be saved as <output_prefix>.bmp (or .svg, "
+        "depending on output_format) instead."
+    );
+    options.add_enum(
+        "output_format",
+        "The format of the generated image. `bmp` renders a bitmap, `svg` "
+        "renders a vector image, of which the size scales with the amount of "
+        "drawn elements rather than with the image dimensions; use this for "
+        "large programs. SVG images cannot be displayed interactively, so they "
+        "are always saved.",
+        "bmp",
+        {"bmp", "svg"}
+    );
+    options.add_int(
+        "tile_size",
+        "When nonzero, the circuit is rendered as a grid of tiles of at most "
+        "this many pixels wide and high, rather than as a single image. The "
+        "tiles are rendered in parallel, and only the cycles that overlap with "
+        "a tile are drawn for it. This makes it possible to visualize circuits "
+        "that would not fit in memory as a single image. Tiled output is "
+        "always saved; the interactive option is ignored.",
+        "0", 0, utils::MAX
+    );
+    options.add_enum(
+        "tile_output",
+        "Controls what is written when tiled rendering is enabled. When "
+        "`tiles`, each tile is saved as <output_prefix>_tile_<row>_<col>.bmp. "
+        "When `stream`, the tiles are rendered band by band and streamed into "
+        "a single <output_prefix>.bmp; the band height is then reduced as "
+        "needed to stay within the memory budget.",
+        "tiles",
+        {"tiles", "stream"}
+    );
+    options.add_int(
+        "tile_threads",
+        "The maximum number of threads used for rendering tiles. 0 uses the "
+        "number of hardware threads.",
+        "0", 0, utils::MAX
+    );
+    options.add_int(
+        "tile_memory_budget",
+        "Approximate upper bound in MiB for the pixel data kept in memory at "
+        "any time while rendering tiles. At least one tile or band is always "
+        "kept in memory, regardless of this limit.",
+        "256", 1, utils::MAX
     );
 }
 
@@ -377,7 +425,12 @@ utils::Int VisualizeCircuitPass::run(
             options["waveform_mapping"].as_str(),
             options["interactive"].as_bool(),
             context.output_prefix,
-            context.full_pass_name
+            context.full_pass_name,
+            options["output_format"].as_str() == "svg" ? detail::ImageFormat::SVG : detail::ImageFormat::BMP,
+            options["tile_size"].as_int(),
+            options["tile_output"].as_str(),
+            options["tile_threads"].as_int(),
+            options["tile_memory_budget"].as_int()
         }
     );
     return 0;
@@ -7,7 +7,9 @@
 #include "circuit.h"
 
 #include <regex>
+#include <thread>
 #include "ql/utils/exception.h"
+#include "ql/utils/parallel.h"
 #include "common.h"
 
 namespace ql {
@@ -499,6 +501,41 @@ Position4 Structure::getCellPosition(const UInt column, const UInt row, const Bi
     }
 }
 
+EndPoints Structure::getCycleRange(const Int x0, const Int x1) const {
+    // The columns are ordered by their left edge, so we can binary-search for
+    // the amount of columns that start before a given x coordinate.
+    auto columnsStartingBefore = [this](const Int x) -> Int {
+        UInt low = 0;
+        UInt high = qbitCellPositions.size();
+        while (low < high) {
+            const UInt mid = low + (high - low) / 2;
+            if (qbitCellPositions[mid][0].x0 < x) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        return utoi(low);
+    };
+
+    // The first column is the last one that starts at or before x0, and the
+    // last column is the last one that starts before x1. The resulting range
+    // is empty (end < start) if the region lies before the first column.
+    return {max<Int>(0, columnsStartingBefore(x0 + 1) - 1), columnsStartingBefore(x1) - 1};
+}
+
+EndPoints Structure::getColumnSpan(const EndPoints &cycleRange) const {
+    // The horizontal extent of the columns of the given (inclusive) range of
+    // cycles, which is empty (end < start) if the range is.
+    if (cycleRange.end < cycleRange.start) {
+        return {0, -1};
+    }
+    return {
+        qbitCellPositions[cycleRange.start][0].x0,
+        qbitCellPositions[cycleRange.end][0].x1
+    };
+}
+
 Vec<Pair<EndPoints, Bool>> Structure::getBitLineSegments() const {
     return bitLineSegments;
 }
@@ -541,6 +578,19 @@ void Structure::printProperties() const {
 }
 
 void visualizeCircuit(const ir::compat::ProgramRef &program, const VisualizerConfiguration &configuration) {
+    // Render the image in tiles if so configured. The tiles are always saved;
+    // they cannot be displayed. Vector images do not need tiling, as their
+    // size does not depend on the pixel area.
+    if (configuration.tileSize > 0 && configuration.imageFormat == ImageFormat::SVG) {
+        QL_IOUT("Tiled rendering does not apply to SVG output; rendering a single image.");
+    } else if (configuration.tileSize > 0) {
+        if (configuration.interactive) {
+            QL_WOUT("Interactive mode is not supported for tiled circuit visualization; saving the image instead.");
+        }
+        generateTiledImage(program, configuration);
+        return;
+    }
+
     const Vec<GateProperties> gates = parseGates(program);
     const Int cycleDuration = utoi(program->platform->cycle_time);
     const Int amountOfCycles = calculateAmountOfCycles(gates, cycleDuration);
@@ -549,9 +599,10 @@ void visualizeCircuit(const ir::compat::ProgramRef &program, const VisualizerCon
     // Generate the image.
     ImageOutput imageOutput = generateImage(program, configuration, minCycleWidths, 0);
 
-    // Save the image if enabled.
-    if (imageOutput.circuitLayout.saveImage || !configuration.interactive) {
-        imageOutput.image.save(configuration.output_prefix + ".bmp");
+    // Save the image if enabled. SVG images cannot be displayed, so they are
+    // always saved.
+    if (imageOutput.circuitLayout.saveImage || !configuration.interactive || configuration.imageFormat == ImageFormat::SVG) {
+        imageOutput.image.save(configuration.output_prefix + imageOutput.image.getFileExtension());
     }
 
     // Display the image if enabled.
@@ -561,10 +612,14 @@ void visualizeCircuit(const ir::compat::ProgramRef &program, const VisualizerCon
     }
 }
 
-ImageOutput generateImage(const ir::compat::ProgramRef &program, const VisualizerConfiguration &configuration, const Vec<Int> &minCycleWidths, const utils::Int extendedImageHeight) {
+/**
+ * Loads the gates of the program and the circuit layout, and prepares the gates
+ * for visualization. This is the common setup for regular and tiled rendering.
+ */
+CircuitLayout prepareCircuit(const ir::compat::ProgramRef &program, const VisualizerConfiguration &configuration, Vec<GateProperties> &gates) {
     // Get the gate list from the program.
     QL_DOUT("Getting gate list...");
-    Vec<GateProperties> gates = parseGates(program);
+    gates = parseGates(program);
     if (gates.size() == 0) {
         QL_FATAL("Quantum program contains no gates!");
     }
@@ -573,12 +628,20 @@ ImageOutput generateImage(const ir::compat::ProgramRef &program, const Visualize
     CircuitLayout layout = parseCircuitConfiguration(gates, configuration.visualizerConfigPath, program->platform->get_instructions());
     validateCircuitLayout(layout, configuration.visualizationType);
 
+    // Fix measurement gates without classical operands.
+    fixMeasurementOperands(gates);
+
+    return layout;
+}
+
+ImageOutput generateImage(const ir::compat::ProgramRef &program, const VisualizerConfiguration &configuration, const Vec<Int> &minCycleWidths, const utils::Int extendedImageHeight) {
+    Vec<GateProperties> gates;
+    CircuitLayout layout = prepareCircuit(program, configuration, gates);
+
     // Calculate circuit properties.
     QL_DOUT("Calculating circuit properties...");
     const Int cycleDuration = utoi(program->platform->cycle_time);
     QL_DOUT("Cycle duration is: " + to_string(cycleDuration) + " ns.");
-    // Fix measurement gates without classical operands.
-    fixMeasurementOperands(gates);
 
     // Initialize the circuit properties.
     CircuitData circuitData(gates, layout, cycleDuration);
@@ -589,24 +652,154 @@ ImageOutput generateImage(const ir::compat::ProgramRef &program, const Visualize
     Structure structure(layout, circuitData, minCycleWidths, extendedImageHeight);
     structure.printProperties();
 
+    // Generate the pulse lines if pulse visualization is enabled.
+    const Vec<QubitLines> linesPerQubit = layout.pulses.areEnabled()
+        ? generateQubitLines(gates, parseWaveformMapping(configuration.waveformMappingPath), circuitData)
+        : Vec<QubitLines>();
+
     // Initialize image.
     QL_DOUT("Initializing image...");
-    Image image(structure.getImageWidth(), structure.getImageHeight());
+    Image image(structure.getImageWidth(), structure.getImageHeight(), configuration.imageFormat);
     image.fill(layout.backgroundColor);
 
+    // Draw the complete circuit.
+    drawCircuit(image, layout, circuitData, structure, linesPerQubit, {0, circuitData.getAmountOfCycles() - 1});
+
+    return {image, layout, circuitData, structure};
+}
+
+/**
+ * Renders the circuit as a grid of tiles instead of as a single image, such
+ * that circuits can be visualized that would not fit in memory as a whole.
+ * Tiles are rendered in parallel, each drawing only the cycles that overlap
+ * with it. At most configuration.tileMemoryBudget MiB worth of pixel data is
+ * kept in memory at any time (but at least one tile or band). Depending on
+ * configuration.tileOutput, the tiles are either written to separate files
+ * (<prefix>_tile_<row>_<col>.bmp), or streamed band by band into a single
+ * <prefix>.bmp.
+ */
+void generateTiledImage(const ir::compat::ProgramRef &program, const VisualizerConfiguration &configuration) {
+    Vec<GateProperties> gates;
+    CircuitLayout layout = prepareCircuit(program, configuration, gates);
+
+    const Int cycleDuration = utoi(program->platform->cycle_time);
+    CircuitData circuitData(gates, layout, cycleDuration);
+    const Vec<Int> minCycleWidths(circuitData.getAmountOfCycles(), 0);
+    const Structure structure(layout, circuitData, minCycleWidths, 0);
+    const Vec<QubitLines> linesPerQubit = layout.pulses.areEnabled()
+        ? generateQubitLines(gates, parseWaveformMapping(configuration.waveformMappingPath), circuitData)
+        : Vec<QubitLines>();
+
+    // Gates may extend into the columns of the cycles after the one they start
+    // in, so a tile must also draw the cycles up to the longest gate duration
+    // before its first column.
+    Int maxGateDurationInCycles = 1;
+    for (const GateProperties &gate : gates) {
+        maxGateDurationInCycles = max(maxGateDurationInCycles, gate.duration / cycleDuration);
+    }
+
+    // Determine the tile geometry.
+    const Int imageWidth = structure.getImageWidth();
+    const Int imageHeight = structure.getImageHeight();
+    const Int memoryBudget = max<Int>(configuration.tileMemoryBudget, 1) * 1024 * 1024;
+    const Bool streamed = configuration.tileOutput == "stream";
+    const Int tileWidth = min(configuration.tileSize, imageWidth);
+    Int tileHeight = min(configuration.tileSize, imageHeight);
+    if (streamed) {
+        // A band must be complete before it can be written, so the height of
+        // the bands is limited by the memory budget.
+        tileHeight = max<Int>(1, min(tileHeight, memoryBudget / (imageWidth * 3)));
+    }
+    const Int columns = (imageWidth + tileWidth - 1) / tileWidth;
+    const Int rows = (imageHeight + tileHeight - 1) / tileHeight;
+
+    // Determine the amount of threads. For separate tiles, each thread keeps
+    // only one tile in memory, so the memory budget limits the threads.
+    UInt threads = configuration.tileThreads > 0 ? (UInt) configuration.tileThreads : std::thread::hardware_concurrency();
+    if (!streamed) {
+        threads = min<UInt>(threads, memoryBudget / (tileWidth * tileHeight * 3));
+    }
+    threads = max<UInt>(threads, 1);
+    QL_IOUT(
+        "Rendering circuit image of " << imageWidth << "x" << imageHeight
+        << " pixels as " << rows << "x" << columns << " tiles of at most "
+        << tileWidth << "x" << tileHeight << " pixels using " << threads
+        << " thread(s)..."
+    );
+
+    // Renders the tile at the given row and column.
+    auto renderTile = [&](const Int row, const Int column) -> Image {
+        const Int x0 = column * tileWidth;
+        const Int y0 = row * tileHeight;
+        const Int x1 = min(x0 + tileWidth, imageWidth);
+        const Int y1 = min(y0 + tileHeight, imageHeight);
+        Image tile(x1 - x0, y1 - y0, x0, y0);
+        tile.fill(layout.backgroundColor);
+
+        // Cull the cycles outside of the tile, leaving a margin of one cycle
+        // for labels and nodes that bleed into neighboring columns.
+        const EndPoints visible = structure.getCycleRange(x0, x1);
+        Int start = max<Int>(0, visible.start - maxGateDurationInCycles);
+
+        // All cycles of a cut range start at the same position, but the range
+        // is only drawn as its first cycle. So if the tile starts inside a cut
+        // range, move the start back to the beginning of that range.
+        while (start > 0 && circuitData.isCycleCut(start) && circuitData.isCycleCut(start - 1)) {
+            start--;
+        }
+        const EndPoints cycleRange = {
+            start,
+            min<Int>(circuitData.getAmountOfCycles() - 1, visible.end + 1)
+        };
+        drawCircuit(tile, layout, circuitData, structure, linesPerQubit, cycleRange);
+        return tile;
+    };
+
+    if (streamed) {
+        BitmapStream bitmap(configuration.output_prefix + ".bmp", imageWidth, imageHeight);
+        for (Int row = 0; row < rows; row++) {
+            Vec<Image> band;
+            for (Int column = 0; column < columns; column++) {
+                band.push_back(Image(0, 0));
+            }
+            run_parallel(columns, threads, [&](UInt, const UInt column) {
+                band.at(column) = renderTile(row, utoi(column));
+            });
+            bitmap.writeBand(band);
+        }
+        bitmap.close();
+    } else {
+        run_parallel(rows * columns, threads, [&](UInt, const UInt index) {
+            const Int row = utoi(index) / columns;
+            const Int column = utoi(index) % columns;
+            renderTile(row, column).save(
+                configuration.output_prefix + "_tile_" + to_string(row) + "_" + to_string(column) + ".bmp"
+            );
+        });
+    }
+}
+
+/**
+ * Draws the circuit onto the given image. Only the cycles in the given
+ * (inclusive) range are drawn, and the bit lines, bit line edges, and pulse
+ * lines only over the columns of those cycles; the bit line labels are always
+ * drawn, relying on the image to clip whatever is out of bounds.
+ */
+void drawCircuit(Image &image, const CircuitLayout &layout, const CircuitData &circuitData, const Structure &structure,
+                 const Vec<QubitLines> &linesPerQubit, const EndPoints &cycleRange) {
     // Draw the cycle labels if the option has been set.
     if (layout.cycles.labels.areEnabled()) {
-        drawCycleLabels(image, layout, circuitData, structure);
+        drawCycleLabels(image, layout, circuitData, structure, cycleRange);
     }
 
     // Draw the cycle edges if the option has been set.
     if (layout.cycles.edges.areEnabled()) {
-        drawCycleEdges(image, layout, circuitData, structure);
+        drawCycleEdges(image, layout, circuitData, structure, cycleRange);
     }
 
     // Draw the bit line edges if enabled.
     if (layout.bitLines.edges.areEnabled()) {
-        drawBitLineEdges(image, layout, circuitData, structure);
+        drawBitLineEdges(image, layout, circuitData, structure, cycleRange);
     }
     
     // Draw the bit line labels if enabled.
@@ -616,28 +809,28 @@ ImageOutput generateImage(const ir::compat::ProgramRef &program, const Visualize
 
     // Draw the circuit as pulses if enabled.
     if (layout.pulses.areEnabled()) {
-        PulseVisualization pulseVisualization = parseWaveformMapping(configuration.waveformMappingPath);
-        const Vec<QubitLines> linesPerQubit = generateQubitLines(gates, pulseVisualization, circuitData);
-
         // Draw the lines of each qubit.
         QL_DOUT("Drawing qubit lines for pulse visualization...");
         for (Int qubitIndex = 0; qubitIndex < circuitData.amountOfQubits; qubitIndex++) {
             const Int yBase = structure.getCellPosition(0, qubitIndex, QUANTUM).y0;
 
-            drawLine(image, structure, cycleDuration, linesPerQubit[qubitIndex].microwave, qubitIndex,
+            drawLine(image, structure, circuitData.cycleDuration, linesPerQubit[qubitIndex].microwave, qubitIndex,
                 yBase,
                 layout.pulses.getPulseRowHeightMicrowave(),
-                layout.pulses.getPulseColorMicrowave());
+                layout.pulses.getPulseColorMicrowave(),
+                cycleRange);
 
-            drawLine(image, structure, cycleDuration, linesPerQubit[qubitIndex].flux, qubitIndex,
+            drawLine(image, structure, circuitData.cycleDuration, linesPerQubit[qubitIndex].flux, qubitIndex,
                 yBase + layout.pulses.getPulseRowHeightMicrowave(),
                 layout.pulses.getPulseRowHeightFlux(),
-                layout.pulses.getPulseColorFlux());
+                layout.pulses.getPulseColorFlux(),
+                cycleRange);
 
-            drawLine(image, structure, cycleDuration, linesPerQubit[qubitIndex].readout, qubitIndex,
+            drawLine(image, structure, circuitData.cycleDuration, linesPerQubit[qubitIndex].readout, qubitIndex,
                 yBase + layout.pulses.getPulseRowHeightMicrowave() + layout.pulses.getPulseRowHeightFlux(),
                 layout.pulses.getPulseRowHeightReadout(),
-                layout.pulses.getPulseColorReadout());
+                layout.pulses.getPulseColorReadout(),
+                cycleRange);
         }
 
         // // Visualize the gates as pulses on a microwave, flux and readout line.
@@ -686,26 +879,26 @@ ImageOutput generateImage(const ir::compat::ProgramRef &program, const Visualize
         // Draw the quantum bit lines.
         QL_DOUT("Drawing qubit lines...");
         for (Int i = 0; i < circuitData.amountOfQubits; i++) {
-            drawBitLine(image, layout, QUANTUM, i, circuitData, structure);
+            drawBitLine(image, layout, QUANTUM, i, circuitData, structure, cycleRange);
         }
             
         // Draw the classical lines if enabled.
         if (layout.bitLines.classical.isEnabled()) {
             // Draw the grouped classical bit lines if the option is set.
             if (circuitData.amountOfClassicalBits > 0 && layout.bitLines.classical.isGrouped()) {
-                drawGroupedClassicalBitLine(image, layout, circuitData, structure);
+                drawGroupedClassicalBitLine(image, layout, circuitData, structure, cycleRange);
             } else {
                 // Otherwise draw each classical bit line seperate.
                 QL_DOUT("Drawing ungrouped classical bit lines...");
                 for (Int i = 0; i < circuitData.amountOfClassicalBits; i++) {
-                    drawBitLine(image, layout, CLASSICAL, i, circuitData, structure);
+                    drawBitLine(image, layout, CLASSICAL, i, circuitData, structure, cycleRange);
                 }
             }
         }
 
         // Draw the cycles.
         QL_DOUT("Drawing cycles...");
-        for (Int i = 0; i < circuitData.getAmountOfCycles(); i++) {
+        for (Int i = cycleRange.start; i <= cycleRange.end; i++) {
             // Only draw a cut cycle if its the first in its cut range.
             if (circuitData.isCycleCut(i)) {
                 if (i > 0 && !circuitData.isCycleCut(i - 1)) {
@@ -717,8 +910,6 @@ ImageOutput generateImage(const ir::compat::ProgramRef &program, const Visualize
             }
         }
     }
-
-    return {image, layout, circuitData, structure};
 }
 
 CircuitLayout parseCircuitConfiguration(Vec<GateProperties> &gates,
@@ -1364,10 +1555,11 @@ void insertFlatLineSegments(Vec<LineSegment> &existingLineSegments, const Int am
 void drawCycleLabels(Image &image,
                      const CircuitLayout &layout,
                      const CircuitData &circuitData,
-                     const Structure &structure) {
+                     const Structure &structure,
+                     const EndPoints &cycleRange) {
     QL_DOUT("Drawing cycle labels...");
 
-    for (Int i = 0; i < circuitData.getAmountOfCycles(); i++) {
+    for (Int i = cycleRange.start; i <= cycleRange.end; i++) {
         Str cycleLabel = "";
         Int cellWidth = 0;
         if (circuitData.isCycleCut(i)) {
@@ -1400,10 +1592,11 @@ void drawCycleLabels(Image &image,
 void drawCycleEdges(Image &image,
                     const CircuitLayout &layout,
                     const CircuitData &circuitData,
-                    const Structure &structure) {
+                    const Structure &structure,
+                    const EndPoints &cycleRange) {
     QL_DOUT("Drawing cycle edges...");
 
-    for (Int i = 0; i < circuitData.getAmountOfCycles(); i++) {
+    for (Int i = cycleRange.start; i <= cycleRange.end; i++) {
         if (i == 0) continue;
         if (circuitData.isCycleCut(i) && circuitData.isCycleCut(i - 1)) continue;
 
@@ -1466,12 +1659,17 @@ void drawBitLineLabels(Image &image,
 void drawBitLineEdges(Image &image,
                       const CircuitLayout &layout,
                       const CircuitData &circuitData,
-                      const Structure &structure)
+                      const Structure &structure,
+                      const EndPoints &cycleRange)
 {
     QL_DOUT("Drawing bit line edges...");
 
-    const Int x0 = structure.getCellPosition(0, 0, QUANTUM).x0 - layout.grid.getBorderSize() / 2;
-    const Int x1 = structure.getCellPosition(circuitData.getAmountOfCycles() - 1, 0, QUANTUM).x1 + layout.grid.getBorderSize() / 2;
+    // Only draw the edges over the columns of the cycle range. The edges
+    // extend into the border beyond the first and last cycle.
+    const EndPoints span = structure.getColumnSpan(cycleRange);
+    if (span.end < span.start) return;
+    const Int x0 = span.start - (cycleRange.start == 0 ? layout.grid.getBorderSize() / 2 : 0);
+    const Int x1 = span.end + (cycleRange.end == circuitData.getAmountOfCycles() - 1 ? layout.grid.getBorderSize() / 2 : 0);
     const Int yOffsetStart = -1 * layout.bitLines.edges.getThickness();
 
     for (Int bitIndex = 0; bitIndex < circuitData.amountOfQubits; bitIndex++) {
@@ -1507,7 +1705,8 @@ void drawBitLine(Image &image,
                  const BitType bitType,
                  const Int row,
                  const CircuitData &circuitData,
-                 const Structure &structure) {
+                 const Structure &structure,
+                 const EndPoints &cycleRange) {
     Color bitLineColor;
     Color bitLabelColor;
     switch (bitType) {
@@ -1521,7 +1720,11 @@ void drawBitLine(Image &image,
             break;
     }
 
+    // Only draw the segments over the columns of the cycle range.
+    const EndPoints span = structure.getColumnSpan(cycleRange);
     for (const Pair<EndPoints, Bool> &segment : structure.getBitLineSegments()) {
+        if (segment.first.end < span.start || segment.first.start > span.end) continue;
+
         const Int y = structure.getCellPosition(0, row, bitType).y0 + structure.getCellDimensions().height / 2;
         // Check if the segment is a cut segment.
         if (segment.second) {
@@ -1530,7 +1733,7 @@ void drawBitLine(Image &image,
 
             drawWiggle(image, segment.first.start, segment.first.end, y, width, height, bitLineColor);
         } else {
-            image.drawLine(segment.first.start, y, segment.first.end, y, bitLineColor);
+            image.drawLine(max(segment.first.start, span.start), y, min(segment.first.end, span.end), y, bitLineColor);
         }
     }
 }
@@ -1538,13 +1741,17 @@ void drawBitLine(Image &image,
 void drawGroupedClassicalBitLine(Image &image,
                                  const CircuitLayout &layout,
                                  const CircuitData &circuitData,
-                                 const Structure &structure) {
+                                 const Structure &structure,
+                                 const EndPoints &cycleRange) {
     QL_DOUT("Drawing grouped classical bit lines...");
 
     const Int y = structure.getCellPosition(0, 0, CLASSICAL).y0 + structure.getCellDimensions().height / 2;
 
-    // Draw the segments of the Real line.
+    // Draw the segments of the Real line over the columns of the cycle range.
+    const EndPoints span = structure.getColumnSpan(cycleRange);
     for (const Pair<EndPoints, Bool> &segment : structure.getBitLineSegments()) {
+        if (segment.first.end < span.start || segment.first.start > span.end) continue;
+
         // Check if the segment is a cut segment.
         if (segment.second) {
             const Int height = structure.getCellDimensions().height / 8;
@@ -1555,15 +1762,18 @@ void drawGroupedClassicalBitLine(Image &image,
             drawWiggle(image, segment.first.start, segment.first.end, y + layout.bitLines.classical.getGroupedLineGap(),
                 width, height, layout.bitLines.classical.getColor());
         } else {
-            image.drawLine(segment.first.start, y - layout.bitLines.classical.getGroupedLineGap(),
-                segment.first.end, y - layout.bitLines.classical.getGroupedLineGap(), layout.bitLines.classical.getColor());
-            image.drawLine(segment.first.start, y + layout.bitLines.classical.getGroupedLineGap(),
-                segment.first.end, y + layout.bitLines.classical.getGroupedLineGap(), layout.bitLines.classical.getColor());
+            const Int x0 = max(segment.first.start, span.start);
+            const Int x1 = min(segment.first.end, span.end);
+            image.drawLine(x0, y - layout.bitLines.classical.getGroupedLineGap(),
+                x1, y - layout.bitLines.classical.getGroupedLineGap(), layout.bitLines.classical.getColor());
+            image.drawLine(x0, y + layout.bitLines.classical.getGroupedLineGap(),
+                x1, y + layout.bitLines.classical.getGroupedLineGap(), layout.bitLines.classical.getColor());
         }
     }
 
     // Draw the dashed line plus classical bit amount number on the first
-    // segment.
+    // segment, which lies in the first cycle.
+    if (cycleRange.start != 0) return;
     Pair<EndPoints, Bool> firstSegment = structure.getBitLineSegments()[0];
     //TODO: store the dashed line parameters in the layout object
     image.drawLine(firstSegment.first.start + 8, y + layout.bitLines.classical.getGroupedLineGap() + 2,
@@ -1594,15 +1804,21 @@ void drawLine(Image &image,
               const Int qubitIndex,
               const Int y,
               const Int maxLineHeight,
-              const Color color) {
+              const Color color,
+              const EndPoints &cycleRange) {
+    // Only draw the segments that overlap with the cycle range, and flat
+    // segments only over the columns of the cycle range.
+    const EndPoints span = structure.getColumnSpan(cycleRange);
     for (const LineSegment &segment : line.segments) {
+        if (segment.range.end < cycleRange.start || segment.range.start > cycleRange.end) continue;
+
         const Int x0 = structure.getCellPosition(segment.range.start, qubitIndex, QUANTUM).x0;
         const Int x1 = structure.getCellPosition(segment.range.end, qubitIndex, QUANTUM).x1;
         const Int yMiddle = y + maxLineHeight / 2;
 
         switch (segment.type) {
             case FLAT: {
-                image.drawLine(x0, yMiddle, x1, yMiddle, color);
+                image.drawLine(max(x0, span.start), yMiddle, min(x1, span.end), yMiddle, color);
             }
             break;
 
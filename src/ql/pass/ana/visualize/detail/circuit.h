@@ -144,6 +144,8 @@ public:
     utils::Int getMinCycleWidth() const;
     Dimensions getCellDimensions() const;
     Position4 getCellPosition(const utils::UInt column, const utils::UInt row, const BitType bitType) const;
+    EndPoints getCycleRange(const utils::Int x0, const utils::Int x1) const;
+    EndPoints getColumnSpan(const EndPoints &cycleRange) const;
     utils::Vec<utils::Pair<EndPoints, utils::Bool>> getBitLineSegments() const;
 
     void printProperties() const;
@@ -157,7 +159,11 @@ struct ImageOutput {
 };
 
 void visualizeCircuit(const ir::compat::ProgramRef &program, const VisualizerConfiguration &configuration);
+CircuitLayout prepareCircuit(const ir::compat::ProgramRef &program, const VisualizerConfiguration &configuration, utils::Vec<GateProperties> &gates);
 ImageOutput generateImage(const ir::compat::ProgramRef &program, const VisualizerConfiguration &configuration, const utils::Vec<utils::Int> &minCycleWidths, utils::Int extendedImageHeight);
+void generateTiledImage(const ir::compat::ProgramRef &program, const VisualizerConfiguration &configuration);
+void drawCircuit(Image &image, const CircuitLayout &layout, const CircuitData &circuitData, const Structure &structure,
+                 const utils::Vec<QubitLines> &linesPerQubit, const EndPoints &cycleRange);
 
 CircuitLayout parseCircuitConfiguration(utils::Vec<GateProperties> &gates, const utils::Str &configPath, const utils::Json &platformInstructions);
 void validateCircuitLayout(CircuitLayout &layout, const utils::Str &visualizationType);
@@ -167,17 +173,17 @@ utils::Vec<QubitLines> generateQubitLines(const utils::Vec<GateProperties> &gate
 utils::Real calculateMaxAmplitude(const utils::Vec<LineSegment> &lineSegments);
 void insertFlatLineSegments(utils::Vec<LineSegment> &existingLineSegments, utils::Int amountOfCycles);
 
-void drawCycleLabels(Image &image, const CircuitLayout &layout, const CircuitData &circuitData, const Structure &structure);
-void drawCycleEdges(Image &image, const CircuitLayout &layout, const CircuitData &circuitData, const Structure &structure);
+void drawCycleLabels(Image &image, const CircuitLayout &layout, const CircuitData &circuitData, const Structure &structure, const EndPoints &cycleRange);
+void drawCycleEdges(Image &image, const CircuitLayout &layout, const CircuitData &circuitData, const Structure &structure, const EndPoints &cycleRange);
 void drawBitLineLabels(Image &image, const CircuitLayout &layout, const CircuitData &circuitData, const Structure &structure);
-void drawBitLineEdges(Image &image, const CircuitLayout &layout, const CircuitData &circuitData, const Structure &structure);
+void drawBitLineEdges(Image &image, const CircuitLayout &layout, const CircuitData &circuitData, const Structure &structure, const EndPoints &cycleRange);
 
-void drawBitLine(Image &image, const CircuitLayout &layout, BitType bitType, utils::Int row, const CircuitData &circuitData, const Structure &structure);
-void drawGroupedClassicalBitLine(Image &image, const CircuitLayout &layout, const CircuitData &circuitData, const Structure &structure);
+void drawBitLine(Image &image, const CircuitLayout &layout, BitType bitType, utils::Int row, const CircuitData &circuitData, const Structure &structure, const EndPoints &cycleRange);
+void drawGroupedClassicalBitLine(Image &image, const CircuitLayout &layout, const CircuitData &circuitData, const Structure &structure, const EndPoints &cycleRange);
 
 void drawWiggle(Image &image, utils::Int x0, utils::Int x1, utils::Int y, utils::Int width, utils::Int height, Color color);
 
-void drawLine(Image &image, const Structure &structure, utils::Int cycleDuration, const Line &line, utils::Int qubitIndex, utils::Int y, utils::Int maxLineHeight, Color color);
+void drawLine(Image &image, const Structure &structure, utils::Int cycleDuration, const Line &line, utils::Int qubitIndex, utils::Int y, utils::Int maxLineHeight, Color color, const EndPoints &cycleRange);
 
 void drawCycle(Image &image, const CircuitLayout &layout, const CircuitData &circuitData, const Structure &structure, const Cycle &cycle);
 void drawGate(Image &image, const CircuitLayout &layout, const CircuitData &circuitData, const GateProperties &gate, const Structure &structure, utils::Int chunkOffset);
@@ -1,5 +1,6 @@
 /** \file
- * Wrapper for the CImg library.
+ * Image abstraction for the visualizer, with a raster backend wrapping the CImg
+ * library and a vector backend producing SVG.
  */
 
 #ifdef WITH_VISUALIZER
@@ -7,7 +8,14 @@
 #include "image.h"
 
 #include "CImg.h"
+
+// Undef garbage left behind by CImg (X11, in particular).
+#undef Bool
+#undef True
+#undef False
+
 #include "ql/utils/num.h"
+#include "ql/utils/exception.h"
 #include "ql/utils/str.h"
 #include "types.h"
 
@@ -19,59 +27,390 @@ namespace detail {
 
 using namespace utils;
 
-Image::Image(const Int imageWidth, const Int imageHeight) : cimg((int) imageWidth, (int) imageHeight, 1, 3) {
+/**
+ * Raster backend, drawing into a pixel buffer using CImg.
+ */
+class RasterCanvas : public Canvas {
+private:
+    cimg_library::CImg<unsigned char> cimg;
+
+public:
+    RasterCanvas(const Int width, const Int height) : cimg((int) width, (int) height, 1, 3) {
+        // empty
+    }
+
+    Int getWidth() const override {
+        return cimg.width();
+    }
+
+    Int getHeight() const override {
+        return cimg.height();
+    }
+
+    Str getFileExtension() const override {
+        return ".bmp";
+    }
+
+    void fill(const Color color) override {
+        cimg.fill(255);
+        cimg.draw_rectangle(0, 0, cimg.width(), cimg.height(), color.data(), 1.0f);
+    }
+
+    void drawLine(const Int x0, const Int y0, const Int x1, const Int y1,
+                  const Color color, const Real alpha, const LinePattern pattern) override {
+        cimg.draw_line((int) x0, (int) y0, (int) x1, (int) y1, color.data(), (float) alpha, static_cast<unsigned int>(pattern));
+    }
+
+    void drawText(const Int x, const Int y, const Str &text, const Int height, const Color color) override {
+        cimg.draw_text((int) x, (int) y, text.c_str(), color.data(), 0, 1, (int) height);
+    }
+
+    void drawCircle(const Int centerX, const Int centerY, const Int radius,
+                    const Color color, const Real alpha, const Bool filled, const LinePattern pattern) override {
+        if (filled) {
+            cimg.draw_circle((int) centerX, (int) centerY, (int) radius, color.data(), (float) alpha);
+        } else {
+            cimg.draw_circle((int) centerX, (int) centerY, (int) radius, color.data(), (float) alpha, static_cast<unsigned int>(pattern));
+        }
+    }
+
+    void drawTriangle(const Int x0, const Int y0, const Int x1, const Int y1, const Int x2, const Int y2,
+                      const Color color, const Real alpha, const Bool filled, const LinePattern pattern) override {
+        if (filled) {
+            cimg.draw_triangle((int) x0, (int) y0, (int) x1, (int) y1, (int) x2, (int) y2, color.data(), (float) alpha);
+        } else {
+            cimg.draw_triangle((int) x0, (int) y0, (int) x1, (int) y1, (int) x2, (int) y2, color.data(), (float) alpha, static_cast<unsigned int>(pattern));
+        }
+    }
+
+    void drawRectangle(const Int x0, const Int y0, const Int x1, const Int y1,
+                       const Color color, const Real alpha, const Bool filled, const LinePattern pattern) override {
+        if (filled) {
+            cimg.draw_rectangle((int) x0, (int) y0, (int) x1, (int) y1, color.data(), (float) alpha);
+        } else {
+            cimg.draw_rectangle((int) x0, (int) y0, (int) x1, (int) y1, color.data(), (float) alpha, static_cast<unsigned int>(pattern));
+        }
+    }
+
+    void save(const Str &filename) override {
+        cimg.save(static_cast<std::string>(filename).c_str());
+    }
+
+    void display(const Str &caption) override {
+        cimg.display(static_cast<std::string>(caption).c_str());
+    }
+
+    /**
+     * Copies row y of the image to the given buffer as width BGR pixel
+     * triplets, i.e. in the pixel format used by bitmap files.
+     */
+    void copyScanline(const Int y, Byte *bgr) const override {
+        for (int x = 0; x < cimg.width(); x++) {
+            bgr[3 * x + 0] = cimg(x, (int) y, 0, 2);
+            bgr[3 * x + 1] = cimg(x, (int) y, 0, 1);
+            bgr[3 * x + 2] = cimg(x, (int) y, 0, 0);
+        }
+    }
+};
+
+/**
+ * Vector backend, recording the draw calls as SVG elements. The coordinates
+ * are the same as those of the raster backend, so both produce the same
+ * picture; CImg is still used to measure text for layout purposes.
+ */
+class VectorCanvas : public Canvas {
+private:
+    const Int width;
+    const Int height;
+    StrStrm elements;
+
+    static Str formatColor(const Color color) {
+        return "rgb(" + to_string((Int) color[0]) + "," + to_string((Int) color[1]) + "," + to_string((Int) color[2]) + ")";
+    }
+
+    static Str escape(const Str &text) {
+        Str result;
+        for (const char c : text) {
+            switch (c) {
+                case '&': result += "&amp;"; break;
+                case '<': result += "&lt;"; break;
+                case '>': result += "&gt;"; break;
+                case '"': result += "&quot;"; break;
+                default: result += c; break;
+            }
+        }
+        return result;
+    }
+
+    /**
+     * Writes the fill or stroke attributes for a shape.
+     */
+    void writePaint(const Color color, const Real alpha, const Bool filled, const LinePattern pattern) {
+        if (filled) {
+            elements << " fill=\"" << formatColor(color) << "\"";
+            if (alpha < 1) elements << " fill-opacity=\"" << alpha << "\"";
+        } else {
+            elements << " fill=\"none\" stroke=\"" << formatColor(color) << "\"";
+            if (alpha < 1) elements << " stroke-opacity=\"" << alpha << "\"";
+            if (pattern == LinePattern::DASHED) elements << " stroke-dasharray=\"4,4\"";
+        }
+    }
+
+public:
+    VectorCanvas(const Int width, const Int height) : width(width), height(height) {
+        // empty
+    }
+
+    Int getWidth() const override {
+        return width;
+    }
+
+    Int getHeight() const override {
+        return height;
+    }
+
+    Str getFileExtension() const override {
+        return ".svg";
+    }
+
+    void fill(const Color color) override {
+        // Everything drawn so far is covered, so it can be dropped.
+        elements.str("");
+        elements << "<rect width=\"100%\" height=\"100%\"";
+        writePaint(color, 1, true, LinePattern::UNBROKEN);
+        elements << "/>\n";
+    }
+
+    void drawLine(const Int x0, const Int y0, const Int x1, const Int y1,
+                  const Color color, const Real alpha, const LinePattern pattern) override {
+        elements << "<line x1=\"" << x0 << "\" y1=\"" << y0 << "\" x2=\"" << x1 << "\" y2=\"" << y1 << "\"";
+        writePaint(color, alpha, false, pattern);
+        elements << "/>\n";
+    }
+
+    void drawText(const Int x, const Int y, const Str &text, const Int height, const Color color) override {
+        elements << "<text x=\"" << x << "\" y=\"" << y << "\" font-size=\"" << height << "\"";
+        elements << " font-family=\"sans-serif\" dominant-baseline=\"hanging\"";
+        writePaint(color, 1, true, LinePattern::UNBROKEN);
+        elements << ">" << escape(text) << "</text>\n";
+    }
+
+    void drawCircle(const Int centerX, const Int centerY, const Int radius,
+                    const Color color, const Real alpha, const Bool filled, const LinePattern pattern) override {
+        elements << "<circle cx=\"" << centerX << "\" cy=\"" << centerY << "\" r=\"" << radius << "\"";
+        writePaint(color, alpha, filled, pattern);
+        elements << "/>\n";
+    }
+
+    void drawTriangle(const Int x0, const Int y0, const Int x1, const Int y1, const Int x2, const Int y2,
+                      const Color color, const Real alpha, const Bool filled, const LinePattern pattern) override {
+        elements << "<polygon points=\"" << x0 << "," << y0 << " " << x1 << "," << y1 << " " << x2 << "," << y2 << "\"";
+        writePaint(color, alpha, filled, pattern);
+        elements << "/>\n";
+    }
+
+    void drawRectangle(const Int x0, const Int y0, const Int x1, const Int y1,
+                       const Color color, const Real alpha, const Bool filled, const LinePattern pattern) override {
+        // Like CImg, the corners are inclusive.
+        elements << "<rect x=\"" << min(x0, x1) << "\" y=\"" << min(y0, y1) << "\"";
+        elements << " width=\"" << (max(x0, x1) - min(x0, x1) + 1) << "\" height=\"" << (max(y0, y1) - min(y0, y1) + 1) << "\"";
+        writePaint(color, alpha, filled, pattern);
+        elements << "/>\n";
+    }
+
+    void save(const Str &filename) override {
+        OutFile file(filename);
+        file << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+        file << "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"" << width << "\" height=\"" << height << "\"";
+        file << " viewBox=\"0 0 " << width << " " << height << "\" shape-rendering=\"crispEdges\">\n";
+        file << elements.str();
+        file << "</svg>\n";
+        file.close();
+    }
+
+    void display(const Str &caption) override {
+        QL_WOUT("Cannot display SVG image '" << caption << "' interactively; it is saved to disk instead.");
+    }
+
+    void copyScanline(const Int y, Byte *bgr) const override {
+        QL_ICE("cannot read pixels from an SVG image");
+    }
+};
+
+Image::Image(const Int imageWidth, const Int imageHeight, const ImageFormat format) :
+    Image(imageWidth, imageHeight, 0, 0, format)
+{
     // empty
 }
 
+Image::Image(const Int imageWidth, const Int imageHeight, const Int originX, const Int originY, const ImageFormat format) :
+    originX(originX),
+    originY(originY)
+{
+    switch (format) {
+        case ImageFormat::BMP: canvas.emplace<RasterCanvas>(imageWidth, imageHeight); break;
+        case ImageFormat::SVG: canvas.emplace<VectorCanvas>(imageWidth, imageHeight); break;
+    }
+}
+
+Int Image::getWidth() const {
+    return canvas->getWidth();
+}
+
+Int Image::getHeight() const {
+    return canvas->getHeight();
+}
+
+Str Image::getFileExtension() const {
+    return canvas->getFileExtension();
+}
+
 void Image::fill(const Color color) {
-    cimg->fill(255);
-    drawFilledRectangle(0, 0, cimg->width(), cimg->height(), color, 1.0f);
+    canvas->fill(color);
 }
 
 void Image::drawLine(const Int x0, const Int y0, const Int x1, const Int y1, const Color color, const Real alpha, const LinePattern pattern) {
-    cimg->draw_line((int) x0, (int) y0, (int) x1, (int) y1, color.data(), (float) alpha, static_cast<unsigned int>(pattern));
+    canvas->drawLine(x0 - originX, y0 - originY, x1 - originX, y1 - originY, color, alpha, pattern);
 }
 
 void Image::drawText(const Int x, const Int y, const Str &text, const Int height, const Color color) {
-    cimg->draw_text((int) x, (int) y, text.c_str(), color.data(), 0, 1, (int) height);
+    canvas->drawText(x - originX, y - originY, text, height, color);
 }
 
 void Image::drawFilledCircle(const Int centerX, const Int centerY, const Int radius,
                              const Color color, const Real alpha) {
-    cimg->draw_circle((int) centerX, (int) centerY, (int) radius, color.data(), (float) alpha);
+    canvas->drawCircle(centerX - originX, centerY - originY, radius, color, alpha, true, LinePattern::UNBROKEN);
 }
 
 void Image::drawOutlinedCircle(const Int centerX, const Int centerY, const Int radius,
                                const Color color, const Real alpha, const LinePattern pattern) {
-    cimg->draw_circle((int) centerX, (int) centerY, (int) radius, color.data(), (float) alpha, static_cast<unsigned int>(pattern));
+    canvas->drawCircle(centerX - originX, centerY - originY, radius, color, alpha, false, pattern);
 }
 
 void Image::drawFilledTriangle(const Int x0, const Int y0, const Int x1, const Int y1, const Int x2, const Int y2,
                                const Color color, const Real alpha) {
-    cimg->draw_triangle((int) x0, (int) y0, (int) x1, (int) y1, (int) x2, (int) y2, color.data(), (float) alpha);
+    canvas->drawTriangle(x0 - originX, y0 - originY, x1 - originX, y1 - originY, x2 - originX, y2 - originY,
+        color, alpha, true, LinePattern::UNBROKEN);
 }
 
 void Image::drawOutlinedTriangle(const Int x0, const Int y0, const Int x1, const Int y1, const Int x2, const Int y2,
                                  const Color color, const Real alpha, const LinePattern pattern) {
-    cimg->draw_triangle((int) x0, (int) y0, (int) x1, (int) y1, (int) x2, (int) y2, color.data(), (float) alpha, static_cast<unsigned int>(pattern));
+    canvas->drawTriangle(x0 - originX, y0 - originY, x1 - originX, y1 - originY, x2 - originX, y2 - originY,
+        color, alpha, false, pattern);
 }
 
 void Image::drawFilledRectangle(const Int x0, const Int y0, const Int x1, const Int y1,
                                 const Color color, const Real alpha) {
-    cimg->draw_rectangle((int) x0, (int) y0, (int) x1, (int) y1, color.data(), (float) alpha);
+    canvas->drawRectangle(x0 - originX, y0 - originY, x1 - originX, y1 - originY, color, alpha, true, LinePattern::UNBROKEN);
 }
 
 void Image::drawOutlinedRectangle(const Int x0, const Int y0, const Int x1, const Int y1,
                                   const Color color, const Real alpha, const LinePattern pattern) {
-    cimg->draw_rectangle((int) x0, (int) y0, (int) x1, (int) y1, color.data(), (float) alpha, static_cast<unsigned int>(pattern));
+    canvas->drawRectangle(x0 - originX, y0 - originY, x1 - originX, y1 - originY, color, alpha, false, pattern);
 }
 
 void Image::save(const Str &filename) {
-    cimg->save(static_cast<std::string>(filename).c_str());
+    canvas->save(filename);
 }
 
 void Image::display(const Str &caption) {
-    cimg->display(static_cast<std::string>(caption).c_str());
+    canvas->display(caption);
+}
+
+void Image::copyScanline(const Int y, Byte *bgr) const {
+    canvas->copyScanline(y, bgr);
+}
+
+/**
+ * Writes a value in little-endian byte order, as used by the bitmap headers.
+ */
+static void writeLittleEndian(std::ofstream &stream, const UInt value, const UInt size) {
+    for (UInt i = 0; i < size; i++) {
+        stream.put((char) ((value >> (8 * i)) & 0xFF));
+    }
+}
+
+BitmapStream::BitmapStream(const Str &filename, const Int width, const Int height) :
+    file(filename),
+    width(width),
+    height(height)
+{
+    const UInt rowSize = ((UInt) width * 3 + 3) & ~3ull;
+    const UInt dataSize = rowSize * (UInt) height;
+    if (width <= 0 || height <= 0 || width > 0x7FFFFFFF || height > 0x7FFFFFFF || dataSize + 54 > 0xFFFFFFFFull) {
+        QL_USER_ERROR(
+            "cannot write image of " << width << "x" << height << " pixels "
+            "to a bitmap file; use tiled output instead"
+        );
+    }
+
+    // BITMAPFILEHEADER.
+    std::ofstream &stream = file.unwrap();
+    stream.put('B');
+    stream.put('M');
+    writeLittleEndian(stream, dataSize + 54, 4);
+    writeLittleEndian(stream, 0, 4);
+    writeLittleEndian(stream, 54, 4);
+
+    // BITMAPINFOHEADER. The height is negative to indicate top-down row
+    // order.
+    writeLittleEndian(stream, 40, 4);
+    writeLittleEndian(stream, (UInt) width, 4);
+    writeLittleEndian(stream, (UInt) (-height) & 0xFFFFFFFFull, 4);
+    writeLittleEndian(stream, 1, 2);
+    writeLittleEndian(stream, 24, 2);
+    writeLittleEndian(stream, 0, 4);
+    writeLittleEndian(stream, dataSize, 4);
+    writeLittleEndian(stream, 2835, 4);
+    writeLittleEndian(stream, 2835, 4);
+    writeLittleEndian(stream, 0, 4);
+    writeLittleEndian(stream, 0, 4);
+    file.check();
+}
+
+/**
+ * Appends a horizontal band of the image to the file. The tiles must be given
+ * from left to right, must all have the same height, and must together span
+ * the full width of the image.
+ */
+void BitmapStream::writeBand(const Vec<Image> &tiles) {
+    if (tiles.empty()) {
+        return;
+    }
+    const Int bandHeight = tiles[0].getHeight();
+    Int bandWidth = 0;
+    for (const Image &tile : tiles) {
+        if (tile.getHeight() != bandHeight) {
+            QL_ICE("tiles in a bitmap band must have the same height");
+        }
+        bandWidth += tile.getWidth();
+    }
+    if (bandWidth != width) {
+        QL_ICE("bitmap band is " << bandWidth << " pixels wide, expected " << width);
+    }
+    if (rowsWritten + bandHeight > height) {
+        QL_ICE("too many rows written to bitmap stream");
+    }
+
+    const UInt rowSize = ((UInt) width * 3 + 3) & ~3ull;
+    std::vector<Byte> row(rowSize, 0);
+    for (Int y = 0; y < bandHeight; y++) {
+        UInt offset = 0;
+        for (const Image &tile : tiles) {
+            tile.copyScanline(y, row.data() + offset);
+            offset += 3 * (UInt) tile.getWidth();
+        }
+        file.unwrap().write(reinterpret_cast<const char*>(row.data()), (std::streamsize) rowSize);
+    }
+    file.check();
+    rowsWritten += bandHeight;
+}
+
+void BitmapStream::close() {
+    if (rowsWritten != height) {
+        QL_ICE("bitmap stream closed after " << rowsWritten << " of " << height << " rows");
+    }
+    file.close();
 }
 
 Dimensions calculateTextDimensions(const Str &text, const Int fontHeight) {
@@ -1,5 +1,6 @@
 /** \file
- * Wrapper for the CImg library.
+ * Image abstraction for the visualizer, with a raster backend wrapping the CImg
+ * library and a vector backend producing SVG.
  */
 
 #pragma once
@@ -9,6 +10,8 @@
 #include "ql/utils/num.h"
 #include "ql/utils/str.h"
 #include "ql/utils/ptr.h"
+#include "ql/utils/vec.h"
+#include "ql/utils/filesystem.h"
 #include "types.h"
 
 // Undef garbage left behind by CImg.
@@ -19,11 +22,6 @@
 #undef IN
 #undef OUT
 
-namespace cimg_library {
-template <typename T>
-struct CImg;
-};
-
 namespace ql {
 namespace pass {
 namespace ana {
@@ -37,12 +35,60 @@ enum class LinePattern : unsigned int {
     DASHED = 0xF0F0F0F0
 };
 
+/**
+ * Output backend of an Image. Coordinates passed to a canvas are local to it,
+ * i.e. (0, 0) is its top-left pixel.
+ */
+class Canvas {
+public:
+    virtual ~Canvas() = default;
+
+    virtual utils::Int getWidth() const = 0;
+    virtual utils::Int getHeight() const = 0;
+    virtual utils::Str getFileExtension() const = 0;
+
+    virtual void fill(const Color color) = 0;
+
+    virtual void drawLine(const utils::Int x0, const utils::Int y0, const utils::Int x1, const utils::Int y1,
+                          const Color color, const utils::Real alpha, const LinePattern pattern) = 0;
+
+    virtual void drawText(const utils::Int x, const utils::Int y, const utils::Str &text, const utils::Int height,
+                          const Color color) = 0;
+
+    virtual void drawCircle(const utils::Int centerX, const utils::Int centerY, const utils::Int radius,
+                            const Color color, const utils::Real alpha, const utils::Bool filled, const LinePattern pattern) = 0;
+
+    virtual void drawTriangle(const utils::Int x0, const utils::Int y0, const utils::Int x1, const utils::Int y1, const utils::Int x2, const utils::Int y2,
+                              const Color color, const utils::Real alpha, const utils::Bool filled, const LinePattern pattern) = 0;
+
+    virtual void drawRectangle(const utils::Int x0, const utils::Int y0, const utils::Int x1, const utils::Int y1,
+                               const Color color, const utils::Real alpha, const utils::Bool filled, const LinePattern pattern) = 0;
+
+    virtual void save(const utils::Str &filename) = 0;
+    virtual void display(const utils::Str &caption) = 0;
+
+    virtual void copyScanline(const utils::Int y, utils::Byte *bgr) const = 0;
+};
+
 class Image {
 private:
-    utils::Ptr<cimg_library::CImg<unsigned char>> cimg;
+    utils::Ptr<Canvas> canvas;
+
+    // Position of the top-left pixel of this image within the (virtual) canvas
+    // that the draw calls address. This is nonzero only for tiles of a larger
+    // image; all draw calls are translated by it, and the backend clips
+    // whatever falls outside of the tile.
+    utils::Int originX;
+    utils::Int originY;
 
 public:
-    Image(const utils::Int imageWidth, const utils::Int imageHeight);
+    Image(const utils::Int imageWidth, const utils::Int imageHeight, const ImageFormat format = ImageFormat::BMP);
+    Image(const utils::Int imageWidth, const utils::Int imageHeight, const utils::Int originX, const utils::Int originY,
+          const ImageFormat format = ImageFormat::BMP);
+
+    utils::Int getWidth() const;
+    utils::Int getHeight() const;
+    utils::Str getFileExtension() const;
 
     void fill(const Color color);
 
@@ -69,6 +115,27 @@ public:
     
     void save(const utils::Str &filename);
     void display(const utils::Str &caption);
+
+    void copyScanline(const utils::Int y, utils::Byte *bgr) const;
+};
+
+/**
+ * Writes a 24-bit bitmap file band by band, such that an image that does not
+ * fit in memory as a whole can be produced from horizontal strips of tiles.
+ * The rows are written top-down, so no seeking is needed.
+ */
+class BitmapStream {
+private:
+    utils::OutFile file;
+    const utils::Int width;
+    const utils::Int height;
+    utils::Int rowsWritten = 0;
+
+public:
+    BitmapStream(const utils::Str &filename, const utils::Int width, const utils::Int height);
+
+    void writeBand(const utils::Vec<Image> &tiles);
+    void close();
 };
 
 Dimensions calculateTextDimensions(const utils::Str &text, const utils::Int fontHeight);
@@ -60,7 +60,7 @@ void visualizeInteractionGraph(const ir::compat::ProgramRef &program, const Visu
         QL_DOUT("Initializing image...");
         const Int imageWidth = 2 * (layout.getBorderWidth() + interactionCircleRadius);
         const Int imageHeight = 2 * (layout.getBorderWidth() + interactionCircleRadius);
-        Image image(imageWidth, imageHeight);
+        Image image(imageWidth, imageHeight, configuration.imageFormat);
         image.fill(white);
 
         // Draw the edges between interacting qubits.
@@ -109,9 +109,10 @@ void visualizeInteractionGraph(const ir::compat::ProgramRef &program, const Visu
             image.drawText(qubit.second.x - layout.getQubitRadius() + xGap, qubit.second.y - layout.getQubitRadius() + yGap, label, layout.getLabelFontHeight(), layout.getLabelColor());
         }
 
-        // Save the image if enabled.
-        if (layout.saveImage || !configuration.interactive) {
-            image.save("qubit_interaction_graph.bmp");
+        // Save the image if enabled. SVG images cannot be displayed, so they
+        // are always saved.
+        if (layout.saveImage || !configuration.interactive || configuration.imageFormat == ImageFormat::SVG) {
+            image.save("qubit_interaction_graph" + image.getFileExtension());
         }
 
         // Display the image if enabled.
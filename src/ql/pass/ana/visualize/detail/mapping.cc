@@ -176,9 +176,10 @@ void visualizeMappingGraph(const ir::compat::ProgramRef &program, const Visualiz
         }
     }
 
-    // Save the image if enabled.
-    if (imageOutput.circuitLayout.saveImage || !configuration.interactive) {
-        imageOutput.image.save(configuration.output_prefix + ".bmp");
+    // Save the image if enabled. SVG images cannot be displayed, so they are
+    // always saved.
+    if (imageOutput.circuitLayout.saveImage || !configuration.interactive || configuration.imageFormat == ImageFormat::SVG) {
+        imageOutput.image.save(configuration.output_prefix + imageOutput.image.getFileExtension());
     }
 
     // Display the image if enabled.
@@ -21,6 +21,17 @@ namespace detail {
 void assertPositive(utils::Int parameterValue, const utils::Str &parameterName);
 void assertPositive(utils::Real parameterValue, const utils::Str &parameterName);
 
+/**
+ * The output format of the generated images. Bitmaps are rendered to a pixel
+ * buffer using CImg. SVG images record the draw calls as vector primitives,
+ * such that their size scales with the amount of drawn elements rather than
+ * with the pixel area, and they remain sharp when zooming in.
+ */
+enum class ImageFormat {
+    BMP,
+    SVG
+};
+
 struct VisualizerConfiguration {
     utils::Str visualizationType;
     utils::Str visualizerConfigPath;
@@ -28,6 +39,14 @@ struct VisualizerConfiguration {
     utils::Bool interactive;
     utils::Str output_prefix;
     utils::Str pass_name;
+    ImageFormat imageFormat;
+
+    // Tiled rendering parameters; only used by the circuit visualizer. A tile
+    // size of zero (the value-initialized default) disables tiling.
+    utils::Int tileSize;
+    utils::Str tileOutput;
+    utils::Int tileThreads;
+    utils::Int tileMemoryBudget;
 };
 
 typedef std::array<utils::Byte, 3> Color;
@@ -113,7 +113,18 @@ VisualizeMappingPass::VisualizeMappingPass(
     options.add_bool(
         "interactive",
         "When yes, the visualizer will open a window when the pass is run. "
-        "When no, an image will be saved as <output_prefix>.bmp instead."
+        "When no, an image will be saved as <output_prefix>.bmp (or .svg, "
+        "depending on output_format) instead."
+    );
+    options.add_enum(
+        "output_format",
+        "The format of the generated image. `bmp` renders a bitmap, `svg` "
+        "renders a vector image, of which the size scales with the amount of "
+        "drawn elements rather than with the image dimensions; use this for "
+        "large programs. SVG images cannot be displayed interactively, so they "
+        "are always saved.",
+        "bmp",
+        {"bmp", "svg"}
     );
 }
 
@@ -132,7 +143,8 @@ utils::Int VisualizeMappingPass::run(
             "", // unused
             options["interactive"].as_bool(),
             context.output_prefix,
-            context.full_pass_name
+            context.full_pass_name,
+            options["output_format"].as_str() == "svg" ? detail::ImageFormat::SVG : detail::ImageFormat::BMP
         }
     );
     return 0;
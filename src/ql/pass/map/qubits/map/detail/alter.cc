@@ -64,7 +64,7 @@ void Alter::print(const utils::Str &s) const {
  * verbosity is at least debug.
  */
 void Alter::debug_print(const utils::Str &s) const {
-    if (utils::logger::log_level >= utils::logger::LogLevel::LOG_DEBUG) {
+    if (QL_IS_LOG_DEBUG) {
         print(s);
     }
 }
@@ -91,7 +91,7 @@ void Alter::print(const utils::Str &s, const utils::List<Alter> &la) {
  * logging verbosity is at least debug.
  */
 void Alter::debug_print(const utils::Str &s, const utils::List<Alter> &la) {
-    if (utils::logger::log_level >= utils::logger::LogLevel::LOG_DEBUG) {
+    if (QL_IS_LOG_DEBUG) {
         print(s, la);
     }
 }
@@ -181,6 +181,9 @@ void Alter::extend(const Past &curr_past, const Past &base_past) {
         // score = quick_fidelity(past.lg);
     } else {
         score = past.get_max_free_cycle() - base_past.get_max_free_cycle();
+        score += options->inter_core_stall_weight * (
+            past.get_inter_core_stall() - base_past.get_inter_core_stall()
+        );
     }
     score_valid = true;
 }
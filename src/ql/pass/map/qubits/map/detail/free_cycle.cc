@@ -4,6 +4,8 @@
 
 #include "free_cycle.h"
 
+#include "ql/resource/inter_core_channel.h"
+
 namespace ql {
 namespace pass {
 namespace map {
@@ -11,6 +13,11 @@ namespace qubits {
 namespace map {
 namespace detail {
 
+/**
+ * The cycle in which all qubits and bregs are initially free.
+ */
+const utils::UInt FreeCycle::FIRST_CYCLE;
+
 /**
  * Initializes this FreeCycle object.
  */
@@ -25,11 +32,37 @@ void FreeCycle::initialize(const ir::compat::PlatformRef &p, const OptionsRef &o
     nb = platform->breg_count;
     ct = platform->cycle_time;
     QL_DOUT("... FreeCycle: nq=" << nq << ", nb=" << nb << ", ct=" << ct << "), initializing to all 0 cycles");
-    fcv.clear();
-    fcv.resize(nq+nb, 1);   // this 1 implies that cycle of first gate will be 1 and not 0; OpenQL convention!?!?
     QL_DOUT("... about to copy FreeCycle initialize local resource_manager to FreeCycle member rm");
-    rs = rm.build(rmgr::Direction::FORWARD);
+    rs_initial = utils::Ptr<const rmgr::State>::make(rm.build(rmgr::Direction::FORWARD));
     QL_DOUT("... done copy FreeCycle initialize local resource_manager to FreeCycle member rm");
+    fcv.assign(nq+nb, FIRST_CYCLE);
+    touched.clear();
+    reset();
+}
+
+/**
+ * Resets this FreeCycle object to the state after initialize(), reusing
+ * the resource state that was built by it. Only the entries of fcv that
+ * were touched since the previous reset are reset.
+ */
+void FreeCycle::reset() {
+    for (auto index : touched) {
+        fcv[index] = FIRST_CYCLE;
+    }
+    touched.clear();
+    rs.reset();
+    rs.emplace(*rs_initial);
+}
+
+/**
+ * Sets the cycle from which the qubit or breg at the given index into fcv
+ * is free, keeping track of the touched entries.
+ */
+void FreeCycle::set_free_cycle(utils::UInt index, utils::UInt cycle) {
+    if (fcv[index] == FIRST_CYCLE && cycle != FIRST_CYCLE) {
+        touched.push_back(index);
+    }
+    fcv[index] = cycle;
 }
 
 /**
@@ -46,6 +79,9 @@ utils::UInt FreeCycle::get_depth() const {
  * entries.
  */
 utils::UInt FreeCycle::get_min() const {
+    if (touched.size() < fcv.size()) {
+        return FIRST_CYCLE;     // at least one entry was never touched
+    }
     utils::UInt min_free_cycle = ir::compat::MAX_CYCLE;
     for (const auto &v : fcv) {
         if (v < min_free_cycle) {
@@ -60,10 +96,10 @@ utils::UInt FreeCycle::get_min() const {
  * entries.
  */
 utils::UInt FreeCycle::get_max() const {
-    utils::UInt max_free_cycle = 0;
-    for (const auto &v : fcv) {
-        if (max_free_cycle < v) {
-            max_free_cycle = v;
+    utils::UInt max_free_cycle = fcv.empty() ? 0 : FIRST_CYCLE;
+    for (auto index : touched) {
+        if (max_free_cycle < fcv[index]) {
+            max_free_cycle = fcv[index];
         }
     }
     return max_free_cycle;
@@ -95,7 +131,7 @@ void FreeCycle::print(const utils::Str &s) const {
  * Calls print only if the loglevel is debug or more verbose.
  */
 void FreeCycle::debug_print(const utils::Str &s) const {
-    if (utils::logger::log_level >= utils::logger::LogLevel::LOG_DEBUG) {
+    if (QL_IS_LOG_DEBUG) {
         print(s);
     }
 }
@@ -142,7 +178,7 @@ utils::Bool FreeCycle::is_first_swap_earliest(
  * and breg indices. Purely functional, doesn't affect state.
  */
 utils::UInt FreeCycle::get_start_cycle_no_rc(const ir::compat::GateRef &g) const {
-    utils::UInt start_cycle = 1;
+    utils::UInt start_cycle = FIRST_CYCLE;
     for (auto qreg : g->operands) {
         start_cycle = utils::max(start_cycle, fcv[qreg]);
     }
@@ -168,27 +204,36 @@ utils::UInt FreeCycle::get_start_cycle(const ir::compat::GateRef &g) const {
     utils::UInt start_cycle = get_start_cycle_no_rc(g);
 
     if (options->heuristic == Heuristic::BASE_RC || options->heuristic == Heuristic::MIN_EXTEND_RC) {
-        utils::UInt base_start_cycle = start_cycle;
-
-        while (start_cycle < ir::compat::MAX_CYCLE) {
-            // QL_DOUT("Startcycle for " << g->qasm() << ": available? at startCycle=" << startCycle);
-            if (rs->available(start_cycle, g)) {
-                // QL_DOUT(" ... [" << startCycle << "] resources available for " << g->qasm());
-                break;
-            } else {
-                // QL_DOUT(" ... [" << startCycle << "] Busy resource for " << g->qasm());
-                start_cycle++;
-            }
-        }
-        if (base_start_cycle != start_cycle) {
-            // QL_DOUT(" ... from [" << baseStartCycle << "] to [" << startCycle-1 << "] busy resource(s) for " << g->qasm());
-        }
+        auto cycle = rs->earliest_available(start_cycle, g, rmgr::Direction::FORWARD);
+        start_cycle = cycle == utils::MAX ? ir::compat::MAX_CYCLE : (utils::UInt)cycle;
     }
     QL_ASSERT (start_cycle < ir::compat::MAX_CYCLE);
 
     return start_cycle;
 }
 
+/**
+ * Returns the number of cycles that the inter-core channel resources alone
+ * would delay the given gate beyond its dependency-based start cycle, i.e.
+ * how long it would wait for a free inter-core channel. Returns 0 when
+ * resource constraints are not used. Purely functional, doesn't affect
+ * state.
+ */
+utils::UInt FreeCycle::get_channel_delay(const ir::compat::GateRef &g) const {
+    if (options->heuristic != Heuristic::BASE_RC && options->heuristic != Heuristic::MIN_EXTEND_RC) {
+        return 0;
+    }
+    utils::UInt start_cycle = get_start_cycle_no_rc(g);
+    auto cycle = rs->earliest_available(
+        start_cycle, g, rmgr::Direction::FORWARD,
+        [](const rmgr::resource_types::Base &resource) {
+            return dynamic_cast<const resource::inter_core_channel::InterCoreChannelResource*>(&resource) != nullptr;
+        }
+    );
+    QL_ASSERT(cycle != utils::MAX);
+    return (utils::UInt)cycle - start_cycle;
+}
+
 /**
  * Schedules the given gate in the FreeCycle map. The gate operands are real
  * qubit indices and breg indices. The FreeCycle map is updated, but not the
@@ -199,10 +244,10 @@ void FreeCycle::add_no_rc(const ir::compat::GateRef &g, utils::UInt startCycle)
     utils::UInt duration = (g->duration+ct-1)/ct;   // rounded-up unsigned integer division
     utils::UInt freeCycle = startCycle + duration;
     for (auto qreg : g->operands) {
-        fcv[qreg] = freeCycle;
+        set_free_cycle(qreg, freeCycle);
     }
     for (auto breg : g->breg_operands) {
-        fcv[nq+breg] = freeCycle;
+        set_free_cycle(nq+breg, freeCycle);
     }
 }
 
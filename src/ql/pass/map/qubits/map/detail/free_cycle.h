@@ -7,6 +7,7 @@
 #include "ql/utils/num.h"
 #include "ql/utils/str.h"
 #include "ql/utils/vec.h"
+#include "ql/utils/ptr.h"
 #include "ql/utils/opt.h"
 #include "ql/ir/compat/compat.h"
 #include "ql/rmgr/manager.h"
@@ -73,15 +74,44 @@ private:
     utils::UInt ct;
 
     /**
-     * fcv[real qubit index i]: qubit i is free from this cycle on.
+     * fcv[real qubit index i]: qubit i is free from this cycle on. Bregs are
+     * stored behind the qubits, at index nq + breg.
      */
     utils::Vec<utils::UInt> fcv;
 
+    /**
+     * The indices into fcv of the entries that were changed from FIRST_CYCLE
+     * since the previous reset, such that reset(), get_min(), and get_max()
+     * only need to visit the qubits and bregs that were actually used, rather
+     * than all of them.
+     */
+    utils::Vec<utils::UInt> touched;
+
     /**
      * Actual resources occupied by scheduled gates, if resource-aware.
      */
     utils::Opt<rmgr::State> rs;
 
+    /**
+     * The resource state before any gates were scheduled, used to reset rs
+     * without having to rebuild the resources from the platform. It is shared
+     * by all copies of this object.
+     */
+    utils::Ptr<const rmgr::State> rs_initial;
+
+    /**
+     * The cycle in which all qubits and bregs are initially free. Note that
+     * this implies that the cycle of the first gate will be 1 and not 0; this
+     * is an OpenQL convention.
+     */
+    static const utils::UInt FIRST_CYCLE = 1;
+
+    /**
+     * Sets the cycle from which the qubit or breg at the given index into fcv
+     * is free, keeping track of the touched entries.
+     */
+    void set_free_cycle(utils::UInt index, utils::UInt cycle);
+
 public:
 
     /**
@@ -89,6 +119,12 @@ public:
      */
     void initialize(const ir::compat::PlatformRef &p, const OptionsRef &opt);
 
+    /**
+     * Resets this FreeCycle object to the state after initialize(), reusing
+     * the resource state that was built by it.
+     */
+    void reset();
+
     /**
      * Returns the depth of the FreeCycle map. Equals the max of all entries
      * minus the min of all entries not used yet; would be used to compute the
@@ -150,6 +186,15 @@ public:
      */
     utils::UInt get_start_cycle(const ir::compat::GateRef &g) const;
 
+    /**
+     * Returns the number of cycles that the inter-core channel resources alone
+     * would delay the given gate beyond its dependency-based start cycle, i.e.
+     * how long it would wait for a free inter-core channel. Returns 0 when
+     * resource constraints are not used. Purely functional, doesn't affect
+     * state.
+     */
+    utils::UInt get_channel_delay(const ir::compat::GateRef &g) const;
+
     /**
      * Schedules the given gate in the FreeCycle map. The gate operands are real
      * qubit indices and breg indices. The FreeCycle map is updated, but not the
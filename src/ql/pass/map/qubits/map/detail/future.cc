@@ -5,6 +5,7 @@
 #include "future.h"
 
 #include "ql/utils/filesystem.h"
+#include "ql/utils/misc.h"
 
 namespace ql {
 namespace pass {
@@ -26,47 +27,134 @@ void Future::initialize(const ir::compat::PlatformRef &p, const OptionsRef &opt)
 /**
  * Set/switch input to the provided kernel.
  */
-void Future::set_kernel(const ir::compat::KernelRef &kernel, const utils::Ptr<Scheduler> &sched) {
+void Future::set_kernel(const ir::compat::KernelRef &kernel) {
     QL_DOUT("Future::set_kernel ...");
     approx_gates_total = kernel->gates.size();
     approx_gates_remaining = approx_gates_total;
-    scheduler = sched;
     if (options->lookahead_mode == LookaheadMode::DISABLED) {
         input_gatepv = kernel->gates;                           // copy to free original circuit to allow outputing to
         input_gatepp = input_gatepv.begin();                    // iterator set to start of input circuit copy
     } else {
-        scheduler->init(
+        // Release the window of the previous kernel before starting the next
+        // one, so they are never in memory at the same time.
+        lookahead.reset();
+        lookahead = LookaheadRef::make(
             kernel,
-            options->output_prefix,
             options->commute_multi_qubit,
             options->commute_single_qubit,
-            options->enable_criticality
+            options->enable_criticality,
+            options->lookahead_horizon
         );
 
         // and so also the original circuit can be output to after this
-        for (auto &gp : kernel->gates) {
-            scheduled.set(gp) = false;   // none were scheduled
-        }
-        scheduled.set(scheduler->instruction[scheduler->s]) = false;      // also the dummy nodes not
-        scheduled.set(scheduler->instruction[scheduler->t]) = false;
+        trims_window = true;
+        offset = 0;
+        frontier = 0;
+        visible_end = 0;
+        remaining_predecessors.clear();
+        available_since.clear();
         avlist.clear();
-        avlist.push_back(scheduler->s);
-        scheduler->set_remaining(rmgr::Direction::FORWARD);          // to know criticality
+        num_made_available = 0;
+        update_window();
+        QL_DOUT(
+            "lookahead window for kernel " << kernel->name << ": "
+            << visible_end << " of " << lookahead->sink() + 1 << " nodes; "
+            << "peak memory usage so far: " << (utils::get_peak_memory_usage() >> 20) << " MiB"
+        );
 
         if (options->write_dot_graphs) {
-            utils::Str map_dot;
+            utils::StrStrm map_dot;
             utils::StrStrm fname;
 
-            scheduler->get_dot(map_dot);
+            lookahead->dump_dot(map_dot);
 
             fname << options->output_prefix << kernel->name << "_" << "mapper" << ".dot";
             QL_IOUT("writing " << "mapper" << " dependence graph dot file to '" << fname.str() << "' ...");
-            utils::OutFile(fname.str()).write(map_dot);
+            utils::OutFile(fname.str()).write(map_dot.str());
         }
     }
     QL_DOUT("Future::set_kernel [DONE]");
 }
 
+/**
+ * Returns a copy of this Future for evaluating an alternative, which shares
+ * the lookahead window but doesn't release any of its nodes.
+ */
+Future Future::branch() const {
+    Future copy = *this;
+    copy.trims_window = false;
+    return copy;
+}
+
+/**
+ * Extends the window to lookahead_horizon nodes beyond the frontier, makes the
+ * new nodes available when they don't depend on any gate that has not been
+ * done, and releases the nodes before the frontier when this Future owns the
+ * window.
+ *
+ * The nodes are made available in program order, which matches the order in
+ * which they would have been made available by completed_gate() if they had
+ * been visible before.
+ */
+void Future::update_window() {
+    auto horizon = options->lookahead_horizon;
+    auto end = lookahead->extend(horizon ? frontier + horizon : utils::UMAX);
+    for (auto node = visible_end; node < end; node++) {
+        utils::UInt count = 0;
+        for (auto pred : lookahead->get(node).predecessors) {
+            if (pred >= offset && remaining_predecessors[pred - offset] != utils::UMAX) {
+                count++;
+            }
+        }
+        remaining_predecessors.push_back(count);
+        available_since.push_back(utils::UMAX);
+        if (count == 0) {
+            make_available(node);
+        }
+    }
+    visible_end = end;
+
+    // Release the nodes before the frontier once they make up at least half
+    // of the window, such that the cost of shifting the state vectors is
+    // amortized over the nodes that were done.
+    if (trims_window && frontier - offset >= visible_end - frontier && frontier > offset) {
+        lookahead->trim(frontier);
+        remaining_predecessors.erase(
+            remaining_predecessors.begin(),
+            remaining_predecessors.begin() + (frontier - offset)
+        );
+        available_since.erase(
+            available_since.begin(),
+            available_since.begin() + (frontier - offset)
+        );
+        offset = frontier;
+    }
+}
+
+/**
+ * Returns the node of the given gate, which must be available.
+ */
+utils::UInt Future::find_available(const ir::compat::GateRef &gate) const {
+    auto node = lookahead->get_node(gate);
+    if (node == utils::UMAX || node >= visible_end || available_since[node - offset] == utils::UMAX) {
+        QL_ICE("gate " << gate->qasm() << " was not available for mapping");
+    }
+    return node;
+}
+
+/**
+ * Adds the given node to avlist, keeping it ordered.
+ *
+ * avlist is ordered from high to low criticality, and a node is inserted
+ * after all nodes with the same criticality, because those were made
+ * available before it. So the order in which nodes are made available
+ * matters.
+ */
+void Future::make_available(utils::UInt node) {
+    available_since[node - offset] = num_made_available++;
+    avlist.set(std::make_pair(lookahead->get(node).priority, available_since[node - offset])) = node;
+}
+
 /**
  * Get from avlist all gates that are non-quantum into nonqlg. Non-quantum
  * gates include classical and dummy (SOURCE/SINK). Return whether some
@@ -85,8 +173,8 @@ utils::Bool Future::get_non_quantum_gates(utils::List<ir::compat::GateRef> &nonq
             }
         }
     } else {
-        for (auto n : avlist) {
-            ir::compat::GateRef gate = scheduler->instruction[n];
+        for (const auto &entry : avlist) {
+            const ir::compat::GateRef &gate = lookahead->get(entry.second).gate;
             if (
                 gate->type() == ir::compat::GateType::CLASSICAL
                 || gate->type() == ir::compat::GateType::DUMMY
@@ -112,8 +200,8 @@ utils::Bool Future::get_gates(utils::List<ir::compat::GateRef> &qlg) const {
             qlg.push_back(gp);
         }
     } else {
-        for (auto n : avlist) {
-            ir::compat::GateRef gp = scheduler->instruction[n];
+        for (const auto &entry : avlist) {
+            const ir::compat::GateRef &gp = lookahead->get(entry.second).gate;
             if (gp->operands.size() > 2) {
                 QL_FATAL(" gate: " << gp->qasm() << " has more than 2 operand qubits; please decompose such gates first before mapping.");
             }
@@ -134,7 +222,28 @@ void Future::completed_gate(const ir::compat::GateRef &gate) {
     if (options->lookahead_mode == LookaheadMode::DISABLED) {
         input_gatepp = std::next(input_gatepp);
     } else {
-        scheduler->take_available(scheduler->node.at(gate), avlist, scheduled, rmgr::Direction::FORWARD);
+        auto node = find_available(gate);
+        avlist.erase(std::make_pair(lookahead->get(node).priority, available_since[node - offset]));
+        available_since[node - offset] = utils::UMAX;
+        remaining_predecessors[node - offset] = utils::UMAX;
+
+        // Successors become available when their last predecessor is done.
+        // They are visited in reverse program order, like the scheduler
+        // does, because that affects the order of equally critical gates in
+        // avlist. Successors that are not visible yet count their done
+        // predecessors when they become visible.
+        const auto &successors = lookahead->get(node).successors;
+        for (auto it = successors.rbegin(); it != successors.rend(); ++it) {
+            if (*it < visible_end && --remaining_predecessors[*it - offset] == 0) {
+                make_available(*it);
+            }
+        }
+
+        // Move the window along with the first node that is not done.
+        while (frontier < visible_end && remaining_predecessors[frontier - offset] == utils::UMAX) {
+            frontier++;
+        }
+        update_window();
     }
 }
 
@@ -147,7 +256,16 @@ ir::compat::GateRef Future::get_most_critical(const utils::List<ir::compat::Gate
     if (options->lookahead_mode == LookaheadMode::DISABLED) {
         return lag.front();
     } else {
-        return scheduler->find_mostcritical(lag);
+        utils::UInt max_remain = 0;
+        ir::compat::GateRef most_critical_gate = {};
+        for (const auto &gp : lag) {
+            utils::UInt gr = lookahead->get(find_available(gp)).remaining;
+            if (gr > max_remain) {
+                most_critical_gate = gp;
+                max_remain = gr;
+            }
+        }
+        return most_critical_gate;
     }
 }
 
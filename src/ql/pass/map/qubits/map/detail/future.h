@@ -8,13 +8,14 @@
 #include "ql/utils/str.h"
 #include "ql/utils/ptr.h"
 #include "ql/utils/map.h"
+#include "ql/utils/pair.h"
 #include "ql/utils/vec.h"
 #include "ql/utils/list.h"
 #include "ql/ir/compat/compat.h"
-#include "ql/pass/sch/schedule/detail/scheduler.h"
 #include "options.h"
 #include "past.h"
 #include "alter.h"
+#include "lookahead.h"
 
 namespace ql {
 namespace pass {
@@ -23,9 +24,6 @@ namespace qubits {
 namespace map {
 namespace detail {
 
-// Shorthand.
-using Scheduler = pass::sch::schedule::detail::Scheduler;
-
 /**
  * Future: input window for mapper.
  *
@@ -41,17 +39,19 @@ using Scheduler = pass::sch::schedule::detail::Scheduler;
  * the mapper, i.e. the mapper selects one or more element(s) from it to map
  * next; it may even create alternatives for each combination of available
  * gates. The gates in the list have attributes like criticality, which can be
- * exploited by the mapper. The dependency graph and the availability list
- * operations are provided by the Scheduler class.
+ * exploited by the mapper. The dependency graph is provided by the Lookahead
+ * class, which builds it using the same dependency rules as the list
+ * scheduler; it is shared between copies of the Future.
  *
- * The future is a window because in principle it could be implemented
- * incrementally, i.e. that the dependence graph would be extended when an
- * attribute gets below a threshold, e.g. when successors of a gate are
- * interrogated for a particular attribute. A problem might be that criticality
- * requires having seen the end of the circuit, but the space overhead of this
- * attribute is much less than that of a full dependence graph. The
- * implementation below is not incremental: it creates the dep graph for a
- * circuit completely.
+ * The future is a window because the dependency graph is constructed
+ * incrementally: it only covers the gates from the earliest unmapped gate
+ * (the frontier) up to about lookahead_horizon gates beyond it. It is extended
+ * as the frontier moves, and the gates before the frontier are released again
+ * by the Future that owns the window. Criticality requires having seen the end
+ * of the circuit, so within a limited horizon it is approximated by the
+ * longest path to the end of the window. The mutable state of the Future is
+ * just the availability list, indexed by criticality, and the number of
+ * unmapped predecessors of each gate in the window that it has seen.
  *
  * The implementation below just selects the most critical gate from the
  * availability list as next candidate to map, the idea being that any
@@ -77,9 +77,11 @@ public:
     OptionsRef options;
 
     /**
-     * A pointer, since dependency graph doesn't change (TODO: document better)
+     * The lookahead window over the dependency graph of the current kernel.
+     * This is a shared pointer, so copies of the Future (made while
+     * recursively evaluating alternatives) can share it; see branch().
      */
-    utils::Ptr<Scheduler> scheduler;
+    LookaheadRef lookahead;
 
     /**
      * Input circuit when not using scheduler based avlist.
@@ -87,14 +89,57 @@ public:
     ir::compat::GateRefs input_gatepv;
 
     /**
-     * State: has gate been scheduled, here: done from future?
+     * Whether this Future releases the nodes of the lookahead window that it
+     * is done with. Only the Future that the mapper maps the kernel with does
+     * this; copies made with branch() must not, since the original may still
+     * need those nodes.
+     */
+    utils::Bool trims_window;
+
+    /**
+     * State: the first node of the window that the per-node state vectors
+     * below cover. All nodes before it are done.
+     */
+    utils::UInt offset;
+
+    /**
+     * State: the first node that has not been done yet.
+     */
+    utils::UInt frontier;
+
+    /**
+     * State: the end of the nodes of the window that this Future has seen.
+     * The nodes after it are not known to be available yet, even if all
+     * their predecessors have been done.
+     */
+    utils::UInt visible_end;
+
+    /**
+     * State: for each node from offset to visible_end, the number of its
+     * predecessors that have not been done from future yet, or utils::UMAX
+     * when the node itself has been done.
+     */
+    utils::Vec<utils::UInt> remaining_predecessors;
+
+    /**
+     * State: the nodes/gates which are available for mapping now, ordered by
+     * non-increasing (deep-)criticality. The key is the priority of the node
+     * in the lookahead window, followed by the order in which the node became
+     * available; the latter puts a node after the nodes that are equally
+     * critical and were already available.
      */
-    utils::Map<ir::compat::GateRef, utils::Bool> scheduled;
+    utils::Map<utils::Pair<Lookahead::Priority, utils::UInt>, utils::UInt> avlist;
 
     /**
-     * State: the nodes/gates which are available for mapping now.
+     * State: for each node from offset to visible_end, the second part of its
+     * key in avlist, or utils::UMAX if it is not available.
      */
-    utils::List<lemon::ListDigraph::Node> avlist;
+    utils::Vec<utils::UInt> available_since;
+
+    /**
+     * State: the number of nodes that have been made available so far.
+     */
+    utils::UInt num_made_available;
 
     /**
      * State: alternative iterator in input_gatepv.
@@ -119,7 +164,31 @@ public:
     /**
      * Set/switch input to the provided kernel.
      */
-    void set_kernel(const ir::compat::KernelRef &kernel, const utils::Ptr<Scheduler> &sched);
+    void set_kernel(const ir::compat::KernelRef &kernel);
+
+    /**
+     * Returns a copy of this Future for evaluating an alternative, which
+     * shares the lookahead window but doesn't release any of its nodes.
+     */
+    Future branch() const;
+
+    /**
+     * Extends the window to lookahead_horizon nodes beyond the frontier, makes
+     * the new nodes available when they don't depend on any gate that has not
+     * been done, and releases the nodes before the frontier when this Future
+     * owns the window.
+     */
+    void update_window();
+
+    /**
+     * Returns the node of the given gate, which must be available.
+     */
+    utils::UInt find_available(const ir::compat::GateRef &gate) const;
+
+    /**
+     * Adds the given node to avlist, keeping it ordered.
+     */
+    void make_available(utils::UInt node);
 
     /**
      * Get from avlist all gates that are non-quantum into nonqlg. Non-quantum
@@ -0,0 +1,285 @@
+/** \file
+ * Windowed dependency graph for the mapper's lookahead window.
+ */
+
+#include "lookahead.h"
+
+#include <cmath>
+#include <algorithm>
+#include <numeric>
+
+namespace ql {
+namespace pass {
+namespace map {
+namespace qubits {
+namespace map {
+namespace detail {
+
+using namespace utils;
+
+// Shorthand.
+using DepType = pass::sch::schedule::detail::DepType;
+using OperandType = pass::sch::schedule::detail::OperandType;
+
+/**
+ * Prepares the window for the given kernel; no nodes are added yet. The
+ * horizon is the number of nodes added at a time, and the minimum number of
+ * nodes that follow a node when its criticality is determined; zero means the
+ * whole kernel.
+ */
+Lookahead::Lookahead(
+    const ir::compat::KernelRef &kernel,
+    Bool commute_multi_qubit,
+    Bool commute_single_qubit,
+    Bool enable_criticality,
+    UInt horizon
+) :
+    input(kernel->gates.begin(), kernel->gates.end()),
+    cycle_time(kernel->platform->cycle_time),
+    enable_criticality(enable_criticality),
+    chunk_size(horizon ? horizon : kernel->gates.size() + 2),
+    rules(
+        kernel->platform->qubit_count,
+        kernel->platform->creg_count,
+        kernel->platform->breg_count,
+        commute_multi_qubit,
+        commute_single_qubit,
+        source(),
+        [this](UInt from_id, UInt to_id, DepType, OperandType, UInt) {
+            add_arc(from_id, to_id);
+        }
+    ),
+    begin(0),
+    final_end(0)
+{
+    QL_DOUT("lookahead window creation ... #gates = " << input.size() << ", horizon = " << chunk_size);
+}
+
+/**
+ * Returns the node index of the SINK node.
+ */
+UInt Lookahead::sink() const {
+    return input.size() + 1;
+}
+
+/**
+ * Returns the first node in the window.
+ */
+UInt Lookahead::get_begin() const {
+    return begin;
+}
+
+/**
+ * Extends the window until at least the nodes before the given node are
+ * final, or all nodes are, and returns the end of the final nodes.
+ *
+ * Nodes are always added a full chunk at a time, and the criticality is
+ * updated after each chunk, such that the chunk boundaries and thus the
+ * criticality of each node are independent of the targets requested.
+ */
+UInt Lookahead::extend(UInt target) {
+    UInt count = sink() + 1;
+    target = std::min(target, count);
+    while (final_end < target) {
+        UInt end = std::min(begin + window.size() + chunk_size, count);
+        while (begin + window.size() < end) {
+            add_node();
+        }
+        update_criticality(final_end);
+        QL_DOUT("lookahead window extended to node " << end << ", final up to node " << final_end);
+    }
+    return final_end;
+}
+
+/**
+ * Releases the nodes before the given node, which must be done for all users
+ * of the window and must be final.
+ */
+void Lookahead::trim(UInt node) {
+    QL_ASSERT(node <= final_end);
+    while (begin < node) {
+        nodes.erase(window.front().gate.get_ptr());
+        window.pop_front();
+        begin++;
+    }
+}
+
+/**
+ * Returns the given node, which must be in the window.
+ */
+const Lookahead::Node &Lookahead::get(UInt node) const {
+    return window[node - begin];
+}
+
+/**
+ * Returns the node of the given gate, or utils::UMAX if the gate is not in the
+ * window.
+ */
+UInt Lookahead::get_node(const ir::compat::GateRef &gate) const {
+    auto it = nodes.find(gate.get_ptr());
+    if (it == nodes.end()) {
+        return UMAX;
+    }
+    return it->second;
+}
+
+/**
+ * Adds the next node to the window, along with its dependencies.
+ */
+void Lookahead::add_node() {
+    UInt node = begin + window.size();
+    window.emplace_back();
+    auto &rec = window.back();
+    if (node == source()) {
+        rec.gate.emplace<ir::compat::gate_types::Source>();
+    } else if (node == sink()) {
+        rec.gate.emplace<ir::compat::gate_types::Sink>();
+        rules.add_sink(node);
+    } else {
+        // The window now owns the gate, so it is released when trimmed.
+        rec.gate = input[node - 1];
+        input[node - 1].reset();
+        rules.add_gate(node, rec.gate);
+    }
+    nodes.emplace(rec.gate.get_ptr(), node);
+}
+
+/**
+ * Callback for the dependency rules. Dependencies on trimmed nodes are
+ * dropped, and duplicates are merged.
+ *
+ * All dependencies of a node are added when that node is added, so a
+ * duplicate is always the most recently added successor.
+ */
+void Lookahead::add_arc(UInt from, UInt to) {
+    if (from < begin) {
+        return;
+    }
+    auto &successors = window[from - begin].successors;
+    if (!successors.empty() && successors.back() == to) {
+        return;
+    }
+    successors.push_back(to);
+    window[to - begin].predecessors.push_back(from);
+}
+
+/**
+ * Returns the duration of the given node in cycles.
+ */
+UInt Lookahead::get_weight(const Node &node) const {
+    return UInt(ceil(static_cast<Real>(node.gate->duration) / cycle_time));
+}
+
+/**
+ * Recomputes the criticality of the nodes from the given node onwards, and
+ * determines the priorities of those that are now final.
+ *
+ * Like Scheduler::set_remaining() for forward scheduling, but the SINK is
+ * replaced by the end of the window until the last chunk has been added: a
+ * node without successors in the window is assumed to remain critical for its
+ * own duration.
+ */
+void Lookahead::update_criticality(UInt from) {
+    UInt end = begin + window.size();
+    Bool complete = end == sink() + 1;
+
+    // All successors come later in program order, so visiting the nodes in
+    // reverse order ensures that their remaining values and most critical
+    // successors are known.
+    for (UInt node = end; node-- > from;) {
+        auto &rec = window[node - begin];
+        UInt weight = get_weight(rec);
+        rec.remaining = complete ? 0 : weight;
+        for (auto succ : rec.successors) {
+            rec.remaining = std::max(rec.remaining, window[succ - begin].remaining + weight);
+        }
+
+        // The scheduler visits the successors in reverse program order.
+        rec.most_critical_successor = UMAX;
+        for (auto it = rec.successors.rbegin(); it != rec.successors.rend(); ++it) {
+            auto &crit = rec.most_critical_successor;
+            if (crit == UMAX || criticality_lessthan(crit, *it)) {
+                crit = *it;
+            }
+        }
+    }
+
+    // Nodes followed by at least a full chunk are final now. Rank them from
+    // most to least critical.
+    UInt new_final = complete ? end : end - chunk_size;
+    Vec<UInt> order(new_final - from);
+    std::iota(order.begin(), order.end(), from);
+    if (enable_criticality) {
+        std::sort(order.begin(), order.end(), [this](UInt n1, UInt n2) {
+            return criticality_lessthan(n2, n1);
+        });
+    }
+    UInt rank = from;
+    for (UInt i = 0; i < order.size(); i++) {
+        auto &rec = window[order[i] - begin];
+        if (enable_criticality && i > 0 && criticality_lessthan(order[i], order[i - 1])) {
+            rank++;
+        }
+        rec.priority = {UMAX - rec.remaining, enable_criticality ? rank : 0};
+    }
+    final_end = new_final;
+}
+
+/**
+ * Returns whether node n1 is less (deep-)critical than node n2. This is
+ * the same ordering as Scheduler::criticality_lessthan() for forward
+ * scheduling, but the most critical successor of each node is looked up
+ * rather than recomputed.
+ */
+Bool Lookahead::criticality_lessthan(UInt n1, UInt n2) const {
+    while (true) {
+        if (n1 == n2) return false;
+
+        const auto &rec1 = window[n1 - begin];
+        const auto &rec2 = window[n2 - begin];
+        if (rec1.remaining < rec2.remaining) return true;
+        if (!enable_criticality) return false;
+        if (rec1.remaining > rec2.remaining) return false;
+
+        // Equally critical, so compare the most critical successors. This
+        // order is total, so if these differ, one of them is less critical.
+        auto crit1 = rec1.most_critical_successor;
+        auto crit2 = rec2.most_critical_successor;
+        if (crit2 == UMAX) return false;
+        if (crit1 == UMAX) return true;
+
+        // Fall back to original gate order for stability.
+        if (crit1 == crit2) return n1 > n2;
+
+        n1 = crit1;
+        n2 = crit2;
+    }
+}
+
+/**
+ * Writes the final nodes in the window in dot format, annotating each node
+ * with its remaining value.
+ */
+void Lookahead::dump_dot(std::ostream &os) const {
+    os << "digraph {\ngraph [ rankdir=TD; ];\n";
+    os << "edge [fontsize=16, arrowhead=vee, arrowsize=0.5];\n";
+    for (UInt node = begin; node < final_end; node++) {
+        os << "\"" << node << "\" [label=\" " << get(node).gate->qasm();
+        os << " (" << get(node).remaining << ") \" fontcolor=black, style=filled, fontsize=16];\n";
+    }
+    for (UInt node = begin; node < final_end; node++) {
+        for (auto it = get(node).successors.rbegin(); it != get(node).successors.rend(); ++it) {
+            if (*it < final_end) {
+                os << "\"" << node << "\"->\"" << *it << "\" [ color=black ];\n";
+            }
+        }
+    }
+    os << "}\n";
+}
+
+} // namespace detail
+} // namespace map
+} // namespace qubits
+} // namespace map
+} // namespace pass
+} // namespace ql
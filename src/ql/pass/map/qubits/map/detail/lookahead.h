@@ -0,0 +1,258 @@
+/** \file
+ * Windowed dependency graph for the mapper's lookahead window.
+ */
+
+#pragma once
+
+#include <ostream>
+#include <deque>
+#include <unordered_map>
+#include "ql/utils/num.h"
+#include "ql/utils/vec.h"
+#include "ql/utils/pair.h"
+#include "ql/utils/ptr.h"
+#include "ql/ir/compat/compat.h"
+#include "ql/pass/sch/schedule/detail/scheduler.h"
+
+namespace ql {
+namespace pass {
+namespace map {
+namespace qubits {
+namespace map {
+namespace detail {
+
+/**
+ * Sliding window over the dependency graph of a kernel, as used by the Future
+ * to determine which gates are available for mapping and how critical they
+ * are.
+ *
+ * The dependencies are found by the same rules as those of the list scheduler
+ * (see pass::sch::schedule::detail::DependencyRules), including the
+ * commutation rules for X and Z rotations, but only the shape of the graph is
+ * kept: the dependency types, causes, and weights are dropped, and duplicate
+ * arcs between the same pair of nodes are merged. Node 0 is the dummy SOURCE
+ * gate, nodes 1 to N are the gates of the kernel in program order, and node
+ * N+1 is the dummy SINK gate.
+ *
+ * Rather than building the graph for the whole kernel up front, nodes are
+ * added on demand in chunks of the given horizon, and the nodes that all users
+ * are done with are released again with trim(). The criticality of a node is
+ * the longest path from it to the SINK, but is computed only over the nodes
+ * in the window, and is frozen ("final") once at least a full horizon of
+ * nodes follows it. Only final nodes are visible to the Future. The chunk
+ * boundaries are fixed, so the criticality of a node does not depend on when
+ * the window was extended. With a horizon of zero or at least the number of
+ * gates, the whole kernel is a single chunk and the criticality is exact.
+ *
+ * The deep-criticality order used to sort the availability list is determined
+ * once for each batch of nodes that become final, so the Future can keep its
+ * availability list indexed by priority rather than comparing nodes whenever
+ * one becomes available.
+ */
+class Lookahead {
+public:
+
+    /**
+     * Sort key for the availability list; lower is more critical. The first
+     * element is the complement of the remaining value, the second is the
+     * rank in the deep-criticality order when deep criticality is enabled,
+     * and zero otherwise.
+     */
+    using Priority = utils::Pair<utils::UInt, utils::UInt>;
+
+    /**
+     * A node in the window.
+     */
+    struct Node {
+
+        /**
+         * The gate corresponding to this node.
+         */
+        ir::compat::GateRef gate;
+
+        /**
+         * The distinct successors of this node that have been added to the
+         * window so far, in program order.
+         */
+        utils::Vec<utils::UInt> successors;
+
+        /**
+         * The distinct predecessors of this node that were still in the
+         * window when this node was added. Predecessors that were trimmed
+         * before that were done already.
+         */
+        utils::Vec<utils::UInt> predecessors;
+
+        /**
+         * The number of cycles along the longest path from the start of this
+         * node to the end of the window, or to the SINK.
+         */
+        utils::UInt remaining = 0;
+
+        /**
+         * The most critical successor, or utils::UMAX if there is none.
+         */
+        utils::UInt most_critical_successor = utils::UMAX;
+
+        /**
+         * The priority of this node. Only valid once the node is final.
+         */
+        Priority priority;
+
+    };
+
+private:
+
+    /**
+     * The gates of the kernel.
+     */
+    utils::Vec<ir::compat::GateRef> input;
+
+    /**
+     * Cycle time of the platform, to convert gate durations to cycles.
+     */
+    utils::UInt cycle_time;
+
+    /**
+     * Whether ties in remaining are broken by the criticality of the
+     * successors (deep criticality) before falling back to program order.
+     */
+    utils::Bool enable_criticality;
+
+    /**
+     * The number of nodes added at a time.
+     */
+    utils::UInt chunk_size;
+
+    /**
+     * The state machine that finds the dependencies of each new node.
+     */
+    pass::sch::schedule::detail::DependencyRules rules;
+
+    /**
+     * The nodes in the window, starting at node begin.
+     */
+    std::deque<Node> window;
+
+    /**
+     * The first node in the window. All nodes before it have been trimmed.
+     */
+    utils::UInt begin;
+
+    /**
+     * The nodes before this one are final.
+     */
+    utils::UInt final_end;
+
+    /**
+     * Map from gate to its node, for the nodes in the window.
+     */
+    std::unordered_map<const ir::compat::Gate*, utils::UInt> nodes;
+
+public:
+
+    /**
+     * Prepares the window for the given kernel; no nodes are added yet. The
+     * horizon is the number of nodes added at a time, and the minimum number
+     * of nodes that follow a node when its criticality is determined; zero
+     * means the whole kernel.
+     */
+    Lookahead(
+        const ir::compat::KernelRef &kernel,
+        utils::Bool commute_multi_qubit,
+        utils::Bool commute_single_qubit,
+        utils::Bool enable_criticality,
+        utils::UInt horizon
+    );
+
+    /**
+     * Returns the node index of the SOURCE node.
+     */
+    static constexpr utils::UInt source() { return 0; }
+
+    /**
+     * Returns the node index of the SINK node.
+     */
+    utils::UInt sink() const;
+
+    /**
+     * Returns the first node in the window.
+     */
+    utils::UInt get_begin() const;
+
+    /**
+     * Extends the window until at least the nodes before the given node are
+     * final, or all nodes are, and returns the end of the final nodes.
+     */
+    utils::UInt extend(utils::UInt target);
+
+    /**
+     * Releases the nodes before the given node, which must be done for all
+     * users of the window and must be final.
+     */
+    void trim(utils::UInt node);
+
+    /**
+     * Returns the given node, which must be in the window.
+     */
+    const Node &get(utils::UInt node) const;
+
+    /**
+     * Returns the node of the given gate, or utils::UMAX if the gate is not
+     * in the window.
+     */
+    utils::UInt get_node(const ir::compat::GateRef &gate) const;
+
+    /**
+     * Writes the final nodes in the window in dot format, annotating each
+     * node with its remaining value.
+     */
+    void dump_dot(std::ostream &os) const;
+
+private:
+
+    /**
+     * Adds the next node to the window, along with its dependencies.
+     */
+    void add_node();
+
+    /**
+     * Callback for the dependency rules. Dependencies on trimmed nodes are
+     * dropped, and duplicates are merged.
+     */
+    void add_arc(utils::UInt from, utils::UInt to);
+
+    /**
+     * Returns the duration of the given node in cycles.
+     */
+    utils::UInt get_weight(const Node &node) const;
+
+    /**
+     * Recomputes the criticality of the nodes from the given node onwards, and
+     * determines the priorities of those that are now final.
+     */
+    void update_criticality(utils::UInt from);
+
+    /**
+     * Returns whether node n1 is less (deep-)critical than node n2. This is
+     * the same ordering as Scheduler::criticality_lessthan() for forward
+     * scheduling, but the most critical successor of each node is looked up
+     * rather than recomputed.
+     */
+    utils::Bool criticality_lessthan(utils::UInt n1, utils::UInt n2) const;
+
+};
+
+/**
+ * Shared reference to a lookahead window. Copies of the Future (made while
+ * evaluating alternatives recursively) all share the same window; see
+ * Future::branch().
+ */
+using LookaheadRef = utils::Ptr<Lookahead>;
+
+} // namespace detail
+} // namespace map
+} // namespace qubits
+} // namespace map
+} // namespace pass
+} // namespace ql
@@ -5,9 +5,11 @@
 #include "mapper.h"
 
 #include <chrono>
+#include "ql/utils/set.h"
 #include "ql/utils/filesystem.h"
 #include "ql/pass/ana/statistics/annotations.h"
 #include "ql/pass/map/qubits/place_mip/detail/algorithm.h"
+#include "ql/pass/map/qubits/place_heuristic/detail/algorithm.h"
 
 namespace ql {
 namespace pass {
@@ -34,6 +36,67 @@ std::ostream &operator<<(std::ostream &os, PathStrategy p) {
 using namespace utils;
 using namespace com;
 
+/**
+ * Returns the neighbors of src that continue a path to tgt within the given
+ * budget, i.e. the next hops in the shortest-path DAG towards tgt, reduced
+ * and ordered according to the given path strategy. For the random strategy,
+ * the neighbors are returned unshuffled. The result only depends on the
+ * topology, so it is computed once and cached for the lifetime of the mapper.
+ */
+const Vec<UInt> &Mapper::get_next_hops(
+    UInt src,
+    UInt tgt,
+    UInt budget,
+    PathStrategy strategy
+) {
+    UInt key = ((budget * nq + src) * nq + tgt) * 5 + (UInt)strategy;
+    auto it = next_hops_cache.find(key);
+    if (it != next_hops_cache.end()) {
+        return it->second;
+    }
+
+    UInt d = platform->topology->get_distance(src, tgt);
+    QL_DOUT("get_next_hops: distance(src=" << src << ", tgt=" << tgt << ") = " << d);
+    QL_ASSERT(d >= 1);
+
+    // Reduce neighbors nbs to those n continuing a path within budget.
+    // src=>tgt is distance d, budget>=d is allowed, attempt src->n=>tgt
+    // src->n is one hop, budget from n is one less so distance(n,tgt) <= budget-1 (i.e. distance < budget)
+    // when budget==d, this defaults to distance(n,tgt) <= d-1
+    auto neighbors = platform->topology->get_neighbors(src);
+    neighbors.remove_if([this,budget,tgt](const UInt& n) { return platform->topology->get_distance(n, tgt) >= budget; });
+
+    // Update the neighbor list according to the path strategy.
+    if (strategy != PathStrategy::RANDOM) {
+
+        // Rotate neighbor list nbl such that largest difference between angles
+        // of adjacent elements is beyond back(). This only makes sense when
+        // there is an underlying xy grid; when not, only the ALL strategy is
+        // supported.
+        QL_ASSERT(platform->topology->has_coordinates() || strategy == PathStrategy::ALL);
+        platform->topology->sort_neighbors_by_angle(src, neighbors);
+
+        // Select the subset of those neighbors that continue in direction(s) we
+        // want.
+        if (!neighbors.empty()) {
+            UInt front = neighbors.front();
+            UInt back = neighbors.back();
+            if (strategy == PathStrategy::LEFT) {
+                neighbors.remove_if([front](const UInt &n) { return n != front; } );
+            } else if (strategy == PathStrategy::RIGHT) {
+                neighbors.remove_if([back](const UInt &n) { return n != back; } );
+            } else if (strategy == PathStrategy::LEFT_RIGHT) {
+                neighbors.remove_if([front, back](const UInt &n) { return n != front && n != back; } );
+            }
+        }
+
+    }
+
+    return next_hops_cache.emplace(
+        key, Vec<UInt>(neighbors.begin(), neighbors.end())
+    ).first->second;
+}
+
 /**
  * Find shortest paths between src and tgt in the grid, bounded by a
  * particular strategy. path is a linked-list node representing the complete
@@ -91,60 +154,17 @@ void Mapper::gen_shortest_paths(
     Path sub_path_node = {src, path};
     RawPtr<Path> sub_path = &sub_path_node;
 
-    // Start looking around at neighbors for serious paths.
-    UInt d = platform->topology->get_distance(src, tgt);
-    QL_DOUT("gen_shortest_paths: distance(src=" << src << ", tgt=" << tgt << ") = " << d);
-    QL_ASSERT(d >= 1);
-
-    // Reduce neighbors nbs to those n continuing a path within budget.
-    // src=>tgt is distance d, budget>=d is allowed, attempt src->n=>tgt
-    // src->n is one hop, budget from n is one less so distance(n,tgt) <= budget-1 (i.e. distance < budget)
-    // when budget==d, this defaults to distance(n,tgt) <= d-1
-    auto neighbors = platform->topology->get_neighbors(src);
-    if (logger::log_level >= logger::LogLevel::LOG_DEBUG) {
-        QL_DOUT("gen_shortest_paths: ... neighbors: ");
-        for (auto dn : neighbors) {
-            QL_DOUT("..." << dn << " ");
-        }
-    }
-    neighbors.remove_if([this,budget,tgt](const UInt& n) { return platform->topology->get_distance(n, tgt) >= budget; });
-    if (logger::log_level >= logger::LogLevel::LOG_DEBUG) {
-        QL_DOUT("gen_shortest_paths: ... after reducing to steps within budget, nbl: ");
-        for (auto dn : neighbors) {
-            QL_DOUT("..." << dn << " ");
-        }
-    }
-
-    // Update the neighbor list according to the path strategy.
+    // Look up the neighbors that continue a path within budget in the
+    // direction(s) we want. For the random strategy, shuffle them; we have to
+    // go through a copy to do that, since the cached list is shared.
+    const Vec<UInt> *neighbors_ptr = &get_next_hops(src, tgt, budget, strategy);
+    Vec<UInt> shuffled_neighbors;
     if (strategy == PathStrategy::RANDOM) {
-
-        // Shuffle the neighbor list. We have to go through a vector to do that,
-        // otherwise std::shuffle doesn't work.
-        utils::Vec<utils::UInt> neighbors_vec{neighbors.begin(), neighbors.end()};
-        std::shuffle(neighbors_vec.begin(), neighbors_vec.end(), rng);
-        neighbors.clear();
-        neighbors.insert(neighbors.begin(), neighbors_vec.begin(), neighbors_vec.end());
-
-    } else {
-
-        // Rotate neighbor list nbl such that largest difference between angles
-        // of adjacent elements is beyond back(). This only makes sense when
-        // there is an underlying xy grid; when not, only the ALL strategy is
-        // supported.
-        QL_ASSERT(platform->topology->has_coordinates() || strategy == PathStrategy::ALL);
-        platform->topology->sort_neighbors_by_angle(src, neighbors);
-
-        // Select the subset of those neighbors that continue in direction(s) we
-        // want.
-        if (strategy == PathStrategy::LEFT) {
-            neighbors.remove_if([neighbors](const UInt &n) { return n != neighbors.front(); } );
-        } else if (strategy == PathStrategy::RIGHT) {
-            neighbors.remove_if([neighbors](const UInt &n) { return n != neighbors.back(); } );
-        } else if (strategy == PathStrategy::LEFT_RIGHT) {
-            neighbors.remove_if([neighbors](const UInt &n) { return n != neighbors.front() && n != neighbors.back(); } );
-        }
-
+        shuffled_neighbors = *neighbors_ptr;
+        std::shuffle(shuffled_neighbors.begin(), shuffled_neighbors.end(), rng);
+        neighbors_ptr = &shuffled_neighbors;
     }
+    const auto &neighbors = *neighbors_ptr;
 
     QL_IF_LOG_DEBUG {
         QL_DOUT("gen_shortest_paths: ... after normalizing, before iterating, nbl: ");
@@ -155,7 +175,7 @@ void Mapper::gen_shortest_paths(
 
     // For all resulting neighbors, find all continuations of a shortest path by
     // recursively calling ourselves.
-    for (auto &n : neighbors) {
+    for (auto n : neighbors) {
         PathStrategy new_strategy = strategy;
 
         // For each neighbor, only look in desired direction, if any.
@@ -704,7 +724,7 @@ void Mapper::select_alter(
     // QL_DOUT("... SelectAlter level=" << level << " entering recursion with " << gla.size() << " good alternatives");
     for (auto &a : good_alters) {
         a.debug_print("... ... considering alternative:");
-        Future sub_future = future; // copy!
+        Future sub_future = future.branch(); // copy!
         Past sub_past = past;       // copy!
         commit_alter(a, sub_future, sub_past);
         a.debug_print(
@@ -773,6 +793,10 @@ void Mapper::select_alter(
             } else {
                 a.score = sub_past.get_max_free_cycle() -
                           base_past.get_max_free_cycle();
+                a.score += options->inter_core_stall_weight * (
+                    sub_past.get_inter_core_stall() -
+                    base_past.get_inter_core_stall()
+                );
             }
             a.debug_print(
                 "... ... select_alter, after committing this alternative, mapped easy gates, no gates to evaluate next; RECURSION BOTTOM");
@@ -852,10 +876,15 @@ void Mapper::map_gates(Future &future, Past &past, Past &base_past) {
 }
 
 /**
- * Performs (initial) placement of the qubits.
+ * Performs (initial) placement of the qubits. The heuristic placer is used
+ * when it is enabled, or as a fallback when the MIP-based placer is enabled
+ * but not available in this build, or when it fails or times out. The result
+ * of the placer is reported as a kernel statistic.
  */
 void Mapper::place(const ir::compat::KernelRef &k, com::map::QubitMapping &v2r) {
+    using pass::ana::statistics::AdditionalStats;
 
+    Bool heuristic = options->enable_heuristic_placer;
     if (options->enable_mip_placer) {
 #ifdef INITIALPLACE
         QL_DOUT("InitialPlace: kernel=" << k->name << " timeout=" << options->mip_timeout << " horizon=" << options->mip_horizon << " [START]");
@@ -868,11 +897,34 @@ void Mapper::place(const ir::compat::KernelRef &k, com::map::QubitMapping &v2r)
         place_mip::detail::Algorithm ip;
         auto ipok = ip.run(k, ipopt, v2r); // compute mapping (in v2r) using ip model, may fail
         QL_DOUT("InitialPlace: kernel=" << k->name << " timeout=" << options->mip_timeout << " horizon=" << options->mip_horizon << " result=" << ipok << " iptimetaken=" << ip.get_time_taken() << " seconds [DONE]");
+        AdditionalStats::push(k, "initial placement result: MIP " + to_string(ipok));
+        heuristic = ipok == place_mip::detail::Result::FAILED || ipok == place_mip::detail::Result::TIMED_OUT;
+        if (heuristic) {
+            QL_IOUT("InitialPlace: kernel=" << k->name << " result=" << ipok << "; falling back to heuristic placement");
+        }
 #else // ifdef INITIALPLACE
-        QL_DOUT("InitialPlace support disabled during OpenQL build [DONE]");
-        QL_WOUT("InitialPlace support disabled during OpenQL build [DONE]");
+        QL_WOUT("InitialPlace support disabled during OpenQL build; using heuristic placement instead");
+        heuristic = true;
 #endif // ifdef INITIALPLACE
     }
+    if (heuristic) {
+        QL_DOUT("HeuristicPlace: kernel=" << k->name << " window=" << options->heuristic_placer_window << " iterations=" << options->heuristic_placer_iterations << " horizon=" << options->mip_horizon << " [START]");
+
+        place_heuristic::detail::Options hpopt;
+        hpopt.map_all = options->initialize_one_to_one;
+        hpopt.horizon = options->mip_horizon;
+        hpopt.window = options->heuristic_placer_window;
+        hpopt.iterations = options->heuristic_placer_iterations;
+        hpopt.timeout = options->heuristic_placer_timeout;
+
+        place_heuristic::detail::Algorithm hp;
+        auto hpok = hp.run(k, hpopt, v2r);
+        if (hp.is_timed_out()) {
+            QL_WOUT("HeuristicPlace: kernel=" << k->name << " timed out after " << hp.get_iterations() << " iterations; using the best placement found so far");
+        }
+        QL_DOUT("HeuristicPlace: kernel=" << k->name << " result=" << hpok << " iterations=" << hp.get_iterations() << " timetaken=" << hp.get_time_taken() << " seconds [DONE]");
+        AdditionalStats::push(k, "initial placement result: heuristic " + to_string(hpok));
+    }
     QL_IF_LOG_DEBUG {
         QL_DOUT("After InitialPlace");
         v2r.dump_state();
@@ -880,32 +932,40 @@ void Mapper::place(const ir::compat::KernelRef &k, com::map::QubitMapping &v2r)
 
 }
 
+/**
+ * Returns the pooled output window, (re)initialized for generating gates into
+ * the given kernel, which must have an empty circuit. The qubit mapping of the
+ * window is not initialized.
+ */
+Past &Mapper::get_past(const ir::compat::KernelRef &k) {
+    if (past_pool_valid) {
+        past_pool.reset(k);
+    } else {
+        past_pool.initialize(k, options);
+        past_pool_valid = true;
+    }
+    return past_pool;
+}
+
 /**
  * Map the kernel's circuit's gates in the provided context (v2r maps),
  * updating circuit and v2r maps.
  */
 void Mapper::route(const ir::compat::KernelRef &k, com::map::QubitMapping &v2r) {
 
-    // Future window, presents input in available list.
-    Future future;
-
-    // Past window, contains output schedule, storing all gates until taken out.
-    Past past;
-
-    // Scheduler instance (from src/scheduler.h) used for its dependency graph.
-    utils::Ptr<Scheduler> sched;
-    sched.emplace();
-
-    // Initialize the future window with the incoming circuit.
-    future.initialize(platform, options);
-    future.set_kernel(k, sched);
+    // Future window, presents input in available list. Switch the pooled
+    // window to the incoming circuit.
+    Future &future = future_pool;
+    future.set_kernel(k);
 
     // Future has now copied kernel->c to private data, making kernel->c ready
     // for use by Past::new_gate(), for the kludge we need because gates can
     // only be constructed in the context of and at the end of a kernel.
     k->gates.reset();
     kernel = k;
-    past.initialize(kernel, options);
+
+    // Past window, contains output schedule, storing all gates until taken out.
+    Past &past = get_past(kernel);
     past.import_mapping(v2r);
 
     // Perform the actual mapping.
@@ -931,6 +991,7 @@ void Mapper::route(const ir::compat::KernelRef &k, com::map::QubitMapping &v2r)
     // Store statistics gathered by the past before it goes out of scope.
     num_swaps_added = past.get_num_swaps_added();
     num_moves_added = past.get_num_moves_added();
+    num_inter_core_stall = past.get_inter_core_stall();
 
 }
 
@@ -946,8 +1007,7 @@ void Mapper::decompose_to_primitives(const ir::compat::KernelRef &k) {
     k->gates.reset();
 
     // Output window in which gates are scheduled.
-    Past past;
-    past.initialize(k, options);
+    Past &past = get_past(k);
 
     for (const auto &gate : circuit) {
 
@@ -984,6 +1044,8 @@ void Mapper::initialize(const ir::compat::PlatformRef &p, const OptionsRef &opt)
     nc = p->creg_count;
     nb = p->breg_count;
     random_init();
+    past_pool_valid = false;
+    future_pool.initialize(p, opt);
     // QL_DOUT("... platform/real number of qubits=" << nq << ");
     cycle_time = p->cycle_time;
 
@@ -991,39 +1053,326 @@ void Mapper::initialize(const ir::compat::PlatformRef &p, const OptionsRef &opt)
 }
 
 /**
- * Runs initial placement, routing, and decomposition to primitives for
- * the given kernel.
- *
- * TODO: this should be split up into multiple passes, but this is difficult
- *  right now because:
- *   - place() does not actually modify the kernel, it just outputs a map.
- *     There is no place for that in the IR (at least not right now), so
- *     at best it could add an annotation, which would be weird. It should
- *     just update the gates immediately, but this is also problematic right
- *     now, because merely making a gate triggers decompositions.
- *   - decompose_to_primitives() could be split off relatively easily, but
- *     there's no point in doing that now, because we want a generic
- *     decomposition pass anyway, and it needs the same kludges for adding gates
- *     as the mapper does, so it (ab)uses those and is thus linked to the mapper
- *     code.
+ * The static kernels through which control flow enters and leaves a range of
+ * kernels of an old-IR program, used to derive the control flow between the
+ * static kernels for inter-kernel mapping.
+ */
+struct KernelRegion {
+
+    /**
+     * Indices of the static kernels through which control can enter the
+     * region.
+     */
+    Set<UInt> first;
+
+    /**
+     * Indices of the static kernels through which control can leave the
+     * region.
+     */
+    Set<UInt> last;
+
+    /**
+     * Whether control can pass through the region without executing any of
+     * its static kernels, for example for an if without an else.
+     */
+    Bool passthrough = true;
+
+};
+
+/**
+ * Control-flow successors and predecessors of the static kernels of an old-IR
+ * program. Node indices correspond to kernel indices, with one additional
+ * node at the end (index kernels.size()) that represents the start of the
+ * program.
+ */
+struct KernelFlow {
+
+    /**
+     * Control-flow successors for each node.
+     */
+    Vec<Set<UInt>> successors;
+
+    /**
+     * Control-flow predecessors for each node.
+     */
+    Vec<Set<UInt>> predecessors;
+
+};
+
+/**
+ * Adds control-flow edges from all the kernels in from to all the kernels in
+ * to.
+ */
+static void add_flow_edges(KernelFlow &flow, const Set<UInt> &from, const Set<UInt> &to) {
+    for (auto source : from) {
+        for (auto target : to) {
+            flow.successors[source].insert(target);
+            flow.predecessors[target].insert(source);
+        }
+    }
+}
+
+/**
+ * Appends region b to region a, adding the control-flow edges between them.
+ */
+static void append_flow_region(KernelFlow &flow, KernelRegion &a, const KernelRegion &b) {
+    add_flow_edges(flow, a.last, b.first);
+    if (a.passthrough) {
+        a.first.insert(b.first.begin(), b.first.end());
+    }
+    if (b.passthrough) {
+        a.last.insert(b.last.begin(), b.last.end());
+    } else {
+        a.last = b.last;
+    }
+    a.passthrough &= b.passthrough;
+}
+
+static KernelRegion parse_flow_region(
+    const ir::compat::ProgramRef &prog,
+    UInt &idx,
+    KernelFlow &flow
+);
+
+/**
+ * Parses a sequence of kernels up to but not including the first kernel of
+ * the given end type, starting at idx. idx is advanced to the end marker.
+ */
+static KernelRegion parse_flow_body(
+    const ir::compat::ProgramRef &prog,
+    UInt &idx,
+    ir::compat::KernelType end_type,
+    KernelFlow &flow
+) {
+    KernelRegion region;
+    while (true) {
+        if (idx >= prog->kernels.size()) {
+            throw Exception("unterminated control-flow construct in kernel list");
+        }
+        if (prog->kernels[idx]->type == end_type) {
+            return region;
+        }
+        append_flow_region(flow, region, parse_flow_region(prog, idx, flow));
+    }
+}
+
+/**
+ * Parses a single static kernel or control-flow construct, starting at idx.
+ * idx is advanced to the next kernel. This follows the structure of
+ * convert_kernels() in the old-to-new IR conversion.
+ */
+static KernelRegion parse_flow_region(
+    const ir::compat::ProgramRef &prog,
+    UInt &idx,
+    KernelFlow &flow
+) {
+    using ir::compat::KernelType;
+    KernelRegion region;
+    switch (prog->kernels[idx]->type) {
+        case KernelType::STATIC:
+            region.first.insert(idx);
+            region.last.insert(idx);
+            region.passthrough = false;
+            idx++;
+            break;
+
+        case KernelType::FOR_START:
+        case KernelType::DO_WHILE_START: {
+            auto end_type = prog->kernels[idx]->type == KernelType::FOR_START
+                ? KernelType::FOR_END : KernelType::DO_WHILE_END;
+            idx++;
+            region = parse_flow_body(prog, idx, end_type, flow);
+            idx++;
+            add_flow_edges(flow, region.last, region.first);
+            break;
+        }
+
+        case KernelType::IF_START: {
+            idx++;
+            region = parse_flow_body(prog, idx, KernelType::IF_END, flow);
+            idx++;
+            KernelRegion else_region;
+            if (idx < prog->kernels.size() && prog->kernels[idx]->type == KernelType::ELSE_START) {
+                idx++;
+                else_region = parse_flow_body(prog, idx, KernelType::ELSE_END, flow);
+                idx++;
+            }
+            region.first.insert(else_region.first.begin(), else_region.first.end());
+            region.last.insert(else_region.last.begin(), else_region.last.end());
+            region.passthrough |= else_region.passthrough;
+            break;
+        }
+
+        default:
+            throw Exception(
+                "unexpected kernel type for kernel with index " + to_string(idx)
+            );
+    }
+    return region;
+}
+
+/**
+ * Derives the control flow between the static kernels of the given program
+ * from the types of its kernels.
  */
-void Mapper::map_kernel(const ir::compat::KernelRef &k) {
+static KernelFlow build_kernel_flow(const ir::compat::ProgramRef &prog) {
+    UInt num_kernels = prog->kernels.size();
+    KernelFlow flow;
+    flow.successors.resize(num_kernels + 1);
+    flow.predecessors.resize(num_kernels + 1);
+    KernelRegion program;
+    program.last.insert(num_kernels);
+    UInt idx = 0;
+    while (idx < num_kernels) {
+        append_flow_region(flow, program, parse_flow_region(prog, idx, flow));
+    }
+    return flow;
+}
+
+/**
+ * Appends a transition from qubit mapping from to qubit mapping to at the
+ * end of the circuit of kernel k, using swaps (or moves) along a spanning
+ * tree of the topology. Only qubits that are live in from are actually
+ * moved, so no gates are added if those are already in place. Returns the
+ * number of swaps and moves added via num_swaps and num_moves.
+ */
+void Mapper::add_transition(
+    const ir::compat::KernelRef &k,
+    const com::map::QubitMapping &from,
+    const com::map::QubitMapping &to,
+    UInt &num_swaps,
+    UInt &num_moves
+) {
+    QL_DOUT("Transition at end of kernel " << k->name << " from " << from.mapping_to_string() << " to " << to.mapping_to_string());
+
+    // Build a breadth-first spanning forest of the topology. Processing its
+    // nodes in reverse order always takes a leaf of what remains of the tree.
+    Vec<UInt> parent(nq, com::map::UNDEFINED_QUBIT);
+    Vec<UInt> depth(nq, 0);
+    Vec<UInt> root(nq, com::map::UNDEFINED_QUBIT);
+    Vec<UInt> order;
+    for (UInt start = 0; start < nq; start++) {
+        if (root[start] != com::map::UNDEFINED_QUBIT) continue;
+        root[start] = start;
+        order.push_back(start);
+        for (UInt i = order.size() - 1; i < order.size(); i++) {
+            UInt q = order[i];
+            for (auto n : platform->topology->get_neighbors(q)) {
+                if (root[n] == com::map::UNDEFINED_QUBIT) {
+                    root[n] = start;
+                    parent[n] = q;
+                    depth[n] = depth[q] + 1;
+                    order.push_back(n);
+                }
+            }
+        }
+    }
+
+    // Track which virtual qubit is currently in which real qubit.
+    Vec<UInt> real_of(from.get_virt_to_real());
+    Vec<UInt> virt_of(nq, com::map::UNDEFINED_QUBIT);
+    for (UInt v = 0; v < nq; v++) {
+        QL_ASSERT(real_of[v] != com::map::UNDEFINED_QUBIT);
+        virt_of[real_of[v]] = v;
+    }
+    Vec<UInt> target_virt_of(nq, com::map::UNDEFINED_QUBIT);
+    for (UInt v = 0; v < nq; v++) {
+        QL_ASSERT(to[v] != com::map::UNDEFINED_QUBIT);
+        target_virt_of[to[v]] = v;
+    }
+
+    // Use a Past to generate the swap or move gates. This needs the kernel's
+    // circuit to be empty while it generates gates.
+    ir::compat::GateRefs circuit = k->gates;
+    k->gates.reset();
+    kernel = k;
+    Past &past = get_past(kernel);
+    past.import_mapping(from);
+
+    // Take leaves of the spanning tree one by one, move the virtual qubit
+    // that belongs there along the tree, and then remove the leaf. Swaps in
+    // which neither qubit is live do not result in gates.
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        UInt leaf = *it;
+        UInt virt = target_virt_of[leaf];
+        UInt src = real_of[virt];
+        if (src == leaf) continue;
+        if (root[src] != root[leaf]) {
+            throw Exception(
+                "cannot add inter-kernel transition to kernel " + k->name +
+                ": the qubit topology is not connected"
+            );
+        }
+
+        // Find the tree path from src to leaf.
+        Vec<UInt> path;
+        Vec<UInt> leaf_side;
+        UInt a = src;
+        UInt b = leaf;
+        while (a != b) {
+            if (depth[a] >= depth[b]) {
+                path.push_back(a);
+                a = parent[a];
+            } else {
+                leaf_side.push_back(b);
+                b = parent[b];
+            }
+        }
+        path.push_back(a);
+        while (!leaf_side.empty()) {
+            path.push_back(leaf_side.back());
+            leaf_side.pop_back();
+        }
+
+        // Swap the virtual qubit along the path.
+        UInt prev = com::map::UNDEFINED_QUBIT;
+        for (auto cur : path) {
+            if (prev != com::map::UNDEFINED_QUBIT) {
+                past.add_swap(prev, cur);
+                UInt v0 = virt_of[prev];
+                UInt v1 = virt_of[cur];
+                virt_of[prev] = v1;
+                virt_of[cur] = v0;
+                real_of[v0] = cur;
+                real_of[v1] = prev;
+            }
+            prev = cur;
+        }
+
+    }
+
+    // Append the generated gates to the kernel.
+    past.flush_all();
+    ir::compat::GateRefs transition;
+    past.flush_to_circuit(transition);
+    k->gates = circuit;
+    for (const auto &gate : transition) {
+        k->gates.add(gate);
+    }
+    num_swaps += past.get_num_swaps_added();
+    num_moves += past.get_num_moves_added();
+
+    QL_DOUT("Transition at end of kernel " << k->name << " added " << transition.size() << " gates");
+}
+
+/**
+ * Runs initial placement (if allow_placement is set) and routing for the
+ * given kernel, starting from the given input mapping. v2r is updated to the
+ * mapping at the end of the kernel. Decomposition to primitives is done
+ * separately by decompose_to_primitives(), after any inter-kernel transitions
+ * have been added.
+ */
+void Mapper::map_kernel(
+    const ir::compat::KernelRef &k,
+    com::map::QubitMapping &v2r,
+    Bool allow_placement
+) {
     QL_DOUT("Mapping kernel " << k->name << " [START]");
     QL_DOUT("... kernel original virtual number of qubits=" << k->qubit_count);
     kernel.reset();            // no new_gates until kernel.c has been copied
 
-    QL_DOUT("Mapper::Map before v2r.initialize: assume_initialized=" << options->assume_initialized);
-
-    // TODO: unify all incoming v2rs into v2r to compute kernel input mapping.
-    //  Right now there is no inter-kernel mapping yet, so just take the
-    //  program's initial mapping for each kernel.
-    com::map::QubitMapping v2r{
-        nq,
-        options->initialize_one_to_one,
-        options->assume_initialized ? com::map::QubitState::INITIALIZED : com::map::QubitState::NONE
-    };
     QL_IF_LOG_DEBUG {
-        QL_DOUT("After initialization");
+        QL_DOUT("Kernel input mapping");
         v2r.dump_state();
     }
 
@@ -1031,7 +1380,9 @@ void Mapper::map_kernel(const ir::compat::KernelRef &k) {
     v2r_in = v2r;
 
     // Perform placement.
-    place(k, v2r);
+    if (allow_placement) {
+        place(k, v2r);
+    }
 
     // Save the placed qubit map for reporting. This is the resulting qubit map
     // at the *start* of the kernel.
@@ -1049,9 +1400,6 @@ void Mapper::map_kernel(const ir::compat::KernelRef &k) {
     // at the *end* of the kernel.
     v2r_out = v2r;
 
-    // Decompose to primitive instructions as specified in the config file.
-    decompose_to_primitives(k);
-
     k->qubit_count = nq;       // bluntly copy nq (==#real qubits), so that all kernels get the same qubit_count
     k->creg_count = nc;        // same for number of cregs and bregs, although we don't really map those
     k->breg_count = nb;
@@ -1062,23 +1410,70 @@ void Mapper::map_kernel(const ir::compat::KernelRef &k) {
 /**
  * Runs mapping for the given program.
  *
- * TODO: inter-kernel mapping is NOT SUPPORTED; each kernel is mapped
- *  individually. That means that the resulting program is garbage if any
- *  quantum state was originally maintained from kernel to kernel!
+ * NOTE: unless the inter_kernel_mapping option is enabled, each kernel is
+ *  mapped individually. That means that the resulting program is garbage if
+ *  any quantum state was originally maintained from kernel to kernel!
  */
 void Mapper::map(const ir::compat::ProgramRef &prog, const OptionsRef &opt) {
 
     // Shorthand.
     using pass::ana::statistics::AdditionalStats;
+    using com::map::QubitMapping;
+    using com::map::QubitState;
 
     // Perform program-wide initialization.
     initialize(prog->platform, opt);
 
+    // The program-wide initial mapping.
+    QubitMapping initial_v2r{
+        nq,
+        options->initialize_one_to_one,
+        options->assume_initialized ? QubitState::INITIALIZED : QubitState::NONE
+    };
+
+    // Derive the control flow between the kernels for inter-kernel mapping.
+    // Node num_kernels represents the start of the program; its output
+    // mapping is the initial mapping.
+    UInt num_kernels = prog->kernels.size();
+    KernelFlow flow;
+    Vec<Bool> mapped;
+    Vec<QubitMapping> inputs;
+    Vec<QubitMapping> outputs;
+    if (options->inter_kernel_mapping) {
+        if (!options->initialize_one_to_one) {
+            throw Exception(
+                "inter-kernel mapping requires the initialize_one_to_one "
+                "mapper option to be enabled"
+            );
+        }
+        flow = build_kernel_flow(prog);
+        mapped.resize(num_kernels + 1, false);
+        inputs.resize(num_kernels + 1);
+        outputs.resize(num_kernels + 1);
+        mapped[num_kernels] = true;
+        outputs[num_kernels] = initial_v2r;
+    }
+
+    // Returns whether the output mapping of mapped node pred is fixed with
+    // respect to kernel succ, because another of its successors has already
+    // been mapped.
+    auto is_fixed = [&](UInt pred, UInt succ) {
+        for (auto other : flow.successors[pred]) {
+            if (other != succ && mapped[other]) {
+                return true;
+            }
+        }
+        return false;
+    };
+
     // Map kernel by kernel, adding statistics all the while.
     UInt total_swaps = 0;
     UInt total_moves = 0;
     Real total_time_taken = 0.0;
-    for (const auto &k : prog->kernels) {
+    Vec<UInt> transition_swaps(num_kernels, 0);
+    Vec<UInt> transition_moves(num_kernels, 0);
+    for (UInt idx = 0; idx < num_kernels; idx++) {
+        const auto &k = prog->kernels[idx];
         QL_IOUT("Mapping kernel: " << k->name);
 
         // Start interval timer for measuring time taken for this kernel.
@@ -1086,8 +1481,127 @@ void Mapper::map(const ir::compat::ProgramRef &prog, const OptionsRef &opt) {
         using namespace std::chrono;
         high_resolution_clock::time_point t1 = high_resolution_clock::now();
 
-        // Actually do the mapping.
-        map_kernel(k);
+        // Determine the input mapping.
+        QubitMapping v2r = initial_v2r;
+        Bool allow_placement = true;
+        Bool inter_kernel = options->inter_kernel_mapping && k->type == ir::compat::KernelType::STATIC;
+        if (inter_kernel) {
+
+            // Take the output mapping of a fixed predecessor if there is one,
+            // otherwise that of any mapped predecessor kernel. Only the
+            // source node can be adjusted at no cost, so only then initial
+            // placement is allowed.
+            UInt fixed_pred = MAX;
+            UInt kernel_pred = MAX;
+            Bool has_kernel_pred = false;
+            Bool has_unmapped_pred = false;
+            for (auto pred : flow.predecessors[idx]) {
+                if (pred != num_kernels) {
+                    has_kernel_pred = true;
+                }
+                if (!mapped[pred]) {
+                    has_unmapped_pred = true;
+                    continue;
+                }
+                if (is_fixed(pred, idx)) {
+                    if (fixed_pred == MAX) {
+                        fixed_pred = pred;
+                    } else if (outputs[pred].get_virt_to_real() != outputs[fixed_pred].get_virt_to_real()) {
+                        throw Exception(
+                            "cannot map kernel " + k->name + " with inter-kernel "
+                            "mapping: the mappings at the end of its "
+                            "predecessors conflict; try disabling the "
+                            "inter_kernel_mapping mapper option"
+                        );
+                    }
+                } else if (pred != num_kernels && kernel_pred == MAX) {
+                    kernel_pred = pred;
+                }
+            }
+            if (fixed_pred != MAX) {
+                v2r = outputs[fixed_pred];
+                allow_placement = false;
+            } else if (kernel_pred != MAX) {
+                v2r = outputs[kernel_pred];
+                allow_placement = false;
+            }
+
+            // Unify the qubit states of the incoming mappings.
+            if (has_kernel_pred) {
+                for (UInt real = 0; real < nq; real++) {
+                    if (v2r.get_state(real) == QubitState::INITIALIZED) {
+                        v2r.set_state(real, QubitState::NONE);
+                    }
+                }
+                for (auto pred : flow.predecessors[idx]) {
+                    if (!mapped[pred]) continue;
+                    for (UInt virt = 0; virt < nq; virt++) {
+                        if (outputs[pred].get_state(outputs[pred][virt]) == QubitState::LIVE) {
+                            v2r.set_state(v2r[virt], QubitState::LIVE);
+                        }
+                    }
+                }
+                if (has_unmapped_pred) {
+                    for (UInt real = 0; real < nq; real++) {
+                        v2r.set_state(real, QubitState::LIVE);
+                    }
+                }
+            }
+
+        }
+
+        // Actually do the mapping. Without inter-kernel mapping, nothing is
+        // appended to the kernel afterwards, so it is decomposed to primitive
+        // instructions right away.
+        map_kernel(k, v2r, allow_placement);
+        if (!options->inter_kernel_mapping) {
+            decompose_to_primitives(k);
+        }
+
+        if (inter_kernel) {
+            inputs[idx] = v2r_ip;
+            outputs[idx] = v2r;
+            mapped[idx] = true;
+
+            // Adjust the mapped predecessors that are not fixed to the input
+            // mapping of this kernel.
+            for (auto pred : flow.predecessors[idx]) {
+                if (pred == idx || !mapped[pred] || is_fixed(pred, idx)) continue;
+                if (outputs[pred].get_virt_to_real() == v2r_ip.get_virt_to_real()) continue;
+                if (pred != num_kernels) {
+                    add_transition(
+                        prog->kernels[pred], outputs[pred], v2r_ip,
+                        transition_swaps[pred], transition_moves[pred]
+                    );
+                }
+                outputs[pred] = v2r_ip;
+            }
+
+            // Add a transition to the input mapping of successors that were
+            // already mapped, i.e. when this kernel ends a loop body.
+            UInt mapped_succ = MAX;
+            for (auto succ : flow.successors[idx]) {
+                if (!mapped[succ]) continue;
+                if (mapped_succ == MAX) {
+                    mapped_succ = succ;
+                } else if (inputs[succ].get_virt_to_real() != inputs[mapped_succ].get_virt_to_real()) {
+                    throw Exception(
+                        "cannot map kernel " + k->name + " with inter-kernel "
+                        "mapping: the mappings at the start of its successors "
+                        "conflict; try disabling the inter_kernel_mapping "
+                        "mapper option"
+                    );
+                }
+            }
+            if (mapped_succ != MAX && outputs[idx].get_virt_to_real() != inputs[mapped_succ].get_virt_to_real()) {
+                add_transition(
+                    k, outputs[idx], inputs[mapped_succ],
+                    transition_swaps[idx], transition_moves[idx]
+                );
+                outputs[idx] = inputs[mapped_succ];
+            }
+
+        }
 
         // Stop the interval timer.
         high_resolution_clock::time_point t2 = high_resolution_clock::now();
@@ -1097,6 +1611,9 @@ void Mapper::map(const ir::compat::ProgramRef &prog, const OptionsRef &opt) {
         // Push mapping statistics into the kernel.
         AdditionalStats::push(k, "swaps added: " + to_string(num_swaps_added));
         AdditionalStats::push(k, "of which moves added: " + to_string(num_moves_added));
+        if (platform->topology->get_num_cores() > 1) {
+            AdditionalStats::push(k, "inter-core channel stall cycles: " + to_string(num_inter_core_stall));
+        }
         AdditionalStats::push(k, "virt2real map before mapper:" + to_string(v2r_in.get_virt_to_real()));
         AdditionalStats::push(k, "virt2real map after initial placement:" + to_string(v2r_ip.get_virt_to_real()));
         AdditionalStats::push(k, "virt2real map after mapper:" + to_string(v2r_out.get_virt_to_real()));
@@ -1111,6 +1628,25 @@ void Mapper::map(const ir::compat::ProgramRef &prog, const OptionsRef &opt) {
 
     }
 
+    // With inter-kernel mapping, decompose to primitive instructions as
+    // specified in the config file only now, because transitions may have
+    // been appended to kernels that were mapped earlier. The decomposition
+    // also reschedules the circuit, so the cycle numbers of transitions are
+    // valid afterwards.
+    if (options->inter_kernel_mapping) {
+        for (UInt idx = 0; idx < num_kernels; idx++) {
+            const auto &k = prog->kernels[idx];
+            AdditionalStats::push(k, "transition swaps added: " + to_string(transition_swaps[idx]));
+            AdditionalStats::push(k, "of which transition moves added: " + to_string(transition_moves[idx]));
+            if (mapped[idx]) {
+                AdditionalStats::push(k, "virt2real map after transition:" + to_string(outputs[idx].get_virt_to_real()));
+            }
+            total_swaps += transition_swaps[idx];
+            total_moves += transition_moves[idx];
+            decompose_to_primitives(k);
+        }
+    }
+
     // Push mapping statistics into the program.
     AdditionalStats::push(prog, "Total no. of swaps: " + to_string(total_swaps));
     AdditionalStats::push(prog, "Total no. of moves of swaps: " + to_string(total_moves));
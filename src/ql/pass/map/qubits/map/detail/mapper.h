@@ -5,6 +5,7 @@
 #pragma once
 
 #include <random>
+#include <unordered_map>
 #include "ql/utils/num.h"
 #include "ql/utils/str.h"
 #include "ql/utils/vec.h"
@@ -150,13 +151,12 @@ std::ostream &operator<<(std::ostream &os, PathStrategy p);
  * it will be used by the heuristic as an initial mapping; they are in this
  * order.
  *
- * Each kernel in the program is independently mapped (see the map_kernel
- * method), ignoring inter-kernel control flow and thereby the requirement to
- * pass on the current mapping.
- *
- * Anticipating inter-kernel mapping, the mapper maintains a kernel input
- * mapping coming from the context, and produces a kernel output mapping for the
- * context; the mapper updates the kernel's circuit from virtual to real.
+ * By default, each kernel in the program is independently mapped (see the
+ * map_kernel method), ignoring inter-kernel control flow and thereby the
+ * requirement to pass on the current mapping. Still, the mapper maintains a
+ * kernel input mapping coming from the context, and produces a kernel output
+ * mapping for the context; the mapper updates the kernel's circuit from
+ * virtual to real.
  *
  * Without inter-kernel control flow, the flow is as follows.
  *  - Mapping starts from a 1 to 1 mapping of virtual to real qubits (the kernel
@@ -171,37 +171,50 @@ std::ostream &operator<<(std::ostream &os, PathStrategy p);
  *  - Optionally decompose swap and/or cnot gates in the real circuit to
  *    primitives (make_primitive).
  *
- * Inter-kernel control flow and consequent mapping dependence between kernels
- * is not implemented. TO BE DONE. The design of mapping multiple kernels is as
- * follows (TO BE ADAPTED TO NEW REALSTATE).
+ * When the inter_kernel_mapping option is enabled, the mapping is instead
+ * passed along the control flow between the static kernels of the program.
+ * This control flow is derived from the types of the kernels (for loops,
+ * do-while loops, and if-else constructs), in the same way that the
+ * conversion to the new IR derives its control-flow structure from them.
+ * Mapping multiple kernels then works as follows.
  *
- *  - Initially the program wide initial mapping is a 1 to 1 mapping of virtual
- *    to real qubits.
- *  - When starting to map a kernel, there is a set of already mapped kernels,
- *    and a set of not yet mapped kernels. Of each mapped kernel, there is an
- *    output mapping, i.e. the mapping of virts to reals with the rs per
- *    virtual. The current kernel has a set of kernels which are direct
- *    predecessor in the program's control flow, a subset of those direct
- *    predecessors thus has been mapped and another subset not mapped; the
- *    output mappings of the mapped predecessor kernels are input.
- *  - Unify these multiple input mappings to a single one; this may introduce
- *    swaps on the control flow edges. The result is the input mapping of the
- *    current kernel; keep it for later reference.
- *  - Attempt an initial placement of the circuit, starting from the kernel
- *    input mapping.
+ *  - The program wide initial mapping is the 1 to 1 mapping of virtual to
+ *    real qubits; it is treated as the output mapping of a virtual source
+ *    node that precedes the first kernel(s) of the program.
+ *  - Kernels are mapped in program order. When starting to map a kernel,
+ *    some of its direct predecessors in the control flow have been mapped
+ *    already; their output mappings are the candidate input mappings.
+ *  - A mapped predecessor is fixed if another of its successors has already
+ *    been mapped, because its output mapping must then stay equal to the
+ *    input mapping of that successor. If there is a fixed predecessor, its
+ *    output mapping becomes the input mapping of the current kernel, and
+ *    initial placement is skipped. Otherwise, the output mapping of a mapped
+ *    predecessor kernel is used as is. Only when the current kernel is only
+ *    reached from the source node, initial placement may freely choose the
+ *    input mapping, as the initial mapping of the program can be adjusted at
+ *    no cost.
+ *  - The states of the real qubits in the input mapping are unified
+ *    conservatively: a qubit that is live at the end of any mapped
+ *    predecessor is live, initialization is not assumed for qubits coming
+ *    from other kernels, and all qubits are considered live when the kernel
+ *    is also reached through a backward edge from a kernel that is not mapped
+ *    yet.
  *  - Use heuristics to map the input (or what initial placement left to do).
- *  - When done, keep the output mapping as the kernel's output mapping. For all
- *    mapped successor kernels, compute a transition from output to their input,
- *    and add it to the edge; the edge code must be optimized for:
- *     - being empty: nothing needs to be done
- *     - having a source with one succ; the edge code can be appended to that
- *       succ
- *     - having a target with one pred; the edge code can be prepended to that
- *       pred
- *     - otherwise, a separate intermediate kernel for the transition code must
- *       be created, and added.
+ *  - Mapped predecessors that are not fixed and have a different output
+ *    mapping get a transition from their output mapping to the input mapping
+ *    appended to their circuit. Likewise, when the current kernel has
+ *    successors that have already been mapped (i.e. it ends a loop body), a
+ *    transition from its output mapping to their input mapping is appended
+ *    to it. Transitions consist of swaps (or moves) along a spanning tree of
+ *    the topology, and only qubits with a live state are actually moved; if
+ *    the live qubits are already in place, no gates are added.
+ *  - When all kernels have been mapped, the circuits including their
+ *    transitions are decomposed to primitives and rescheduled.
  *
- * THE ABOVE INTER-KERNEL MAPPING IS NOT IMPLEMENTED.
+ * Transition code is thus always placed at the end of the source kernel of a
+ * control-flow edge. Edges that would need their own intermediate kernel,
+ * because the mapping at their source is fixed in a way that conflicts with
+ * the input mapping of their target, are reported as an error.
  *
  * The Mapper's main entry is map_kernel which manages the input and output
  * streams of QASM instructions, and does the logic between (global) initial
@@ -273,6 +286,12 @@ private:
      */
     utils::UInt num_moves_added;
 
+    /**
+     * Number of cycles that inter-core gates of the most recently mapped
+     * kernel waited for a free inter-core channel, set by map_kernel().
+     */
+    utils::UInt num_inter_core_stall;
+
     /**
      * Qubit mapping before mapping, set by map_kernel().
      */
@@ -288,11 +307,55 @@ private:
      */
     com::map::QubitMapping v2r_out;
 
+    /**
+     * Cache for get_next_hops(), keyed by a combination of the source, target,
+     * budget, and strategy. Together, the entries form a shortest-path DAG
+     * towards each target qubit that is derived from the topology only once,
+     * and is shared by all kernels mapped by this mapper.
+     */
+    std::unordered_map<utils::UInt, utils::Vec<utils::UInt>> next_hops_cache;
+
+    /**
+     * Output window that is reused for all kernels mapped by this mapper (and
+     * for their transitions and decomposition into primitives), such that its
+     * resource state is only built from the platform once. Valid only when
+     * past_pool_valid is set; see get_past().
+     */
+    Past past_pool;
+
+    /**
+     * Whether past_pool has been initialized for the current program.
+     */
+    utils::Bool past_pool_valid = false;
+
+    /**
+     * Input window that is reused for all kernels mapped by this mapper, such
+     * that its state vectors keep their capacity from kernel to kernel.
+     * Initialized by initialize(); set_kernel() switches it to the next
+     * kernel.
+     */
+    Future future_pool;
+
     struct Path {
         utils::UInt qubit;
         utils::RawPtr<Path> prev;
     };
 
+    /**
+     * Returns the neighbors of src that continue a path to tgt within the given
+     * budget, i.e. the next hops in the shortest-path DAG towards tgt, reduced
+     * and ordered according to the given path strategy. For the random
+     * strategy, the neighbors are returned unshuffled. The result only depends
+     * on the topology, so it is computed once and cached for the lifetime of
+     * the mapper.
+     */
+    const utils::Vec<utils::UInt> &get_next_hops(
+        utils::UInt src,
+        utils::UInt tgt,
+        utils::UInt budget,
+        PathStrategy strategy
+    );
+
     /**
      * Find shortest paths between src and tgt in the grid, bounded by a
      * particular strategy. path is a linked-list node representing the complete
@@ -470,6 +533,13 @@ private:
      */
     void place(const ir::compat::KernelRef &k, com::map::QubitMapping &v2r);
 
+    /**
+     * Returns the pooled output window, (re)initialized for generating gates
+     * into the given kernel, which must have an empty circuit. The qubit
+     * mapping of the window is not initialized.
+     */
+    Past &get_past(const ir::compat::KernelRef &k);
+
     /**
      * Map the kernel's circuit's gates in the provided context (v2r maps),
      * updating circuit and v2r maps.
@@ -489,8 +559,11 @@ private:
     void initialize(const ir::compat::PlatformRef &p, const OptionsRef &opt);
 
     /**
-     * Runs initial placement, routing, and decomposition to primitives for
-     * the given kernel.
+     * Runs initial placement (if allow_placement is set) and routing for the
+     * given kernel, starting from the given input mapping. v2r is updated to
+     * the mapping at the end of the kernel. Decomposition to primitives is
+     * done separately by decompose_to_primitives(), after any inter-kernel
+     * transitions have been added.
      *
      * TODO: this should be split up into multiple passes, but this is difficult
      *  right now because:
@@ -505,16 +578,35 @@ private:
      *     gates as the mapper does, so it (ab)uses those and is thus linked to
      *     the mapper code.
      */
-    void map_kernel(const ir::compat::KernelRef &k);
+    void map_kernel(
+        const ir::compat::KernelRef &k,
+        com::map::QubitMapping &v2r,
+        utils::Bool allow_placement
+    );
+
+    /**
+     * Appends a transition from qubit mapping from to qubit mapping to at the
+     * end of the circuit of kernel k, using swaps (or moves) along a spanning
+     * tree of the topology. Only qubits that are live in from are actually
+     * moved, so no gates are added if those are already in place. Returns the
+     * number of swaps and moves added via num_swaps and num_moves.
+     */
+    void add_transition(
+        const ir::compat::KernelRef &k,
+        const com::map::QubitMapping &from,
+        const com::map::QubitMapping &to,
+        utils::UInt &num_swaps,
+        utils::UInt &num_moves
+    );
 
 public:
 
     /**
      * Runs mapping for the given program.
      *
-     * TODO: inter-kernel mapping is NOT SUPPORTED; each kernel is mapped
-     *  individually. That means that the resulting program is garbage if any
-     *  quantum state was originally maintained from kernel to kernel!
+     * NOTE: unless the inter_kernel_mapping option is enabled, each kernel is
+     *  mapped individually. That means that the resulting program is garbage
+     *  if any quantum state was originally maintained from kernel to kernel!
      */
     void map(const ir::compat::ProgramRef &prog, const OptionsRef &opt);
 
@@ -202,6 +202,15 @@ struct Options {
      */
     utils::Bool assume_prep_only_initializes = false;
 
+    /**
+     * Controls whether the qubit mapping is carried across kernel boundaries
+     * along the control flow of the program, rather than starting each kernel
+     * from the initial mapping. Transition swaps are added to the end of a
+     * kernel when the mapping at the end of a kernel differs from the one its
+     * successor was mapped with.
+     */
+    utils::Bool inter_kernel_mapping = false;
+
     /**
      * Controls whether MIP-based placement should be attempted before resorting
      * to heuristics.
@@ -220,6 +229,29 @@ struct Options {
      */
     utils::UInt mip_horizon = 0;
 
+    /**
+     * Controls whether the windowed heuristic initial placement algorithm
+     * should be run before routing. Ignored when MIP-based placement is
+     * enabled.
+     */
+    utils::Bool enable_heuristic_placer = false;
+
+    /**
+     * Number of two-qubit gates per window for heuristic placement.
+     */
+    utils::UInt heuristic_placer_window = 32;
+
+    /**
+     * Number of simulated annealing iterations per window for heuristic
+     * placement.
+     */
+    utils::UInt heuristic_placer_iterations = 10000;
+
+    /**
+     * Timeout for heuristic placement in seconds, or 0 to disable timeout.
+     */
+    utils::Real heuristic_placer_timeout = 0.0;
+
     /**
      * Controls which heuristic the heuristic mapper is to use.
      */
@@ -231,6 +263,13 @@ struct Options {
      */
     utils::UInt max_alters = 0;
 
+    /**
+     * Weight of the cycles that inter-core swaps and moves wait for a free
+     * inter-core channel in the score of an alternative routing solution. 0
+     * disables this.
+     */
+    utils::Real inter_core_stall_weight = 0.0;
+
     /**
      * Controls how to tie-break equally-scoring alternative mapping solutions.
      */
@@ -241,6 +280,13 @@ struct Options {
      */
     LookaheadMode lookahead_mode = LookaheadMode::NO_ROUTING_FIRST;
 
+    /**
+     * The number of gates that are added to the lookahead window at a time,
+     * and the minimum number of gates following a gate when its criticality is
+     * determined. Zero means the whole kernel.
+     */
+    utils::UInt lookahead_horizon = 10000;
+
     /**
      * Controls which paths are considered when routing.
      */
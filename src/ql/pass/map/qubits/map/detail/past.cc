@@ -39,9 +39,30 @@ void Past::initialize(const ir::compat::KernelRef &k, const OptionsRef &opt) {
     output_gates.clear();             // no gates output yet by flushing from or bypassing this past
     num_swaps_added = 0;              // no swaps or moves added yet to this past; AddSwap adds one here
     num_moves_added = 0;              // no moves added yet to this past; AddSwap may add one here
+    inter_core_stall = 0;             // no inter-core gates delayed by channel occupancy yet
     cycle.clear();                    // no gates have cycles assigned in this past; scheduling gate updates this
 }
 
+/**
+ * Resets this past to the state after initialize(), such that it can be
+ * reused for the given kernel of the same platform. Unlike initialize(), this
+ * reuses the resource state and does not touch the qubit mapping, which
+ * should subsequently be set using import_mapping() if needed.
+ */
+void Past::reset(const ir::compat::KernelRef &k) {
+    QL_DOUT("Past::reset");
+    QL_ASSERT(k->gates.empty());
+    kernel = k;
+    fc.reset();
+    waiting_gates.clear();
+    gates.clear();
+    output_gates.clear();
+    num_swaps_added = 0;
+    num_moves_added = 0;
+    inter_core_stall = 0;
+    cycle.clear();
+}
+
 /**
  * Copies the given qubit mapping into our mapping.
  */
@@ -68,7 +89,7 @@ void Past::print_fc() const{
  * is at least debug.
  */
 void Past::debug_print_fc() const {
-    if (utils::logger::log_level >= utils::logger::LogLevel::LOG_DEBUG) {
+    if (QL_IS_LOG_DEBUG) {
         fc.print("");
     }
 }
@@ -130,6 +151,17 @@ void Past::schedule() {
 
         auto gate = *gate_it;
 
+        // Keep track of how long inter-core gates have to wait for a free
+        // channel, as reported by the channel resources themselves, for the
+        // channel-aware routing score and the mapper statistics. Delays
+        // caused by other resources, such as instruments, are not counted.
+        if (
+            gate->operands.size() == 2 &&
+            platform->topology->is_inter_core_hop(gate->operands[0], gate->operands[1])
+        ) {
+            inter_core_stall += fc.get_channel_delay(gate);
+        }
+
         // Add this gate to the maps, scheduling the gate (doing the cycle
         // assignment).
         // QL_DOUT("... add " << gp->qasm() << " startcycle=" << startCycle << " cycles=" << ((gp->duration+ct-1)/ct) );
@@ -269,6 +301,14 @@ utils::UInt Past::get_num_moves_added() const {
     return num_moves_added;
 }
 
+/**
+ * Returns the total number of cycles that the inter-core gates scheduled in
+ * this past waited for a free inter-core channel.
+ */
+utils::UInt Past::get_inter_core_stall() const {
+    return inter_core_stall;
+}
+
 /**
  * Shorthand for throwing an exception for a non-existant gate.
  */
@@ -150,6 +150,13 @@ private:
      */
     utils::UInt num_moves_added;
 
+    /**
+     * Total number of cycles that the inter-core gates scheduled in this past
+     * waited for a free inter-core channel, as reported by the channel
+     * resources. Only tracked with resource-constrained heuristics.
+     */
+    utils::UInt inter_core_stall;
+
 public:
 
     /**
@@ -157,6 +164,14 @@ public:
      */
     void initialize(const ir::compat::KernelRef &k, const OptionsRef &opt);
 
+    /**
+     * Resets this past to the state after initialize(), such that it can be
+     * reused for the given kernel of the same platform. Unlike initialize(),
+     * this reuses the resource state and does not touch the qubit mapping,
+     * which should subsequently be set using import_mapping() if needed.
+     */
+    void reset(const ir::compat::KernelRef &k);
+
     /**
      * Copies the given qubit mapping into our mapping.
      */
@@ -243,6 +258,12 @@ public:
      */
     utils::UInt get_num_moves_added() const;
 
+    /**
+     * Returns the total number of cycles that the inter-core gates scheduled
+     * in this past waited for a free inter-core channel.
+     */
+    utils::UInt get_inter_core_stall() const;
+
     /**
      * Returns whether swap(fr0,fr1) starts earlier than swap(sr0,sr1). This is
      * really a short-cut ignoring config file and perhaps several other
@@ -31,10 +31,13 @@ void MapQubitsPass::dump_docs(
     NOTE: the substeps of this pass will probably be subdivided into individual
     passes in the future.
 
-    WARNING: this pass currently operates purely on a per-kernel basis. Because
-    it may adjust the qubit mapping from input to output, a program consisting
-    of multiple kernels that maintains a quantum state between the kernels may
-    be silently destroyed.
+    WARNING: unless inter_kernel_mapping is enabled, this pass operates purely
+    on a per-kernel basis. Because it may adjust the qubit mapping from input
+    to output, a program consisting of multiple kernels that maintains a
+    quantum state between the kernels may then be silently destroyed. With
+    inter_kernel_mapping, the mapping at the end of a kernel is passed on to
+    its successors in the control flow of the program, and transition swaps
+    are added where control flow merges with differing mappings.
 
     * Initial placement *
 
@@ -57,6 +60,15 @@ void MapQubitsPass::dump_docs(
       OpenQL due to license conflicts with the library used for solving the
       MIP problem. If it is not included, the step is effectively no-op, and
       a warning message will be printed.
+
+      Alternatively, a heuristic algorithm can be used to minimize the same
+      objective (enable_heuristic_placer). It considers windows of two-qubit
+      gates in order, weighing each window half as much as the previous one.
+      The qubits that interact in a window are first placed greedily, after
+      which the placement is refined by simulated annealing. The amount of work
+      per window is bounded by a fixed number of iterations, so its result is
+      deterministic, and it scales to large devices and circuits. The result
+      is only used when it is better than the mapping the kernel started with.
 )" R"(
     * Heuristic routing *
 
@@ -168,6 +180,18 @@ MapQubitsPass::MapQubitsPass(
         "quantum state. This allows it to make some optimizations."
     );
 
+    options.add_bool(
+        "inter_kernel_mapping",
+        "Controls whether the qubit mapping is carried across kernel boundaries "
+        "along the control flow of the program. When enabled, each kernel "
+        "starts from the mapping that its predecessor ended with, and "
+        "transition swaps are only added to the end of a kernel when this is "
+        "not possible, for instance at the end of a loop body. This requires "
+        "initialize_one_to_one to be enabled. When disabled, each kernel is "
+        "mapped independently, starting from the initial mapping.",
+        false
+    );
+
     //========================================================================//
     // Options for the MIP initial placement engine                           //
     //========================================================================//
@@ -181,12 +205,54 @@ MapQubitsPass::MapQubitsPass(
 
     options.add_int(
         "mip_horizon",
-        "This controls how many two-qubit gates the MIP-based initial placement "
-        "algorithm considers for each kernel (if enabled). If 0 or unspecified, "
-        "all gates are considered.",
+        "This controls how many two-qubit gates the MIP-based and heuristic "
+        "initial placement algorithms consider for each kernel (if enabled). "
+        "If 0 or unspecified, all gates are considered.",
         "0", 0, utils::MAX
     );
 
+    //========================================================================//
+    // Options for the heuristic initial placement engine                     //
+    //========================================================================//
+
+    options.add_bool(
+        "enable_heuristic_placer",
+        "Controls whether the windowed heuristic initial placement algorithm "
+        "should be run before routing. This algorithm greedily places the "
+        "qubits and refines the placement by simulated annealing, one window "
+        "of two-qubit gates at a time, with gates in later windows weighing "
+        "less. Unlike the MIP-based placer, it scales to large devices and "
+        "circuits. When the MIP-based placer is enabled, this algorithm is "
+        "only used as a fallback, when MIP support is not available in this "
+        "build of OpenQL or when MIP-based placement fails or times out.",
+        false
+    );
+
+    options.add_int(
+        "heuristic_placer_window",
+        "The number of two-qubit gates per window for the heuristic initial "
+        "placement algorithm. Gates in window t weigh 2^-t, and at most 10 "
+        "windows are considered.",
+        "32", 1, utils::MAX
+    );
+
+    options.add_int(
+        "heuristic_placer_iterations",
+        "The number of simulated annealing iterations per window for the "
+        "heuristic initial placement algorithm. Together with the window "
+        "size, this bounds the time spent on placement deterministically.",
+        "10000", 0, utils::MAX
+    );
+
+    options.add_real(
+        "heuristic_placer_timeout",
+        "Timeout in seconds for the heuristic initial placement algorithm, "
+        "after which the best placement found so far is used, or 0 to disable "
+        "the timeout. Note that the resulting placement depends on the speed "
+        "of the machine when the timeout is reached.",
+        "0", 0.0
+    );
+
     //========================================================================//
     // Options controlling the heuristic routing algorithm                    //
     //========================================================================//
@@ -218,6 +284,18 @@ MapQubitsPass::MapQubitsPass(
         0, utils::MAX
     );
 
+    options.add_real(
+        "inter_core_stall_weight",
+        "Only used for multi-core platforms with the `minextendrc` heuristic. "
+        "When nonzero, the score of each alternative routing solution is "
+        "increased by this factor times the number of cycles that its "
+        "inter-core swaps and moves had to wait for a free inter-core "
+        "communication channel, as reported by the resource manager. This "
+        "spreads inter-core communication over time and channels, rather "
+        "than only minimizing the extension of the circuit. 0 disables this.",
+        "0", 0.0
+    );
+
     options.add_enum(
         "tie_break_method",
         "Controls how to tie-break equally-scoring alternative mapping "
@@ -259,6 +337,20 @@ MapQubitsPass::MapQubitsPass(
         {"no", "1qfirst", "noroutingfirst", "all"}
     );
 
+    options.add_int(
+        "lookahead_horizon",
+        "Controls how far ahead of the earliest unmapped gate the dependency "
+        "graph is constructed when `lookahead_mode` is not `no`, in number of "
+        "gates. The graph is extended in steps of this many gates as mapping "
+        "progresses, and the criticality of a gate is determined over at least "
+        "this many gates following it, rather than over the rest of the "
+        "kernel. Smaller values reduce the memory usage for large kernels at "
+        "the cost of a less accurate criticality; `all` constructs the graph "
+        "for the whole kernel at once.",
+        "10000",
+        1, utils::MAX, {"all"}
+    );
+
     options.add_enum(
         "path_selection_mode",
         "Controls whether to consider all paths from a source to destination "
@@ -403,8 +495,13 @@ pmgr::pass_types::NodeType MapQubitsPass::on_construct(
     parsed_options->initialize_one_to_one = options["initialize_one_to_one"].as_bool();
     parsed_options->assume_initialized = options["assume_initialized"].as_bool();
     parsed_options->assume_prep_only_initializes = options["assume_prep_only_initializes"].as_bool();
+    parsed_options->inter_kernel_mapping = options["inter_kernel_mapping"].as_bool();
     parsed_options->enable_mip_placer = options["enable_mip_placer"].as_bool();
     parsed_options->mip_horizon = options["mip_horizon"].as_uint();
+    parsed_options->enable_heuristic_placer = options["enable_heuristic_placer"].as_bool();
+    parsed_options->heuristic_placer_window = options["heuristic_placer_window"].as_uint();
+    parsed_options->heuristic_placer_iterations = options["heuristic_placer_iterations"].as_uint();
+    parsed_options->heuristic_placer_timeout = options["heuristic_placer_timeout"].as_real();
 
     auto route_heuristic = options["route_heuristic"].as_str();
     if (route_heuristic == "base") {
@@ -422,6 +519,7 @@ pmgr::pass_types::NodeType MapQubitsPass::on_construct(
     }
 
     parsed_options->max_alters = options["max_alternative_routes"].as_uint();
+    parsed_options->inter_core_stall_weight = options["inter_core_stall_weight"].as_real();
 
     auto tie_break_method = options["tie_break_method"].as_str();
     if (tie_break_method == "first") {
@@ -449,6 +547,12 @@ pmgr::pass_types::NodeType MapQubitsPass::on_construct(
         QL_ASSERT(false);
     }
 
+    if (options["lookahead_horizon"].as_str() == "all") {
+        parsed_options->lookahead_horizon = 0;
+    } else {
+        parsed_options->lookahead_horizon = options["lookahead_horizon"].as_uint();
+    }
+
     auto path_selection_mode = options["path_selection_mode"].as_str();
     if (path_selection_mode == "all") {
         parsed_options->path_selection_mode = detail::PathSelectionMode::ALL;
@@ -0,0 +1,188 @@
+#include "ql/pass/tests/helpers.h"
+
+using namespace ql;
+using namespace ql::pass::tests;
+
+/**
+ * Returns a kernel on the given platform with CNOTs between distant qubits,
+ * such that mapping it changes the qubit mapping.
+ */
+static ir::compat::KernelRef make_kernel(
+    const ir::compat::PlatformRef &plat,
+    const utils::Str &name,
+    utils::UInt offset
+) {
+    auto kernel = utils::make<ir::compat::Kernel>(name, plat, 17, 32, 32);
+    kernel->cnot(offset, 8 + offset);
+    kernel->cnot(2 + offset, 16 - offset);
+    kernel->cnot(5, 11 + offset);
+    return kernel;
+}
+
+/**
+ * Returns a kernel that acts on all qubits of the given platform, so that
+ * their state is maintained from kernel to kernel.
+ */
+static ir::compat::KernelRef make_prepare(const ir::compat::PlatformRef &plat) {
+    auto prepare = utils::make<ir::compat::Kernel>("prepare", plat, 17, 32, 32);
+    for (utils::UInt q = 0; q < 17; q++) {
+        prepare->x(q);
+    }
+    return prepare;
+}
+
+/**
+ * Returns a kernel that measures all qubits of the given platform.
+ */
+static ir::compat::KernelRef make_finish(const ir::compat::PlatformRef &plat) {
+    auto finish = utils::make<ir::compat::Kernel>("finish", plat, 17, 32, 32);
+    finish->cnot(0, 8);
+    for (utils::UInt q = 0; q < 17; q++) {
+        finish->measure(q);
+    }
+    return finish;
+}
+
+/**
+ * Returns a condition for control-flow constructs.
+ */
+static ir::compat::ClassicalOperation make_condition() {
+    return ir::compat::ClassicalOperation(
+        ir::compat::ClassicalRegister(0), "==", ir::compat::ClassicalRegister(1)
+    );
+}
+
+/**
+ * Builds a program that prepares all qubits, runs a loop body, and then
+ * measures the qubits.
+ */
+static ir::compat::ProgramRef make_for_program(const ir::compat::PlatformRef &plat) {
+    auto program = utils::make<ir::compat::Program>("test_prog", plat, 17, 32, 32);
+    program->add(make_prepare(plat));
+    program->add_for(make_kernel(plat, "body", 0), 10);
+    program->add(make_finish(plat));
+    return program;
+}
+
+/**
+ * Like make_for_program(), but with a do-while loop.
+ */
+static ir::compat::ProgramRef make_do_while_program(const ir::compat::PlatformRef &plat) {
+    auto program = utils::make<ir::compat::Program>("test_prog", plat, 17, 32, 32);
+    program->add(make_prepare(plat));
+    program->add_do_while(make_kernel(plat, "body", 0), make_condition());
+    program->add(make_finish(plat));
+    return program;
+}
+
+/**
+ * Builds a program with an if-else construct, of which the branches route
+ * differently, between the preparation and the measurements.
+ */
+static ir::compat::ProgramRef make_if_else_program(const ir::compat::PlatformRef &plat) {
+    auto program = utils::make<ir::compat::Program>("test_prog", plat, 17, 32, 32);
+    program->add(make_prepare(plat));
+    program->add_if_else(
+        make_kernel(plat, "if_branch", 0),
+        make_kernel(plat, "else_branch", 1),
+        make_condition()
+    );
+    program->add(make_finish(plat));
+    return program;
+}
+
+/**
+ * Builds a program with a do-while loop around a kernel and a nested
+ * do-while loop. The last kernel of the outer body also ends the inner body,
+ * so it has two successors that are mapped before it: itself and the first
+ * kernel of the outer body. These start with different mappings, since the
+ * first kernel of the outer body needs routing.
+ */
+static ir::compat::ProgramRef make_conflicting_program(const ir::compat::PlatformRef &plat) {
+    auto outer = utils::make<ir::compat::Program>("outer", plat, 17, 32, 32);
+    outer->add(make_kernel(plat, "head", 0));
+    outer->add_do_while(make_kernel(plat, "inner", 1), make_condition());
+    auto program = utils::make<ir::compat::Program>("test_prog", plat, 17, 32, 32);
+    program->add(make_prepare(plat));
+    program->add_do_while(outer, make_condition());
+    program->add(make_finish(plat));
+    return program;
+}
+
+/**
+ * Maps the given program with or without inter-kernel mapping, and returns
+ * the resulting program.
+ */
+static ir::compat::ProgramRef map(
+    const ir::compat::ProgramRef &program,
+    utils::Bool inter_kernel
+) {
+    return run_pass(program, "map.qubits.Map", {
+        {"inter_kernel_mapping", inter_kernel ? "yes" : "no"}
+    });
+}
+
+/**
+ * Returns the qubit mapping at the start of the given kernel.
+ */
+static utils::Str get_start_mapping(const ir::compat::ProgramRef &program, const utils::Str &name) {
+    return get_stat(get_kernel(program, name), "virt2real map after initial placement:");
+}
+
+/**
+ * Returns the qubit mapping at the end of the given kernel, including the
+ * transition added by inter-kernel mapping.
+ */
+static utils::Str get_end_mapping(const ir::compat::ProgramRef &program, const utils::Str &name) {
+    return get_stat(get_kernel(program, name), "virt2real map after transition:");
+}
+
+int main() {
+    auto plat = ir::compat::Platform::build("test_plat", utils::Str("cc_light.s17"));
+
+    // The loop body must restore the mapping it started with, so with
+    // inter-kernel mapping a transition is added to it, while the kernel
+    // before the loop needs no more gates than before.
+    auto independent = map(make_for_program(plat), false);
+    auto inter_kernel = map(make_for_program(plat), true);
+    QL_ASSERT(count_gates(inter_kernel) > count_gates(independent));
+    QL_ASSERT_EQ(
+        get_kernel(inter_kernel, "prepare")->gates.size(),
+        get_kernel(independent, "prepare")->gates.size()
+    );
+    QL_ASSERT_EQ(get_end_mapping(inter_kernel, "body"), get_start_mapping(inter_kernel, "body"));
+    QL_ASSERT_EQ(get_end_mapping(inter_kernel, "body"), get_start_mapping(inter_kernel, "finish"));
+    QL_ASSERT_EQ(get_end_mapping(inter_kernel, "prepare"), get_start_mapping(inter_kernel, "body"));
+
+    // Mapping the same program twice must give the same result.
+    auto again = map(make_for_program(plat), true);
+    QL_ASSERT_EQ(count_gates(again), count_gates(inter_kernel));
+    QL_ASSERT_EQ(get_end_mapping(again, "body"), get_end_mapping(inter_kernel, "body"));
+
+    // The same holds for a do-while loop.
+    auto do_while = map(make_do_while_program(plat), true);
+    QL_ASSERT_EQ(get_end_mapping(do_while, "body"), get_start_mapping(do_while, "body"));
+    QL_ASSERT_EQ(get_end_mapping(do_while, "body"), get_start_mapping(do_while, "finish"));
+
+    // Both branches of an if-else construct start with the mapping at the
+    // end of the kernel before it, and end with the mapping that the kernel
+    // after it starts with.
+    auto if_else = map(make_if_else_program(plat), true);
+    QL_ASSERT_EQ(get_start_mapping(if_else, "if_branch"), get_end_mapping(if_else, "prepare"));
+    QL_ASSERT_EQ(get_start_mapping(if_else, "else_branch"), get_end_mapping(if_else, "prepare"));
+    QL_ASSERT_EQ(get_end_mapping(if_else, "if_branch"), get_start_mapping(if_else, "finish"));
+    QL_ASSERT_EQ(get_end_mapping(if_else, "else_branch"), get_start_mapping(if_else, "finish"));
+
+    // A kernel whose successors start with conflicting mappings cannot be
+    // mapped with inter-kernel mapping, but can without it.
+    map(make_conflicting_program(plat), false);
+    utils::Bool conflict = false;
+    try {
+        map(make_conflicting_program(plat), true);
+    } catch (utils::Exception &e) {
+        conflict = utils::Str(e.what()).find("conflict") != utils::Str::npos;
+    }
+    QL_ASSERT(conflict);
+
+    return 0;
+}
@@ -0,0 +1,50 @@
+#include "ql/pass/tests/helpers.h"
+
+using namespace ql;
+using namespace ql::pass::tests;
+
+/**
+ * Builds a program on the 17-qubit platform consisting of the given number of
+ * identical kernels, each of which needs routing.
+ */
+static ir::compat::ProgramRef make_program(
+    const ir::compat::PlatformRef &plat,
+    utils::UInt kernels
+) {
+    auto program = utils::make<ir::compat::Program>("test_prog", plat, 17, 32, 32);
+    for (utils::UInt i = 0; i < kernels; i++) {
+        auto kernel = utils::make<ir::compat::Kernel>(
+            "kernel_" + utils::to_string(i), plat, 17, 32, 32
+        );
+        kernel->x(0);
+        kernel->cnot(0, 8);
+        kernel->cnot(2, 16);
+        kernel->cnot(5, 11);
+        kernel->measure(8);
+        program->add(kernel);
+    }
+    return program;
+}
+
+int main() {
+    auto plat = ir::compat::Platform::build("test_plat", utils::Str("cc_light.s17"));
+
+    // The mapper reuses its state objects from kernel to kernel. Since the
+    // kernels are mapped independently and all start from the same mapping,
+    // identical kernels must give identical results, which would not be the
+    // case if any state (gates, free cycles, reserved resources) leaked from
+    // one kernel into the next.
+    const utils::UInt kernels = 4;
+    auto program = run_pass(make_program(plat, kernels), "map.qubits.Map", {
+        {"route_heuristic", "minextendrc"},
+        {"tie_break_method", "first"}
+    });
+    QL_ASSERT_EQ(program->kernels.size(), kernels);
+    auto first = get_schedule(program->kernels[0]);
+    QL_ASSERT(first.size() > 5);
+    for (const auto &kernel : program->kernels) {
+        QL_ASSERT(get_schedule(kernel) == first);
+    }
+
+    return 0;
+}
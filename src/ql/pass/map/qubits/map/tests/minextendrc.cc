@@ -0,0 +1,57 @@
+#include <random>
+
+#include "ql/pass/tests/helpers.h"
+
+using namespace ql;
+using namespace ql::pass::tests;
+
+/**
+ * Builds a single-kernel program on the 17-qubit platform with random
+ * single-qubit gates and CNOTs between arbitrary qubit pairs, such that the
+ * router has to insert plenty of swaps.
+ */
+static ir::compat::ProgramRef make_program(
+    const ir::compat::PlatformRef &plat,
+    utils::UInt gates
+) {
+    auto program = utils::make<ir::compat::Program>("test_prog", plat, 17, 32, 32);
+    auto kernel = utils::make<ir::compat::Kernel>("test_kernel", plat, 17, 32, 32);
+    program->add(kernel);
+    std::mt19937 rng(42);
+    for (utils::UInt i = 0; i < gates; i++) {
+        utils::UInt q = rng() % 17;
+        if (rng() % 2) {
+            kernel->x(q);
+        } else {
+            kernel->cnot(q, (q + 1 + rng() % 16) % 17);
+        }
+    }
+    return program;
+}
+
+/**
+ * Maps the given program with the resource-constrained minimal-extension
+ * heuristic, and returns the mapped gates with their cycles.
+ */
+static Schedule map(const ir::compat::ProgramRef &program) {
+    return get_schedule(run_pass(program, "map.qubits.Map", {
+        {"route_heuristic", "minextendrc"},
+        {"max_alternative_routes", "4"},
+        {"recursion_depth_limit", "2"}
+    })->kernels[0]);
+}
+
+int main() {
+    auto plat = ir::compat::Platform::build("test_plat", utils::Str("cc_light.s17"));
+
+    // The mapper copies the resource state for every alternative it
+    // considers; those copies must not affect each other, so mapping the same
+    // program twice must give the same result.
+    const utils::UInt gates = 400;
+    auto first = map(make_program(plat, gates));
+    auto second = map(make_program(plat, gates));
+    QL_ASSERT(first == second);
+    QL_ASSERT(first.size() >= gates);
+
+    return 0;
+}
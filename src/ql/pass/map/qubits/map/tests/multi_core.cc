@@ -0,0 +1,90 @@
+#include "ql/pass/tests/helpers.h"
+
+using namespace ql;
+using namespace ql::pass::tests;
+
+/**
+ * Builds a program for the 4-core platform in the style of
+ * tests/test_multi_core.cc, in which the first qubits of all cores interact
+ * with each other a number of times, such that the router has to insert many
+ * inter-core swaps that compete for the inter-core channels.
+ */
+static ir::compat::ProgramRef make_program(
+    const ir::compat::PlatformRef &plat,
+    utils::UInt rounds
+) {
+    auto program = utils::make<ir::compat::Program>("test_prog", plat, 16, 0, 0);
+    auto kernel = utils::make<ir::compat::Kernel>("test_kernel", plat, 16, 0, 0);
+    program->add(kernel);
+    for (utils::UInt i = 0; i < 4; i++) {
+        kernel->x(4*i);
+        kernel->x(4*i + 1);
+    }
+    for (utils::UInt i = 0; i < 4; i++) {
+        kernel->cnot(4*i, 4*i + 1);
+    }
+    for (utils::UInt r = 0; r < rounds; r++) {
+        for (utils::UInt i = 0; i < 4; i++) {
+            for (utils::UInt j = 0; j < 4; j++) {
+                if (i != j) {
+                    kernel->cnot(4*i + r % 2, 4*j);
+                }
+            }
+        }
+    }
+    return program;
+}
+
+/**
+ * Maps the given program with the resource-constrained minimal-extension
+ * heuristic and the given inter-core stall weight, and returns the mapped
+ * gates with their cycles. The latency of the mapped circuit in cycles and
+ * the number of cycles that inter-core gates waited for a free channel are
+ * returned via latency and stall.
+ */
+static Schedule map(
+    const ir::compat::ProgramRef &program,
+    const utils::Str &weight,
+    utils::UInt &latency,
+    utils::UInt &stall
+) {
+    auto kernel = run_pass(program, "map.qubits.Map", {
+        {"route_heuristic", "minextendrc"},
+        {"tie_break_method", "first"},
+        {"inter_core_stall_weight", weight}
+    })->kernels[0];
+    auto ct = kernel->platform->cycle_time;
+    latency = 0;
+    for (const auto &gate : kernel->gates) {
+        latency = utils::max(latency, gate->cycle + (gate->duration + ct - 1) / ct);
+    }
+    stall = utils::parse_uint(get_stat(kernel, "inter-core channel stall cycles: "));
+    return get_schedule(kernel);
+}
+
+int main() {
+    auto plat = ir::compat::Platform::build(
+        "mc4x4full", utils::Str("test_multi_core_4x4_full.json")
+    );
+
+    const utils::UInt rounds = 4;
+    utils::UInt latency_plain, latency_aware, latency_again;
+    utils::UInt stall_plain, stall_aware, stall_again;
+    auto plain = map(make_program(plat, rounds), "0", latency_plain, stall_plain);
+    auto aware = map(make_program(plat, rounds), "1", latency_aware, stall_aware);
+    auto again = map(make_program(plat, rounds), "1", latency_again, stall_again);
+
+    // Channel-aware routing only changes which routes are chosen, so all
+    // gates must still be there, and the result must be deterministic.
+    QL_ASSERT(plain.size() >= 12 * rounds);
+    QL_ASSERT(aware.size() >= 12 * rounds);
+    QL_ASSERT(aware == again);
+
+    // Without channel awareness, the inter-core swaps compete for the
+    // channels, so taking the stalls into account must pay off in either
+    // fewer stall cycles or a shorter circuit.
+    QL_ASSERT(stall_plain > 0);
+    QL_ASSERT(stall_aware < stall_plain || latency_aware < latency_plain);
+
+    return 0;
+}
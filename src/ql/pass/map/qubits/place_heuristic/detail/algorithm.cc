@@ -0,0 +1,501 @@
+/** \file
+ * Heuristic initial placement engine.
+ */
+
+#include "algorithm.h"
+
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <algorithm>
+
+namespace ql {
+namespace pass {
+namespace map {
+namespace qubits {
+namespace place_heuristic {
+namespace detail {
+
+using namespace utils;
+
+/**
+ * String conversion for initial placement results.
+ */
+std::ostream &operator<<(std::ostream &os, Result ipr) {
+    switch (ipr) {
+        case Result::ANY:       os << "any";        break;
+        case Result::CURRENT:   os << "current";    break;
+        case Result::NEW_MAP:   os << "newmap";     break;
+    }
+    return os;
+}
+
+/**
+ * Maximum number of windows that is considered. The gates in later windows
+ * would have a weight below 2^-10.
+ */
+static const UInt MAX_WINDOWS = 10;
+
+/**
+ * Number of annealing iterations between checks of the timeout.
+ */
+static const UInt TIMEOUT_CHECK_INTERVAL = 256;
+
+/**
+ * Placement state for the heuristic: a sparse weighted interaction graph
+ * between virtual qubits, and the current location of each virtual qubit.
+ */
+class Placement {
+public:
+
+    /**
+     * The topology of the platform, providing the distances between
+     * locations.
+     */
+    const com::Topology &topology;
+
+    /**
+     * Number of locations and virtual qubits.
+     */
+    UInt nlocs;
+
+    /**
+     * Weighted interactions of each virtual qubit, without duplicates.
+     */
+    Vec<Vec<std::pair<UInt, Real>>> interactions;
+
+    /**
+     * Location of each virtual qubit, or UNDEFINED_QUBIT if not placed yet.
+     */
+    Vec<UInt> loc_of;
+
+    /**
+     * Virtual qubit at each location, or UNDEFINED_QUBIT if free.
+     */
+    Vec<UInt> virt_at;
+
+    /**
+     * Constructs an empty placement for the given topology.
+     */
+    explicit Placement(const com::Topology &topology) :
+        topology(topology),
+        nlocs(topology.get_num_qubits()),
+        interactions(nlocs),
+        loc_of(nlocs, com::map::UNDEFINED_QUBIT),
+        virt_at(nlocs, com::map::UNDEFINED_QUBIT)
+    {}
+
+    /**
+     * Returns the cost of an interaction between the given two locations,
+     * i.e. their distance minus one, such that nearest-neighbor interactions
+     * cost nothing.
+     */
+    Real cost(UInt k, UInt l) const {
+        if (k == l) return 0.0;
+        return (Real)topology.get_distance(k, l) - 1.0;
+    }
+
+    /**
+     * Adds the given weighted interactions, given as a list of virtual qubit
+     * pairs, to the interaction graph.
+     */
+    void add_interactions(const Vec<std::pair<UInt, UInt>> &pairs, Real weight) {
+        for (const auto &pair : pairs) {
+            interactions[pair.first].emplace_back(pair.second, weight);
+            interactions[pair.second].emplace_back(pair.first, weight);
+        }
+        for (auto &list : interactions) {
+            std::sort(list.begin(), list.end());
+            Vec<std::pair<UInt, Real>> merged;
+            for (const auto &entry : list) {
+                if (!merged.empty() && merged.back().first == entry.first) {
+                    merged.back().second += entry.second;
+                } else {
+                    merged.push_back(entry);
+                }
+            }
+            list = std::move(merged);
+        }
+    }
+
+    /**
+     * Returns the weighted cost of the interactions of virtual qubit virt with
+     * the placed virtual qubits other than skip, if virt were at location loc.
+     */
+    Real cost_at(UInt virt, UInt loc, UInt skip) const {
+        Real total = 0.0;
+        for (const auto &entry : interactions[virt]) {
+            UInt other = entry.first;
+            if (other == skip || loc_of[other] == com::map::UNDEFINED_QUBIT) {
+                continue;
+            }
+            total += entry.second * cost(loc, loc_of[other]);
+        }
+        return total;
+    }
+
+    /**
+     * Returns the change in cost when the contents of the given two locations
+     * would be swapped.
+     */
+    Real swap_delta(UInt p, UInt q) const {
+        UInt a = virt_at[p];
+        UInt b = virt_at[q];
+        Real delta = 0.0;
+        if (a != com::map::UNDEFINED_QUBIT) {
+            delta += cost_at(a, q, b) - cost_at(a, p, b);
+        }
+        if (b != com::map::UNDEFINED_QUBIT) {
+            delta += cost_at(b, p, a) - cost_at(b, q, a);
+        }
+        return delta;
+    }
+
+    /**
+     * Swaps the contents of the given two locations.
+     */
+    void swap(UInt p, UInt q) {
+        UInt a = virt_at[p];
+        UInt b = virt_at[q];
+        virt_at[p] = b;
+        virt_at[q] = a;
+        if (a != com::map::UNDEFINED_QUBIT) loc_of[a] = q;
+        if (b != com::map::UNDEFINED_QUBIT) loc_of[b] = p;
+    }
+
+    /**
+     * Places virtual qubit virt at location loc.
+     */
+    void place(UInt virt, UInt loc) {
+        QL_ASSERT(virt_at[loc] == com::map::UNDEFINED_QUBIT);
+        loc_of[virt] = loc;
+        virt_at[loc] = virt;
+    }
+
+    /**
+     * Returns the total cost of the current placement, for the interactions
+     * between placed qubits.
+     */
+    Real total_cost() const {
+        Real total = 0.0;
+        for (UInt virt = 0; virt < nlocs; virt++) {
+            if (loc_of[virt] != com::map::UNDEFINED_QUBIT) {
+                total += cost_at(virt, loc_of[virt], com::map::UNDEFINED_QUBIT);
+            }
+        }
+        return total / 2.0;
+    }
+
+};
+
+/**
+ * Runs the algorithm to find an initial placement of the virtual qubits for
+ * the given kernel with the given options. v2r is updated when a better
+ * mapping was found.
+ */
+Result Algorithm::run(
+    const ir::compat::KernelRef &k,
+    const Options &opt,
+    com::map::QubitMapping &v2r
+) {
+    using namespace std::chrono;
+
+    // Initialize ourselves for the given kernel.
+    options = opt;
+    kernel = k;
+    platform = kernel->platform;
+    nlocs = platform->qubit_count;
+    iterations = 0;
+    timed_out = false;
+    time_taken = 0.0;
+    auto start_time = steady_clock::now();
+    QL_DOUT("HeuristicPlace.run: nlocs=" << nlocs << " window=" << options.window << " iterations=" << options.iterations);
+
+    // Collect the two-qubit gates per window, up to the horizon and the
+    // maximum number of windows. Also check whether all of them are already
+    // nearest-neighbor in the current mapping.
+    UInt window = max<UInt>(options.window, 1);
+    UInt max_gates = MAX_WINDOWS * window;
+    if (options.horizon != 0) {
+        max_gates = min(max_gates, options.horizon);
+    }
+    Vec<Vec<std::pair<UInt, UInt>>> windows;
+    Vec<Bool> used(nlocs, false);
+    Bool currmap = true;
+    UInt num_gates = 0;
+    for (const auto &gate : kernel->gates) {
+        const auto &q = gate->operands;
+        if (q.size() > 2) {
+            QL_FATAL(" gate: " << gate->qasm() << " has more than 2 operand qubits; please decompose such gates first before mapping.");
+        }
+        if (num_gates >= max_gates) {
+            continue;
+        }
+        for (auto v : q) {
+            used[v] = true;
+        }
+        if (q.size() != 2 || q[0] == q[1]) {
+            continue;
+        }
+        if (num_gates % window == 0) {
+            windows.emplace_back();
+        }
+        windows.back().emplace_back(q[0], q[1]);
+        num_gates++;
+        if (
+            v2r[q[0]] == com::map::UNDEFINED_QUBIT
+            || v2r[q[1]] == com::map::UNDEFINED_QUBIT
+            || platform->topology->get_distance(v2r[q[0]], v2r[q[1]]) > 1
+        ) {
+            currmap = false;
+        }
+    }
+    if (windows.empty()) {
+        QL_DOUT("HeuristicPlace: no two-qubit gates found, so any mapping is ok");
+        return Result::ANY;
+    }
+    if (currmap) {
+        QL_DOUT("HeuristicPlace: in current map, all two-qubit gates are nearest neighbor, so current map is ok");
+        return Result::CURRENT;
+    }
+
+    // Precompute the neighbors of each location.
+    Vec<Vec<UInt>> neighbors(nlocs);
+    for (UInt loc = 0; loc < nlocs; loc++) {
+        for (auto n : platform->topology->get_neighbors(loc)) {
+            neighbors[loc].push_back(n);
+        }
+    }
+
+    // Locations sorted by their total distance to all other locations, used
+    // to seed the placement of qubits that don't interact with placed qubits
+    // near the center of the topology.
+    Placement placement(*platform->topology);
+    Vec<UInt> central_locs(nlocs);
+    Vec<Real> centrality(nlocs, 0.0);
+    for (UInt loc = 0; loc < nlocs; loc++) {
+        central_locs[loc] = loc;
+        for (UInt other = 0; other < nlocs; other++) {
+            centrality[loc] += placement.cost(loc, other);
+        }
+    }
+    std::stable_sort(central_locs.begin(), central_locs.end(), [&](UInt a, UInt b) {
+        return centrality[a] < centrality[b];
+    });
+
+    // Process the windows in order.
+    std::mt19937 rng(0);
+    auto random_real = [&rng]() {
+        return (Real)(rng() - rng.min()) / (Real)(rng.max() - rng.min());
+    };
+    Vec<UInt> active;
+    Real weight = 1.0;
+    for (const auto &pairs : windows) {
+        if (timed_out) break;
+        placement.add_interactions(pairs, weight);
+
+        // Greedily place the qubits that interact for the first time.
+        Vec<UInt> unplaced;
+        for (const auto &pair : pairs) {
+            for (auto virt : {pair.first, pair.second}) {
+                if (placement.loc_of[virt] == com::map::UNDEFINED_QUBIT &&
+                    std::find(unplaced.begin(), unplaced.end(), virt) == unplaced.end()) {
+                    unplaced.push_back(virt);
+                }
+            }
+        }
+        while (!unplaced.empty()) {
+
+            // Pick the qubit with the strongest interaction with the placed
+            // qubits, or with the strongest interaction overall if none of
+            // them interact with placed qubits.
+            UInt best_idx = 0;
+            Real best_attached = -1.0;
+            Real best_total = -1.0;
+            for (UInt idx = 0; idx < unplaced.size(); idx++) {
+                Real attached = 0.0;
+                Real total = 0.0;
+                for (const auto &entry : placement.interactions[unplaced[idx]]) {
+                    total += entry.second;
+                    if (placement.loc_of[entry.first] != com::map::UNDEFINED_QUBIT) {
+                        attached += entry.second;
+                    }
+                }
+                if (attached > best_attached || (attached == best_attached && total > best_total)) {
+                    best_idx = idx;
+                    best_attached = attached;
+                    best_total = total;
+                }
+            }
+            UInt virt = unplaced[best_idx];
+            unplaced.erase(unplaced.begin() + best_idx);
+
+            // Place it at the free location that minimizes its cost, breaking
+            // ties by centrality.
+            UInt best_loc = com::map::UNDEFINED_QUBIT;
+            Real best_cost = 0.0;
+            for (auto loc : central_locs) {
+                if (placement.virt_at[loc] != com::map::UNDEFINED_QUBIT) continue;
+                Real cost = placement.cost_at(virt, loc, com::map::UNDEFINED_QUBIT);
+                if (best_loc == com::map::UNDEFINED_QUBIT || cost < best_cost) {
+                    best_loc = loc;
+                    best_cost = cost;
+                }
+            }
+            QL_ASSERT(best_loc != com::map::UNDEFINED_QUBIT);
+            placement.place(virt, best_loc);
+            active.push_back(virt);
+
+        }
+
+        // Refine the placement by simulated annealing. The temperature starts
+        // at the cost of one additional hop for a gate in this window, and
+        // decreases geometrically.
+        Real cost = placement.total_cost();
+        Real best_cost = cost;
+        Vec<UInt> best_loc_of = placement.loc_of;
+        Real start_temp = weight;
+        Real end_temp = weight * 0.01;
+        for (UInt it = 0; it < options.iterations; it++) {
+            if (options.timeout > 0.0 && it % TIMEOUT_CHECK_INTERVAL == 0) {
+                duration<Real> elapsed = steady_clock::now() - start_time;
+                if (elapsed.count() > options.timeout) {
+                    timed_out = true;
+                    break;
+                }
+            }
+            iterations++;
+
+            // Propose to move a random interacting qubit next to one of its
+            // partners, or to a random location.
+            UInt virt = active[rng() % active.size()];
+            UInt p = placement.loc_of[virt];
+            UInt q;
+            const auto &partners = placement.interactions[virt];
+            if (rng() % 2 && !partners.empty()) {
+                UInt partner = partners[rng() % partners.size()].first;
+                const auto &near = neighbors[placement.loc_of[partner]];
+                if (near.empty()) continue;
+                q = near[rng() % near.size()];
+            } else {
+                q = rng() % nlocs;
+            }
+            if (q == p) continue;
+
+            // Accept or reject the move.
+            Real delta = placement.swap_delta(p, q);
+            Real temp = start_temp * std::pow(end_temp / start_temp, (Real)it / (Real)options.iterations);
+            if (delta <= 0.0 || random_real() < std::exp(-delta / temp)) {
+                placement.swap(p, q);
+                cost += delta;
+                if (cost < best_cost - 1e-9) {
+                    best_cost = cost;
+                    best_loc_of = placement.loc_of;
+                }
+            }
+
+        }
+
+        // Continue from the best placement found.
+        for (UInt loc = 0; loc < nlocs; loc++) {
+            placement.virt_at[loc] = com::map::UNDEFINED_QUBIT;
+        }
+        for (UInt virt = 0; virt < nlocs; virt++) {
+            placement.loc_of[virt] = best_loc_of[virt];
+            if (best_loc_of[virt] != com::map::UNDEFINED_QUBIT) {
+                placement.virt_at[best_loc_of[virt]] = virt;
+            }
+        }
+
+        weight /= 2.0;
+    }
+    Real cost = placement.total_cost();
+
+    // Compare with the current mapping, if it places all interacting qubits.
+    Bool current_complete = true;
+    for (auto virt : active) {
+        if (v2r[virt] == com::map::UNDEFINED_QUBIT) {
+            current_complete = false;
+        }
+    }
+    Real current_cost = 0.0;
+    if (current_complete) {
+        for (auto virt : active) {
+            for (const auto &entry : placement.interactions[virt]) {
+                current_cost += entry.second * placement.cost(v2r[virt], v2r[entry.first]);
+            }
+        }
+        current_cost /= 2.0;
+    }
+
+    duration<Real> elapsed = steady_clock::now() - start_time;
+    time_taken = elapsed.count();
+    QL_DOUT("HeuristicPlace: cost=" << cost << " current cost=" << current_cost << " iterations=" << iterations << " timed out=" << timed_out << " time taken=" << time_taken);
+    if (current_complete && cost >= current_cost) {
+        QL_DOUT("HeuristicPlace: no better placement found, so current map is kept");
+        return Result::CURRENT;
+    }
+
+    // Return the new mapping in v2r. Virtual qubits that are used but not
+    // placed (because they only appear in single-qubit gates or beyond the
+    // considered windows) or, with map_all, unused virtual qubits are kept at
+    // their current location if that is still free, or otherwise moved to
+    // the first free location.
+    Vec<UInt> previous = v2r.get_virt_to_real();
+    for (UInt virt = 0; virt < nlocs; virt++) {
+        v2r[virt] = placement.loc_of[virt];
+    }
+    for (UInt pass = 0; pass < 2; pass++) {
+        UInt free_loc = 0;
+        for (UInt virt = 0; virt < nlocs; virt++) {
+            if (placement.loc_of[virt] != com::map::UNDEFINED_QUBIT) continue;
+            if (!used[virt] && !options.map_all) continue;
+            UInt loc = previous[virt];
+            if (pass == 0) {
+                if (loc != com::map::UNDEFINED_QUBIT && placement.virt_at[loc] == com::map::UNDEFINED_QUBIT) {
+                    placement.place(virt, loc);
+                    v2r[virt] = loc;
+                }
+            } else {
+                while (placement.virt_at[free_loc] != com::map::UNDEFINED_QUBIT) {
+                    free_loc++;
+                }
+                placement.place(virt, free_loc);
+                v2r[virt] = free_loc;
+            }
+        }
+    }
+    QL_IF_LOG_DEBUG {
+        QL_DOUT("... final result Virt2Real map of HeuristicPlace");
+        v2r.dump_state();
+    }
+    return Result::NEW_MAP;
+}
+
+/**
+ * Returns the amount of time taken by the call to run() in seconds.
+ */
+Real Algorithm::get_time_taken() const {
+    return time_taken;
+}
+
+/**
+ * Returns the number of annealing iterations performed by the call to run().
+ */
+UInt Algorithm::get_iterations() const {
+    return iterations;
+}
+
+/**
+ * Returns whether the call to run() stopped because of the timeout.
+ */
+Bool Algorithm::is_timed_out() const {
+    return timed_out;
+}
+
+} // namespace detail
+} // namespace place_heuristic
+} // namespace qubits
+} // namespace map
+} // namespace pass
+} // namespace ql
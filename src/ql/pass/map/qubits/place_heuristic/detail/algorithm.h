@@ -0,0 +1,193 @@
+/** \file
+ * Heuristic initial placement engine.
+ *
+ * This is a scalable alternative to the MIP-based initial placement engine in
+ * place_mip, with the same interface. It minimizes the same objective, i.e.
+ * the sum over all considered two-qubit gates of the distance between the
+ * locations of their operands (minus one, such that nearest-neighbor gates
+ * cost nothing), but it does so heuristically, and with memory and time that
+ * scale linearly with the number of considered gates and qubits rather than
+ * quadratically or worse.
+ *
+ * The two-qubit gates of the kernel are split into windows of a configurable
+ * number of gates. The gates in window t are weighted with 2^-t, such that the
+ * placement is primarily optimized for the start of the kernel, leaving the
+ * rest to routing; windows with a weight below 2^-10 are not considered at
+ * all. The windows are then processed in order:
+ *
+ *  - the virtual qubits that interact for the first time in the window are
+ *    placed greedily: the qubit with the strongest interaction with the
+ *    already-placed qubits is placed first, at the free location that
+ *    minimizes its weighted distance to them;
+ *  - the placement is then refined by simulated annealing over the weights of
+ *    all windows considered so far, where a move swaps the contents of two
+ *    locations (one of which may be empty).
+ *
+ * The amount of work is bounded by a fixed number of annealing iterations per
+ * window, and optionally by a timeout. The timeout is checked cooperatively
+ * by the annealing loop, after which the best placement found so far is
+ * used. The random number generator is seeded with a fixed value, so the
+ * result is deterministic as long as the timeout is not reached. The result
+ * is only used when it is better than the mapping that was passed in.
+ */
+
+#pragma once
+
+#include "ql/utils/num.h"
+#include "ql/utils/str.h"
+#include "ql/utils/vec.h"
+#include "ql/ir/compat/compat.h"
+#include "ql/com/map/qubit_mapping.h"
+
+namespace ql {
+namespace pass {
+namespace map {
+namespace qubits {
+namespace place_heuristic {
+namespace detail {
+
+/**
+ * Options structure for configuring the heuristic initial placement
+ * algorithm.
+ */
+struct Options {
+
+    /**
+     * The placement algorithm will only consider the connectivity required to
+     * perform the first horizon two-qubit gates of a kernel. 0 means that all
+     * gates should be considered (subject to the window weighting).
+     */
+    utils::UInt horizon = 0;
+
+    /**
+     * Number of two-qubit gates per window.
+     */
+    utils::UInt window = 32;
+
+    /**
+     * Number of simulated annealing iterations per window.
+     */
+    utils::UInt iterations = 10000;
+
+    /**
+     * Timeout for the algorithm in seconds, or 0 to disable timeout. When the
+     * timeout is reached, the best placement found so far is used.
+     */
+    utils::Real timeout = 0.0;
+
+    /**
+     * When set, any virtual qubits not used in the original kernel will also
+     * be mapped to real qubits.
+     */
+    utils::Bool map_all = false;
+
+};
+
+/**
+ * Enumeration of the possible algorithm outcomes.
+ */
+enum class Result {
+
+    /**
+     * Any mapping will do, because there are no two-qubit gates in the circuit.
+     */
+    ANY,
+
+    /**
+     * The current mapping will do, because all two-qubit gates are
+     * nearest-neighbor, or because no better placement was found.
+     */
+    CURRENT,
+
+    /**
+     * The placement algorithm found a mapping that is better than the current
+     * one for the considered two-qubit gates.
+     */
+    NEW_MAP
+
+};
+
+/**
+ * String conversion for initial placement results.
+ */
+std::ostream &operator<<(std::ostream &os, Result ipr);
+
+/**
+ * Heuristic initial placement algorithm.
+ */
+class Algorithm {
+private:
+
+    /**
+     * The options that we're being called with.
+     */
+    Options options;
+
+    /**
+     * Reference to the kernel we're operating on.
+     */
+    ir::compat::KernelRef kernel;
+
+    /**
+     * Shorthand reference for the platform corresponding to the kernel.
+     */
+    ir::compat::PlatformRef platform;
+
+    /**
+     * Number of locations (real qubits), which is also the number of virtual
+     * qubits.
+     */
+    utils::UInt nlocs = 0;
+
+    /**
+     * Total number of annealing iterations performed by run().
+     */
+    utils::UInt iterations = 0;
+
+    /**
+     * Whether the timeout was reached by run().
+     */
+    utils::Bool timed_out = false;
+
+    /**
+     * Total time taken by run() in seconds.
+     */
+    utils::Real time_taken = 0.0;
+
+public:
+
+    /**
+     * Runs the algorithm to find an initial placement of the virtual qubits for
+     * the given kernel with the given options. v2r is updated when a better
+     * mapping was found.
+     */
+    Result run(
+        const ir::compat::KernelRef &k,
+        const Options &opt,
+        com::map::QubitMapping &v2r
+    );
+
+    /**
+     * Returns the amount of time taken by the call to run() in seconds.
+     */
+    utils::Real get_time_taken() const;
+
+    /**
+     * Returns the number of annealing iterations performed by the call to
+     * run().
+     */
+    utils::UInt get_iterations() const;
+
+    /**
+     * Returns whether the call to run() stopped because of the timeout.
+     */
+    utils::Bool is_timed_out() const;
+
+};
+
+} // namespace detail
+} // namespace place_heuristic
+} // namespace qubits
+} // namespace map
+} // namespace pass
+} // namespace ql
@@ -0,0 +1,125 @@
+#include "ql/ir/compat/compat.h"
+#include "ql/com/map/qubit_mapping.h"
+#include "../detail/algorithm.h"
+
+using namespace ql;
+using pass::map::qubits::place_heuristic::detail::Algorithm;
+using pass::map::qubits::place_heuristic::detail::Options;
+using pass::map::qubits::place_heuristic::detail::Result;
+
+/**
+ * Returns the cost of the given mapping for the two-qubit gates of the given
+ * kernel, i.e. the sum of the distances between their operands minus one.
+ */
+static utils::UInt cost(const ir::compat::KernelRef &kernel, const com::map::QubitMapping &v2r) {
+    utils::UInt total = 0;
+    for (const auto &gate : kernel->gates) {
+        if (gate->operands.size() == 2) {
+            total += kernel->platform->topology->get_distance(
+                v2r[gate->operands[0]], v2r[gate->operands[1]]
+            ) - 1;
+        }
+    }
+    return total;
+}
+
+/**
+ * Asserts that the given mapping maps all placed qubits to distinct real
+ * qubits. Qubits that are not used by the kernel may remain unplaced.
+ */
+static void check_valid(const com::map::QubitMapping &v2r, utils::UInt num_qubits) {
+    utils::Vec<utils::Bool> taken(num_qubits, false);
+    for (utils::UInt virt = 0; virt < num_qubits; virt++) {
+        if (v2r[virt] == com::map::UNDEFINED_QUBIT) continue;
+        QL_ASSERT(v2r[virt] < num_qubits);
+        QL_ASSERT(!taken[v2r[virt]]);
+        taken[v2r[virt]] = true;
+    }
+}
+
+/**
+ * Runs the heuristic placer for the given kernel with the given options,
+ * starting from the one-to-one mapping.
+ */
+static Result place(
+    const ir::compat::KernelRef &kernel,
+    const Options &options,
+    com::map::QubitMapping &v2r,
+    Algorithm &algorithm
+) {
+    v2r = com::map::QubitMapping(kernel->platform->qubit_count, true);
+    return algorithm.run(kernel, options, v2r);
+}
+
+int main() {
+
+    // On the 7-qubit surface code grid, qubit 3 is connected to 0, 1, 5, and
+    // 6, and the remaining edges are 0-2, 2-5, 1-4, and 4-6. Under the
+    // one-to-one mapping, none of the gates below are nearest-neighbor, but
+    // a placement exists for which they all are.
+    auto plat = ir::compat::Platform::build("test_plat", utils::Str("cc_light"));
+    auto kernel = utils::make<ir::compat::Kernel>("kernel", plat, 7, 32, 10);
+    kernel->cnot(0, 1);
+    kernel->cnot(0, 6);
+    kernel->cnot(2, 4);
+    com::map::QubitMapping v2r;
+    Algorithm algorithm;
+    Options options;
+    auto identity = com::map::QubitMapping(7, true);
+    QL_ASSERT_EQ(cost(kernel, identity), 5u);
+
+    // Greedy placement alone already improves on the one-to-one mapping.
+    options.iterations = 0;
+    QL_ASSERT(place(kernel, options, v2r, algorithm) == Result::NEW_MAP);
+    check_valid(v2r, 7);
+    auto greedy_cost = cost(kernel, v2r);
+    QL_ASSERT(greedy_cost < 5u);
+    QL_ASSERT_EQ(algorithm.get_iterations(), 0u);
+
+    // Annealing finds the optimal placement.
+    options.iterations = 10000;
+    QL_ASSERT(place(kernel, options, v2r, algorithm) == Result::NEW_MAP);
+    check_valid(v2r, 7);
+    QL_ASSERT_EQ(cost(kernel, v2r), 0u);
+    QL_ASSERT(!algorithm.is_timed_out());
+    QL_ASSERT_EQ(algorithm.get_iterations(), 10000u);
+
+    // The result is deterministic under the iteration budget.
+    auto first = v2r.get_virt_to_real();
+    place(kernel, options, v2r, algorithm);
+    QL_ASSERT(v2r.get_virt_to_real() == first);
+
+    // With a horizon of one gate, only the first gate is considered.
+    options.horizon = 1;
+    QL_ASSERT(place(kernel, options, v2r, algorithm) == Result::NEW_MAP);
+    check_valid(v2r, 7);
+    QL_ASSERT_EQ(plat->topology->get_distance(v2r[0], v2r[1]), 1u);
+    options.horizon = 0;
+
+    // When the timeout is reached, the annealing loop stops early, and the
+    // best placement found so far is used.
+    options.iterations = 1000000000;
+    options.timeout = 1e-9;
+    place(kernel, options, v2r, algorithm);
+    QL_ASSERT(algorithm.is_timed_out());
+    QL_ASSERT(algorithm.get_iterations() < options.iterations);
+    check_valid(v2r, 7);
+    QL_ASSERT(cost(kernel, v2r) <= greedy_cost);
+    options.iterations = 10000;
+    options.timeout = 0.0;
+
+    // Without two-qubit gates any mapping will do, and when all of them are
+    // already nearest-neighbor the current mapping is kept.
+    auto single = utils::make<ir::compat::Kernel>("single", plat, 7, 32, 10);
+    single->x(0);
+    single->y(4);
+    QL_ASSERT(place(single, options, v2r, algorithm) == Result::ANY);
+    QL_ASSERT(v2r.get_virt_to_real() == identity.get_virt_to_real());
+    auto nearest = utils::make<ir::compat::Kernel>("nearest", plat, 7, 32, 10);
+    nearest->cnot(0, 3);
+    nearest->cnot(4, 6);
+    QL_ASSERT(place(nearest, options, v2r, algorithm) == Result::CURRENT);
+    QL_ASSERT(v2r.get_virt_to_real() == identity.get_virt_to_real());
+
+    return 0;
+}
@@ -10,6 +10,8 @@
 #include <mutex>
 #include <condition_variable>
 #include <lemon/lp.h>
+#include "ql/utils/logger.h"
+#include "ql/com/options.h"
 
 namespace ql {
 namespace pass {
@@ -446,8 +448,12 @@ Bool Algorithm::wrapper(com::map::QubitMapping &v2r) {
     time_taken = waitseconds;    // pessimistic, in case of timeout, otherwise it is corrected*/
 
     // v2r and result are allocated on stack of main thread by some ancestor so be careful with threading
-    std::thread t([&cv, this, &v2r]()
+    utils::logger::Context *log_context = utils::logger::get_context();
+    utils::Options *options = &com::options::current();
+    std::thread t([&cv, this, &v2r, log_context, options]()
         {
+            utils::logger::Scope log_scope(log_context);
+            com::options::Scope options_scope(options);
             QL_DOUT("InitialPlace.wrapper subthread about to call body");
             result = body(v2r);
             QL_DOUT("InitialPlace.body returned in subthread; about to signal the main thread");
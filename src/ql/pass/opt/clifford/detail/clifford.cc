@@ -4,8 +4,11 @@
 
 #include "clifford.h"
 
+#include <algorithm>
+#include <unordered_map>
 #include "ql/utils/num.h"
-#include "ql/com/options.h"
+#include "ql/ir/ops.h"
+#include "ql/ir/describe.h"
 
 namespace ql {
 namespace pass {
@@ -17,26 +20,73 @@ namespace detail {
 using namespace utils;
 
 /**
- * Create gate sequences for all accumulated cliffords, output them and
- * reset state.
+ * Clifford state transition table.
+ *
+ * [from state][accumulating sequence represented as state] => new state
+ */
+const Int Clifford::TRANSITION_TABLE[24][24] = {
+    {  0, 1, 2, 3, 4, 5, 6, 7, 8, 9,10,11,12,13,14,15,16,17,18,19,20,21,22,23 },
+    {  1, 2, 0,10,11, 9, 4, 5, 3, 7, 8, 6,23,21,22,14,12,13,20,18,19,17,15,16 },
+    {  2, 0, 1, 8, 6, 7,11, 9,10, 5, 3, 4,16,17,15,22,23,21,19,20,18,13,14,12 },
+    {  3, 4, 5, 0, 1, 2, 9,10,11, 6, 7, 8,15,16,17,12,13,14,21,22,23,18,19,20 },
+    {  4, 5, 3, 7, 8, 6, 1, 2, 0,10,11, 9,20,18,19,17,15,16,23,21,22,14,12,13 },
+    {  5, 3, 4,11, 9,10, 8, 6, 7, 2, 0, 1,13,14,12,19,20,18,22,23,21,16,17,15 },
+    {  6, 7, 8, 9,10,11, 0, 1, 2, 3, 4, 5,18,19,20,21,22,23,12,13,14,15,16,17 },
+    {  7, 8, 6, 4, 5, 3,10,11, 9, 1, 2, 0,17,15,16,20,18,19,14,12,13,23,21,22 },
+    {  8, 6, 7, 2, 0, 1, 5, 3, 4,11, 9,10,22,23,21,16,17,15,13,14,12,19,20,18 },
+    {  9,10,11, 6, 7, 8, 3, 4, 5, 0, 1, 2,21,22,23,18,19,20,15,16,17,12,13,14 },
+    { 10,11, 9, 1, 2, 0, 7, 8, 6, 4, 5, 3,14,12,13,23,21,22,17,15,16,20,18,19 },
+    { 11, 9,10, 5, 3, 4, 2, 0, 1, 8, 6, 7,19,20,18,13,14,12,16,17,15,22,23,21 },
+    { 12,13,14,21,22,23,18,19,20,15,16,17, 0, 1, 2, 9,10,11, 6, 7, 8, 3, 4, 5 },
+    { 13,14,12,16,17,15,22,23,21,19,20,18, 5, 3, 4, 2, 0, 1, 8, 6, 7,11, 9,10 },
+    { 14,12,13,20,18,19,17,15,16,23,21,22,10,11, 9, 4, 5, 3, 7, 8, 6, 1, 2, 0 },
+    { 15,16,17,18,19,20,21,22,23,12,13,14, 3, 4, 5, 6, 7, 8, 9,10,11, 0, 1, 2 },
+    { 16,17,15,13,14,12,19,20,18,22,23,21, 2, 0, 1, 5, 3, 4,11, 9,10, 8, 6, 7 },
+    { 17,15,16,23,21,22,14,12,13,20,18,19, 7, 8, 6, 1, 2, 0,10,11, 9, 4, 5, 3 },
+    { 18,19,20,15,16,17,12,13,14,21,22,23, 6, 7, 8, 3, 4, 5, 0, 1, 2, 9,10,11 },
+    { 19,20,18,22,23,21,16,17,15,13,14,12,11, 9,10, 8, 6, 7, 2, 0, 1, 5, 3, 4 },
+    { 20,18,19,14,12,13,23,21,22,17,15,16, 4, 5, 3,10,11, 9, 1, 2, 0, 7, 8, 6 },
+    { 21,22,23,12,13,14,15,16,17,18,19,20, 9,10,11, 0, 1, 2, 3, 4, 5, 6, 7, 8 },
+    { 22,23,21,19,20,18,13,14,12,16,17,15, 8, 6, 7,11, 9,10, 5, 3, 4, 2, 0, 1 },
+    { 23,21,22,17,15,16,20,18,19,14,12,13, 1, 2, 0, 7, 8, 6, 4, 5, 3,10,11, 9 }
+};
+
+/**
+ * Create gate sequences for all accumulated cliffords, output them to the
+ * given block in the given cycle and reset state.
  */
-void Clifford::sync_all(const ir::compat::KernelRef &k) {
+void Clifford::sync_all(const ir::BlockBaseRef &block, Int cycle) {
     QL_DOUT("... sync_all");
-    for (UInt q = 0; q < nq; q++) {
-        sync(k, q);
+
+    // Only qubits with pending state can generate gates. Sort them to emit
+    // the sequences in the same order as a scan over all qubits would.
+    std::sort(pending_qubits.begin(), pending_qubits.end());
+    for (auto q : pending_qubits) {
+        sync(block, cycle, q);
     }
+    pending_qubits.clear();
     QL_DOUT("... sync_all DONE");
 }
 
 /**
- * Create gate sequence for accumulated cliffords of qubit q, output it and
- * reset state.
+ * Create gate sequence for accumulated cliffords of qubit q, output it to
+ * the given block in the given cycle and reset state.
  */
-void Clifford::sync(const ir::compat::KernelRef &k, UInt q) {
+void Clifford::sync(const ir::BlockBaseRef &block, Int cycle, UInt q) {
+    if (!pending[q]) {
+        return;
+    }
+    pending[q] = false;
     Int csq = cliffstate[q];
     if (csq != 0) {
         QL_DOUT("... sync q[" << q << "]: generating clifford " << cs2string(csq));
-        k->clifford(csq, q);          // generates clifford(csq) in kernel.c
+        for (const auto &name : cs2gates(csq)) {
+            Any<ir::Expression> operands;
+            operands.add(ir::make_qubit_ref(ir, q));
+            auto insn = ir::make_instruction(ir, name, operands);
+            insn->cycle = cycle;
+            block->statements.add(insn);
+        }
         UInt  acc_cycles = cliffcycles[q];
         UInt  ins_cycles = cs2cycles(csq);
         QL_DOUT("... qubit q[" << q << "]: accumulated: " << acc_cycles << ", inserted: " << ins_cycles);
@@ -49,42 +99,68 @@ void Clifford::sync(const ir::compat::KernelRef &k, UInt q) {
 }
 
 /**
- * Find the clifford state from identity to given gate, or return -1 if
- * unknown or the gate is not in C1.
+ * Find the clifford state from identity to given instruction, or return -1 if
+ * unknown or the instruction is not in C1.
  *
- * TODO: this currently infers the Clifford index by gate name; instead
+ * TODO: this currently infers the Clifford index by instruction name; instead
  *  semantics like this should be in the config file somehow.
  */
-Int Clifford::gate2cs(const ir::compat::GateRef &gate) {
-    auto gname = gate->name;
-    if (gname == "identity")         return 0;
-    else if (gname == "i")           return 0;
-    else if (gname == "pauli_x")     return 3;
-    else if (gname == "x")           return 3;
-    else if (gname == "rx180")       return 3;
-    else if (gname == "pauli_y")     return 6;
-    else if (gname == "y")           return 6;
-    else if (gname == "ry180")       return 6;
-    else if (gname == "pauli_z")     return 9;
-    else if (gname == "z")           return 9;
-    else if (gname == "rz180")       return 9;
-    else if (gname == "hadamard")    return 12;
-    else if (gname == "h")           return 12;
-    else if (gname == "xm90")        return 13;
-    else if (gname == "mrx90")       return 13;
-    else if (gname == "s")           return 14;
-    else if (gname == "zm90")        return 14;
-    else if (gname == "mrz90")       return 14;
-    else if (gname == "ym90")        return 15;
-    else if (gname == "mry90")       return 15;
-    else if (gname == "x90")         return 16;
-    else if (gname == "rx90")        return 16;
-    else if (gname == "y90")         return 21;
-    else if (gname == "ry90")        return 21;
-    else if (gname == "sdag")        return 23;
-    else if (gname == "z90")         return 23;
-    else if (gname == "rz90")        return 23;
-    else return -1;
+Int Clifford::gate2cs(const ir::CustomInstruction &insn) {
+    static const std::unordered_map<Str, Int> NAME_TO_CS = {
+        { "identity",  0 }, { "i",        0 },
+        { "pauli_x",   3 }, { "x",        3 }, { "rx180",  3 },
+        { "pauli_y",   6 }, { "y",        6 }, { "ry180",  6 },
+        { "pauli_z",   9 }, { "z",        9 }, { "rz180",  9 },
+        { "hadamard", 12 }, { "h",       12 },
+        { "xm90",     13 }, { "mrx90",   13 },
+        { "s",        14 }, { "zm90",    14 }, { "mrz90", 14 },
+        { "ym90",     15 }, { "mry90",   15 },
+        { "x90",      16 }, { "rx90",    16 },
+        { "y90",      21 }, { "ry90",    21 },
+        { "sdag",     23 }, { "z90",     23 }, { "rz90",  23 }
+    };
+    auto it = NAME_TO_CS.find(insn.instruction_type->name);
+    if (it == NAME_TO_CS.end()) {
+        return -1;
+    }
+    return it->second;
+}
+
+/**
+ * Returns the names of the gates in the minimal sequence for the given
+ * clifford state.
+ */
+const Vec<Str> &Clifford::cs2gates(Int cs) {
+    static const Vec<Vec<Str>> CS_TO_GATES = {
+        {},                                 // 0: ['I']
+        { "ry90", "rx90" },                 // 1: ['Y90', 'X90']
+        { "mrx90", "mry90" },               // 2: ['mX90', 'mY90']
+        { "rx180" },                        // 3: ['X180']
+        { "mry90", "mrx90" },               // 4: ['mY90', 'mX90']
+        { "rx90", "mry90" },                // 5: ['X90', 'mY90']
+        { "ry180" },                        // 6: ['Y180']
+        { "mry90", "rx90" },                // 7: ['mY90', 'X90']
+        { "rx90", "ry90" },                 // 8: ['X90', 'Y90']
+        { "rx180", "ry180" },               // 9: ['X180', 'Y180']
+        { "ry90", "mrx90" },                // 10: ['Y90', 'mX90']
+        { "mrx90", "ry90" },                // 11: ['mX90', 'Y90']
+        { "ry90", "rx180" },                // 12: ['Y90', 'X180']
+        { "mrx90" },                        // 13: ['mX90']
+        { "rx90", "mry90", "mrx90" },       // 14: ['X90', 'mY90', 'mX90']
+        { "mry90" },                        // 15: ['mY90']
+        { "rx90" },                         // 16: ['X90']
+        { "rx90", "ry90", "rx90" },         // 17: ['X90', 'Y90', 'X90']
+        { "mry90", "rx180" },               // 18: ['mY90', 'X180']
+        { "rx90", "ry180" },                // 19: ['X90', 'Y180']
+        { "rx90", "mry90", "rx90" },        // 20: ['X90', 'mY90', 'X90']
+        { "ry90" },                         // 21: ['Y90']
+        { "mrx90", "ry180" },               // 22: ['mX90', 'Y180']
+        { "rx90", "ry90", "mrx90" }         // 23: ['X90', 'Y90', 'mX90']
+    };
+    if (cs < 0 || cs >= (Int)CS_TO_GATES.size()) {
+        QL_ICE("invalid clifford state " << cs);
+    }
+    return CS_TO_GATES[cs];
 }
 
 /**
@@ -156,104 +232,177 @@ Str Clifford::cs2string(Int cs) {
 }
 
 /**
- * Optimizes the given kernel, returning how many cycles were saved.
+ * Returns the qubits of the main qubit register operated on by the given
+ * instruction. Returns false if the qubits cannot be determined, for instance
+ * because a qubit is indexed dynamically, in which case the instruction must
+ * be treated as if it affects all qubits.
  */
-utils::UInt Clifford::optimize_kernel(const ir::compat::KernelRef &kernel) {
-    QL_DOUT("clifford_optimize_kernel()");
+Bool Clifford::get_qubits(
+    const ir::InstructionRef &insn,
+    Vec<UInt> &qubits
+) const {
+    qubits.clear();
+    for (const auto &operand : ir::get_operands(insn)) {
+        if (auto ref = operand->as_reference()) {
+            if (
+                ref->target == ir->platform->qubits &&
+                ref->data_type == ir->platform->qubits->data_type
+            ) {
+                if (ref->indices.size() != 1 || !ref->indices[0]->as_int_literal()) {
+                    return false;
+                }
+                qubits.push_back(ref->indices[0]->as_int_literal()->value);
+            }
+        }
+    }
+    return true;
+}
 
-    nq = kernel->qubit_count;
-    ct = kernel->platform->cycle_time;
-    QL_DOUT("Clifford optimizer on kernel " << kernel->name << " ...");
+/**
+ * Constructs a Clifford optimizer for the given IR.
+ */
+Clifford::Clifford(const ir::Ref &ir) :
+    ir(ir),
+    cliffstate(ir::get_num_qubits(ir), 0),      // 0 is identity; for all qubits accumulated state is set to identity
+    cliffcycles(ir::get_num_qubits(ir), 0),     // for all qubits, no accumulated cycles
+    pending(ir::get_num_qubits(ir), false),     // no qubits have accumulated state yet
+    pending_qubits(),
+    total_saved(0)                              // just for reporting
+{}
 
-    // copy circuit kernel.c to take input from;
-    // output will fill kernel.c again
-    auto input_gates = kernel->gates;
-    kernel->gates.reset();
+/**
+ * Optimizes the given block, including its structured control-flow
+ * sub-blocks, returning how many cycles were saved.
+ */
+utils::UInt Clifford::optimize_block(const ir::BlockBaseRef &block) {
+    QL_DOUT("Clifford optimizer on block ...");
+    UInt saved_before = total_saved;
 
-    cliffstate.resize(nq, 0);       // 0 is identity; for all qubits accumulated state is set to identity
-    cliffcycles.resize(nq, 0);      // for all qubits, no accumulated cycles
-    total_saved = 0;                // reset saved, just for reporting
+    // Take the statements out of the block to take input from; output will
+    // fill the (now empty) block again.
+    Vec<ir::StatementRef> input;
+    input.reserve(block->statements.size());
+    for (const auto &statement : block->statements) {
+        input.push_back(statement);
+    }
+    block->statements.reset();
 
     /*
     The main idea of this optimization is that there are 24 clifford gates and these form a group,
     i.e. any sequence of clifford gates is in effect equivalent to one clifford from the group.
 
-    Make a linear scan from begin to end over the circuit;
+    Make a linear scan from begin to end over the block;
     attempt to find sequences of consecutive clifford gates operating on qubit q;
     these series can be interwoven, so have to be found in parallel.
     Each sequence can potentially be replaced by an equivalent shorter one from the group of 24 cliffords,
     reducing the number of cycles that the sequence takes, the circuit latency and the gate count.
 
     The clifford group is represented by:
-    - Int string2cs(Str gname): the clifford state of a gate with the given name; identity is 0
-    - a state diagram clifftrans[24][24] that represents for two given clifford (sequences),
+    - Int gate2cs(insn): the clifford state of an instruction, by the name of its type; identity is 0
+    - a state diagram TRANSITION_TABLE[24][24] that represents for two given clifford (sequences),
       to which clifford the combination is equivalent to;
-      so clifford(sequence1; sequence2) == clifftrans[clifford(sequence1)][clifford(sequence2)].
+      so clifford(sequence1; sequence2) == TRANSITION_TABLE[clifford(sequence1)][clifford(sequence2)].
     - UInt cs2cycles(Int cs): the minimum number of cycles needed to implement a clifford of state cs
-    - void k.clifford(Int csq, UInt q): generates minimal clifford sequence for state csq and qubit q
+    - cs2gates(Int cs): the names of the gates of the minimal sequence for state cs
 
     Therefore, maintain for each qubit q while scanning:
     - cliffstate[q]:    clifford state of sequence until now per qubit; initially identity
     - cliffcycles[q]:   number of cycles of the sequence until now per qubit; initially 0
     Each time a clifford c is encountered for qubit q, the clifford c is incorporated into cliffstate[q]
-    by making the transition: cliffstate[q] = clifftrans[cliffstate[q]][string2cs(c)],
+    by making the transition: cliffstate[q] = TRANSITION_TABLE[cliffstate[q]][gate2cs(c)],
     and updating cliffcycles[q].
-    And when finding a gate that ends a sequence of cliffords ('synchronization point'),
-    the minimal sequence corresponding to the accumulated sequence is output before the new gate.
+    And when finding a statement that ends a sequence of cliffords ('synchronization point'),
+    the minimal sequence corresponding to the accumulated sequence is output before the new statement,
+    in the same cycle.
 
-    While scanning the circuit having accumulated the clifford state, for each next gate split out:
-    - those potentially affecting all qubits: push out all state, clearing all accumulated state
+    While scanning the block having accumulated the clifford state, for each next statement split out:
+    - those potentially affecting all qubits: push out all state, clearing all accumulated state;
+      these are all statements other than custom instructions, and custom instructions without
+      (known) qubit operands; structured control-flow sub-blocks are then optimized independently
     - those affecting a particular set of qubits: for those qubits, push out state, clearing their state
     - those affecting a single qubit but not being a clifford: push out state for that qubit, clearing it
     - those affecting a single qubit and being a conditional gate: push out state for that qubit, clearing it
     - remaining case is a single qubit clifford: add it to the state
     */
-    for (const auto &gate : input_gates) {
-        QL_DOUT("... gate: " << gate->qasm());
+    Int cycle = 0;
+    Vec<UInt> qubits;
+    for (const auto &statement : input) {
+        QL_DOUT("... statement: " << ir::describe(*statement));
+        cycle = statement->cycle;
 
+        auto insn = statement->as_custom_instruction();
         if (
-            gate->type() == ir::compat::GateType::CLASSICAL       // classical gates (really being pessimistic here about these)
-            || gate->operands.empty()                             // gates without operands which may affect ALL qubits
+            !insn                                                   // non-gate statements (really being pessimistic here about these)
+            || !get_qubits(statement.as<ir::Instruction>(), qubits) // gates with dynamically indexed qubits
+            || qubits.empty()                                       // gates without qubit operands which may affect ALL qubits
         ) {
             // sync all qubits: create gate sequences corresponding to what was accumulated in cliffstate, for all qubits
-            sync_all(kernel);
-            kernel->gates.add(gate);
-        } else if (gate->operands.size() != 1) {                 // gates like CNOT/CZ/TOFFOLI
+            sync_all(block, cycle);
+            block->statements.add(statement);
+
+            // the state is now clear, so the bodies of structured control-flow
+            // statements can be optimized with the same state vectors
+            if (auto if_else = statement->as_if_else()) {
+                for (const auto &branch : if_else->branches) {
+                    optimize_block(branch->body);
+                }
+                if (!if_else->otherwise.empty()) {
+                    optimize_block(if_else->otherwise);
+                }
+            } else if (auto loop = statement->as_loop()) {
+                optimize_block(loop->body);
+            }
+
+        } else if (qubits.size() != 1) {                           // gates like CNOT/CZ/TOFFOLI
             // sync particular qubits: create gate sequences corresponding to what was accumulated in cliffstate, for those particular operand qubits
-            for (auto q : gate->operands) {
-                sync(kernel, q);
+            for (auto q : qubits) {
+                sync(block, cycle, q);
             }
-            kernel->gates.add(gate);
+            block->statements.add(statement);
         } else {
             // unary quantum gates like x/y/z/h/xm90/y90/s/wait/meas/prepz
-            UInt q = gate->operands[0];
-            Int cs = gate2cs(gate);
+            UInt q = qubits[0];
+            Int cs = gate2cs(*insn);
+            auto blit = insn->condition->as_bit_literal();
             if (
-                cs == -1                                        // non-clifford unary gates (wait, meas, prepz, ...)
-                || gate->is_conditional()                         // conditional unary (clifford) gates
+                cs == -1                                            // non-clifford unary gates (wait, meas, prepz, ...)
+                || !blit || !blit->value                            // conditional unary (clifford) gates
             ) {
                 // sync particular single qubit: create gate sequence corresponding to what was accumulated in cliffstate, for this particular operand qubit
-                QL_DOUT("... unary gate not a clifford gate or conditional: " << gate->qasm());
-                sync(kernel, q);
-                kernel->gates.add(gate);
+                QL_DOUT("... unary gate not a clifford gate or conditional: " << ir::describe(*statement));
+                sync(block, cycle, q);
+                block->statements.add(statement);
             } else {
                 // unary quantum clifford gates like x/y/z/h/xm90/y90/s/...
                 // don't emit gate but accumulate gate in cliffstate
                 // also record accumulated cycles to compute savings
-                cliffcycles[q] += (gate->duration + ct - 1) / ct;
+                cliffcycles[q] += ir::get_duration_of_instruction(statement.as<ir::Instruction>());
+                if (!pending[q]) {
+                    pending[q] = true;
+                    if (pending_qubits.size() >= 2 * pending.size()) {
+                        // Drop the qubits that were synced individually since
+                        // the last sync_all() to keep this list bounded.
+                        pending_qubits.erase(
+                            std::remove_if(
+                                pending_qubits.begin(), pending_qubits.end(),
+                                [this](UInt pq) { return !pending[pq]; }
+                            ),
+                            pending_qubits.end()
+                        );
+                    }
+                    pending_qubits.push_back(q);
+                }
                 Int csq = cliffstate[q];
                 QL_DOUT("... from " << cs2string(csq) << " to " << cs2string(TRANSITION_TABLE[csq][cs]));
                 cliffstate[q] = TRANSITION_TABLE[csq][cs];
             }
         }
-        QL_DOUT("... gate: " << gate->qasm() << " DONE");
     }
-    sync_all(kernel);
-    kernel->cycles_valid = false;
+    sync_all(block, cycle);
 
-    QL_DOUT("Clifford optimizer on kernel " << kernel->name << " saved " << total_saved << " cycles [DONE]");
+    QL_DOUT("Clifford optimizer on block saved " << (total_saved - saved_before) << " cycles [DONE]");
 
-    return total_saved;
+    return total_saved - saved_before;
 }
 
 } // namespace detail
@@ -5,8 +5,9 @@
 #pragma once
 
 #include "ql/utils/num.h"
+#include "ql/utils/str.h"
 #include "ql/utils/vec.h"
-#include "ql/ir/compat/compat.h"
+#include "ql/ir/ir.h"
 
 namespace ql {
 namespace pass {
@@ -22,14 +23,10 @@ class Clifford {
 private:
 
     /**
-     * Shorthand for the number of qubits in the kernel.
+     * The IR that the block being optimized belongs to, used to construct the
+     * replacement gates.
      */
-    utils::UInt nq;
-
-    /**
-     * Shorthand for the platform's cycle time in nanoseconds.
-     */
-    utils::UInt ct;
+    ir::Ref ir;
 
     /**
      * Current accumulated Clifford state per qubit.
@@ -42,62 +39,57 @@ private:
     utils::Vec<utils::UInt> cliffcycles;
 
     /**
-     * Total number of cycles saved per kernel.
+     * Whether qubit q has accumulated Clifford state that has not been synced
+     * yet. Mirrors pending_qubits for O(1) membership tests.
+     */
+    utils::Vec<utils::Bool> pending;
+
+    /**
+     * The qubits that have accumulated Clifford state that has not been synced
+     * yet. This allows sync_all() to only visit the qubits that were actually
+     * touched since the previous synchronization point, rather than all qubits
+     * in the program.
+     */
+    utils::Vec<utils::UInt> pending_qubits;
+
+    /**
+     * Total number of cycles saved since the optimizer was constructed.
      */
     utils::UInt total_saved;
 
     /**
-     * Create gate sequences for all accumulated cliffords, output them and
-     * reset state.
+     * Create gate sequences for all accumulated cliffords, output them to the
+     * given block in the given cycle and reset state.
      */
-    void sync_all(const ir::compat::KernelRef &k);
+    void sync_all(const ir::BlockBaseRef &block, utils::Int cycle);
 
     /**
-     * Create gate sequence for accumulated cliffords of qubit q, output it and
-     * reset state.
+     * Create gate sequence for accumulated cliffords of qubit q, output it to
+     * the given block in the given cycle and reset state.
      */
-    void sync(const ir::compat::KernelRef &k, utils::UInt q);
+    void sync(const ir::BlockBaseRef &block, utils::Int cycle, utils::UInt q);
 
     /**
      * Clifford state transition table.
      *
      * [from state][accumulating sequence represented as state] => new state
      */
-    const utils::Int TRANSITION_TABLE[24][24] = {
-        {  0, 1, 2, 3, 4, 5, 6, 7, 8, 9,10,11,12,13,14,15,16,17,18,19,20,21,22,23 },
-        {  1, 2, 0,10,11, 9, 4, 5, 3, 7, 8, 6,23,21,22,14,12,13,20,18,19,17,15,16 },
-        {  2, 0, 1, 8, 6, 7,11, 9,10, 5, 3, 4,16,17,15,22,23,21,19,20,18,13,14,12 },
-        {  3, 4, 5, 0, 1, 2, 9,10,11, 6, 7, 8,15,16,17,12,13,14,21,22,23,18,19,20 },
-        {  4, 5, 3, 7, 8, 6, 1, 2, 0,10,11, 9,20,18,19,17,15,16,23,21,22,14,12,13 },
-        {  5, 3, 4,11, 9,10, 8, 6, 7, 2, 0, 1,13,14,12,19,20,18,22,23,21,16,17,15 },
-        {  6, 7, 8, 9,10,11, 0, 1, 2, 3, 4, 5,18,19,20,21,22,23,12,13,14,15,16,17 },
-        {  7, 8, 6, 4, 5, 3,10,11, 9, 1, 2, 0,17,15,16,20,18,19,14,12,13,23,21,22 },
-        {  8, 6, 7, 2, 0, 1, 5, 3, 4,11, 9,10,22,23,21,16,17,15,13,14,12,19,20,18 },
-        {  9,10,11, 6, 7, 8, 3, 4, 5, 0, 1, 2,21,22,23,18,19,20,15,16,17,12,13,14 },
-        { 10,11, 9, 1, 2, 0, 7, 8, 6, 4, 5, 3,14,12,13,23,21,22,17,15,16,20,18,19 },
-        { 11, 9,10, 5, 3, 4, 2, 0, 1, 8, 6, 7,19,20,18,13,14,12,16,17,15,22,23,21 },
-        { 12,13,14,21,22,23,18,19,20,15,16,17, 0, 1, 2, 9,10,11, 6, 7, 8, 3, 4, 5 },
-        { 13,14,12,16,17,15,22,23,21,19,20,18, 5, 3, 4, 2, 0, 1, 8, 6, 7,11, 9,10 },
-        { 14,12,13,20,18,19,17,15,16,23,21,22,10,11, 9, 4, 5, 3, 7, 8, 6, 1, 2, 0 },
-        { 15,16,17,18,19,20,21,22,23,12,13,14, 3, 4, 5, 6, 7, 8, 9,10,11, 0, 1, 2 },
-        { 16,17,15,13,14,12,19,20,18,22,23,21, 2, 0, 1, 5, 3, 4,11, 9,10, 8, 6, 7 },
-        { 17,15,16,23,21,22,14,12,13,20,18,19, 7, 8, 6, 1, 2, 0,10,11, 9, 4, 5, 3 },
-        { 18,19,20,15,16,17,12,13,14,21,22,23, 6, 7, 8, 3, 4, 5, 0, 1, 2, 9,10,11 },
-        { 19,20,18,22,23,21,16,17,15,13,14,12,11, 9,10, 8, 6, 7, 2, 0, 1, 5, 3, 4 },
-        { 20,18,19,14,12,13,23,21,22,17,15,16, 4, 5, 3,10,11, 9, 1, 2, 0, 7, 8, 6 },
-        { 21,22,23,12,13,14,15,16,17,18,19,20, 9,10,11, 0, 1, 2, 3, 4, 5, 6, 7, 8 },
-        { 22,23,21,19,20,18,13,14,12,16,17,15, 8, 6, 7,11, 9,10, 5, 3, 4, 2, 0, 1 },
-        { 23,21,22,17,15,16,20,18,19,14,12,13, 1, 2, 0, 7, 8, 6, 4, 5, 3,10,11, 9 }
-    };
-
-    /**
-     * Find the clifford state from identity to given gate, or return -1 if
-     * unknown or the gate is not in C1.
+    static const utils::Int TRANSITION_TABLE[24][24];
+
+    /**
+     * Find the clifford state from identity to given instruction, or return -1
+     * if unknown or the instruction is not in C1.
      *
-     * TODO: this currently infers the Clifford index by gate name; instead
-     *  semantics like this should be in the config file somehow.
+     * TODO: this currently infers the Clifford index by instruction name;
+     *  instead semantics like this should be in the config file somehow.
      */
-    static utils::Int gate2cs(const ir::compat::GateRef &gate);
+    static utils::Int gate2cs(const ir::CustomInstruction &insn);
+
+    /**
+     * Returns the names of the gates in the minimal sequence for the given
+     * clifford state.
+     */
+    static const utils::Vec<utils::Str> &cs2gates(utils::Int cs);
 
     /**
      * Find the duration of the gate sequence corresponding to given clifford
@@ -114,12 +106,29 @@ private:
      */
     static utils::Str cs2string(utils::Int cs);
 
+    /**
+     * Returns the qubits of the main qubit register operated on by the given
+     * instruction. Returns false if the qubits cannot be determined, for
+     * instance because a qubit is indexed dynamically, in which case the
+     * instruction must be treated as if it affects all qubits.
+     */
+    utils::Bool get_qubits(
+        const ir::InstructionRef &insn,
+        utils::Vec<utils::UInt> &qubits
+    ) const;
+
 public:
 
     /**
-     * Optimizes the given kernel, returning how many cycles were saved.
+     * Constructs a Clifford optimizer for the given IR.
+     */
+    explicit Clifford(const ir::Ref &ir);
+
+    /**
+     * Optimizes the given block, including its structured control-flow
+     * sub-blocks, returning how many cycles were saved.
      */
-    utils::UInt optimize_kernel(const ir::compat::KernelRef &kernel);
+    utils::UInt optimize_block(const ir::BlockBaseRef &block);
 
 };
 
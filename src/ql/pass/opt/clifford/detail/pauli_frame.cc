@@ -0,0 +1,414 @@
+/** \file
+ * Pauli frame tracking optimizer.
+ */
+
+#include "pauli_frame.h"
+
+#include "ql/utils/num.h"
+#include "ql/utils/logger.h"
+
+namespace ql {
+namespace pass {
+namespace opt {
+namespace clifford {
+namespace pauli_frame {
+namespace detail {
+
+using namespace utils;
+
+/**
+ * Number of qubits stored per word of the bit-packed rows.
+ */
+static const UInt WORD_BITS = 64;
+
+/**
+ * Constructs an identity frame for the given number of qubits.
+ */
+PauliFrame::PauliFrame(UInt num_qubits) {
+    reset(num_qubits);
+}
+
+/**
+ * Resets the frame to identity for the given number of qubits.
+ */
+void PauliFrame::reset(UInt num_qubits) {
+    UInt num_words = (num_qubits + WORD_BITS - 1) / WORD_BITS;
+    x_row.assign(num_words, 0);
+    z_row.assign(num_words, 0);
+}
+
+/**
+ * Returns the X component of the frame for qubit q.
+ */
+Bool PauliFrame::get_x(UInt q) const {
+    return (x_row[q / WORD_BITS] >> (q % WORD_BITS)) & 1u;
+}
+
+/**
+ * Returns the Z component of the frame for qubit q.
+ */
+Bool PauliFrame::get_z(UInt q) const {
+    return (z_row[q / WORD_BITS] >> (q % WORD_BITS)) & 1u;
+}
+
+/**
+ * Returns whether the frame is identity for qubit q.
+ */
+Bool PauliFrame::is_identity(UInt q) const {
+    return !get_x(q) && !get_z(q);
+}
+
+/**
+ * Returns whether the frame is identity for all qubits.
+ */
+Bool PauliFrame::is_identity() const {
+    for (UInt w = 0; w < x_row.size(); w++) {
+        if (x_row[w] | z_row[w]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Returns the qubits for which the frame is not identity, in ascending
+ * order.
+ */
+Vec<UInt> PauliFrame::get_active_qubits() const {
+    Vec<UInt> qubits;
+    for (UInt w = 0; w < x_row.size(); w++) {
+        UInt word = x_row[w] | z_row[w];
+        for (UInt b = 0; word; b++, word >>= 1) {
+            if (word & 1u) {
+                qubits.push_back(w * WORD_BITS + b);
+            }
+        }
+    }
+    return qubits;
+}
+
+/**
+ * Clears the X and/or Z component of the frame for qubit q.
+ */
+void PauliFrame::clear(UInt q, Bool x, Bool z) {
+    UInt mask = ~(UInt(1) << (q % WORD_BITS));
+    if (x) x_row[q / WORD_BITS] &= mask;
+    if (z) z_row[q / WORD_BITS] &= mask;
+}
+
+/**
+ * Multiplies the frame with the Pauli X^x Z^z on qubit q.
+ */
+void PauliFrame::apply_pauli(UInt q, Bool x, Bool z) {
+    x_row[q / WORD_BITS] ^= UInt(x) << (q % WORD_BITS);
+    z_row[q / WORD_BITS] ^= UInt(z) << (q % WORD_BITS);
+}
+
+/**
+ * Conjugates the frame by a Hadamard-like gate on qubit q, i.e. a gate
+ * that exchanges X and Z up to sign.
+ */
+void PauliFrame::apply_hadamard(UInt q) {
+    Bool x = get_x(q);
+    Bool z = get_z(q);
+    clear(q);
+    apply_pauli(q, z, x);
+}
+
+/**
+ * Conjugates the frame by a phase-like gate on qubit q, i.e. a gate that
+ * maps X to Y and Z to Z up to sign.
+ */
+void PauliFrame::apply_phase(UInt q) {
+    apply_pauli(q, false, get_x(q));
+}
+
+/**
+ * Conjugates the frame by a sqrt(X)-like gate on qubit q, i.e. a gate that
+ * maps X to X and Z to Y up to sign.
+ */
+void PauliFrame::apply_sqrt_x(UInt q) {
+    apply_pauli(q, get_z(q), false);
+}
+
+/**
+ * Conjugates the frame by a CNOT with the given control and target.
+ *
+ * X on the control propagates to the target, and Z on the target
+ * propagates to the control.
+ */
+void PauliFrame::apply_cnot(UInt control, UInt target) {
+    Bool xc = get_x(control);
+    Bool zt = get_z(target);
+    apply_pauli(target, xc, false);
+    apply_pauli(control, false, zt);
+}
+
+/**
+ * Conjugates the frame by a CZ on the given qubits.
+ *
+ * X on either qubit picks up a Z on the other.
+ */
+void PauliFrame::apply_cz(UInt a, UInt b) {
+    Bool xa = get_x(a);
+    Bool xb = get_x(b);
+    apply_pauli(a, false, xb);
+    apply_pauli(b, false, xa);
+}
+
+/**
+ * Conjugates the frame by a SWAP on the given qubits.
+ */
+void PauliFrame::apply_swap(UInt a, UInt b) {
+    Bool xa = get_x(a);
+    Bool za = get_z(a);
+    Bool xb = get_x(b);
+    Bool zb = get_z(b);
+    clear(a);
+    clear(b);
+    apply_pauli(a, xb, zb);
+    apply_pauli(b, xa, za);
+}
+
+/**
+ * Classifies the given gate by name.
+ *
+ * TODO: like the Clifford optimizer, this infers semantics by gate name;
+ *  this should be in the config file somehow.
+ */
+const GateInfo &PauliFrameOptimizer::classify(const ir::compat::GateRef &gate) {
+    static const std::unordered_map<Str, GateInfo> NAME_TO_INFO = {
+        { "x",        { GateClass::PAULI, true, false } },
+        { "pauli_x",  { GateClass::PAULI, true, false } },
+        { "rx180",    { GateClass::PAULI, true, false } },
+        { "x180",     { GateClass::PAULI, true, false } },
+        { "y",        { GateClass::PAULI, true, true } },
+        { "pauli_y",  { GateClass::PAULI, true, true } },
+        { "ry180",    { GateClass::PAULI, true, true } },
+        { "y180",     { GateClass::PAULI, true, true } },
+        { "z",        { GateClass::PAULI, false, true } },
+        { "pauli_z",  { GateClass::PAULI, false, true } },
+        { "rz180",    { GateClass::PAULI, false, true } },
+        { "i",        { GateClass::IDENTITY, false, false } },
+        { "identity", { GateClass::IDENTITY, false, false } },
+        { "h",        { GateClass::HADAMARD_LIKE, false, false } },
+        { "hadamard", { GateClass::HADAMARD_LIKE, false, false } },
+        { "y90",      { GateClass::HADAMARD_LIKE, false, false } },
+        { "ry90",     { GateClass::HADAMARD_LIKE, false, false } },
+        { "ym90",     { GateClass::HADAMARD_LIKE, false, false } },
+        { "my90",     { GateClass::HADAMARD_LIKE, false, false } },
+        { "mry90",    { GateClass::HADAMARD_LIKE, false, false } },
+        { "s",        { GateClass::PHASE_LIKE, false, false } },
+        { "sdag",     { GateClass::PHASE_LIKE, false, false } },
+        { "z90",      { GateClass::PHASE_LIKE, false, false } },
+        { "rz90",     { GateClass::PHASE_LIKE, false, false } },
+        { "zm90",     { GateClass::PHASE_LIKE, false, false } },
+        { "mrz90",    { GateClass::PHASE_LIKE, false, false } },
+        { "x90",      { GateClass::SQRT_X_LIKE, false, false } },
+        { "rx90",     { GateClass::SQRT_X_LIKE, false, false } },
+        { "xm90",     { GateClass::SQRT_X_LIKE, false, false } },
+        { "mx90",     { GateClass::SQRT_X_LIKE, false, false } },
+        { "mrx90",    { GateClass::SQRT_X_LIKE, false, false } },
+        { "cnot",     { GateClass::CNOT, false, false } },
+        { "cx",       { GateClass::CNOT, false, false } },
+        { "cz",       { GateClass::CZ, false, false } },
+        { "cphase",   { GateClass::CZ, false, false } },
+        { "swap",     { GateClass::SWAP, false, false } },
+        { "t",        { GateClass::DIAGONAL, false, false } },
+        { "tdag",     { GateClass::DIAGONAL, false, false } },
+        { "rz",       { GateClass::DIAGONAL, false, false } },
+        { "measure",  { GateClass::DIAGONAL, false, false } },
+        { "measz",    { GateClass::DIAGONAL, false, false } },
+        { "prepz",    { GateClass::PREPARE, false, false } },
+        { "prep_z",   { GateClass::PREPARE, false, false } },
+        { "prepx",    { GateClass::PREPARE, false, false } },
+        { "prep_x",   { GateClass::PREPARE, false, false } },
+        { "prepy",    { GateClass::PREPARE, false, false } },
+        { "prep_y",   { GateClass::PREPARE, false, false } }
+    };
+    static const GateInfo OTHER_INFO = { GateClass::OTHER, false, false };
+
+    auto it = info_cache.find(gate->name);
+    if (it != info_cache.end()) {
+        return it->second;
+    }
+
+    // Specialized custom gates carry their operands in the name (e.g.
+    // "x q0"), so only look at the part before the first space.
+    auto base_name = gate->name.substr(0, gate->name.find(' '));
+    auto it2 = NAME_TO_INFO.find(base_name);
+    const auto &info = it2 != NAME_TO_INFO.end() ? it2->second : OTHER_INFO;
+    return info_cache.emplace(gate->name, info).first->second;
+}
+
+/**
+ * Emits the pending frame for qubit q into the kernel and clears it. If
+ * x_only is set, only the X component is flushed, and any Z component is
+ * kept in the frame.
+ */
+void PauliFrameOptimizer::flush(
+    const ir::compat::KernelRef &kernel,
+    UInt q,
+    Bool x_only
+) {
+    Bool x = frame.get_x(q);
+    Bool z = frame.get_z(q) && !x_only;
+    if (x && z) {
+        QL_DOUT("... flushing y on q[" << q << "]");
+        kernel->y(q);
+    } else if (x) {
+        QL_DOUT("... flushing x on q[" << q << "]");
+        kernel->x(q);
+    } else if (z) {
+        QL_DOUT("... flushing z on q[" << q << "]");
+        kernel->z(q);
+    }
+    frame.clear(q, true, !x_only);
+}
+
+/**
+ * Emits the pending frame for all qubits into the kernel and clears it.
+ */
+void PauliFrameOptimizer::flush_all(const ir::compat::KernelRef &kernel) {
+    for (auto q : frame.get_active_qubits()) {
+        flush(kernel, q);
+    }
+}
+
+/**
+ * Optimizes the given kernel, returning how many gates were removed. The
+ * kernel is only modified if this reduces its gate count.
+ */
+UInt PauliFrameOptimizer::optimize_kernel(const ir::compat::KernelRef &kernel) {
+    QL_DOUT("Pauli frame optimizer on kernel " << kernel->name << " ...");
+    frame.reset(kernel->qubit_count);
+
+    /*
+    The frame represents a Pauli operator that still has to be applied after
+    all gates emitted thus far. Pauli gates are multiplied into the frame
+    instead of being emitted. Clifford gates are emitted as-is, and the frame is
+    conjugated through them; since the frame is a Pauli and the gate is a
+    Clifford, the result is again a Pauli. For all other gates, the frame is
+    flushed for the operands, i.e. emitted as X, Y, or Z gates before the gate
+    itself, such that it is applied at the correct point. Pauli gates that
+    meet up in the frame thus cancel, even when they are separated by
+    multi-qubit Clifford gates.
+    */
+    auto cycles_valid = kernel->cycles_valid;
+    ir::compat::GateRefs input_gates;
+    input_gates.get_vec().swap(kernel->gates.get_vec());
+    kernel->gates.get_vec().reserve(input_gates.size());
+    for (const auto &gate : input_gates) {
+        QL_DOUT("... gate: " << gate->qasm());
+
+        // Classical gates and gates without operands may affect all qubits.
+        if (
+            gate->type() == ir::compat::GateType::CLASSICAL
+            || gate->operands.empty()
+        ) {
+            flush_all(kernel);
+            kernel->gates.add(gate);
+            continue;
+        }
+
+        // Conditional gates cannot be conjugated through, as the frame would
+        // then depend on the condition.
+        if (gate->is_conditional()) {
+            for (auto q : gate->operands) {
+                flush(kernel, q);
+            }
+            kernel->gates.add(gate);
+            continue;
+        }
+
+        const auto &info = classify(gate);
+        auto num_operands = gate->operands.size();
+        auto gate_class = info.gate_class;
+        switch (gate_class) {
+            case GateClass::CNOT:
+            case GateClass::CZ:
+            case GateClass::SWAP:
+                if (num_operands != 2) gate_class = GateClass::OTHER;
+                break;
+            case GateClass::OTHER:
+                break;
+            default:
+                if (num_operands != 1) gate_class = GateClass::OTHER;
+                break;
+        }
+
+        const auto &ops = gate->operands;
+        switch (gate_class) {
+            case GateClass::PAULI:
+                frame.apply_pauli(ops[0], info.x, info.z);
+                break;
+            case GateClass::IDENTITY:
+                kernel->gates.add(gate);
+                break;
+            case GateClass::HADAMARD_LIKE:
+                frame.apply_hadamard(ops[0]);
+                kernel->gates.add(gate);
+                break;
+            case GateClass::PHASE_LIKE:
+                frame.apply_phase(ops[0]);
+                kernel->gates.add(gate);
+                break;
+            case GateClass::SQRT_X_LIKE:
+                frame.apply_sqrt_x(ops[0]);
+                kernel->gates.add(gate);
+                break;
+            case GateClass::CNOT:
+                frame.apply_cnot(ops[0], ops[1]);
+                kernel->gates.add(gate);
+                break;
+            case GateClass::CZ:
+                frame.apply_cz(ops[0], ops[1]);
+                kernel->gates.add(gate);
+                break;
+            case GateClass::SWAP:
+                frame.apply_swap(ops[0], ops[1]);
+                kernel->gates.add(gate);
+                break;
+            case GateClass::DIAGONAL:
+                flush(kernel, ops[0], true);
+                kernel->gates.add(gate);
+                break;
+            case GateClass::PREPARE:
+                frame.clear(ops[0]);
+                kernel->gates.add(gate);
+                break;
+            case GateClass::OTHER:
+                for (auto q : ops) {
+                    flush(kernel, q);
+                }
+                kernel->gates.add(gate);
+                break;
+        }
+    }
+    flush_all(kernel);
+
+    // Pushing Paulis through the circuit can also increase the gate count,
+    // for instance when they end up being flushed on more qubits than they
+    // started on. Keep the original kernel in that case.
+    if (kernel->gates.size() >= input_gates.size()) {
+        QL_DOUT(
+            "Pauli frame optimizer on kernel " << kernel->name
+            << " did not reduce gate count; keeping original [DONE]"
+        );
+        kernel->gates.get_vec().swap(input_gates.get_vec());
+        kernel->cycles_valid = cycles_valid;
+        return 0;
+    }
+
+    UInt removed = input_gates.size() - kernel->gates.size();
+    kernel->cycles_valid = false;
+    QL_DOUT("Pauli frame optimizer on kernel " << kernel->name << " removed " << removed << " gates [DONE]");
+    return removed;
+}
+
+} // namespace detail
+} // namespace pauli_frame
+} // namespace clifford
+} // namespace opt
+} // namespace pass
+} // namespace ql
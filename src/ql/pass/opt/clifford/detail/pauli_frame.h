@@ -0,0 +1,268 @@
+/** \file
+ * Pauli frame tracking optimizer.
+ */
+
+#pragma once
+
+#include <unordered_map>
+#include "ql/utils/num.h"
+#include "ql/utils/str.h"
+#include "ql/utils/vec.h"
+#include "ql/ir/compat/compat.h"
+
+namespace ql {
+namespace pass {
+namespace opt {
+namespace clifford {
+namespace pauli_frame {
+namespace detail {
+
+/**
+ * A Pauli operator on each qubit of a register, represented as the X and Z
+ * rows of a stabilizer tableau. The rows are bit-packed, 64 qubits per word.
+ * Sign bits are not tracked; conjugating a Pauli by a Clifford only changes
+ * the sign, which is a global phase as far as the frame is concerned.
+ *
+ * The Pauli on qubit q is X^x(q) Z^z(q), so x = z = 1 represents Y.
+ */
+class PauliFrame {
+private:
+
+    /**
+     * Bit-packed X row of the frame.
+     */
+    utils::Vec<utils::UInt> x_row;
+
+    /**
+     * Bit-packed Z row of the frame.
+     */
+    utils::Vec<utils::UInt> z_row;
+
+public:
+
+    /**
+     * Constructs an identity frame for the given number of qubits.
+     */
+    explicit PauliFrame(utils::UInt num_qubits = 0);
+
+    /**
+     * Resets the frame to identity for the given number of qubits.
+     */
+    void reset(utils::UInt num_qubits);
+
+    /**
+     * Returns the X component of the frame for qubit q.
+     */
+    utils::Bool get_x(utils::UInt q) const;
+
+    /**
+     * Returns the Z component of the frame for qubit q.
+     */
+    utils::Bool get_z(utils::UInt q) const;
+
+    /**
+     * Returns whether the frame is identity for qubit q.
+     */
+    utils::Bool is_identity(utils::UInt q) const;
+
+    /**
+     * Returns whether the frame is identity for all qubits.
+     */
+    utils::Bool is_identity() const;
+
+    /**
+     * Returns the qubits for which the frame is not identity, in ascending
+     * order.
+     */
+    utils::Vec<utils::UInt> get_active_qubits() const;
+
+    /**
+     * Clears the X and/or Z component of the frame for qubit q.
+     */
+    void clear(utils::UInt q, utils::Bool x = true, utils::Bool z = true);
+
+    /**
+     * Multiplies the frame with the Pauli X^x Z^z on qubit q.
+     */
+    void apply_pauli(utils::UInt q, utils::Bool x, utils::Bool z);
+
+    /**
+     * Conjugates the frame by a Hadamard-like gate on qubit q, i.e. a gate
+     * that exchanges X and Z up to sign.
+     */
+    void apply_hadamard(utils::UInt q);
+
+    /**
+     * Conjugates the frame by a phase-like gate on qubit q, i.e. a gate that
+     * maps X to Y and Z to Z up to sign.
+     */
+    void apply_phase(utils::UInt q);
+
+    /**
+     * Conjugates the frame by a sqrt(X)-like gate on qubit q, i.e. a gate that
+     * maps X to X and Z to Y up to sign.
+     */
+    void apply_sqrt_x(utils::UInt q);
+
+    /**
+     * Conjugates the frame by a CNOT with the given control and target.
+     */
+    void apply_cnot(utils::UInt control, utils::UInt target);
+
+    /**
+     * Conjugates the frame by a CZ on the given qubits.
+     */
+    void apply_cz(utils::UInt a, utils::UInt b);
+
+    /**
+     * Conjugates the frame by a SWAP on the given qubits.
+     */
+    void apply_swap(utils::UInt a, utils::UInt b);
+
+};
+
+/**
+ * The effect of a gate on the Pauli frame, as inferred from its name.
+ */
+enum class GateClass {
+
+    /**
+     * A Pauli gate; absorbed into the frame.
+     */
+    PAULI,
+
+    /**
+     * The identity gate; commutes with the frame.
+     */
+    IDENTITY,
+
+    /**
+     * A single-qubit Clifford that exchanges X and Z (h, y90, ym90, ...).
+     */
+    HADAMARD_LIKE,
+
+    /**
+     * A single-qubit Clifford that maps X to Y (s, sdag, z90, ...).
+     */
+    PHASE_LIKE,
+
+    /**
+     * A single-qubit Clifford that maps Z to Y (x90, xm90, ...).
+     */
+    SQRT_X_LIKE,
+
+    /**
+     * A CNOT gate; the first operand is the control.
+     */
+    CNOT,
+
+    /**
+     * A CZ gate.
+     */
+    CZ,
+
+    /**
+     * A SWAP gate.
+     */
+    SWAP,
+
+    /**
+     * A gate that is diagonal in the Z basis (t, rz, Z-basis measurement, ...).
+     * Z commutes with it, so only the X component of the frame needs to be
+     * flushed.
+     */
+    DIAGONAL,
+
+    /**
+     * A state preparation; discards whatever frame was pending on the qubit.
+     */
+    PREPARE,
+
+    /**
+     * Anything else; the frame must be flushed for all operands first.
+     */
+    OTHER
+
+};
+
+/**
+ * Gate classification result.
+ */
+struct GateInfo {
+
+    /**
+     * The effect of the gate on the frame.
+     */
+    GateClass gate_class;
+
+    /**
+     * For Pauli gates, the X component of the Pauli.
+     */
+    utils::Bool x;
+
+    /**
+     * For Pauli gates, the Z component of the Pauli.
+     */
+    utils::Bool z;
+
+};
+
+/**
+ * Pauli frame optimizer logic implementation.
+ */
+class PauliFrameOptimizer {
+private:
+
+    /**
+     * The Pauli frame that is to be applied after all gates emitted thus far.
+     */
+    PauliFrame frame;
+
+    /**
+     * Cache from full gate name to classification. Specialized gates carry
+     * their operands in the name (e.g. "x q0"), so without it the base name
+     * would be split off and looked up again for every Pauli gate absorbed
+     * into the frame.
+     */
+    std::unordered_map<utils::Str, GateInfo> info_cache;
+
+    /**
+     * Classifies the given gate by name.
+     *
+     * TODO: like the Clifford optimizer, this infers semantics by gate name;
+     *  this should be in the config file somehow.
+     */
+    const GateInfo &classify(const ir::compat::GateRef &gate);
+
+    /**
+     * Emits the pending frame for qubit q into the kernel and clears it. If
+     * x_only is set, only the X component is flushed, and any Z component is
+     * kept in the frame.
+     */
+    void flush(
+        const ir::compat::KernelRef &kernel,
+        utils::UInt q,
+        utils::Bool x_only = false
+    );
+
+    /**
+     * Emits the pending frame for all qubits into the kernel and clears it.
+     */
+    void flush_all(const ir::compat::KernelRef &kernel);
+
+public:
+
+    /**
+     * Optimizes the given kernel, returning how many gates were removed. The
+     * kernel is only modified if this reduces its gate count.
+     */
+    utils::UInt optimize_kernel(const ir::compat::KernelRef &kernel);
+
+};
+
+} // namespace detail
+} // namespace pauli_frame
+} // namespace clifford
+} // namespace opt
+} // namespace pass
+} // namespace ql
@@ -4,6 +4,7 @@
 
 #include "ql/pass/opt/clifford/optimize.h"
 
+#include "ql/ir/old_to_new.h"
 #include "ql/pmgr/pass_types/base.h"
 #include "ql/pass/ana/statistics/annotations.h"
 #include "detail/clifford.h"
@@ -28,7 +29,13 @@ void CliffordOptimizePass::dump_docs(
 
     Note that the relation between the Clifford state transition corresponding
     to a particular gate is currently hardcoded based on gate name, and the
-    equivalent cycle counts are also hardcoded.
+    equivalent cycle counts are also hardcoded. The replacement sequences are
+    built from the `rx90`, `ry90`, `mrx90`, `mry90`, `rx180`, and `ry180`
+    instructions, so those that are needed must exist on the platform.
+
+    Structured control-flow statements and instructions that do not operate on
+    specific qubits end all pending Clifford sequences, after which the bodies
+    of any structured control-flow statements are optimized independently.
     )");
 }
 
@@ -46,23 +53,30 @@ CliffordOptimizePass::CliffordOptimizePass(
     const utils::Ptr<const pmgr::Factory> &pass_factory,
     const utils::Str &instance_name,
     const utils::Str &type_name
-) : pmgr::pass_types::KernelTransformation(pass_factory, instance_name, type_name) {
+) : pmgr::pass_types::Transformation(pass_factory, instance_name, type_name) {
 }
 
 /**
  * Runs the Clifford optimizer.
  */
 utils::Int CliffordOptimizePass::run(
-    const ir::compat::ProgramRef &program,
-    const ir::compat::KernelRef &kernel,
+    const ir::Ref &ir,
     const pmgr::pass_types::Context &context
 ) const {
-    auto cycles_saved = detail::Clifford().optimize_kernel(kernel);
-    ana::statistics::AdditionalStats::push(
-        kernel,
-        utils::to_string(cycles_saved) + " cycles saved by " + context.full_pass_name
-    );
-    return cycles_saved;
+    utils::UInt total_saved = 0;
+    if (!ir->program.empty()) {
+        detail::Clifford clifford(ir);
+        for (const auto &block : ir->program->blocks) {
+            auto cycles_saved = clifford.optimize_block(block);
+            block->set_annotation<ir::KernelCyclesValid>({false});
+            ana::statistics::AdditionalStats::push(
+                block,
+                utils::to_string(cycles_saved) + " cycles saved by " + context.full_pass_name
+            );
+            total_saved += cycles_saved;
+        }
+    }
+    return (utils::Int)total_saved;
 }
 
 } // namespace optimize
@@ -0,0 +1,83 @@
+/** \file
+ * Defines the Pauli frame optimizer pass.
+ */
+
+#include "ql/pass/opt/clifford/pauli_frame.h"
+
+#include "ql/pmgr/pass_types/base.h"
+#include "ql/pass/ana/statistics/annotations.h"
+#include "detail/pauli_frame.h"
+
+namespace ql {
+namespace pass {
+namespace opt {
+namespace clifford {
+namespace pauli_frame {
+
+/**
+ * Dumps docs for the Pauli frame optimizer.
+ */
+void PauliFrameOptimizePass::dump_docs(
+    std::ostream &os,
+    const utils::Str &line_prefix
+) const {
+    utils::dump_str(os, line_prefix, R"(
+    This pass removes Pauli gates (X, Y, and Z) by tracking them in a Pauli
+    frame rather than emitting them. Clifford gates, including CNOT, CZ, and
+    SWAP, are emitted unchanged, while the frame is conjugated through them.
+    Pauli gates that meet up in the frame thus cancel, even when they are
+    separated by two-qubit gates, as is common in error-correction cycles.
+
+    The frame is flushed, i.e. emitted as X, Y, or Z gates on the affected
+    qubits, before any non-Clifford gate, conditional gate, or measurement.
+    Only the X component of the frame needs to be flushed before gates that
+    are diagonal in the Z basis, such as T and Z-basis measurement, and any
+    pending frame is discarded when a qubit is prepared. Whatever is left is
+    flushed at the end of each kernel. Since flushing may emit more gates than
+    were absorbed, a kernel is only modified when this reduces its total gate
+    count. The pass returns the total number of gates removed.
+
+    The flushed gates are emitted using the x, y, and z instructions, so these
+    must be available in the platform. Note that the effect of a gate on the
+    frame is currently inferred from its name.
+    )");
+}
+
+/**
+ * Returns a user-friendly type name for this pass.
+ */
+utils::Str PauliFrameOptimizePass::get_friendly_type() const {
+    return "Pauli frame optimizer";
+}
+
+/**
+ * Constructs a Pauli frame optimizer.
+ */
+PauliFrameOptimizePass::PauliFrameOptimizePass(
+    const utils::Ptr<const pmgr::Factory> &pass_factory,
+    const utils::Str &instance_name,
+    const utils::Str &type_name
+) : pmgr::pass_types::KernelTransformation(pass_factory, instance_name, type_name) {
+}
+
+/**
+ * Runs the Pauli frame optimizer.
+ */
+utils::Int PauliFrameOptimizePass::run(
+    const ir::compat::ProgramRef &program,
+    const ir::compat::KernelRef &kernel,
+    const pmgr::pass_types::Context &context
+) const {
+    auto gates_removed = detail::PauliFrameOptimizer().optimize_kernel(kernel);
+    ana::statistics::AdditionalStats::push(
+        kernel,
+        utils::to_string(gates_removed) + " gates removed by " + context.full_pass_name
+    );
+    return gates_removed;
+}
+
+} // namespace pauli_frame
+} // namespace clifford
+} // namespace opt
+} // namespace pass
+} // namespace ql
@@ -0,0 +1,52 @@
+#include "ql/pass/tests/helpers.h"
+
+using namespace ql;
+using namespace ql::pass::tests;
+
+/**
+ * Runs the Clifford optimizer on the given program, and returns the names of
+ * the resulting gates of all kernels, separated by spaces.
+ */
+static utils::Str optimize(const ir::compat::ProgramRef &program) {
+    utils::Str gates;
+    for (const auto &kernel : run_pass(program, "opt.clifford.Optimize")->kernels) {
+        for (const auto &gate : kernel->gates) {
+            gates += gate->name + " ";
+        }
+    }
+    return gates;
+}
+
+int main() {
+    auto plat = ir::compat::Platform::build("test_plat", utils::Str("cc_light"));
+
+    // X.Y.Z is the identity up to global phase, so the gates on qubit 0 are
+    // removed entirely. H is Y90 followed by X180, which is emitted before the
+    // CNOT that ends the Clifford sequence on qubit 1. The two X gates after
+    // it cancel out.
+    auto program = utils::make<ir::compat::Program>("test_prog", plat, 7, 32, 10);
+    auto kernel = utils::make<ir::compat::Kernel>("kernel", plat, 7, 32, 10);
+    kernel->x(0);
+    kernel->y(0);
+    kernel->z(0);
+    kernel->hadamard(1);
+    kernel->cnot(1, 2);
+    kernel->x(1);
+    kernel->x(1);
+    kernel->measure(2);
+    program->add(kernel);
+    QL_ASSERT_EQ(optimize(program), utils::Str("ry90 rx180 cnot measure "));
+
+    // The body of a loop is optimized independently of the kernels around it.
+    program = utils::make<ir::compat::Program>("test_prog", plat, 7, 32, 10);
+    auto body = utils::make<ir::compat::Kernel>("body", plat, 7, 32, 10);
+    body->x(0);
+    body->x(0);
+    body->y(3);
+    body->z(3);
+    body->z(3);
+    program->add_for(body, 5);
+    QL_ASSERT_EQ(optimize(program), utils::Str("ry180 "));
+
+    return 0;
+}
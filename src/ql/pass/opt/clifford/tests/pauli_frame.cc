@@ -0,0 +1,72 @@
+#include "ql/pass/tests/helpers.h"
+#include "surface_code.h"
+
+using namespace ql;
+using namespace ql::pass::tests;
+
+static ir::compat::PlatformRef plat;
+
+/**
+ * Returns a new single-kernel program on the 17-qubit platform.
+ */
+static ir::compat::ProgramRef make_program(ir::compat::KernelRef &kernel) {
+    auto program = utils::make<ir::compat::Program>("test_prog", plat, 17, 32, 32);
+    kernel = utils::make<ir::compat::Kernel>("test_kernel", plat, 17, 32, 32);
+    program->add(kernel);
+    return program;
+}
+
+/**
+ * Runs the Pauli frame optimizer on the given program, and returns the number
+ * of gates in the resulting kernel.
+ */
+static utils::UInt optimize(const ir::compat::ProgramRef &program) {
+    return run_pass(program, "opt.clifford.PauliFrame")->kernels[0]->gates.size();
+}
+
+int main() {
+    plat = ir::compat::Platform::build("test_plat", utils::Str("cc_light.s17"));
+    ir::compat::KernelRef kernel;
+
+    // Paulis cancel through a CNOT.
+    auto program = make_program(kernel);
+    kernel->x(0);
+    kernel->cnot(0, 1);
+    kernel->x(0);
+    kernel->x(1);
+    QL_ASSERT(optimize(program) == 1);
+
+    // Z commutes with a Z-basis measurement, and is cancelled afterwards.
+    program = make_program(kernel);
+    kernel->z(0);
+    kernel->measure(0);
+    kernel->z(0);
+    QL_ASSERT(optimize(program) == 1);
+
+    // Paulis are discarded by state preparation.
+    program = make_program(kernel);
+    kernel->x(2);
+    kernel->h(2);
+    kernel->prepz(2);
+    QL_ASSERT(optimize(program) == 2);
+
+    // The kernel is left as-is when propagation would add gates.
+    program = make_program(kernel);
+    kernel->x(0);
+    kernel->cnot(0, 1);
+    kernel->measure(1);
+    QL_ASSERT(optimize(program) == 3);
+
+    // On Pauli-twirled surface code syndrome extraction, all twirl and echo
+    // gates must cancel, leaving only the bare extraction circuit.
+    const utils::UInt rounds = 10;
+    program = make_program(kernel);
+    syndrome_extraction(kernel, rounds, false);
+    auto bare_gates = kernel->gates.size();
+    program = make_program(kernel);
+    syndrome_extraction(kernel, rounds, true);
+    QL_ASSERT(kernel->gates.size() > bare_gates);
+    QL_ASSERT_EQ(optimize(program), bare_gates);
+
+    return 0;
+}
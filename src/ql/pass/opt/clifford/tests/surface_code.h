@@ -0,0 +1,101 @@
+/** \file
+ * Surface code circuits for testing and benchmarking the Pauli frame
+ * optimizer.
+ */
+
+#pragma once
+
+#include <random>
+#include "ql/ir/compat/compat.h"
+
+namespace ql {
+namespace pass {
+namespace tests {
+
+/**
+ * Applies X^x Z^z to the given qubit.
+ */
+inline void pauli(const ir::compat::KernelRef &kernel, utils::UInt q, utils::Bool x, utils::Bool z) {
+    if (x && z) {
+        kernel->y(q);
+    } else if (x) {
+        kernel->x(q);
+    } else if (z) {
+        kernel->z(q);
+    }
+}
+
+/**
+ * Applies a CNOT with a random Pauli twirl, i.e. a random Pauli before the
+ * CNOT and the Pauli that undoes it after.
+ */
+inline void twirled_cnot(
+    const ir::compat::KernelRef &kernel,
+    utils::UInt c,
+    utils::UInt t,
+    std::mt19937 &rng
+) {
+    utils::UInt r = rng() % 16;
+    utils::Bool xc = r & 1, zc = r & 2, xt = r & 4, zt = r & 8;
+    pauli(kernel, c, xc, zc);
+    pauli(kernel, t, xt, zt);
+    kernel->cnot(c, t);
+    pauli(kernel, c, xc, zc != zt);
+    pauli(kernel, t, xt != xc, zt);
+}
+
+/**
+ * Appends rounds of distance-3 rotated surface code syndrome extraction to the
+ * kernel. Data qubits are 0..8, X ancillas 9..12, and Z ancillas 13..16. If
+ * twirl is set, all CNOTs are Pauli-twirled, and the data qubits get an X echo
+ * pair while the ancillas are measured.
+ */
+inline void syndrome_extraction(
+    const ir::compat::KernelRef &kernel,
+    utils::UInt rounds,
+    utils::Bool twirl
+) {
+    const utils::Vec<utils::Vec<utils::UInt>> x_checks = {{1, 2, 4, 5}, {3, 4, 6, 7}, {0, 1}, {7, 8}};
+    const utils::Vec<utils::Vec<utils::UInt>> z_checks = {{0, 1, 3, 4}, {4, 5, 7, 8}, {2, 5}, {3, 6}};
+    std::mt19937 rng(42);
+    for (utils::UInt round = 0; round < rounds; round++) {
+        for (utils::UInt a = 9; a < 17; a++) {
+            kernel->prepz(a);
+        }
+        for (utils::UInt i = 0; i < 4; i++) {
+            kernel->h(9 + i);
+        }
+        for (utils::UInt i = 0; i < 4; i++) {
+            for (auto d : x_checks[i]) {
+                if (twirl) {
+                    twirled_cnot(kernel, 9 + i, d, rng);
+                } else {
+                    kernel->cnot(9 + i, d);
+                }
+            }
+            for (auto d : z_checks[i]) {
+                if (twirl) {
+                    twirled_cnot(kernel, d, 13 + i, rng);
+                } else {
+                    kernel->cnot(d, 13 + i);
+                }
+            }
+        }
+        for (utils::UInt i = 0; i < 4; i++) {
+            kernel->h(9 + i);
+        }
+        for (utils::UInt d = 0; twirl && d < 9; d++) {
+            kernel->x(d);
+        }
+        for (utils::UInt a = 9; a < 17; a++) {
+            kernel->measure(a);
+        }
+        for (utils::UInt d = 0; twirl && d < 9; d++) {
+            kernel->x(d);
+        }
+    }
+}
+
+} // namespace tests
+} // namespace pass
+} // namespace ql
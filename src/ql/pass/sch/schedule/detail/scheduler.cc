@@ -10,11 +10,11 @@
  * bundles, a list of bundles in which gates starting in the same cycle are
  * grouped.
  *
- * The dependency graph (represented by the graph field below) is created in the
- * Init method, and the graph is constructed from and referring to the gates in
- * the sequence of gates in the kernel's circuit. In this graph, the nodes refer
- * to the gates in the circuit, and the edges represent the dependencies between
- * two gates. Init scans the gates of the circuit from start to end, inspects
+ * The dependency graph (represented by the flat node and arc arrays in the
+ * class) is created in the Init method, and the graph is constructed from and
+ * referring to the gates in the sequence of gates in the kernel's circuit. In
+ * this graph, the nodes refer to the gates in the circuit, and the edges
+ * represent the dependencies between two gates. Init scans the gates of the circuit from start to end, inspects
  * their parameters, and for each gate depending on the gate type and parameter
  * value and previous gates operating on the same parameters, it creates a
  * dependency of the current gate on that previous gate. Such a dependency has a
@@ -86,6 +86,7 @@
 
 #include "scheduler.h"
 
+#include <queue>
 #include "ql/utils/vec.h"
 #include "ql/utils/filesystem.h"
 
@@ -96,8 +97,6 @@ namespace schedule {
 namespace detail {
 
 using namespace utils;
-using ListDigraph = lemon::ListDigraph;
-using ListDigraphPath = lemon::Path<ListDigraph>;
 
 std::ostream &operator<<(std::ostream &os, DepType dt) {
     switch (dt) {
@@ -140,43 +139,43 @@ std::ostream &operator<<(std::ostream &os, OperandType ot) {
     return os;
 }
 
-Scheduler::Scheduler() :
-    instruction(graph),
-    name(graph),
-    order(graph),
-    weight(graph),
-    op_type(graph),
-    cause(graph),
-    dep_type(graph)
-{
-}
-
 // ins->name may contain parameters, so must be stripped first before checking it for gate's name
-void Scheduler::strip_name(Str &name) {
+void DependencyRules::strip_name(Str &name) {
     UInt p = name.find(' ');
     if (p != Str::npos) {
         name = name.substr(0,p);
     }
 }
 
-// Add a dependency between two nodes: from node fromID to node toID
-// the dependence is annotated with the deptype, operandtype and operand for possible transformations and for tracing
-void Scheduler::add_dep(
-    Int from_id,
-    Int to_id,
-    DepType dt,
-    OperandType ot,
-    UInt operand
-) {
-    QL_DOUT(".. adddep ... from fromID " << from_id << " to toID " << to_id << "   opnd=" << ot << "[" << operand << "], dep=" << dt);
-    auto from_node = graph.nodeFromId(from_id);
-    auto to_node = graph.nodeFromId(to_id);
-    auto arc = graph.addArc(from_node, to_node);
-    weight[arc] = Int(ceil(static_cast<Real>(instruction[from_node]->duration) / cycle_time));
-    op_type[arc] = ot;
-    cause[arc] = operand;
-    dep_type[arc] = dt;
-    QL_DOUT("... dep " << name[from_node] << " -> " << name[to_node] << " opnd=" << op_type[arc] << "[" << cause[arc] << "], dep=" << dep_type[arc] << ", wght=" << weight[arc] << ")");
+// start the state machines, one for each possible operand, as if the SOURCE node did a Default or Write on all of them
+DependencyRules::DependencyRules(
+    UInt qubit_count,
+    UInt creg_count,
+    UInt breg_count,
+    Bool commute_multi_qubit,
+    Bool commute_single_qubit,
+    UInt src_id,
+    const Callback &add_dep
+) :
+    qubit_count(qubit_count),
+    creg_count(creg_count),
+    breg_count(breg_count),
+    commute_multi_qubit(commute_multi_qubit),
+    commute_single_qubit(commute_single_qubit),
+    add_dep(add_dep)
+{
+    last_q_event.assign(qubit_count, EventType::DEFAULT);   // start as if SOURCE gate did Default on all qubit operands
+    last_default.assign(qubit_count, src_id);
+    last_x_rotates.resize(qubit_count);                     // start off as empty list, no Xrotate/Zrotate seen yet
+    last_z_rotates.resize(qubit_count);
+
+    last_c_event.assign(creg_count, EventType::CWRITE);     // start as if SOURCE gate did Cwrite on all creg operands
+    last_c_writer.assign(creg_count, src_id);
+    last_c_readers.resize(creg_count);                      // start off as empty list, no Creader seen yet
+
+    last_b_event.assign(breg_count, EventType::BWRITE);     // start as if SOURCE gate did Bwrite on all breg operands
+    last_b_writer.assign(breg_count, src_id);
+    last_b_readers.resize(breg_count);                      // start off as empty list, no Breader seen yet
 }
 
 // Signal a new event to the depgraph constructor:
@@ -190,8 +189,8 @@ void Scheduler::add_dep(
 // and the following event sequence per Creg/Breg operand: Write { Write | Read+ }* Write,
 // in which the first Write/Default is the SOURCE and the last Write/Default is the SINK.
 // The state machines have as state vectors for the lastevent, and various last states; these are vectors indexed by the operand.
-void Scheduler::new_event(
-    int curr_id,
+void DependencyRules::new_event(
+    UInt curr_id,
     OperandType operand_type,
     UInt operand,
     EventType curr_event,
@@ -322,6 +321,206 @@ void Scheduler::new_event(
     }
 }
 
+// add the dependences of gate ins, which is node curr_id, on the gates that were added before it
+void DependencyRules::add_gate(UInt curr_id, const ir::compat::GateRef &ins) {
+    auto iname = ins->name; // copy!!!!
+    strip_name(iname);
+
+    // Add edges (arcs)
+    // In quantum computing there are no real Reads and Writes on qubits because they cannot be cloned.
+    // Every qubit use influences the qubit, updates it, so would be considered a Read+Write at the same time.
+    // In dependency graph construction, this leads to WAW-dependency chains of all uses of the same qubit,
+    // and hence in a scheduler using this graph to a sequentialization of those uses in the original program order.
+    // For a scheduler, only the presence of a dependency counts, not its type (RAW/WAW/etc.).
+    //
+    // But as in classical computation Reads commute, in quantum computation e.g. Z rotations commute.
+    // However, multiple classes of such uses can be readily distinguished, e.g. X rotations and Z rotations.
+    // So all X rotations commute and all Zs commute, but an X followed by a Z or vice-versa must be sequentialized.
+    // And since a Write for a qubit is not really correct, we call the default behaviour Default.
+    // So in classical computing with 2 event types, there can be 4 kinds of dependences: RAR, RAW, WAR, and WAW;
+    // of these an RAR dependence is only created when we explicitly want to sequentialize, i.e. ignore commutability.
+    // Similarly with 3 event types in quantum, there can be 9 kinds of dependences:
+    // DAD, DAX, DAZ, XAD, XAX, XAZ, ZAD, ZAX, and ZAZ. Again, XAX and ZAZ dependences
+    // are only created when we explicitly want to sequentialize, i.e. ignore commutability.
+    // Since dependency graphs also has other uses apart from the scheduler, and we might
+    // reconstruct the sets of commuting events later, we annotate the dependence type (and operand) in the edge.
+    //
+    // In classical computing, Reads not only commute but can be done in parallel.
+    // But two Xrotations on the same qubit (and also two Z rotations on the same qubit) cannot be done in parallel.
+    // So the independence in the dependence graph should not be interpreted as a license for parallel execution.
+    //
+    // In a non-resource scheduler such independent gates are put in parallel
+    // but it doesn't do harm because it is not a real machine.
+    // In a resource-constrained scheduler the resource constraint that prohibits more than one use
+    // of the same qubit being active at the same time, will prevent this parallelism.
+    // So ignoring Xrotate After Xrotate (XAX) dependencies enables the scheduler to take advantage
+    // of the commutation property of Xrotations (among which the target operands of CNOTs.
+    // Likewise, ignoring Zrotate After Zrotate (ZAZ) dependencies enables the scheduler to take advantage
+    // of the commutation property of Zrotations (among which the control operands of all controlled unitaries,
+    // and the CZ target operands).
+    
+    // The schedulers are list schedulers, i.e. they maintain a list of gates in their algorithm,
+    // of gates available for being scheduled because they are not blocked by dependencies on non-scheduled gates.
+    // Therefore, the schedulers are able to select the best one from a set of commutable gates.
+
+    // FIXME: define signature in .json file similar to how llvm/scaffold/gcc defines instructions
+    // and then have a signature interpreter here; then we don't have this long if-chain
+    // and, more importantly, we don't have the knowledge of particular gates here;
+    // the default signature would be that of a default gate, modifying each qubit operand.
+
+    // every gate can have a condition with condition operands (which are bit register indices) that are read
+    for (auto boperand : ins->cond_operands) {
+        QL_DOUT(".. Condition operand: " << boperand);
+        new_event(curr_id, OperandType::BREG, boperand, EventType::BREAD, true);
+    }
+
+    // each type of gate has a different 'signature' of events; switch out to each one
+    if (iname == "measure") {
+        QL_DOUT(". considering " << ins->qasm() << " as measure");
+        // Default each qubit operand + Cwrite each classical operand + Bwrite each bit operand
+        for (auto operand : ins->operands) {
+            new_event(curr_id, OperandType::QUBIT, operand, EventType::DEFAULT, false);
+        }
+        for (auto coperand : ins->creg_operands) {
+            new_event(curr_id, OperandType::CREG, coperand, EventType::CWRITE, false);
+        }
+        for (auto boperand : ins->breg_operands) {
+            new_event(curr_id, OperandType::BREG, boperand, EventType::BWRITE, false);
+        }
+        QL_DOUT(". measure done");
+    } else if (iname == "display") {
+        QL_DOUT(". considering " << ins->qasm() << " as display");
+        // no operands, display all qubits, cregs and bregs
+        // FIXME: operands should have been added when creating this gate; then this special case would not be needed
+        // Default on each qubit operand
+        // Cwrite on each classical operand
+        // Bwrite on each bit operand
+        Vec<UInt> qubits(qubit_count);
+        std::iota(qubits.begin(), qubits.end(), 0);
+        for (auto operand : qubits) {
+            new_event(curr_id, OperandType::QUBIT, operand, EventType::DEFAULT, false);
+        }
+        Vec<UInt> cregs(creg_count);
+        std::iota(cregs.begin(), cregs.end(), 0);
+        for (auto coperand : cregs) {
+            new_event(curr_id, OperandType::CREG, coperand, EventType::CWRITE, false);
+        }
+        Vec<UInt> bregs(breg_count);
+        std::iota(bregs.begin(), bregs.end(), 0);
+        for (auto boperand : bregs) {
+            new_event(curr_id, OperandType::BREG, boperand, EventType::BWRITE, false);
+        }
+    } else if (ins->type() == ir::compat::GateType::CLASSICAL) {
+        QL_DOUT(". considering " << ins->qasm() << " as classical gate");
+        // Cwrite each classical operand
+        for (auto coperand : ins->creg_operands) {
+            new_event(curr_id, OperandType::CREG, coperand, EventType::CWRITE, false);
+        }
+    } else if (iname == "cnot") {
+        QL_DOUT(". considering " << ins->qasm() << " as cnot");
+        // CNOTs first operand is control and a Zrotate, second operand is target and an Xrotate
+        QL_ASSERT(ins->operands.size() == 2);
+        new_event(curr_id, OperandType::QUBIT, ins->operands[0], EventType::ZROTATE, commute_multi_qubit);
+        new_event(curr_id, OperandType::QUBIT, ins->operands[1], EventType::XROTATE, commute_multi_qubit);
+    } else if (iname == "cz" || iname == "cphase") {
+        QL_DOUT(". considering " << ins->qasm() << " as cz");
+        // CZs operands are both Zrotates
+        QL_ASSERT(ins->operands.size() == 2);
+        new_event(curr_id, OperandType::QUBIT, ins->operands[0], EventType::ZROTATE, commute_multi_qubit);
+        new_event(curr_id, OperandType::QUBIT, ins->operands[1], EventType::ZROTATE, commute_multi_qubit);
+    } else if (
+            iname == "rz"
+            || iname == "z"
+            || iname == "pauli_z"
+            || iname == "rz180"
+            || iname == "z90"
+            || iname == "rz90"
+            || iname == "zm90"
+            || iname == "mrz90"
+            || iname == "s"
+            || iname == "sdag"
+            || iname == "t"
+            || iname == "tdag"
+        ) {
+        QL_DOUT(". considering " << ins->qasm() << " as Z rotation");
+        // Z rotations on single operand
+        QL_ASSERT(ins->operands.size() == 1);
+        new_event(curr_id, OperandType::QUBIT, ins->operands[0], EventType::ZROTATE, commute_single_qubit);
+    } else if (
+            iname == "rx"
+            || iname == "x"
+            || iname == "pauli_x"
+            || iname == "rx180"
+            || iname == "x90"
+            || iname == "rx90"
+            || iname == "xm90"
+            || iname == "mrx90"
+            || iname == "x45"
+        ) {
+        QL_DOUT(". considering " << ins->qasm() << " as X rotation");
+        // X rotations on single operand
+        QL_ASSERT(ins->operands.size() == 1);
+        new_event(curr_id, OperandType::QUBIT, ins->operands[0], EventType::XROTATE, commute_single_qubit);
+    } else {
+        QL_DOUT(". considering " << ins->qasm() << " as no special gate (catch-all, generic rules)");
+        // Default on each qubit operand
+        // Cwrite on each classical operand
+        // Bwrite on each bit operand
+        for (auto operand : ins->operands) {
+            new_event(curr_id, OperandType::QUBIT, operand, EventType::DEFAULT, false);
+        }
+        for (auto coperand : ins->creg_operands) {
+            new_event(curr_id, OperandType::CREG, coperand, EventType::CWRITE, false);
+        }
+        for (auto boperand : ins->breg_operands) {
+            new_event(curr_id, OperandType::BREG, boperand, EventType::BWRITE, false);
+        }
+    } // end of if/else
+}
+
+// add the dependences of the SINK node curr_id, which behaves as a Default on every qubit
+// and as a Cwrite/Bwrite on every creg and breg
+void DependencyRules::add_sink(UInt curr_id) {
+    Vec<UInt> qubits(qubit_count);
+    std::iota(qubits.begin(), qubits.end(), 0);
+    for (auto operand : qubits) {
+        new_event(curr_id, OperandType::QUBIT, operand, EventType::DEFAULT, false);
+    }
+    Vec<UInt> cregs(creg_count);
+    std::iota(cregs.begin(), cregs.end(), 0);
+    for (auto coperand : cregs) {
+        new_event(curr_id, OperandType::CREG, coperand, EventType::CWRITE, false);
+    }
+    Vec<UInt> bregs(breg_count);
+    std::iota(bregs.begin(), bregs.end(), 0);
+    for (auto boperand : bregs) {
+        new_event(curr_id, OperandType::BREG, boperand, EventType::BWRITE, false);
+    }
+}
+
+Scheduler::Scheduler() : s(0), t(0) {
+}
+
+// Add a dependency between two nodes: from node fromID to node toID
+// the dependence is annotated with the deptype, operandtype and operand for possible transformations and for tracing
+// arcs must be added grouped by target node, i.e. all arcs into to_id before any arc into a later node
+void Scheduler::add_dep(
+    UInt from_id,
+    UInt to_id,
+    DepType dt,
+    OperandType ot,
+    UInt operand
+) {
+    QL_DOUT(".. adddep ... from fromID " << from_id << " to toID " << to_id << "   opnd=" << ot << "[" << operand << "], dep=" << dt);
+    arc_source.push_back(from_id);
+    arc_target.push_back(to_id);
+    weight.push_back(Int(ceil(static_cast<Real>(instruction[from_id]->duration) / cycle_time)));
+    op_type.push_back(ot);
+    cause.push_back(operand);
+    dep_type.push_back(dt);
+    QL_DOUT("... dep " << instruction[from_id]->qasm() << " -> " << instruction[to_id]->qasm() << " opnd=" << ot << "[" << operand << "], dep=" << dt << ", wght=" << weight.back() << ")");
+}
+
 // construct the dependency graph ('graph') with nodes from the circuit and adding arcs for their dependencies
 void Scheduler::init(
     const ir::compat::KernelRef &kernel,
@@ -350,30 +549,38 @@ void Scheduler::init(
     // operands can be a qubit, a classical register or a bit register
     // the indices in the state vectors are operand indices within the operandType space
 
+    // the nodes are known in advance: SOURCE, the gates in circuit order, and SINK
+    UInt node_count = kernel->gates.size() + 2;
+    instruction.clear();
+    instruction.reserve(node_count);
+    order.assign(node_count, 0);
+    in_offsets.clear();
+    in_offsets.reserve(node_count + 1);
+    arc_source.clear();
+    arc_target.clear();
+    weight.clear();
+    op_type.clear();
+    cause.clear();
+    dep_type.clear();
+
     // start filling the dependency graph by creating the s node, the top of the graph
     {
         // add dummy source node
-        auto srcNode = graph.addNode();
-        instruction[srcNode].emplace<ir::compat::gate_types::Source>();    // so SOURCE is defined as instruction[s], not unique in itself
-        node.set(instruction[srcNode]) = srcNode;
-        name[srcNode] = instruction[srcNode]->qasm();
-        s = srcNode;
+        s = 0;
+        instruction.emplace_back();
+        instruction[s].emplace<ir::compat::gate_types::Source>();    // so SOURCE is defined as instruction[s], not unique in itself
+        in_offsets.push_back(0);
     }
-    Int src_id = graph.id(s);
-
-    // start the state machines, one for each possible operand
-    last_q_event.resize(qubit_count, EventType::DEFAULT);   // start as if SOURCE gate did Default on all qubit operands
-    last_default.resize(qubit_count, src_id);
-    last_x_rotates.resize(qubit_count);                     // start off as empty list, no Xrotate/Zrotate seen yet
-    last_z_rotates.resize(qubit_count);
-
-    last_c_event.resize(creg_count, EventType::CWRITE);     // start as if SOURCE gate did Cwrite on all creg operands
-    last_c_writer.resize(creg_count, src_id);
-    last_c_readers.resize(creg_count);                      // start off as empty list, no Creader seen yet
-
-    last_b_event.resize(breg_count, EventType::BWRITE);     // start as if SOURCE gate did Bwrite on all breg operands
-    last_b_writer.resize(breg_count, src_id);
-    last_b_readers.resize(breg_count);                      // start off as empty list, no Breader seen yet
+    UInt src_id = s;
+
+    // the dependency rules add the arcs into each node as it is added, through add_dep
+    DependencyRules rules(
+        qubit_count, creg_count, breg_count,
+        commute_multi_qubit, commute_single_qubit, src_id,
+        [this](UInt from_id, UInt to_id, DepType dt, OperandType ot, UInt operand) {
+            add_dep(from_id, to_id, dt, ot, operand);
+        }
+    );
 
     // for each gate pointer ins in the circuit, add a node and add dependencies on previous gates to it
     utils::Int index = 0;
@@ -393,167 +600,13 @@ void Scheduler::init(
             QL_DOUT(".. Condition: `" << ins->cond_qasm() << "'");
         }
 
-        auto iname = ins->name; // copy!!!!
-        strip_name(iname);
-
         // Add node
-        ListDigraph::Node currNode = graph.addNode();
-        int curr_id = graph.id(currNode);
-        instruction[currNode] = ins;
-        node.set(ins) = currNode;
-        name[currNode] = ins->qasm();   // and this includes any condition!
-        order[currNode] = index++;
-
-        // Add edges (arcs)
-        // In quantum computing there are no real Reads and Writes on qubits because they cannot be cloned.
-        // Every qubit use influences the qubit, updates it, so would be considered a Read+Write at the same time.
-        // In dependency graph construction, this leads to WAW-dependency chains of all uses of the same qubit,
-        // and hence in a scheduler using this graph to a sequentialization of those uses in the original program order.
-        // For a scheduler, only the presence of a dependency counts, not its type (RAW/WAW/etc.).
-        //
-        // But as in classical computation Reads commute, in quantum computation e.g. Z rotations commute.
-        // However, multiple classes of such uses can be readily distinguished, e.g. X rotations and Z rotations.
-        // So all X rotations commute and all Zs commute, but an X followed by a Z or vice-versa must be sequentialized.
-        // And since a Write for a qubit is not really correct, we call the default behaviour Default.
-        // So in classical computing with 2 event types, there can be 4 kinds of dependences: RAR, RAW, WAR, and WAW;
-        // of these an RAR dependence is only created when we explicitly want to sequentialize, i.e. ignore commutability.
-        // Similarly with 3 event types in quantum, there can be 9 kinds of dependences:
-        // DAD, DAX, DAZ, XAD, XAX, XAZ, ZAD, ZAX, and ZAZ. Again, XAX and ZAZ dependences
-        // are only created when we explicitly want to sequentialize, i.e. ignore commutability.
-        // Since dependency graphs also has other uses apart from the scheduler, and we might
-        // reconstruct the sets of commuting events later, we annotate the dependence type (and operand) in the edge.
-        //
-        // In classical computing, Reads not only commute but can be done in parallel.
-        // But two Xrotations on the same qubit (and also two Z rotations on the same qubit) cannot be done in parallel.
-        // So the independence in the dependence graph should not be interpreted as a license for parallel execution.
-        //
-        // In a non-resource scheduler such independent gates are put in parallel
-        // but it doesn't do harm because it is not a real machine.
-        // In a resource-constrained scheduler the resource constraint that prohibits more than one use
-        // of the same qubit being active at the same time, will prevent this parallelism.
-        // So ignoring Xrotate After Xrotate (XAX) dependencies enables the scheduler to take advantage
-        // of the commutation property of Xrotations (among which the target operands of CNOTs.
-        // Likewise, ignoring Zrotate After Zrotate (ZAZ) dependencies enables the scheduler to take advantage
-        // of the commutation property of Zrotations (among which the control operands of all controlled unitaries,
-        // and the CZ target operands).
-        
-        // The schedulers are list schedulers, i.e. they maintain a list of gates in their algorithm,
-        // of gates available for being scheduled because they are not blocked by dependencies on non-scheduled gates.
-        // Therefore, the schedulers are able to select the best one from a set of commutable gates.
-
-        // FIXME: define signature in .json file similar to how llvm/scaffold/gcc defines instructions
-        // and then have a signature interpreter here; then we don't have this long if-chain
-        // and, more importantly, we don't have the knowledge of particular gates here;
-        // the default signature would be that of a default gate, modifying each qubit operand.
-
-        // every gate can have a condition with condition operands (which are bit register indices) that are read
-        for (auto boperand : ins->cond_operands) {
-            QL_DOUT(".. Condition operand: " << boperand);
-            new_event(curr_id, OperandType::BREG, boperand, EventType::BREAD, true);
-        }
+        UInt curr_id = instruction.size();
+        instruction.push_back(ins);
+        in_offsets.push_back(arc_source.size());
+        order[curr_id] = index++;
 
-        // each type of gate has a different 'signature' of events; switch out to each one
-        if (iname == "measure") {
-            QL_DOUT(". considering " << name[currNode] << " as measure");
-            // Default each qubit operand + Cwrite each classical operand + Bwrite each bit operand
-            for (auto operand : ins->operands) {
-                new_event(curr_id, OperandType::QUBIT, operand, EventType::DEFAULT, false);
-            }
-            for (auto coperand : ins->creg_operands) {
-                new_event(curr_id, OperandType::CREG, coperand, EventType::CWRITE, false);
-            }
-            for (auto boperand : ins->breg_operands) {
-                new_event(curr_id, OperandType::BREG, boperand, EventType::BWRITE, false);
-            }
-            QL_DOUT(". measure done");
-        } else if (iname == "display") {
-            QL_DOUT(". considering " << name[currNode] << " as display");
-            // no operands, display all qubits, cregs and bregs
-            // FIXME: operands should have been added when creating this gate; then this special case would not be needed
-            // Default on each qubit operand
-            // Cwrite on each classical operand
-            // Bwrite on each bit operand
-            Vec<UInt> qubits(qubit_count);
-            std::iota(qubits.begin(), qubits.end(), 0);
-            for (auto operand : qubits) {
-                new_event(curr_id, OperandType::QUBIT, operand, EventType::DEFAULT, false);
-            }
-            Vec<UInt> cregs(creg_count);
-            std::iota(cregs.begin(), cregs.end(), 0);
-            for (auto coperand : cregs) {
-                new_event(curr_id, OperandType::CREG, coperand, EventType::CWRITE, false);
-            }
-            Vec<UInt> bregs(breg_count);
-            std::iota(bregs.begin(), bregs.end(), 0);
-            for (auto boperand : bregs) {
-                new_event(curr_id, OperandType::BREG, boperand, EventType::BWRITE, false);
-            }
-        } else if (ins->type() == ir::compat::GateType::CLASSICAL) {
-            QL_DOUT(". considering " << name[currNode] << " as classical gate");
-            // Cwrite each classical operand
-            for (auto coperand : ins->creg_operands) {
-                new_event(curr_id, OperandType::CREG, coperand, EventType::CWRITE, false);
-            }
-        } else if (iname == "cnot") {
-            QL_DOUT(". considering " << name[currNode] << " as cnot");
-            // CNOTs first operand is control and a Zrotate, second operand is target and an Xrotate
-            QL_ASSERT(ins->operands.size() == 2);
-            new_event(curr_id, OperandType::QUBIT, ins->operands[0], EventType::ZROTATE, commute_multi_qubit);
-            new_event(curr_id, OperandType::QUBIT, ins->operands[1], EventType::XROTATE, commute_multi_qubit);
-        } else if (iname == "cz" || iname == "cphase") {
-            QL_DOUT(". considering " << name[currNode] << " as cz");
-            // CZs operands are both Zrotates
-            QL_ASSERT(ins->operands.size() == 2);
-            new_event(curr_id, OperandType::QUBIT, ins->operands[0], EventType::ZROTATE, commute_multi_qubit);
-            new_event(curr_id, OperandType::QUBIT, ins->operands[1], EventType::ZROTATE, commute_multi_qubit);
-        } else if (
-                iname == "rz"
-                || iname == "z"
-                || iname == "pauli_z"
-                || iname == "rz180"
-                || iname == "z90"
-                || iname == "rz90"
-                || iname == "zm90"
-                || iname == "mrz90"
-                || iname == "s"
-                || iname == "sdag"
-                || iname == "t"
-                || iname == "tdag"
-            ) {
-            QL_DOUT(". considering " << name[currNode] << " as Z rotation");
-            // Z rotations on single operand
-            QL_ASSERT(ins->operands.size() == 1);
-            new_event(curr_id, OperandType::QUBIT, ins->operands[0], EventType::ZROTATE, commute_single_qubit);
-        } else if (
-                iname == "rx"
-                || iname == "x"
-                || iname == "pauli_x"
-                || iname == "rx180"
-                || iname == "x90"
-                || iname == "rx90"
-                || iname == "xm90"
-                || iname == "mrx90"
-                || iname == "x45"
-            ) {
-            QL_DOUT(". considering " << name[currNode] << " as X rotation");
-            // X rotations on single operand
-            QL_ASSERT(ins->operands.size() == 1);
-            new_event(curr_id, OperandType::QUBIT, ins->operands[0], EventType::XROTATE, commute_single_qubit);
-        } else {
-            QL_DOUT(". considering " << name[currNode] << " as no special gate (catch-all, generic rules)");
-            // Default on each qubit operand
-            // Cwrite on each classical operand
-            // Bwrite on each bit operand
-            for (auto operand : ins->operands) {
-                new_event(curr_id, OperandType::QUBIT, operand, EventType::DEFAULT, false);
-            }
-            for (auto coperand : ins->creg_operands) {
-                new_event(curr_id, OperandType::CREG, coperand, EventType::CWRITE, false);
-            }
-            for (auto boperand : ins->breg_operands) {
-                new_event(curr_id, OperandType::BREG, boperand, EventType::BWRITE, false);
-            }
-        } // end of if/else
+        rules.add_gate(curr_id, ins);
         QL_DOUT(". instruction done: " << ins->qasm());
     } // end of instruction for
 
@@ -561,12 +614,11 @@ void Scheduler::init(
     // finish filling the dependency graph by creating the t node, the bottom of the graph
     {
         // add dummy target node
-        ListDigraph::Node curr_node = graph.addNode();
-        int curr_id = graph.id(curr_node);
-        instruction[curr_node].emplace<ir::compat::gate_types::Sink>();    // so SINK is defined as instruction[t], not unique in itself
-        node.set(instruction[curr_node]) = curr_node;
-        name[curr_node] = instruction[curr_node]->qasm();
-        t = curr_node;
+        UInt curr_id = instruction.size();
+        instruction.emplace_back();
+        instruction[curr_id].emplace<ir::compat::gate_types::Sink>();    // so SINK is defined as instruction[t], not unique in itself
+        in_offsets.push_back(arc_source.size());
+        t = curr_id;
 
         // add deps to the dummy target node to close the dependency chains
         // it behaves as a Default to every qubit, Cwrite/Bwrite to every creg and breg
@@ -579,51 +631,50 @@ void Scheduler::init(
         // guaranteed that on a jump and on start of target circuit, the source circuit completed).
         //
         // note that there always is a LastWriter: the dummy source node wrote to every qubit and class. reg
-        Vec<UInt> qubits(qubit_count);
-        std::iota(qubits.begin(), qubits.end(), 0);
-        for (auto operand : qubits) {
-            new_event(curr_id, OperandType::QUBIT, operand, EventType::DEFAULT, false);
-        }
-        Vec<UInt> cregs(creg_count);
-        std::iota(cregs.begin(), cregs.end(), 0);
-        for (auto coperand : cregs) {
-            new_event(curr_id, OperandType::CREG, coperand, EventType::CWRITE, false);
-        }
-        Vec<UInt> bregs(breg_count);
-        std::iota(bregs.begin(), bregs.end(), 0);
-        for (auto boperand : bregs) {
-            new_event(curr_id, OperandType::BREG, boperand, EventType::BWRITE, false);
-        }
+        rules.add_sink(curr_id);
+    }
+    in_offsets.push_back(arc_source.size());
+
+    // the arcs were added grouped by target node; also group them by source node,
+    // keeping them in order of addition within each group
+    out_offsets.assign(node_count + 1, 0);
+    for (auto src : arc_source) {
+        out_offsets[src + 1]++;
+    }
+    for (UInt n = 0; n < node_count; n++) {
+        out_offsets[n + 1] += out_offsets[n];
+    }
+    out_arcs.resize(arc_source.size());
+    Vec<UInt> out_fill(out_offsets.begin(), out_offsets.end() - 1);
+    for (UInt arc = 0; arc < arc_source.size(); arc++) {
+        out_arcs[out_fill[arc_source[arc]]++] = arc;
     }
 
     // when in doubt about dependence graph, enable next line to get a dump of it in debugging output
     dprint_depgraph("init");
 
-    // useless as well because by construction, there cannot be cycles
-    // but when afterwards dependencies are added, cycles may be created,
-    // and after doing so (a copy of) this test should certainly be done because
-    // a cyclic dependency graph cannot be scheduled;
-    // this test here is a kind of debugging aid whether dependency creation was done well
-    if (!dag(graph)) {
-        QL_FATAL("The dependency graph is not a DAG.");
-    }
+    // by construction, all arcs point from an earlier to a later node, so the graph is a DAG;
+    // when afterwards dependencies are added, cycles may be created,
+    // and after doing so a DAG test should certainly be done because
+    // a cyclic dependency graph cannot be scheduled
     QL_DOUT("dependency graph creation Done.");
 }
 
 // print depgraph for debugging with string parameter identifying where
 void Scheduler::dprint_depgraph(const Str &s) const {
-    if (logger::log_level >= logger::LogLevel::LOG_DEBUG) {
+    if (QL_IS_LOG_DEBUG) {
         std::cout << "Depgraph " << s << std::endl;
-        for (ListDigraph::NodeIt n(graph); n != lemon::INVALID; ++n) {
-            std::cout << "Node " << graph.id(n) << " \"" << name[n] << "\" :" << std::endl;
+        for (UInt n = 0; n < instruction.size(); n++) {
+            std::cout << "Node " << n << " \"" << instruction[n]->qasm() << "\" :" << std::endl;
             std::cout << "    out:";
-            for (ListDigraph::OutArcIt arc(graph,n); arc != lemon::INVALID; ++arc) {
-                std::cout << " Arc(" << graph.id(arc) << "," << dep_type[arc] << "," << op_type[arc] << "[" << cause[arc] << "])->node(" << graph.id(graph.target(arc)) << ")";
+            for (UInt i = out_offsets[n + 1]; i-- > out_offsets[n];) {
+                UInt arc = out_arcs[i];
+                std::cout << " Arc(" << arc << "," << dep_type[arc] << "," << op_type[arc] << "[" << cause[arc] << "])->node(" << arc_target[arc] << ")";
             }
             std::cout << std::endl;
             std::cout << "    in:";
-            for (ListDigraph::InArcIt arc(graph,n); arc != lemon::INVALID; ++arc) {
-                std::cout << " Arc(" << graph.id(arc) << "," << dep_type[arc] << "," << op_type[arc] << "[" << cause[arc] << "])<-node(" << graph.id(graph.source(arc)) << ")";
+            for (UInt arc = in_offsets[n + 1]; arc-- > in_offsets[n];) {
+                std::cout << " Arc(" << arc << "," << dep_type[arc] << "," << op_type[arc] << "[" << cause[arc] << "])<-node(" << arc_source[arc] << ")";
             }
             std::cout << std::endl;
         }
@@ -633,15 +684,19 @@ void Scheduler::dprint_depgraph(const Str &s) const {
 
 void Scheduler::print() const {
     QL_COUT("Printing dependency Graph ");
-    digraphWriter(graph).
-        nodeMap("name", name).
-        arcMap("optype", op_type).
-        arcMap("cause", cause).
-        arcMap("weight", weight).
-        // arcMap("depType", depType).
-        node("source", s).
-        node("target", t).
-        run();
+    std::cout << "@nodes" << std::endl;
+    std::cout << "label\tname" << std::endl;
+    for (UInt n = 0; n < instruction.size(); n++) {
+        std::cout << n << "\t\"" << instruction[n]->qasm() << "\"" << std::endl;
+    }
+    std::cout << "@arcs" << std::endl;
+    std::cout << "\t\tlabel\toptype\tcause\tweight" << std::endl;
+    for (UInt arc = 0; arc < arc_source.size(); arc++) {
+        std::cout << arc_source[arc] << "\t" << arc_target[arc] << "\t" << arc << "\t" << op_type[arc] << "\t" << cause[arc] << "\t" << weight[arc] << std::endl;
+    }
+    std::cout << "@attributes" << std::endl;
+    std::cout << "source\t" << s << std::endl;
+    std::cout << "target\t" << t << std::endl;
 }
 
 void Scheduler::write_dependence_matrix() const {
@@ -649,16 +704,12 @@ void Scheduler::write_dependence_matrix() const {
     Str datfname(output_prefix + "dependenceMatrix.dat");
     OutFile fout(datfname);
 
-    UInt total_instructions = countNodes(graph);
+    UInt total_instructions = instruction.size();
     Vec<Vec<Bool> > matrix(total_instructions, Vec<Bool>(total_instructions));
 
     // now print the edges
-    for (ListDigraph::ArcIt arc(graph); arc != lemon::INVALID; ++arc) {
-        auto srcNode = graph.source(arc);
-        auto dstNode = graph.target(arc);
-        UInt srcID = graph.id( srcNode );
-        UInt dstID = graph.id( dstNode );
-        matrix[srcID][dstID] = true;
+    for (UInt arc = 0; arc < arc_source.size(); arc++) {
+        matrix[arc_source[arc]][arc_target[arc]] = true;
     }
 
     for (UInt i = 1; i < total_instructions - 1; i++) {
@@ -679,63 +730,58 @@ void Scheduler::write_dependence_matrix() const {
 // the latter never happens when the depgraph was constructed directly from the circuit
 // but when in between the depgraph was updated (as done in commute_variation),
 // dependences may have been inserted in the opposite circuit direction and then the recursion kicks in
-void Scheduler::set_cycle_gate(const ir::compat::GateRef &gp, rmgr::Direction dir) {
-    ListDigraph::Node curr_node = node.at(gp);
+void Scheduler::set_cycle_gate(UInt n, rmgr::Direction dir) {
     UInt  curr_cycle;
     if (dir == rmgr::Direction::FORWARD) {
         curr_cycle = 0;
-        for (ListDigraph::InArcIt arc(graph, curr_node); arc != lemon::INVALID; ++arc) {
-            auto nextgp = instruction[graph.source(arc)];
-            if (nextgp->cycle == ir::compat::MAX_CYCLE) {
-                set_cycle_gate(nextgp, dir);
+        for (UInt arc = in_offsets[n + 1]; arc-- > in_offsets[n];) {
+            UInt next_node = arc_source[arc];
+            if (instruction[next_node]->cycle == ir::compat::MAX_CYCLE) {
+                set_cycle_gate(next_node, dir);
             }
-            curr_cycle = max<UInt>(curr_cycle, nextgp->cycle + weight[arc]);
+            curr_cycle = max<UInt>(curr_cycle, instruction[next_node]->cycle + weight[arc]);
         }
     } else {
         curr_cycle = ALAP_SINK_CYCLE;
-        for (ListDigraph::OutArcIt arc(graph, curr_node); arc != lemon::INVALID; ++arc) {
-            auto nextgp = instruction[graph.target(arc)];
-            if (nextgp->cycle == ir::compat::MAX_CYCLE) {
-                set_cycle_gate(nextgp, dir);
+        for (UInt i = out_offsets[n + 1]; i-- > out_offsets[n];) {
+            UInt arc = out_arcs[i];
+            UInt next_node = arc_target[arc];
+            if (instruction[next_node]->cycle == ir::compat::MAX_CYCLE) {
+                set_cycle_gate(next_node, dir);
             }
-            curr_cycle = min<UInt>(curr_cycle, nextgp->cycle - weight[arc]);
+            curr_cycle = min<UInt>(curr_cycle, instruction[next_node]->cycle - weight[arc]);
         }
     }
-    gp->cycle = curr_cycle;
-    QL_DOUT("... set_cycle of " << gp->qasm() << " cycles " << gp->cycle);
+    instruction[n]->cycle = curr_cycle;
+    QL_DOUT("... set_cycle of " << instruction[n]->qasm() << " cycles " << instruction[n]->cycle);
 }
 
 void Scheduler::set_cycle(rmgr::Direction dir) {
-    // note when iterating that graph contains SOURCE and SINK whereas the circuit doesn't
-    for (ListDigraph::NodeIt n(graph); n != lemon::INVALID; ++n) {
-        instruction[n]->cycle = ir::compat::MAX_CYCLE;       // not yet visited successfully by set_cycle_gate
+    // note when iterating that graph contains SOURCE and SINK whereas the circuit doesn't;
+    // the nodes of the circuit's gates are in circuit order
+    for (auto &gp : instruction) {
+        gp->cycle = ir::compat::MAX_CYCLE;       // not yet visited successfully by set_cycle_gate
     }
     if (dir == rmgr::Direction::FORWARD) {
-        set_cycle_gate(instruction[s], dir);
-        for (auto gpit = kernel->gates.begin(); gpit != kernel->gates.end(); gpit++) {
-            if ((*gpit)->cycle == ir::compat::MAX_CYCLE) {
-                set_cycle_gate(*gpit, dir);
+        for (UInt n = s; n <= t; n++) {
+            if (instruction[n]->cycle == ir::compat::MAX_CYCLE) {
+                set_cycle_gate(n, dir);
             }
         }
-        set_cycle_gate(instruction[t], dir);
     } else {
-        set_cycle_gate(instruction[t], dir);
-        for (auto gpit = kernel->gates.rbegin(); gpit != kernel->gates.rend(); gpit++) {
-            if ((*gpit)->cycle == ir::compat::MAX_CYCLE) {
-                set_cycle_gate(*gpit, dir);
+        for (UInt n = t + 1; n-- > s;) {
+            if (instruction[n]->cycle == ir::compat::MAX_CYCLE) {
+                set_cycle_gate(n, dir);
             }
         }
-        set_cycle_gate(instruction[s], dir);
 
         // readjust cycle values of gates so that SOURCE is at 0
         UInt  SOURCECycle = instruction[s]->cycle;
         QL_DOUT("... readjusting cycle values by -" << SOURCECycle);
 
-        instruction[t]->cycle -= SOURCECycle;
-        for (auto &gp : kernel->gates) {
-            gp->cycle -= SOURCECycle;
+        for (auto &gp : instruction) {
+            gp->cycle -= SOURCECycle;       // i.e. SOURCE becomes 0
         }
-        instruction[s]->cycle -= SOURCECycle;   // i.e. becomes 0
     }
 }
 
@@ -785,79 +831,59 @@ void Scheduler::schedule_alap() {
 // it is without RC and depends on direction: forward:ASAP so cycles until SINK, backward:ALAP so cycles until SOURCE;
 // remaining[node] is complementary to node's cycle value,
 // so the implementation below is also a systematically modified copy of that of set_cycle_gate and set_cycle
-void Scheduler::set_remaining_gate(const ir::compat::GateRef &gp, rmgr::Direction dir) {
-    ListDigraph::Node curr_node = node.at(gp);
+void Scheduler::set_remaining_gate(UInt n, rmgr::Direction dir) {
     UInt curr_remain = 0;
-    QL_DOUT("... set_remaining of node " << graph.id(curr_node) << ": " << gp->qasm() << " ...");
+    QL_DOUT("... set_remaining of node " << n << ": " << instruction[n]->qasm() << " ...");
     if (dir == rmgr::Direction::FORWARD) {
-        for (ListDigraph::OutArcIt arc(graph, curr_node); arc != lemon::INVALID; ++arc) {
-            auto nextNode = graph.target(arc);
-            QL_DOUT("...... target of arc " << graph.id(arc) << " to node " << graph.id(nextNode));
-            if (remaining.at(nextNode) == ir::compat::MAX_CYCLE) {
-                set_remaining_gate(instruction[nextNode], dir);
+        for (UInt i = out_offsets[n + 1]; i-- > out_offsets[n];) {
+            UInt arc = out_arcs[i];
+            UInt next_node = arc_target[arc];
+            QL_DOUT("...... target of arc " << arc << " to node " << next_node);
+            if (remaining[next_node] == ir::compat::MAX_CYCLE) {
+                set_remaining_gate(next_node, dir);
             }
-            curr_remain = max<UInt>(curr_remain, remaining.at(nextNode) + weight[arc]);
+            curr_remain = max<UInt>(curr_remain, remaining[next_node] + weight[arc]);
         }
     } else {
-        for (ListDigraph::InArcIt arc(graph, curr_node); arc != lemon::INVALID; ++arc) {
-            auto nextNode = graph.source(arc);
-            QL_DOUT("...... source of arc " << graph.id(arc) << " from node " << graph.id(nextNode));
-            if (remaining.at(nextNode) == ir::compat::MAX_CYCLE) {
-                set_remaining_gate(instruction[nextNode], dir);
+        for (UInt arc = in_offsets[n + 1]; arc-- > in_offsets[n];) {
+            UInt next_node = arc_source[arc];
+            QL_DOUT("...... source of arc " << arc << " from node " << next_node);
+            if (remaining[next_node] == ir::compat::MAX_CYCLE) {
+                set_remaining_gate(next_node, dir);
             }
-            curr_remain = max<UInt>(curr_remain, remaining.at(nextNode) + weight[arc]);
+            curr_remain = max<UInt>(curr_remain, remaining[next_node] + weight[arc]);
         }
     }
-    remaining.set(curr_node) = curr_remain;
-    QL_DOUT("... set_remaining of node " << graph.id(curr_node) << ": " << gp->qasm() << " remaining " << curr_remain);
+    remaining[n] = curr_remain;
+    QL_DOUT("... set_remaining of node " << n << ": " << instruction[n]->qasm() << " remaining " << curr_remain);
 }
 
 void Scheduler::set_remaining(rmgr::Direction dir) {
     // note when iterating that graph contains SOURCE and SINK whereas the circuit doesn't;
-    // regretfully, the order of visiting the nodes while iterating over the graph, is undefined
-    // and in set_remaining (and set_cycle) the order matters (i.e. in circuit order or reversed circuit order)
-    for (ListDigraph::NodeIt n(graph); n != lemon::INVALID; ++n) {
-        remaining.set(n) = ir::compat::MAX_CYCLE;               // not yet visited successfully by set_remaining_gate
-    }
+    // the nodes are in circuit order, so visiting them in reverse (forward) order
+    // when computing the remaining cycles until SINK (SOURCE) never recurses
+    remaining.assign(instruction.size(), ir::compat::MAX_CYCLE);    // not yet visited successfully by set_remaining_gate
     if (dir == rmgr::Direction::FORWARD) {
         // remaining until SINK (i.e. the SINK.cycle-ALAP value)
-        set_remaining_gate(instruction[t], dir);
-        for (auto gpit = kernel->gates.rbegin(); gpit != kernel->gates.rend(); gpit++) {
-            if (remaining.at(node.at(*gpit)) == ir::compat::MAX_CYCLE) {
-                set_remaining_gate(*gpit, dir);
+        for (UInt n = t + 1; n-- > s;) {
+            if (remaining[n] == ir::compat::MAX_CYCLE) {
+                set_remaining_gate(n, dir);
             }
         }
-        set_remaining_gate(instruction[s], dir);
     } else {
         // remaining until SOURCE (i.e. the ASAP value)
-        set_remaining_gate(instruction[s], dir);
-        for (auto gpit = kernel->gates.begin(); gpit != kernel->gates.end(); gpit++) {
-            if (remaining.at(node.at(*gpit)) == ir::compat::MAX_CYCLE) {
-                set_remaining_gate(*gpit, dir);
+        for (UInt n = s; n <= t; n++) {
+            if (remaining[n] == ir::compat::MAX_CYCLE) {
+                set_remaining_gate(n, dir);
             }
         }
-        set_remaining_gate(instruction[t], dir);
-    }
-}
-
-ir::compat::GateRef Scheduler::find_mostcritical(const List<ir::compat::GateRef> &lg) {
-    UInt max_remain = 0;
-    ir::compat::GateRef most_critical_gate = {};
-    for (const auto &gp : lg) {
-        UInt gr = remaining.at(node.at(gp));
-        if (gr > max_remain) {
-            most_critical_gate = gp;
-            max_remain = gr;
-        }
     }
-    QL_DOUT("... most critical gate: " << most_critical_gate->qasm() << " with remaining=" << max_remain);
-    return most_critical_gate;
 }
 
 // Set the curr_cycle of the scheduling algorithm to start at the appropriate end as well;
 // note that the cycle attributes will be shifted down to start at 1 after backward scheduling.
 void Scheduler::init_available(
-    List<ListDigraph::Node> &avlist,
+    List<UInt> &avlist,
     rmgr::Direction dir,
     UInt &curr_cycle
 ) {
@@ -878,18 +904,16 @@ void Scheduler::init_available(
 // dependencies that are duplicates from the perspective of the scheduler
 // may be present in the dependency graph because the scheduler ignores dependency type and cause
 void Scheduler::get_depending_nodes(
-    ListDigraph::Node n,
+    UInt n,
     rmgr::Direction dir,
-    List<ListDigraph::Node> &ln
+    List<UInt> &ln
 ) {
     if (dir == rmgr::Direction::FORWARD) {
-        for (ListDigraph::OutArcIt succ_arc(graph, n); succ_arc != lemon::INVALID; ++succ_arc) {
-            auto succ_node = graph.target(succ_arc);
-            // DOUT("...... succ of " << instruction[n]->qasm() << " : " << instruction[succNode]->qasm());
+        for (UInt i = out_offsets[n + 1]; i-- > out_offsets[n];) {
+            UInt succ_node = arc_target[out_arcs[i]];
             Bool found = false;             // filter out duplicates
-            for (auto anySuccNode : ln) {
-                if (succ_node == anySuccNode) {
-                    // DOUT("...... duplicate: " << instruction[succNode]->qasm());
+            for (auto any_succ_node : ln) {
+                if (succ_node == any_succ_node) {
                     found = true;           // duplicate found
                 }
             }
@@ -899,13 +923,11 @@ void Scheduler::get_depending_nodes(
         }
         // ln contains depending nodes of n without duplicates
     } else {
-        for (ListDigraph::InArcIt pred_arc(graph, n); pred_arc != lemon::INVALID; ++pred_arc) {
-            ListDigraph::Node pred_node = graph.source(pred_arc);
-            // DOUT("...... pred of " << instruction[n]->qasm() << " : " << instruction[predNode]->qasm());
+        for (UInt arc = in_offsets[n + 1]; arc-- > in_offsets[n];) {
+            UInt pred_node = arc_source[arc];
             Bool found = false;             // filter out duplicates
             for (auto any_pred_node : ln) {
                 if (pred_node == any_pred_node) {
-                    // DOUT("...... duplicate: " << instruction[predNode]->qasm());
                     found = true;           // duplicate found
                 }
             }
@@ -923,19 +945,19 @@ void Scheduler::get_depending_nodes(
 // this function is used to order the avlist in an order from highest deep-criticality to lowest deep-criticality;
 // it is the core of the heuristics of the critical path list scheduler.
 Bool Scheduler::criticality_lessthan(
-    ListDigraph::Node n1,
-    ListDigraph::Node n2,
+    UInt n1,
+    UInt n2,
     rmgr::Direction dir
 ) {
     if (n1 == n2) return false;             // because not <
 
-    if (remaining.at(n1) < remaining.at(n2)) return true;
+    if (remaining[n1] < remaining[n2]) return true;
     if (!enable_criticality) return false;
-    if (remaining.at(n1) > remaining.at(n2)) return false;
+    if (remaining[n1] > remaining[n2]) return false;
     // so: remaining[n1] == remaining[n2]
 
-    List<ListDigraph::Node> ln1;
-    List<ListDigraph::Node> ln2;
+    List<UInt> ln1;
+    List<UInt> ln2;
 
     get_depending_nodes(n1, dir, ln1);
     get_depending_nodes(n2, dir, ln2);
@@ -943,26 +965,26 @@ Bool Scheduler::criticality_lessthan(
     if (ln1.empty()) return true;           // so when both empty, it is equal, so not strictly <, so false
     // so: ln1.non_empty && ln2.non_empty
 /*
-    ln1.sort([this](const ListDigraph::Node &d1, const ListDigraph::Node &d2) { return remaining.at(d1) < remaining.at(d2); });
-    ln2.sort([this](const ListDigraph::Node &d1, const ListDigraph::Node &d2) { return remaining.at(d1) < remaining.at(d2); });
+    ln1.sort([this](const UInt &d1, const UInt &d2) { return remaining[d1] < remaining[d2]; });
+    ln2.sort([this](const UInt &d1, const UInt &d2) { return remaining[d1] < remaining[d2]; });
 
-    UInt crit_dep_n1 = remaining.at(ln1.back());    // the last of the list is the one with the largest remaining value
-    UInt crit_dep_n2 = remaining.at(ln2.back());
+    UInt crit_dep_n1 = remaining[ln1.back()];    // the last of the list is the one with the largest remaining value
+    UInt crit_dep_n2 = remaining[ln2.back()];
 
     if (crit_dep_n1 < crit_dep_n2) return true;
     if (crit_dep_n1 > crit_dep_n2) return false;
     // so: crit_dep_n1 == crit_dep_n2, call this crit_dep
 
-    ln1.remove_if([this,crit_dep_n1](ListDigraph::Node n) { return remaining.at(n) < crit_dep_n1; });
-    ln2.remove_if([this,crit_dep_n2](ListDigraph::Node n) { return remaining.at(n) < crit_dep_n2; });
+    ln1.remove_if([this,crit_dep_n1](UInt n) { return remaining[n] < crit_dep_n1; });
+    ln2.remove_if([this,crit_dep_n2](UInt n) { return remaining[n] < crit_dep_n2; });
     // because both contain element with remaining == crit_dep: ln1.non_empty && ln2.non_empty
 
     if (ln1.size() < ln2.size()) return true;
     if (ln1.size() > ln2.size()) return false;
     // so: ln1.size() == ln2.size() >= 1
 */
-    ln1.sort([this,dir](const ListDigraph::Node &d1, const ListDigraph::Node &d2) { return criticality_lessthan(d1, d2, dir); });
-    ln2.sort([this,dir](const ListDigraph::Node &d1, const ListDigraph::Node &d2) { return criticality_lessthan(d1, d2, dir); });
+    ln1.sort([this,dir](const UInt &d1, const UInt &d2) { return criticality_lessthan(d1, d2, dir); });
+    ln2.sort([this,dir](const UInt &d1, const UInt &d2) { return criticality_lessthan(d1, d2, dir); });
     if (criticality_lessthan(ln1.back(), ln2.back(), dir)) return true;
     if (criticality_lessthan(ln2.back(), ln1.back(), dir)) return false;
 
@@ -978,20 +1000,20 @@ Bool Scheduler::criticality_lessthan(
 // avlist is initialized with s or t as first element by init_available
 // avlist is kept ordered on deep-criticality, non-increasing (i.e. highest deep-criticality first)
 void Scheduler::make_available(
-    ListDigraph::Node n,
-    utils::List<lemon::ListDigraph::Node> &avlist,
+    UInt n,
+    utils::List<UInt> &avlist,
     rmgr::Direction dir
 ) {
     Bool already_in_avlist = false;  // check whether n is already in avlist
     // originates from having multiple arcs between pair of nodes
-    List<ListDigraph::Node>::iterator first_lower_criticality_inp; // for keeping avlist ordered
+    List<UInt>::iterator first_lower_criticality_inp; // for keeping avlist ordered
     Bool first_lower_criticality_found = false;                          // for keeping avlist ordered
 
-    QL_DOUT(".... making available node " << name[n] << " remaining: " << remaining.dbg(n));
+    QL_DOUT(".... making available node " << instruction[n]->qasm() << " remaining: " << remaining[n]);
     for (auto inp = avlist.begin(); inp != avlist.end(); inp++) {
         if (*inp == n) {
             already_in_avlist = true;
-            QL_DOUT("...... duplicate when making available: " << name[n]);
+            QL_DOUT("...... duplicate when making available: " << instruction[n]->qasm());
         } else {
             // scanning avlist from front to back (avlist is ordered from high to low criticality)
             // when encountering first node *inp with less criticality,
@@ -1009,7 +1031,7 @@ void Scheduler::make_available(
         }
     }
     if (!already_in_avlist) {
-        set_cycle_gate(instruction[n], dir);        // for the schedulers to inspect whether gate has completed
+        set_cycle_gate(n, dir);                     // for the schedulers to inspect whether gate has completed
         if (first_lower_criticality_found) {
             // add n to avlist just before the first with lower criticality
             avlist.insert(first_lower_criticality_inp, n);
@@ -1017,7 +1039,7 @@ void Scheduler::make_available(
             // add n to end of avlist, if none found with less criticality
             avlist.push_back(n);
         }
-        QL_DOUT("...... made available node(@" << instruction[n]->cycle << "): " << name[n] << " remaining: " << remaining.dbg(n));
+        QL_DOUT("...... made available node(@" << instruction[n]->cycle << "): " << instruction[n]->qasm() << " remaining: " << remaining[n]);
     }
 }
 
@@ -1039,21 +1061,20 @@ void Scheduler::make_available(
 // because from then on that value is compared to the curr_cycle to check
 // whether a node has completed execution and thus is available for scheduling in curr_cycle
 void Scheduler::take_available(
-    ListDigraph::Node n,
-    utils::List<lemon::ListDigraph::Node> &avlist,
-    utils::Map<ir::compat::GateRef, utils::Bool> &scheduled,
+    UInt n,
+    utils::List<UInt> &avlist,
+    utils::Vec<utils::Bool> &scheduled,
     rmgr::Direction dir
 ) {
-    scheduled.set(instruction[n]) = true;
+    scheduled[n] = true;
     avlist.remove(n);
 
     if (dir == rmgr::Direction::FORWARD) {
-        for (ListDigraph::OutArcIt succ_arc(graph, n); succ_arc != lemon::INVALID; ++succ_arc) {
-            auto succ_node = graph.target(succ_arc);
+        for (UInt i = out_offsets[n + 1]; i-- > out_offsets[n];) {
+            UInt succ_node = arc_target[out_arcs[i]];
             Bool schedulable = true;
-            for (ListDigraph::InArcIt pred_arc(graph, succ_node); pred_arc != lemon::INVALID; ++pred_arc) {
-                ListDigraph::Node predNode = graph.source(pred_arc);
-                if (!scheduled.at(instruction[predNode])) {
+            for (UInt pred_arc = in_offsets[succ_node + 1]; pred_arc-- > in_offsets[succ_node];) {
+                if (!scheduled[arc_source[pred_arc]]) {
                     schedulable = false;
                     break;
                 }
@@ -1063,12 +1084,11 @@ void Scheduler::take_available(
             }
         }
     } else {
-        for (ListDigraph::InArcIt pred_arc(graph, n); pred_arc != lemon::INVALID; ++pred_arc) {
-            auto pred_node = graph.source(pred_arc);
+        for (UInt pred_arc = in_offsets[n + 1]; pred_arc-- > in_offsets[n];) {
+            UInt pred_node = arc_source[pred_arc];
             Bool schedulable = true;
-            for (ListDigraph::OutArcIt succ_arc(graph, pred_node); succ_arc != lemon::INVALID; ++succ_arc) {
-                auto succ_node = graph.target(succ_arc);
-                if (!scheduled.at(instruction[succ_node])) {
+            for (UInt i = out_offsets[pred_node + 1]; i-- > out_offsets[pred_node];) {
+                if (!scheduled[arc_target[out_arcs[i]]]) {
                     schedulable = false;
                     break;
                 }
@@ -1098,7 +1118,7 @@ void Scheduler::advance_curr_cycle(rmgr::Direction dir, UInt &curr_cycle) {
 // return true when immediately schedulable
 // when returning false, isres indicates whether resource occupation was the reason or operand completion (for debugging)
 Bool Scheduler::immediately_schedulable(
-    ListDigraph::Node n,
+    UInt n,
     rmgr::Direction dir,
     const UInt curr_cycle,
     rmgr::State &rs,
@@ -1133,8 +1153,8 @@ Bool Scheduler::immediately_schedulable(
 
 // select a node from the avlist
 // the avlist is deep-ordered from high to low criticality (see criticality_lessthan above)
-ListDigraph::Node Scheduler::select_available(
-    utils::List<lemon::ListDigraph::Node> &avlist,
+UInt Scheduler::select_available(
+    utils::List<UInt> &avlist,
     rmgr::Direction dir,
     const UInt curr_cycle,
     rmgr::State &rs,
@@ -1144,14 +1164,14 @@ ListDigraph::Node Scheduler::select_available(
 
     QL_DOUT("avlist(@" << curr_cycle << "):");
     for (auto n : avlist) {
-        QL_DOUT("...... node(@" << instruction[n]->cycle << "): " << name[n] << " remaining: " << remaining.dbg(n));
+        QL_DOUT("...... node(@" << instruction[n]->cycle << "): " << instruction[n]->qasm() << " remaining: " << remaining[n]);
     }
 
     // select the first (most critical) immediately schedulable gate that has duration 0
     for (auto n : avlist) {
         Bool isres;
         if (instruction[n]->duration == 0 && immediately_schedulable(n, dir, curr_cycle, rs, isres)) {
-            QL_DOUT("... node (@" << instruction[n]->cycle << "): " << name[n] << " duration 0 and immediately schedulable, remaining=" << remaining.dbg(n) << ", selected");
+            QL_DOUT("... node (@" << instruction[n]->cycle << "): " << instruction[n]->qasm() << " duration 0 and immediately schedulable, remaining=" << remaining[n] << ", selected");
             success = true;
             return n;
         }
@@ -1161,11 +1181,11 @@ ListDigraph::Node Scheduler::select_available(
     for (auto n : avlist) {
         Bool isres;
         if (immediately_schedulable(n, dir, curr_cycle, rs, isres)) {
-            QL_DOUT("... node (@" << instruction[n]->cycle << "): " << name[n] << " immediately schedulable, remaining=" << remaining.dbg(n) << ", selected");
+            QL_DOUT("... node (@" << instruction[n]->cycle << "): " << instruction[n]->qasm() << " immediately schedulable, remaining=" << remaining[n] << ", selected");
             success = true;
             return n;
         } else {
-            QL_DOUT("... node (@" << instruction[n]->cycle << "): " << name[n] << " remaining=" << remaining.dbg(n) << ", waiting for " << (isres ? "resource" : "dependent completion"));
+            QL_DOUT("... node (@" << instruction[n]->cycle << "): " << instruction[n]->qasm() << " remaining=" << remaining[n] << ", waiting for " << (isres ? "resource" : "dependent completion"));
         }
     }
 
@@ -1192,30 +1212,27 @@ void Scheduler::schedule(
     // in terms of dependencies, resources, and criticality
     if (dir == rmgr::Direction::FORWARD) {
         utils::Int index = 0;
-        for (const auto &ins : kernel->gates) {
-            order[node.at(ins)] = index++;
+        for (UInt n = s + 1; n < t; n++) {
+            order[n] = index++;
         }
     } else {
         utils::Int index = 0;
-        for (const auto &ins : kernel->gates) {
-            order[node.at(ins)] = index--;
+        for (UInt n = s + 1; n < t; n++) {
+            order[n] = index--;
         }
     }
 
     // build a new resource state
     auto rs = rm.build(dir);
 
-    // scheduled[gp] :=: whether gate *gp has been scheduled, init all false
-    Map<ir::compat::GateRef, Bool> scheduled;
+    // scheduled[n] :=: whether node n has been scheduled, init all false (including SOURCE/SINK)
+    Vec<Bool> scheduled(instruction.size(), false);
     // avlist :=: list of schedulable nodes, initially (see below) just s or t
-    List<ListDigraph::Node> avlist;
+    List<UInt> avlist;
 
     // initializations for this scheduler
     // note that dependency graph is not modified by a scheduler, so it can be reused
     QL_DOUT("... initialization");
-    for (ListDigraph::NodeIt n(graph); n != lemon::INVALID; ++n) {
-        scheduled.set(instruction[n]) = false;   // none were scheduled, including SOURCE/SINK
-    }
     UInt  curr_cycle;         // current cycle for which instructions are sought
     init_available(avlist, dir, curr_cycle);     // first node (SOURCE/SINK) is made available and curr_cycle set
     set_remaining(dir);         // for each gate, number of cycles until end of schedule
@@ -1223,7 +1240,7 @@ void Scheduler::schedule(
     QL_DOUT("... loop over avlist until it is empty");
     while (!avlist.empty()) {
         Bool success;
-        ListDigraph::Node selected_node;
+        UInt selected_node;
 
         selected_node = select_available(avlist, dir, curr_cycle, rs, success);
         if (!success) {
@@ -1287,7 +1304,7 @@ void Scheduler::schedule_alap(
     QL_DOUT("Scheduling ALAP [DONE]");
 }
 
-void Scheduler::schedule_alap_uniform() {
+void Scheduler::schedule_alap_uniform_scan() {
     // algorithm based on "Balanced Scheduling and Operation Chaining in High-Level Synthesis for FPGA Designs"
     // by David C. Zaretsky, Gaurav Mittal, Robert P. Dick, and Prith Banerjee
     // Figure 3. Balanced scheduling algorithm
@@ -1309,7 +1326,7 @@ void Scheduler::schedule_alap_uniform() {
     // and such that the circuit's depth is not enlarged and the dependencies/latencies are obeyed.
     // Hence, the result resembles an ALAP schedule with excess bundle lengths solved by moving nodes down ("rolling pin").
 
-    QL_DOUT("Scheduling ALAP UNIFORM to get bundles ...");
+    QL_DOUT("Scheduling ALAP UNIFORM (scan) to get bundles ...");
 
     // initialize gp->cycle as ASAP cycles as first approximation of result;
     // note that the circuit doesn't contain the SOURCE and SINK gates but the dependency graph does;
@@ -1329,9 +1346,9 @@ void Scheduler::schedule_alap_uniform() {
     // DOUT("Creating gates_per_cycle");
     // create gates_per_cycle[cycle] = for each cycle the list of gates at cycle cycle
     // this is the basic map to be operated upon by the uniforming scheduler below;
-    Map<UInt, List<ir::compat::GateRef>> gates_per_cycle;
-    for (const auto &gp : kernel->gates) {
-        gates_per_cycle.set(gp->cycle).push_back(gp);
+    Map<UInt, List<UInt>> gates_per_cycle;
+    for (UInt n = s + 1; n < t; n++) {
+        gates_per_cycle.set(instruction[n]->cycle).push_back(n);
     }
 
     // DOUT("Displaying circuit and bundle statistics");
@@ -1395,17 +1412,17 @@ void Scheduler::schedule_alap_uniform() {
             QL_DOUT("pred_cycle=" << pred_cycle);
             QL_DOUT("gates_per_cycle[curr_cycle].size()=" << gates_per_cycle.get(curr_cycle).size());
             UInt min_remaining_cycle = ir::compat::MAX_CYCLE;
-            List<ir::compat::GateRef>::const_iterator best_predgp_it;
-            ir::compat::GateRef best_predgp = {};
+            List<UInt>::const_iterator best_predgp_it;
+            UInt best_node = s;
             Bool best_predgp_found = false;
 
             // scan bundle at pred_cycle to find suitable candidate to move forward to curr_cycle
             for (auto predgp_it = gates_per_cycle.get(pred_cycle).begin(); predgp_it != gates_per_cycle.get(pred_cycle).end(); ++predgp_it) {
-                auto predgp = *predgp_it;
+                UInt pred_node = *predgp_it;
+                const auto &predgp = instruction[pred_node];
                 Bool forward_predgp = true;
                 UInt predgp_completion_cycle;
-                ListDigraph::Node pred_node = node.at(predgp);
-                QL_DOUT("... considering: " << predgp->qasm() << " @cycle=" << predgp->cycle << " remaining=" << remaining.dbg(pred_node));
+                QL_DOUT("... considering: " << predgp->qasm() << " @cycle=" << predgp->cycle << " remaining=" << remaining[pred_node]);
 
                 // candidate's result, when moved, must be ready before end-of-circuit and before used
                 predgp_completion_cycle = curr_cycle + UInt(ceil(static_cast<Real>(predgp->duration)/cycle_time));
@@ -1414,8 +1431,8 @@ void Scheduler::schedule_alap_uniform() {
                     forward_predgp = false;
                     QL_DOUT("... ... rejected (after circuit): " << predgp->qasm() << " would complete @" << predgp_completion_cycle << " SINK @" << cycle_count + 1);
                 } else {
-                    for (ListDigraph::OutArcIt arc(graph,pred_node); arc != lemon::INVALID; ++arc) {
-                        ir::compat::GateRef target_gp = instruction[graph.target(arc)];
+                    for (UInt i = out_offsets[pred_node + 1]; i-- > out_offsets[pred_node];) {
+                        const auto &target_gp = instruction[arc_target[out_arcs[i]]];
                         UInt target_cycle = target_gp->cycle;
                         if (predgp_completion_cycle > target_cycle) {
                             forward_predgp = false;
@@ -1426,10 +1443,10 @@ void Scheduler::schedule_alap_uniform() {
 
                 // when multiple nodes in bundle qualify, take the one with lowest remaining
                 // because that is the most critical one and thus deserves a cycle as high as possible (ALAP)
-                if (forward_predgp && remaining.at(pred_node) < min_remaining_cycle) {
-                    min_remaining_cycle = remaining.at(pred_node);
+                if (forward_predgp && remaining[pred_node] < min_remaining_cycle) {
+                    min_remaining_cycle = remaining[pred_node];
                     best_predgp_found = true;
-                    best_predgp = predgp;
+                    best_node = pred_node;
                     best_predgp_it = predgp_it;
                 }
             }
@@ -1448,14 +1465,15 @@ void Scheduler::schedule_alap_uniform() {
                     // target bundle was empty, now it will be non_empty
                     non_empty_bundle_count++;
                 }
+                const auto &best_predgp = instruction[best_node];
                 best_predgp->cycle = curr_cycle;        // what it is all about
-                gates_per_cycle.set(curr_cycle).push_back(best_predgp);
+                gates_per_cycle.set(curr_cycle).push_back(best_node);
 
                 // recompute targets
                 if (non_empty_bundle_count == 0) break;     // nothing to do
                 avg_gates_per_cycle = Real(gate_count)/curr_cycle;
                 avg_gates_per_non_empty_cycle = Real(gate_count)/non_empty_bundle_count;
-                QL_DOUT("... moved " << best_predgp->qasm() << " with remaining=" << remaining.dbg(node.at(best_predgp))
+                QL_DOUT("... moved " << best_predgp->qasm() << " with remaining=" << remaining[best_node]
                                      << " from cycle=" << pred_cycle << " to cycle=" << curr_cycle
                                      << "; new avg_gates_per_cycle=" << avg_gates_per_cycle
                                      << "; avg_gates_per_non_empty_cycle=" << avg_gates_per_non_empty_cycle
@@ -1506,6 +1524,181 @@ void Scheduler::schedule_alap_uniform() {
     QL_DOUT("Scheduling ALAP UNIFORM [DONE]");
 }
 
+void Scheduler::schedule_alap_uniform() {
+    // same algorithm and same result as schedule_alap_uniform_scan(), see there for a description;
+    // the difference is in how the node to move to the current cycle is found.
+    //
+    // A node n can be moved to curr_cycle when cycle(n) < curr_cycle <= latest(n), with latest(n) the latest
+    // cycle at which n can start such that it completes before SINK and before each of its successors starts.
+    // The scan picks the candidate in the highest bundle below curr_cycle and within that bundle the one with
+    // lowest remaining; since the bundles below curr_cycle never received moved nodes, their gates are still in
+    // node order, so remaining ties are broken by lowest node index. These candidates are kept in a priority queue
+    // with exactly that ordering. The scan visits curr_cycle downward, and during it:
+    // - latest(n) only increases (only successors move, and only up), so a candidate stays a candidate
+    //   until curr_cycle drops to cycle(n) or below; such stale nodes end up at the top of the queue
+    //   (highest cycle first) and are popped lazily;
+    // - a node that is not yet a candidate becomes one when curr_cycle drops to latest(n); to find it then,
+    //   it is kept in a bucket per latest cycle, and it is re-evaluated when one of its successors moves.
+    // Each node is thus pushed and popped O(1 + number of moved successors) times, and each move is O(log n).
+
+    QL_DOUT("Scheduling ALAP UNIFORM to get bundles ...");
+
+    // ASAP cycles as first approximation of the result, and remaining for the selection, as in the scan version;
+    // SOURCE at cycle 0, then all circuit's gates at cycles 1 to cycle_count, and finally SINK at cycle cycle_count+1
+    set_cycle(rmgr::Direction::FORWARD);
+    UInt cycle_count = instruction[t]->cycle - 1;
+    set_remaining(rmgr::Direction::FORWARD);
+
+    // per cycle the number of gates in its bundle, and the statistics as in the scan version
+    Vec<UInt> bundle_size(cycle_count + 1, 0);
+    for (UInt n = s + 1; n < t; n++) {
+        bundle_size[instruction[n]->cycle]++;
+    }
+    auto dprint_statistics = [&](const Str &when) {
+        UInt max_gates_per_cycle = 0;
+        UInt non_empty_bundles = 0;
+        UInt gates = 0;
+        for (UInt cycle = 1; cycle <= cycle_count; cycle++) {
+            max_gates_per_cycle = max<UInt>(max_gates_per_cycle, bundle_size[cycle]);
+            if (bundle_size[cycle] != 0) {
+                non_empty_bundles++;
+            }
+            gates += bundle_size[cycle];
+        }
+        QL_DOUT("... " << when << " uniform scheduling:"
+                 << " cycle_count=" << cycle_count
+                 << "; gate_count=" << gates
+                 << "; non_empty_bundle_count=" << non_empty_bundles
+        );
+        QL_DOUT("... and max_gates_per_cycle=" << max_gates_per_cycle
+                                               << "; avg_gates_per_cycle=" << Real(gates)/cycle_count
+                                               << "; avg_gates_per_non_empty_cycle=" << Real(gates)/non_empty_bundles
+        );
+    };
+    if (QL_IS_LOG_DEBUG) {
+        dprint_statistics("before");
+    }
+    UInt non_empty_bundle_count = 0;
+    UInt gate_count = t - s - 1;
+    for (UInt cycle = 1; cycle <= cycle_count; cycle++) {
+        if (bundle_size[cycle] != 0) {
+            non_empty_bundle_count++;
+        }
+    }
+
+    // latest cycle at which node n can start without completing after SINK or after any of its successors start;
+    // signed, because it can be below 1 when n is on the critical path with a zero-cycle start
+    auto latest_cycle = [&](UInt n) -> Int {
+        Int latest = cycle_count + 1;
+        for (UInt i = out_offsets[n + 1]; i-- > out_offsets[n];) {
+            latest = min<Int>(latest, instruction[arc_target[out_arcs[i]]]->cycle);
+        }
+        return latest - Int(ceil(static_cast<Real>(instruction[n]->duration)/cycle_time));
+    };
+
+    // candidates for the current cycle, best candidate on top
+    auto lower_priority = [this](UInt n1, UInt n2) {
+        if (instruction[n1]->cycle != instruction[n2]->cycle) {
+            return instruction[n1]->cycle < instruction[n2]->cycle;
+        }
+        if (remaining[n1] != remaining[n2]) {
+            return remaining[n1] > remaining[n2];
+        }
+        return n1 > n2;
+    };
+    std::priority_queue<UInt, Vec<UInt>, decltype(lower_priority)> candidates(lower_priority);
+    Vec<Bool> queued(t + 1, false);
+
+    // nodes that are not yet a candidate but become one at a lower cycle, per the cycle at which they do;
+    // entries can be stale (latest increased or already queued), they are checked when the bucket is emptied
+    Vec<Vec<UInt>> becomes_candidate_at(cycle_count + 1);
+    auto enqueue = [&](UInt n, UInt curr_cycle) {
+        Int latest = latest_cycle(n);
+        if (latest <= Int(instruction[n]->cycle)) {
+            return;
+        } else if (latest >= Int(curr_cycle)) {
+            candidates.push(n);
+            queued[n] = true;
+        } else {
+            becomes_candidate_at[latest].push_back(n);
+        }
+    };
+    for (UInt n = s + 1; n < t; n++) {
+        enqueue(n, cycle_count + 1);
+    }
+
+    for (UInt curr_cycle = cycle_count; curr_cycle >= 1; curr_cycle--) {
+        if (non_empty_bundle_count == 0) break;     // nothing to do
+        Real avg_gates_per_non_empty_cycle = Real(gate_count)/non_empty_bundle_count;
+        QL_DOUT("Cycle=" << curr_cycle << " number of gates=" << bundle_size[curr_cycle]
+                         << "; avg_gates_per_non_empty_cycle=" << avg_gates_per_non_empty_cycle);
+
+        for (auto n : becomes_candidate_at[curr_cycle]) {
+            if (!queued[n] && instruction[n]->cycle < curr_cycle && latest_cycle(n) >= Int(curr_cycle)) {
+                candidates.push(n);
+                queued[n] = true;
+            }
+        }
+        becomes_candidate_at[curr_cycle].clear();
+
+        while (Real(bundle_size[curr_cycle]) < avg_gates_per_non_empty_cycle) {
+
+            // drop the nodes that are at or above the current cycle, they can't be moved anymore
+            while (!candidates.empty() && instruction[candidates.top()]->cycle >= curr_cycle) {
+                candidates.pop();
+            }
+            if (candidates.empty()) {
+                break;
+            }
+            UInt best_node = candidates.top();
+            candidates.pop();
+
+            // move the node from its cycle to curr_cycle, and adjust all bookkeeping that is affected by this
+            const auto &best_gp = instruction[best_node];
+            UInt pred_cycle = best_gp->cycle;
+            bundle_size[pred_cycle]--;
+            if (bundle_size[pred_cycle] == 0) {
+                non_empty_bundle_count--;
+            }
+            if (bundle_size[curr_cycle] == 0) {
+                non_empty_bundle_count++;
+            }
+            bundle_size[curr_cycle]++;
+            best_gp->cycle = curr_cycle;        // what it is all about
+
+            avg_gates_per_non_empty_cycle = Real(gate_count)/non_empty_bundle_count;
+            QL_DOUT("... moved " << best_gp->qasm() << " with remaining=" << remaining[best_node]
+                                 << " from cycle=" << pred_cycle << " to cycle=" << curr_cycle
+                                 << "; new avg_gates_per_non_empty_cycle=" << avg_gates_per_non_empty_cycle
+            );
+
+            // the node's predecessors may now be moved up further
+            for (UInt arc = in_offsets[best_node + 1]; arc-- > in_offsets[best_node];) {
+                UInt pred_node = arc_source[arc];
+                if (pred_node != s && !queued[pred_node] && instruction[pred_node]->cycle < curr_cycle) {
+                    enqueue(pred_node, curr_cycle);
+                }
+            }
+        }
+
+        // curr_cycle ready, mask it and its gates from the target counts
+        gate_count -= bundle_size[curr_cycle];
+        if (bundle_size[curr_cycle] != 0) {
+            non_empty_bundle_count--;
+        }
+    }
+
+    // new cycle values computed; reflect this in circuit's gate order
+    sort_by_cycle(kernel->gates);
+    kernel->cycles_valid = true;
+
+    if (QL_IS_LOG_DEBUG) {
+        dprint_statistics("after");
+    }
+
+    QL_DOUT("Scheduling ALAP UNIFORM [DONE]");
+}
+
 // printing dot of the dependency graph
 void Scheduler::get_dot(
     Bool with_critical,
@@ -1513,19 +1706,8 @@ void Scheduler::get_dot(
     std::ostream &dotout
 ) {
     QL_DOUT("Get_dot");
-    ListDigraphPath p;
-    ListDigraph::ArcMap<Bool> is_in_critical{graph};
-    if (with_critical) {
-        for (ListDigraph::ArcIt a(graph); a != lemon::INVALID; ++a) {
-            is_in_critical[a] = false;
-            for (ListDigraphPath::ArcIt ap(p); ap != lemon::INVALID; ++ap) {
-                if (a == ap) {
-                    is_in_critical[a] = true;
-                    break;
-                }
-            }
-        }
-    }
+    // no critical path is computed (yet), so no arc is marked as being on it
+    Vec<Bool> is_in_critical(arc_source.size(), false);
 
     Str node_style(" fontcolor=black, style=filled, fontsize=16");
     Str edge_style_1(" color=black");
@@ -1537,9 +1719,9 @@ void Scheduler::get_dot(
            << std::endl;
 
     // first print the nodes
-    for (ListDigraph::NodeIt n(graph); n != lemon::INVALID; ++n) {
-        dotout << "\"" << graph.id(n) << "\""
-               << " [label=\" " << name[n] << " \""
+    for (UInt n = 0; n < instruction.size(); n++) {
+        dotout << "\"" << n << "\""
+               << " [label=\" " << instruction[n]->qasm() << " \""
                << node_style
                 << "];" << std::endl;
     }
@@ -1563,19 +1745,15 @@ void Scheduler::get_dot(
         dotout << ";\n}\n";
 
         // Now print ranks, as shown below
-        dotout << "{ rank=same; Cycle" << instruction[s]->cycle <<"; " << graph.id(s) << "; }\n";
-        for (const auto &gp : kernel->gates) {
-            dotout << "{ rank=same; Cycle" << gp->cycle <<"; " << graph.id(node.at(gp)) << "; }\n";
+        for (UInt n = 0; n < instruction.size(); n++) {
+            dotout << "{ rank=same; Cycle" << instruction[n]->cycle <<"; " << n << "; }\n";
         }
-        dotout << "{ rank=same; Cycle" << instruction[t]->cycle <<"; " << graph.id(t) << "; }\n";
     }
 
     // now print the edges
-    for (ListDigraph::ArcIt arc(graph); arc != lemon::INVALID; ++arc) {
-        auto src_node = graph.source(arc);
-        auto dst_node = graph.target(arc);
-        Int src_id = graph.id(src_node );
-        Int dst_id = graph.id(dst_node );
+    for (UInt arc = 0; arc < arc_source.size(); arc++) {
+        UInt src_id = arc_source[arc];
+        UInt dst_id = arc_target[arc];
 
         if (with_critical) {
             edge_style = (is_in_critical[arc] == true) ? edge_style_2 : edge_style_1;
@@ -7,14 +7,10 @@
 
 #pragma once
 
-#include <lemon/list_graph.h>
-#include <lemon/lgf_reader.h>
-#include <lemon/lgf_writer.h>
-#include <lemon/dijkstra.h>
-#include <lemon/connectivity.h>
-
+#include <functional>
 #include "ql/utils/num.h"
 #include "ql/utils/str.h"
+#include "ql/utils/vec.h"
 #include "ql/utils/list.h"
 #include "ql/utils/map.h"
 #include "ql/utils/ptr.h"
@@ -24,18 +20,6 @@
 
 namespace ql {
 namespace pass {
-
-// Forward declaration for mapper Future class for friend declaration.
-namespace map {
-namespace qubits {
-namespace map {
-namespace detail {
-class Future;
-} // namespace detail
-} // namespace route
-} // namespace qubits
-} // namespace map
-
 namespace sch {
 namespace schedule {
 namespace detail {
@@ -47,71 +31,63 @@ std::ostream &operator<<(std::ostream &os, DepType dt);
 enum class EventType {DEFAULT, XROTATE, ZROTATE, CREAD, CWRITE, BREAD, BWRITE};
 std::ostream &operator<<(std::ostream &os, EventType et);
 
-typedef utils::Vec<utils::Int> ReadersListType;
+typedef utils::Vec<utils::UInt> ReadersListType;
 
 enum class OperandType {QUBIT, CREG, BREG};
 std::ostream &operator<<(std::ostream &os, OperandType ot);
 
-class Scheduler {
-private:
-    // NOTE JvS: I don't like that this needs to be here, but making all this
-    // stuff public feels way worse.
-    friend class map::qubits::map::detail::Future;
-
-    // dependence graph is constructed (see Init) once from the sequence of gates in a kernel's circuit
-    // it can be reused as often as needed as long as no gates are added/deleted; it doesn't modify those gates
-    lemon::ListDigraph graph;
-
-    // conversion between gate* (pointer to the gate in the circuit) and node (of the dependence graph)
-    lemon::ListDigraph::NodeMap<ir::compat::GateRef> instruction;// instruction[n] == gate*
-    utils::Map<ir::compat::GateRef, lemon::ListDigraph::Node>  node;// node[gate*] == n
-
-    // attributes
-    lemon::ListDigraph::NodeMap<utils::Str> name;     // name[n] == qasm string
-    lemon::ListDigraph::NodeMap<utils::Int> order;    // order[n] == original index of gates in kernel
-    lemon::ListDigraph::ArcMap<utils::Int> weight;    // number of cycles of dependence
-    lemon::ListDigraph::ArcMap<OperandType> op_type;  // qubit, creg or breg
-    lemon::ListDigraph::ArcMap<utils::Int> cause;     // operand index
-    lemon::ListDigraph::ArcMap<DepType> dep_type;     // RAW, WAW, ...
-
-    // s and t nodes are the top and bottom of the dependence graph
-    lemon::ListDigraph::Node s, t;                     // instruction[s]==SOURCE, instruction[t]==SINK
+// the rules by which the dependences of a gate on the gates before it are found;
+// they are fed the gates of a circuit one by one in their original order (see add_gate)
+// and report each dependence that they find through the add_dep callback,
+// so that both the scheduler's dependence graph and the mapper's lookahead window can be built from them
+class DependencyRules {
+public:
+    // called for each dependence found, with the same parameters as Scheduler::add_dep
+    using Callback = std::function<void(
+        utils::UInt from_id,
+        utils::UInt to_id,
+        DepType dt,
+        OperandType ot,
+        utils::UInt operand
+    )>;
 
+private:
     // parameters of dependence graph construction
-    utils::UInt cycle_time;             // to convert durations to cycles as weight of dependence
     utils::UInt qubit_count;            // number of qubits, to check/represent qubit as cause of dependence
     utils::UInt creg_count;             // number of cregs, to check/represent creg as cause of dependence
     utils::UInt breg_count;             // number of bregs, to check/represent breg as cause of dependence
-    ir::compat::KernelRef kernel;       // current and result circuit, passed from Init to each scheduler
-
-    // pass option information
-    utils::Str output_prefix;           // replaces output directory global option
     utils::Bool commute_multi_qubit;    // whether to commute CZ and CNOT gates
     utils::Bool commute_single_qubit;   // whether to commute X and Z rotations
-    utils::Bool enable_criticality;     // whether to enable criticality selection logic
-
-    // scheduler support
-    utils::Map<lemon::ListDigraph::Node, utils::UInt>  remaining;  // remaining[node] == cycles until end; critical path representation
+    Callback add_dep;                   // receives the dependences that were found
 
     // state of the state machine that is used to construct the dependence graph
     // for each OperandType there is a separate type of state machine
     // for each particular operand there is a separate state machine
     // all vectors are indexed by the operand
     utils::Vec<EventType> last_q_event;           // Qubit: Default, Xrotate, Zrotate
-    utils::Vec<utils::Int> last_default;          // state machine: Default { Default | Xrotate+ | Zrotate+ }* Default
+    utils::Vec<utils::UInt> last_default;         // state machine: Default { Default | Xrotate+ | Zrotate+ }* Default
     utils::Vec<ReadersListType> last_x_rotates;
     utils::Vec<ReadersListType> last_z_rotates;
 
     utils::Vec<EventType> last_c_event;           // Creg: Write, Read
-    utils::Vec<utils::Int> last_c_writer;         // state machine: Write { Write | Read+ }* Write,
+    utils::Vec<utils::UInt> last_c_writer;        // state machine: Write { Write | Read+ }* Write,
     utils::Vec<ReadersListType> last_c_readers;
 
     utils::Vec<EventType> last_b_event;           // Breg: Write, Read
-    utils::Vec<utils::Int> last_b_writer;         // state machine: Write { Write | Read+ }* Write,
+    utils::Vec<utils::UInt> last_b_writer;        // state machine: Write { Write | Read+ }* Write,
     utils::Vec<ReadersListType> last_b_readers;
 
 public:
-    Scheduler();
+    // start with all operands last written by the node src_id (the dummy source node)
+    DependencyRules(
+        utils::UInt qubit_count,
+        utils::UInt creg_count,
+        utils::UInt breg_count,
+        utils::Bool commute_multi_qubit,
+        utils::Bool commute_single_qubit,
+        utils::UInt src_id,
+        const Callback &add_dep
+    );
 
     // name may contain parameters, so must be stripped first before checking it for gate's name
     static void strip_name(utils::Str &name);
@@ -125,18 +101,74 @@ public:
     // the state machines knows of all relevant previous events and in this context
     // can add dependences for this new current gate on those previous ones
     void new_event(
-        int curr_id,
+        utils::UInt curr_id,
         OperandType operand_type,
         utils::UInt operand,
         EventType curr_event,
         bool commutes
     );
 
+    // add the dependences of gate ins, which is node curr_id, on the gates added before it
+    void add_gate(utils::UInt curr_id, const ir::compat::GateRef &ins);
+
+    // add the dependences of the dummy sink node curr_id on the gates added before it;
+    // it behaves as a Default to every qubit, Cwrite/Bwrite to every creg and breg
+    void add_sink(utils::UInt curr_id);
+};
+
+class Scheduler {
+private:
+    // dependence graph is constructed (see Init) once from the sequence of gates in a kernel's circuit
+    // it can be reused as often as needed as long as no gates are added/deleted; it doesn't modify those gates
+    //
+    // it is represented as flat arrays (struct of arrays) indexed by node and by arc:
+    // node 0 is SOURCE, nodes 1..N are the kernel's gates in their original order, and node N+1 is SINK;
+    // arcs are numbered in the order in which they were added, which is grouped by target node
+    // because all dependences of a gate are added when that gate is added;
+    // the qasm strings of the gates are only computed when needed (debug and dot output)
+
+    // per node
+    utils::Vec<ir::compat::GateRef> instruction;        // instruction[n] == gate*
+    utils::Vec<utils::Int> order;                       // order[n] == original index of gates in kernel
+    utils::Vec<utils::UInt> in_offsets;                 // arcs into n are in_offsets[n] .. in_offsets[n+1]-1
+    utils::Vec<utils::UInt> out_offsets;                // arcs out of n are out_arcs[out_offsets[n] .. out_offsets[n+1]-1]
+    utils::Vec<utils::UInt> out_arcs;                   // arc indices grouped by source node, in order of addition
+
+    // per arc
+    utils::Vec<utils::UInt> arc_source;                 // source node of arc
+    utils::Vec<utils::UInt> arc_target;                 // target node of arc
+    utils::Vec<utils::Int> weight;                      // number of cycles of dependence
+    utils::Vec<OperandType> op_type;                    // qubit, creg or breg
+    utils::Vec<utils::Int> cause;                       // operand index
+    utils::Vec<DepType> dep_type;                       // RAW, WAW, ...
+
+    // s and t nodes are the top and bottom of the dependence graph
+    utils::UInt s, t;                                   // instruction[s]==SOURCE, instruction[t]==SINK
+
+    // parameters of dependence graph construction
+    utils::UInt cycle_time;             // to convert durations to cycles as weight of dependence
+    utils::UInt qubit_count;            // number of qubits, to check/represent qubit as cause of dependence
+    utils::UInt creg_count;             // number of cregs, to check/represent creg as cause of dependence
+    utils::UInt breg_count;             // number of bregs, to check/represent breg as cause of dependence
+    ir::compat::KernelRef kernel;       // current and result circuit, passed from Init to each scheduler
+
+    // pass option information
+    utils::Str output_prefix;           // replaces output directory global option
+    utils::Bool commute_multi_qubit;    // whether to commute CZ and CNOT gates
+    utils::Bool commute_single_qubit;   // whether to commute X and Z rotations
+    utils::Bool enable_criticality;     // whether to enable criticality selection logic
+
+    // scheduler support
+    utils::Vec<utils::UInt> remaining;  // remaining[node] == cycles until end; critical path representation
+
+public:
+    Scheduler();
+
     // add a dependence between two nodes
     // operand is in index space corresponding to operand type
     void add_dep(
-        utils::Int from_id,
-        utils::Int to_id,
+        utils::UInt from_id,
+        utils::UInt to_id,
         DepType dt,
         OperandType ot,
         utils::UInt operand
@@ -196,8 +228,8 @@ public:
     // cycle assignment without RC depending on direction: forward:ASAP, backward:ALAP;
     // without RC, this is all there is to schedule, apart from forming the bundles in ir::compat::bundler()
     // set_cycle iterates over the circuit's gates and set_cycle_gate over the dependences of each gate
-    // please note that set_cycle_gate expects a caller like set_cycle which iterates gp forward through the circuit
-    void set_cycle_gate(const ir::compat::GateRef &gp, rmgr::Direction dir);
+    // please note that set_cycle_gate expects a caller like set_cycle which iterates n forward through the circuit
+    void set_cycle_gate(utils::UInt n, rmgr::Direction dir);
     void set_cycle(rmgr::Direction dir);
 
     // sort circuit by the gates' cycle attribute in non-decreasing order
@@ -233,10 +265,9 @@ public:
     // This means that criticality has become independent of the direction of scheduling
     // which is easier in the core of the scheduler.
 
-    // Note that set_remaining_gate expects a caller like set_remaining that iterates gp backward over the circuit
-    void set_remaining_gate(const ir::compat::GateRef &gp, rmgr::Direction dir);
+    // Note that set_remaining_gate expects a caller like set_remaining that iterates n backward over the circuit
+    void set_remaining_gate(utils::UInt n, rmgr::Direction dir);
     void set_remaining(rmgr::Direction dir);
-    ir::compat::GateRef find_mostcritical(const utils::List<ir::compat::GateRef> &lg);
 
     // ASAP/ALAP list scheduling support code with RC
     // Uses an "available list" (avlist) as interface between dependence graph and scheduler
@@ -258,7 +289,7 @@ public:
     // Set the curr_cycle of the scheduling algorithm to start at the appropriate end as well;
     // note that the cycle attributes will be shifted down to start at 1 after backward scheduling.
     void init_available(
-        utils::List<lemon::ListDigraph::Node> &avlist,
+        utils::List<utils::UInt> &avlist,
         rmgr::Direction dir,
         utils::UInt &curr_cycle
     );
@@ -268,9 +299,9 @@ public:
     // dependences that are duplicates from the perspective of the scheduler
     // may be present in the dependence graph because the scheduler ignores dependence type and cause
     void get_depending_nodes(
-        lemon::ListDigraph::Node n,
+        utils::UInt n,
         rmgr::Direction dir,
-        utils::List<lemon::ListDigraph::Node> &ln
+        utils::List<utils::UInt> &ln
     );
 
     // Compute of two nodes whether the first one is less deep-critical than the second, for the given scheduling direction;
@@ -279,8 +310,8 @@ public:
     // this function is used to order the avlist in an order from highest deep-criticality to lowest deep-criticality;
     // it is the core of the heuristics of the critical path list scheduler.
     utils::Bool criticality_lessthan(
-        lemon::ListDigraph::Node n1,
-        lemon::ListDigraph::Node n2,
+        utils::UInt n1,
+        utils::UInt n2,
         rmgr::Direction dir
     );
 
@@ -292,8 +323,8 @@ public:
     // avlist is initialized with s or t as first element by init_available
     // avlist is kept ordered on deep-criticality, non-increasing (i.e. highest deep-criticality first)
     void make_available(
-        lemon::ListDigraph::Node n,
-        utils::List<lemon::ListDigraph::Node> &avlist,
+        utils::UInt n,
+        utils::List<utils::UInt> &avlist,
         rmgr::Direction dir
     );
 
@@ -315,9 +346,9 @@ public:
     // because from then on that value is compared to the curr_cycle to check
     // whether a node has completed execution and thus is available for scheduling in curr_cycle
     void take_available(
-        lemon::ListDigraph::Node n,
-        utils::List<lemon::ListDigraph::Node> &avlist,
-        utils::Map<ir::compat::GateRef, utils::Bool> &scheduled,
+        utils::UInt n,
+        utils::List<utils::UInt> &avlist,
+        utils::Vec<utils::Bool> &scheduled,
         rmgr::Direction dir
     );
 
@@ -333,7 +364,7 @@ public:
     // return true when immediately schedulable
     // when returning false, isres indicates whether resource occupation was the reason or operand completion (for debugging)
     utils::Bool immediately_schedulable(
-        lemon::ListDigraph::Node n,
+        utils::UInt n,
         rmgr::Direction dir,
         const utils::UInt curr_cycle,
         rmgr::State &rs,
@@ -342,8 +373,8 @@ public:
 
     // select a node from the avlist
     // the avlist is deep-ordered from high to low criticality (see criticality_lessthan above)
-    lemon::ListDigraph::Node select_available(
-        utils::List<lemon::ListDigraph::Node> &avlist,
+    utils::UInt select_available(
+        utils::List<utils::UInt> &avlist,
         rmgr::Direction dir,
         const utils::UInt curr_cycle,
         rmgr::State &rs,
@@ -371,9 +402,17 @@ public:
         const rmgr::Manager &rm
     );
 
+    // uniform scheduling (rolling pin), see schedule_alap_uniform_scan() for the algorithm;
+    // this version keeps per-cycle bundle sizes and the candidate nodes for each cycle in a priority queue
+    // (with the candidates that become movable at lower cycles in per-cycle buckets), such that each move
+    // costs O(log n) instead of a scan over all lower bundles; it makes exactly the same moves as the scan
     void schedule_alap_uniform();
 
-    // printing dot of the dependence graph
+    // uniform scheduling as originally implemented, scanning the lower bundles for a node to move;
+    // O(n^2) when bundles cannot be filled up, kept as reference and for comparison
+    void schedule_alap_uniform_scan();
+
+    // printing dot of the dependence graph; there is no critical path representation (yet), so with_critical has no effect
     void get_dot(utils::Bool with_critical, utils::Bool with_cycles, std::ostream &dotout);
     void get_dot(utils::Str &dot);
 };
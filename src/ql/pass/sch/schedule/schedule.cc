@@ -67,6 +67,17 @@ SchedulePass::SchedulePass(
         {"asap", "alap", "uniform"}
     );
 
+    options.add_enum(
+        "uniform_algorithm",
+        "Which implementation of uniform scheduling is to be used. Both give "
+        "the same schedule; queue finds the gates to move using priority "
+        "queues, while scan is the original implementation that scans the "
+        "earlier cycles for them, which takes quadratic time when bundles "
+        "cannot be filled up. Only used for the uniform scheduling target.",
+        "queue",
+        {"queue", "scan"}
+    );
+
     options.add_enum(
         "scheduler_heuristic",
         "This controls what scheduling heuristic should be used for ordering "
@@ -138,7 +149,11 @@ utils::Int SchedulePass::run(
         } else if (options["scheduler_target"].as_str() == "alap") {
             sched.schedule_alap();
         } else if (options["scheduler_target"].as_str() == "uniform") {
-            sched.schedule_alap_uniform();
+            if (options["uniform_algorithm"].as_str() == "scan") {
+                sched.schedule_alap_uniform_scan();
+            } else {
+                sched.schedule_alap_uniform();
+            }
         } else {
             utils::StrStrm ss;
             ss << "unimplemented scheduling target for " << context.full_pass_name;
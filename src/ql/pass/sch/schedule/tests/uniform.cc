@@ -0,0 +1,39 @@
+#include "uniform.h"
+
+using namespace ql;
+using namespace ql::pass::tests;
+
+/**
+ * Returns the size of the largest bundle of the given schedule.
+ */
+static utils::UInt max_bundle_size(const Schedule &schedule) {
+    utils::Map<utils::UInt, utils::UInt> sizes;
+    utils::UInt max_size = 0;
+    for (const auto &gate : schedule) {
+        max_size = utils::max(max_size, ++sizes.set(gate.second));
+    }
+    return max_size;
+}
+
+int main() {
+    auto plat = ir::compat::Platform::build("test_plat", utils::Str("cc_light.s17"));
+
+    // Both implementations must make the same moves, and neither should make
+    // the largest bundle larger than it is in the ASAP schedule it starts from.
+    for (utils::UInt layers : {1, 3, 10, 50}) {
+        auto asap = schedule_uniform(make_uniform_program(plat, layers), "asap", "queue");
+        auto queue = schedule_uniform(make_uniform_program(plat, layers), "uniform", "queue");
+        auto scan = schedule_uniform(make_uniform_program(plat, layers), "uniform", "scan");
+        QL_ASSERT(queue == scan);
+        QL_ASSERT(max_bundle_size(queue) <= max_bundle_size(asap));
+    }
+
+    // A larger circuit, in which the queue has to handle many moves between
+    // the same bundles. This is kept small enough for the scan to finish
+    // quickly, as it takes time quadratic in the number of cycles.
+    auto queue = schedule_uniform(make_uniform_program(plat, 250), "uniform", "queue");
+    auto scan = schedule_uniform(make_uniform_program(plat, 250), "uniform", "scan");
+    QL_ASSERT(queue == scan);
+
+    return 0;
+}
@@ -0,0 +1,69 @@
+/** \file
+ * Circuits and helpers for testing and benchmarking uniform scheduling.
+ */
+
+#pragma once
+
+#include <random>
+#include "ql/pass/tests/helpers.h"
+
+namespace ql {
+namespace pass {
+namespace tests {
+
+/**
+ * Builds a single-kernel program on the given 17-qubit platform in the style
+ * of tests/test_uniform_sched.py: layers of X gates on all qubits, which make
+ * for large bundles, separated by a few CNOTs, which make for small ones.
+ * Every eighth layer has a chain of dependent CNOTs instead, which makes for a
+ * run of small bundles that the X gates can only partly fill up; this is the
+ * worst case for scanning the earlier cycles for gates to move.
+ */
+inline ir::compat::ProgramRef make_uniform_program(
+    const ir::compat::PlatformRef &plat,
+    utils::UInt layers
+) {
+    auto program = utils::make<ir::compat::Program>("test_prog", plat, 17, 32, 32);
+    auto kernel = utils::make<ir::compat::Kernel>("test_kernel", plat, 17, 32, 32);
+    program->add(kernel);
+    std::mt19937 rng(42);
+    for (utils::UInt layer = 0; layer < layers; layer++) {
+        for (utils::UInt q = 0; q < 17; q++) {
+            if (rng() % 4) {
+                kernel->x(q);
+            }
+        }
+        utils::UInt cnots = layer % 8 ? 1 + rng() % 2 : 8;
+        utils::UInt c = rng() % 17;
+        for (utils::UInt i = 0; i < cnots; i++) {
+            utils::UInt t = (c + 1 + rng() % 3) % 17;
+            kernel->cnot(c, t);
+            if (layer % 8 == 0) {
+                std::swap(c, t);
+            } else {
+                c = rng() % 17;
+            }
+        }
+    }
+    return program;
+}
+
+/**
+ * Schedules the given program with the given scheduling target and uniform
+ * scheduling implementation, and returns the resulting schedule.
+ */
+inline Schedule schedule_uniform(
+    const ir::compat::ProgramRef &program,
+    const utils::Str &target,
+    const utils::Str &algorithm
+) {
+    return get_schedule(run_pass(program, "sch.Schedule", {
+        {"scheduler_target", target},
+        {"uniform_algorithm", algorithm},
+        {"resource_constraints", "no"}
+    })->kernels[0]);
+}
+
+} // namespace tests
+} // namespace pass
+} // namespace ql
@@ -0,0 +1,101 @@
+/** \file
+ * Helper functions shared by the unit tests of the passes.
+ */
+
+#pragma once
+
+#include "ql/utils/num.h"
+#include "ql/utils/str.h"
+#include "ql/utils/vec.h"
+#include "ql/utils/map.h"
+#include "ql/utils/pair.h"
+#include "ql/ir/compat/compat.h"
+#include "ql/ir/old_to_new.h"
+#include "ql/ir/new_to_old.h"
+#include "ql/pmgr/manager.h"
+#include "ql/pass/ana/statistics/annotations.h"
+
+namespace ql {
+namespace pass {
+namespace tests {
+
+/**
+ * Gate and cycle pairs of a kernel, in program order.
+ */
+using Schedule = utils::Vec<utils::Pair<utils::Str, utils::UInt>>;
+
+/**
+ * Runs a single pass of the given type with the given options on the given
+ * program, and returns the resulting program. The program is converted to
+ * the new IR and back around the pass, as the pass manager would.
+ */
+inline ir::compat::ProgramRef run_pass(
+    const ir::compat::ProgramRef &program,
+    const utils::Str &type_name,
+    const utils::Map<utils::Str, utils::Str> &options = {}
+) {
+    pmgr::Manager manager;
+    manager.append_pass(type_name, "", options);
+    auto ir = ir::convert_old_to_new(program);
+    manager.compile(ir);
+    return ir::convert_new_to_old(ir);
+}
+
+/**
+ * Returns the kernel with the given name of the given program.
+ */
+inline ir::compat::KernelRef get_kernel(
+    const ir::compat::ProgramRef &program,
+    const utils::Str &name
+) {
+    for (const auto &kernel : program->kernels) {
+        if (kernel->name == name) {
+            return kernel;
+        }
+    }
+    QL_ICE("kernel " << name << " not found");
+}
+
+/**
+ * Returns the gates of the given kernel along with their cycles.
+ */
+inline Schedule get_schedule(const ir::compat::KernelRef &kernel) {
+    Schedule schedule;
+    for (const auto &gate : kernel->gates) {
+        schedule.emplace_back(gate->qasm(), gate->cycle);
+    }
+    return schedule;
+}
+
+/**
+ * Returns the total number of gates in the given program.
+ */
+inline utils::UInt count_gates(const ir::compat::ProgramRef &program) {
+    utils::UInt count = 0;
+    for (const auto &kernel : program->kernels) {
+        count += kernel->gates.size();
+    }
+    return count;
+}
+
+/**
+ * Returns the remainder of the first additional statistics line of the given
+ * kernel that starts with the given prefix.
+ */
+inline utils::Str get_stat(
+    const ir::compat::KernelRef &kernel,
+    const utils::Str &prefix
+) {
+    if (auto stats = kernel->get_annotation_ptr<ana::statistics::AdditionalStats>()) {
+        for (const auto &line : stats->stats) {
+            if (utils::starts_with(line, prefix)) {
+                return line.substr(prefix.size());
+            }
+        }
+    }
+    QL_ICE("statistic " << prefix << " not found for kernel " << kernel->name);
+}
+
+} // namespace tests
+} // namespace pass
+} // namespace ql
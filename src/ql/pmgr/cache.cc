@@ -0,0 +1,333 @@
+/** \file
+ * Content-addressed compile cache for pass results.
+ */
+
+#include "ql/pmgr/cache.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include "ql/version.h"
+#include "ql/utils/filesystem.h"
+#include "ql/utils/logger.h"
+#include "ql/com/options.h"
+#include "ql/ir/cqasm/read.h"
+#include "ql/ir/cqasm/write.h"
+
+namespace ql {
+namespace pmgr {
+namespace cache {
+
+/**
+ * Extension used for the cache entry files.
+ */
+static const char *ENTRY_SUFFIX = ".qlc";
+
+/**
+ * Prefixes of the global options that cannot affect the result of a pass,
+ * and therefore are not part of the cache key.
+ */
+static const char *IGNORED_OPTION_PREFIXES[] = {
+    "log_", "cache_", "platform_cache", "consistency_checks", "output_dir"
+};
+
+/**
+ * Estimated total size of the entries in each cache directory, such that
+ * Store::save() only scans the directory when the size limit may have been
+ * exceeded. The estimate is exact after a scan, but afterwards only accounts
+ * for the entries saved by this process, so entries saved by other processes
+ * are only accounted for at the next scan.
+ */
+static std::mutex size_estimates_mutex;
+static utils::Map<utils::Str, utils::UInt> size_estimates;
+
+/**
+ * Returns a stable 128-bit hash of the given data as a hexadecimal string.
+ * Unlike std::hash, this is stable across processes and platforms, so it can
+ * be used for naming cache files. The two halves are 64-bit FNV-1a hashes
+ * with different offset bases, the second of which is additionally folded
+ * after every byte to decorrelate it from the first.
+ */
+utils::Str digest(const utils::Str &data) {
+    utils::UInt a = 0xCBF29CE484222325ull;
+    utils::UInt b = 0x6C62272E07BB0142ull;
+    for (auto c : data) {
+        a ^= (utils::UInt)(unsigned char)c;
+        a *= 0x100000001B3ull;
+        b ^= (utils::UInt)(unsigned char)c;
+        b *= 0x100000001B3ull;
+        b ^= b >> 29;
+    }
+    utils::StrStrm ss;
+    ss << std::hex << std::setfill('0') << std::setw(16) << a << std::setw(16) << b;
+    return ss.str();
+}
+
+/**
+ * Returns a summary of the platform contents. The pass results are only
+ * stored when a pass does not change this summary, since only the program is
+ * restored from the cache.
+ */
+utils::Str summarize_platform(const ir::Ref &ir) {
+    utils::StrStrm ss;
+    ss << ir->platform->data_types.size() << " data types, ";
+    ss << ir->platform->instructions.size() << " instructions, ";
+    ss << ir->platform->functions.size() << " functions, ";
+    ss << ir->platform->objects.size() << " objects: ";
+    ss << ir->platform->data.data.dump();
+    return ss.str();
+}
+
+/**
+ * Builds the key text for the given pass configuration and input. The
+ * returned string is the data to be hashed; it includes the OpenQL version,
+ * the global options that may affect compilation, and the platform
+ * configuration of the given IR.
+ */
+utils::Str make_key(
+    const utils::Str &pass_config,
+    const ir::Ref &ir,
+    const utils::Str &input
+) {
+    utils::StrStrm ss;
+    ss << "OpenQL " << OPENQL_VERSION_STRING << "\n";
+    ss << pass_config;
+
+    // Global options, minus the ones that only affect logging, caching, and
+    // where output files are written.
+    utils::StrStrm global;
+    com::options::current().dump_options(false, global);
+    std::istringstream lines(global.str());
+    utils::Str line;
+    while (std::getline(lines, line)) {
+        utils::Bool ignored = false;
+        for (auto prefix : IGNORED_OPTION_PREFIXES) {
+            if (utils::starts_with(line, prefix)) {
+                ignored = true;
+                break;
+            }
+        }
+        if (!ignored) {
+            ss << line << "\n";
+        }
+    }
+
+    ss << summarize_platform(ir) << "\n";
+    ss << input;
+    return ss.str();
+}
+
+/**
+ * Serializes the program of the given IR to cQASM.
+ */
+utils::Str serialize(const ir::Ref &ir) {
+    utils::StrStrm ss;
+    ir::cqasm::write(ir, {}, ss);
+    return ss.str();
+}
+
+/**
+ * Reads the given serialized program into a new IR root that shares the
+ * platform of the given IR. Returns an empty reference if the data could
+ * not be read.
+ */
+ir::Ref deserialize(const ir::Ref &ir, const utils::Str &data) {
+    auto result = utils::make<ir::Root>(ir->platform);
+    try {
+        ir::cqasm::ReadOptions read_options;
+        read_options.schedule_mode = ir::cqasm::ScheduleMode::KEEP;
+        ir::cqasm::read(result, data, "<cache>", read_options);
+    } catch (utils::Exception &e) {
+        QL_DOUT("failed to read cached program: " << e.what());
+        return {};
+    }
+    if (result->program.empty()) {
+        return {};
+    }
+    return result;
+}
+
+/**
+ * Returns the IR read from the given serialized program if it serializes to
+ * exactly the same data again, or an empty reference if it does not. Only
+ * data for which this holds is stored in the cache.
+ */
+ir::Ref verify_round_trip(const ir::Ref &ir, const utils::Str &data) {
+    auto result = deserialize(ir, data);
+    if (result.empty() || serialize(result) != data) {
+        return {};
+    }
+    return result;
+}
+
+/**
+ * Constructs the store from the current global options.
+ */
+Store::Store() :
+    dir(com::options::current()["cache_dir"].as_str()),
+    size_limit(com::options::current()["cache_size_limit"].as_uint() << 20)
+{}
+
+/**
+ * Returns the filename for the entry with the given digest.
+ */
+utils::Str Store::get_filename(const utils::Str &hash) const {
+    return dir + "/" + hash + ENTRY_SUFFIX;
+}
+
+/**
+ * Returns whether caching is enabled, i.e. whether cache_dir is set.
+ */
+utils::Bool Store::is_enabled() const {
+    return !dir.empty();
+}
+
+/**
+ * Looks up the entry for the given key. Returns whether it was found; if
+ * so, retval and data are set to the stored return value and result data.
+ */
+utils::Bool Store::load(
+    const utils::Str &key,
+    utils::Int &retval,
+    utils::Str &data
+) const {
+    if (!is_enabled()) {
+        return false;
+    }
+    auto hash = digest(key);
+    auto fname = get_filename(hash);
+    if (!utils::is_file(fname)) {
+        return false;
+    }
+    utils::Str contents;
+    try {
+        contents = utils::InFile(fname).read();
+    } catch (utils::Exception &e) {
+        QL_DOUT("failed to read cache entry " << fname << ": " << e.what());
+        return false;
+    }
+
+    // Check the header and the key stored after it, such that corrupted
+    // entries and hash collisions result in a miss.
+    auto eol = contents.find('\n');
+    if (eol == utils::Str::npos) {
+        return false;
+    }
+    std::istringstream header(contents.substr(0, eol));
+    utils::Str stored_hash;
+    utils::UInt stored_length = 0;
+    if (!(header >> stored_hash >> stored_length >> retval)) {
+        return false;
+    }
+    if (stored_hash != hash || stored_length != key.size()) {
+        return false;
+    }
+    if (contents.compare(eol + 1, key.size(), key) != 0) {
+        QL_DOUT("cache entry " << fname << " has a different key");
+        return false;
+    }
+    data = contents.substr(eol + 1 + key.size());
+
+    // Mark the entry as recently used for eviction.
+    utils::touch_file(fname);
+    QL_DOUT("loaded cached result from " << fname);
+    return true;
+}
+
+/**
+ * Stores the given return value and result data for the given key.
+ * Failure to write the entry is not an error, but results in a warning.
+ */
+void Store::save(
+    const utils::Str &key,
+    utils::Int retval,
+    const utils::Str &data
+) const {
+    if (!is_enabled()) {
+        return;
+    }
+    auto hash = digest(key);
+    auto fname = get_filename(hash);
+    auto tmp_fname = utils::get_temporary_path(fname);
+    utils::StrStrm header;
+    header << hash << " " << key.size() << " " << retval << "\n";
+    try {
+        utils::OutFile file(tmp_fname);
+        file << header.str();
+        file << key;
+        file << data;
+        file.close();
+    } catch (utils::Exception &e) {
+        QL_WOUT("failed to write compile cache entry " << tmp_fname << ": " << e.what());
+        utils::remove_file(tmp_fname);
+        return;
+    }
+    if (!utils::rename_file(tmp_fname, fname)) {
+        utils::remove_file(tmp_fname);
+        return;
+    }
+    QL_DOUT("saved result to compile cache as " << fname);
+
+    // Only scan the directory when this process first saves an entry in it,
+    // and when the estimated size exceeds the limit after that.
+    utils::UInt entry_size = header.str().size() + key.size() + data.size();
+    utils::Bool scan;
+    {
+        std::lock_guard<std::mutex> lock(size_estimates_mutex);
+        auto it = size_estimates.find(dir);
+        if (it == size_estimates.end()) {
+            scan = true;
+        } else {
+            it->second += entry_size;
+            scan = it->second > size_limit;
+        }
+    }
+    if (scan) {
+        auto total_size = evict(fname);
+        std::lock_guard<std::mutex> lock(size_estimates_mutex);
+        size_estimates.set(dir) = total_size;
+    }
+}
+
+/**
+ * Removes the least recently used entries other than the given one until
+ * the total size of the entries is within the size limit. Returns the total
+ * size of the remaining entries.
+ */
+utils::UInt Store::evict(const utils::Str &keep) const {
+    utils::Vec<utils::FileInfo> entries;
+    utils::UInt total_size = 0;
+    for (const auto &file : utils::list_files(dir)) {
+        if (utils::ends_with(file.path, ENTRY_SUFFIX)) {
+            entries.push_back(file);
+            total_size += file.size;
+        }
+    }
+    if (total_size <= size_limit) {
+        return total_size;
+    }
+    std::sort(
+        entries.begin(), entries.end(),
+        [](const utils::FileInfo &lhs, const utils::FileInfo &rhs) {
+            return lhs.modified < rhs.modified;
+        }
+    );
+    for (const auto &entry : entries) {
+        if (total_size <= size_limit) {
+            break;
+        }
+        if (entry.path == keep) {
+            continue;
+        }
+        if (utils::remove_file(entry.path)) {
+            QL_DOUT("evicted compile cache entry " << entry.path);
+            total_size -= entry.size;
+        }
+    }
+    return total_size;
+}
+
+} // namespace cache
+} // namespace pmgr
+} // namespace ql
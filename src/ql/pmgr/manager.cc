@@ -7,6 +7,7 @@
 #include "ql/utils/filesystem.h"
 #include "ql/com/options.h"
 #include "ql/arch/architecture.h"
+#include "ql/ir/consistency.h"
 #include "ql/ir/cqasm/write.h"
 
 namespace ql {
@@ -173,6 +174,46 @@ static utils::Str option_value_from_json(const utils::Json &json) {
 
 }
 
+/**
+ * Applies the given default pass options to the passes in the given group
+ * that have not been constructed yet, recursively. Options that don't exist
+ * for a pass or that were already set explicitly are left alone.
+ */
+static void apply_default_options(
+    const PassRef &group,
+    const utils::Map<utils::Str, utils::Str> &pass_default_options
+) {
+    for (const auto &pass : group->get_sub_passes()) {
+        if (!pass->is_constructed()) {
+            auto &opts = pass->get_options();
+            for (const auto &it : pass_default_options) {
+                if (opts.has_option(it.first) && !opts[it.first].is_set()) {
+                    opts[it.first] = it.second;
+                }
+            }
+        }
+        if (pass->is_group()) {
+            apply_default_options(pass, pass_default_options);
+        }
+    }
+}
+
+/**
+ * Returns whether any of the passes in the given group has not been
+ * constructed yet, recursively.
+ */
+static utils::Bool has_unconstructed_passes(const PassRef &group) {
+    for (const auto &pass : group->get_sub_passes()) {
+        if (!pass->is_constructed()) {
+            return true;
+        }
+        if (pass->is_group() && has_unconstructed_passes(pass)) {
+            return true;
+        }
+    }
+    return false;
+}
+
 /**
  * Load passes into the given pass group from a JSON array of pass descriptions.
  */
@@ -300,8 +341,8 @@ static utils::Map<utils::Str, utils::Str> convert_global_to_pass_options() {
 
     // Set output_prefix based on output_dir and unique_output.
     utils::StrStrm ss;
-    ss << com::options::global["output_dir"].as_str() << "/";
-    if (com::options::global["unique_output"].as_bool()) {
+    ss << com::options::current()["output_dir"].as_str() << "/";
+    if (com::options::current()["unique_output"].as_bool()) {
         ss << "%N";
     } else {
         ss << "%n";
@@ -311,19 +352,19 @@ static utils::Map<utils::Str, utils::Str> convert_global_to_pass_options() {
 
     // Set the debug option based on write_qasm_files and
     // write_report_files.
-    if (com::options::global["write_qasm_files"].as_bool()) {
-        if (com::options::global["write_report_files"].as_bool()) {
+    if (com::options::current()["write_qasm_files"].as_bool()) {
+        if (com::options::current()["write_report_files"].as_bool()) {
             retval.set("debug") = "both";
         } else {
             retval.set("debug") = "qasm";
         }
-    } else if (com::options::global["write_report_files"].as_bool()) {
+    } else if (com::options::current()["write_report_files"].as_bool()) {
         retval.set("debug") = "stats";
     }
 
     // Set options for the scheduler.
-    const auto &scheduler = com::options::global["scheduler"];
-    const auto &scheduler_uniform = com::options::global["scheduler_uniform"];
+    const auto &scheduler = com::options::current()["scheduler"];
+    const auto &scheduler_uniform = com::options::current()["scheduler_uniform"];
     if (scheduler.is_set() || scheduler_uniform.is_set()) {
         if (scheduler_uniform.as_bool()) {
             retval.set("scheduler_target") = "uniform";
@@ -336,25 +377,25 @@ static utils::Map<utils::Str, utils::Str> convert_global_to_pass_options() {
 
     // Set options for both the scheduler and mapper (since the mapper has
     // a scheduler built into it, they share some options).
-    const auto &scheduler_commute = com::options::global["scheduler_commute"];
+    const auto &scheduler_commute = com::options::current()["scheduler_commute"];
     if (scheduler_commute.is_set()) {
         retval.set("commute_multi_qubit") = scheduler_commute.as_str();
     }
-    const auto &scheduler_commute_rotations = com::options::global["scheduler_commute_rotations"];
+    const auto &scheduler_commute_rotations = com::options::current()["scheduler_commute_rotations"];
     if (scheduler_commute_rotations.is_set()) {
         retval.set("commute_single_qubit") = scheduler_commute_rotations.as_str();
     }
-    const auto &scheduler_heuristic = com::options::global["scheduler_heuristic"];
+    const auto &scheduler_heuristic = com::options::current()["scheduler_heuristic"];
     if (scheduler_heuristic.is_set()) {
         retval.set("scheduler_heuristic") = scheduler_heuristic.as_str();
     }
-    const auto &print_dot_graphs = com::options::global["print_dot_graphs"];
+    const auto &print_dot_graphs = com::options::current()["print_dot_graphs"];
     if (print_dot_graphs.is_set()) {
         retval.set("write_dot_graphs") = print_dot_graphs.as_str();
     }
 
     // Set options for the mapper.
-    const auto &initialplace = com::options::global["initialplace"];
+    const auto &initialplace = com::options::current()["initialplace"];
     if (initialplace.is_set()) {
         if (initialplace.as_str() == "no") {
             retval.set("enable_mip_placer") = "no";
@@ -365,51 +406,51 @@ static utils::Map<utils::Str, utils::Str> convert_global_to_pass_options() {
             retval.set("enable_mip_placer") = "yes";
         }
     }
-    const auto &initialplace2qhorizon = com::options::global["initialplace2qhorizon"];
+    const auto &initialplace2qhorizon = com::options::current()["initialplace2qhorizon"];
     if (initialplace2qhorizon.is_set()) {
         retval.set("mip_horizon") = initialplace2qhorizon.as_str();
     }
-    const auto &mapper = com::options::global["mapper"];
+    const auto &mapper = com::options::current()["mapper"];
     if (mapper.is_set() && mapper.as_str() != "no") {
         retval.set("route_heuristic") = mapper.as_str();
     }
-    const auto &mapmaxalters = com::options::global["mapmaxalters"];
+    const auto &mapmaxalters = com::options::current()["mapmaxalters"];
     if (mapmaxalters.is_set()) {
         retval.set("max_alternative_routes") = mapmaxalters.as_str();
     }
-    const auto &mapinitone2one = com::options::global["mapinitone2one"];
+    const auto &mapinitone2one = com::options::current()["mapinitone2one"];
     if (mapinitone2one.is_set()) {
         retval.set("initialize_one_to_one") = mapinitone2one.as_str();
     }
-    const auto &mapassumezeroinitstate = com::options::global["mapassumezeroinitstate"];
+    const auto &mapassumezeroinitstate = com::options::current()["mapassumezeroinitstate"];
     if (mapassumezeroinitstate.is_set()) {
         retval.set("assume_initialized") = mapassumezeroinitstate.as_str();
     }
-    const auto &mapprepinitsstate = com::options::global["mapprepinitsstate"];
+    const auto &mapprepinitsstate = com::options::current()["mapprepinitsstate"];
     if (mapprepinitsstate.is_set()) {
         retval.set("assume_prep_only_initializes") = mapprepinitsstate.as_str();
     }
-    const auto &maplookahead = com::options::global["maplookahead"];
+    const auto &maplookahead = com::options::current()["maplookahead"];
     if (maplookahead.is_set()) {
         retval.set("lookahead_mode") = maplookahead.as_str();
     }
-    const auto &mappathselect = com::options::global["mappathselect"];
+    const auto &mappathselect = com::options::current()["mappathselect"];
     if (mappathselect.is_set()) {
         retval.set("path_selection_mode") = mappathselect.as_str();
     }
-    const auto &mapselectswaps = com::options::global["mapselectswaps"];
+    const auto &mapselectswaps = com::options::current()["mapselectswaps"];
     if (mapselectswaps.is_set()) {
         retval.set("swap_selection_mode") = mapselectswaps.as_str();
     }
-    const auto &maprecNN2q = com::options::global["maprecNN2q"];
+    const auto &maprecNN2q = com::options::current()["maprecNN2q"];
     if (maprecNN2q.is_set()) {
         retval.set("recurse_on_nn_two_qubit") = maprecNN2q.as_str();
     }
-    const auto &mapselectmaxlevel = com::options::global["mapselectmaxlevel"];
+    const auto &mapselectmaxlevel = com::options::current()["mapselectmaxlevel"];
     if (mapselectmaxlevel.is_set()) {
         retval.set("recursion_depth_limit") = mapselectmaxlevel.as_str();
     }
-    const auto &mapselectmaxwidth = com::options::global["mapselectmaxwidth"];
+    const auto &mapselectmaxwidth = com::options::current()["mapselectmaxwidth"];
     if (mapselectmaxwidth.is_set()) {
         if (mapselectmaxwidth.as_str() == "min") {
             retval.set("recursion_width_factor") = "1.0";
@@ -423,29 +464,29 @@ static utils::Map<utils::Str, utils::Str> convert_global_to_pass_options() {
             retval.set("recursion_width_factor") = "100000000000";
         }
     }
-    const auto &maptiebreak = com::options::global["maptiebreak"];
+    const auto &maptiebreak = com::options::current()["maptiebreak"];
     if (maptiebreak.is_set()) {
         retval.set("tie_break_method") = maptiebreak.as_str();
     }
-    const auto &mapusemoves = com::options::global["mapusemoves"];
+    const auto &mapusemoves = com::options::current()["mapusemoves"];
     if (mapusemoves.is_set()) {
         retval.set("use_moves") = mapusemoves.as_str();
     }
-    const auto &mapreverseswap = com::options::global["mapreverseswap"];
+    const auto &mapreverseswap = com::options::current()["mapreverseswap"];
     if (mapreverseswap.is_set()) {
         retval.set("reverse_swap_if_better") = mapreverseswap.as_str();
     }
 
     // Set options for CC backend.
-    const auto &backend_cc_map_input_file = com::options::global["backend_cc_map_input_file"];
+    const auto &backend_cc_map_input_file = com::options::current()["backend_cc_map_input_file"];
     if (backend_cc_map_input_file.is_set()) {
         retval.set("map_input_file") = backend_cc_map_input_file.as_str();
     }
-    const auto &backend_cc_verbose = com::options::global["backend_cc_verbose"];
+    const auto &backend_cc_verbose = com::options::current()["backend_cc_verbose"];
     if (backend_cc_verbose.is_set()) {
         retval.set("verbose") = backend_cc_verbose.as_str();
     }
-    const auto &backend_cc_run_once = com::options::global["backend_cc_run_once"];
+    const auto &backend_cc_run_once = com::options::current()["backend_cc_run_once"];
     if (backend_cc_run_once.is_set()) {
         retval.set("run_once") = backend_cc_run_once.as_str();
     }
@@ -523,11 +564,10 @@ Manager Manager::from_json(
         throw utils::Exception("missing strategy.passes key");
     }
 
-    // Build the default pass options record.
+    // Build the default pass options record. The compatibility-mode options
+    // are only applied when the passes are constructed, for options that
+    // were not set explicitly by then.
     utils::Map<utils::Str, utils::Str> pass_default_options;
-    if (compatibility_mode) {
-        pass_default_options = convert_global_to_pass_options();
-    }
     if (pass_options) {
         for (auto it = pass_options->begin(); it != pass_options->end(); ++it) {
             pass_default_options.set(it.key()) = option_value_from_json(it.value());
@@ -536,6 +576,7 @@ Manager Manager::from_json(
 
     // Construct the pass manager.
     Manager manager{architecture, dnu};
+    manager.compatibility_mode = compatibility_mode;
 
     // Add passes from the pass descriptions.
     add_passes_from_json(manager.get_root(), *passes, pass_default_options);
@@ -567,21 +608,21 @@ Manager Manager::from_defaults(const ir::compat::PlatformRef &platform) {
         "io.cqasm.Report",
         "initialqasmwriter",
         {
-            {"output_prefix", com::options::global["output_dir"].as_str() + "/%N"},
+            {"output_prefix", com::options::current()["output_dir"].as_str() + "/%N"},
             {"output_suffix", ".qasm"},
             {"with_timing", "no"}
         }
     );
-    if (com::options::global["clifford_prescheduler"].as_bool()) {
+    if (com::options::current()["clifford_prescheduler"].as_bool()) {
         manager.append_pass(
             "opt.clifford.Optimize",
             "clifford_prescheduler"
         );
     }
-    if (com::options::global["prescheduler"].as_bool()) {
+    if (com::options::current()["prescheduler"].as_bool()) {
         if (
-            com::options::global["scheduler_uniform"].as_bool() ||
-            com::options::global["scheduler_heuristic"].is_set()
+            com::options::current()["scheduler_uniform"].as_bool() ||
+            com::options::current()["scheduler_heuristic"].is_set()
         ) {
             manager.append_pass(
                 "sch.Schedule",
@@ -601,7 +642,7 @@ Manager Manager::from_defaults(const ir::compat::PlatformRef &platform) {
             );
         }
     }
-    if (com::options::global["clifford_postscheduler"].as_bool()) {
+    if (com::options::current()["clifford_postscheduler"].as_bool()) {
         manager.append_pass(
             "opt.clifford.Optimize",
             "clifford_postscheduler"
@@ -611,7 +652,7 @@ Manager Manager::from_defaults(const ir::compat::PlatformRef &platform) {
         "io.cqasm.Report",
         "scheduledqasmwriter",
         {
-            {"output_prefix", com::options::global["output_dir"].as_str() + "/%N"},
+            {"output_prefix", com::options::current()["output_dir"].as_str() + "/%N"},
             {"output_suffix", "_scheduled.qasm"}
         }
     );
@@ -627,19 +668,8 @@ Manager Manager::from_defaults(const ir::compat::PlatformRef &platform) {
     );
 
     // Set the pass options using the compatibility mode option name/value
-    // converter.
-    auto options = convert_global_to_pass_options();
-    for (const auto &pass : manager.get_passes()) {
-        for (const auto &it : options) {
-            const auto &option = it.first;
-            const auto &value = it.second;
-            if (pass->get_options().has_option(option)) {
-                if (!pass->get_options()[option].is_set()) {
-                    pass->set_option(option, value);
-                }
-            }
-        }
-    }
+    // converter once the passes are constructed.
+    manager.compatibility_mode = true;
 
     return manager;
 }
@@ -884,11 +914,72 @@ void Manager::clear_passes() {
     return root->clear_sub_passes();
 }
 
+/**
+ * Creates context_options and context_logger from the current global options
+ * and log level if they don't exist yet.
+ */
+void Manager::ensure_context() {
+    if (context_options.has_value()) {
+        return;
+    }
+    context_logger.emplace();
+    context_options.emplace(com::options::make_ql_options());
+    utils::logger::Scope logger_scope(context_logger.unwrap().get());
+    context_options->update_from(com::options::current());
+}
+
+/**
+ * Sets one of OpenQL's global options (see com::options) for compilations
+ * using this pass manager only. The first call gives this pass manager a
+ * private copy of the current global options and log level, after which
+ * changes to the global options no longer affect it. This allows
+ * independent pass managers to compile concurrently in different threads.
+ */
+void Manager::set_context_option(const utils::Str &option, const utils::Str &value) {
+    ensure_context();
+    utils::logger::Scope logger_scope(context_logger.unwrap().get());
+    (*context_options)[option] = value;
+}
+
+/**
+ * Returns the value of one of OpenQL's global options as used for
+ * compilations using this pass manager.
+ */
+utils::Str Manager::get_context_option(const utils::Str &option) const {
+    if (context_options.has_value()) {
+        return (*context_options)[option].as_str();
+    }
+    return com::options::current()[option].as_str();
+}
+
+/**
+ * Redirects the log output of compilations using this pass manager to the
+ * given streams, for debug/info messages and warnings/errors respectively.
+ * Like set_context_option(), this gives the pass manager a private copy of
+ * the global options. The streams must outlive the pass manager or the next
+ * call to this function, whichever comes first.
+ */
+void Manager::set_log_streams(std::ostream &out, std::ostream &err) {
+    ensure_context();
+    context_logger->out = &out;
+    context_logger->err = &err;
+}
+
 /**
  * Constructs all passes recursively. This freezes the pass options, but
  * allows subtrees to be modified.
  */
 void Manager::construct() {
+    com::options::Scope options_scope(context_options.unwrap().get());
+    utils::logger::Scope logger_scope(context_logger.unwrap().get());
+
+    // Convert the compatibility-mode global options here rather than when
+    // the pass manager was built, such that they are read from the options
+    // of this pass manager's context as they are now.
+    if (compatibility_mode && has_unconstructed_passes(root)) {
+        apply_default_options(root, convert_global_to_pass_options());
+    }
+
     root->construct_recursive();
 }
 
@@ -897,11 +988,18 @@ void Manager::construct() {
  */
 void Manager::compile(const ir::Ref &ir) {
 
+    // Run everything with the options and logging context of this pass
+    // manager.
+    com::options::Scope options_scope(context_options.unwrap().get());
+    utils::logger::Scope logger_scope(context_logger.unwrap().get());
+
     // Ensure that all passes are constructed.
     construct();
 
-    // Compile the program.
+    // Check the incoming IR, compile the program, and check the result.
+    ir::check_consistency(ir, ir::ConsistencyCheckLevel::BOUNDARY);
     root->compile(ir, "");
+    ir::check_consistency(ir, ir::ConsistencyCheckLevel::BOUNDARY);
 
 }
 
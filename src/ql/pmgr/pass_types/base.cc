@@ -6,9 +6,12 @@
 
 #include <cctype>
 #include <regex>
+#include <memory>
 #include "ql/utils/filesystem.h"
+#include "ql/ir/consistency.h"
 #include "ql/ir/cqasm/write.h"
 #include "ql/pmgr/manager.h"
+#include "ql/pmgr/cache.h"
 #include "ql/pass/ana/statistics/report.h"
 
 namespace ql {
@@ -182,6 +185,26 @@ Base::Base(
         "no",
         {"no", "yes", "stats", "qasm", "both"}
     );
+    options.add_enum(
+        "cache",
+        "Controls whether the result of this pass is taken from the compile "
+        "cache, configured via the `cache_dir` global option, when the same "
+        "pass (or pass group) with the same options was run on the same "
+        "platform and input before. `no` disables caching. `program` caches "
+        "the resulting program as a whole. `kernel` caches the result for "
+        "each kernel separately for passes that operate on kernels "
+        "independently, such that only the kernels that changed are "
+        "recompiled, also when the same kernel appears in another program "
+        "or at another position. The additional statistics a pass adds to a "
+        "kernel are cached along with it. For other passes, `kernel` "
+        "behaves as `program`, except for pass groups, which are then not "
+        "cached themselves (the option is normally set for their sub-passes "
+        "as well). Only results that can be "
+        "represented in cQASM are cached, and output files written by a pass "
+        "are not reproduced when its result is taken from the cache.",
+        "no",
+        {"no", "program", "kernel"}
+    );
 }
 
 /**
@@ -192,6 +215,28 @@ utils::Bool Base::is_legacy() const {
     return false;
 }
 
+/**
+ * Returns whether this pass operates on each kernel independently, such that
+ * its results can be cached per kernel. Returns false unless overridden.
+ */
+utils::Bool Base::is_kernel_local() const {
+    return false;
+}
+
+/**
+ * Returns the key text for the compile cache for running this pass or pass
+ * group on the given input, using the platform of the given IR. The input is
+ * normally the serialized program or kernel.
+ */
+utils::Str Base::make_cache_key(
+    const ir::Ref &ir,
+    const utils::Str &input
+) const {
+    utils::StrStrm config;
+    dump_cache_config(config);
+    return cache::make_key(config.str(), ir, input);
+}
+
 /**
  * Returns `pass "<name>"` for normal passes and `root` for the root pass.
  * Used for error messages.
@@ -1033,7 +1078,17 @@ utils::Int Base::run_main_pass(
     const Context &context
 ) const {
     QL_IOUT("starting pass \"" << context.full_pass_name << "\" of type \"" << type_name << "\"...");
+
+    // In paranoid mode, check the parts of the IR modified by the pass.
+    std::unique_ptr<ir::IncrementalConsistencyChecker> checker;
+    if (ir::get_consistency_check_level() >= ir::ConsistencyCheckLevel::PARANOID) {
+        checker.reset(new ir::IncrementalConsistencyChecker(ir));
+    }
+
     auto retval = run_internal(ir, context);
+    if (checker) {
+        checker->check(ir);
+    }
     QL_IOUT("completed pass \"" << context.full_pass_name << "\"; return value is " << retval);
     return retval;
 }
@@ -1052,6 +1107,131 @@ void Base::run_sub_passes(
     }
 }
 
+/**
+ * Dumps the complete configuration of this pass and all sub-passes, including
+ * the options that were not explicitly set, for use as part of the compile
+ * cache key.
+ */
+void Base::dump_cache_config(std::ostream &os) const {
+    os << "pass " << type_name << "\n";
+    options.dump_options(false, os, "  ");
+    if (is_group()) {
+        if (node_type != NodeType::GROUP) {
+            os << "condition " << condition->to_string() << "\n";
+        }
+        for (const auto &pass : sub_pass_order) {
+            pass->dump_cache_config(os);
+        }
+        os << "end\n";
+    }
+}
+
+/**
+ * Traverses our level of the pass tree based on our node type.
+ */
+void Base::run_node(
+    const ir::Ref &ir,
+    const Context &context
+) const {
+    switch (node_type) {
+        case NodeType::NORMAL: {
+            run_main_pass(ir, context);
+            break;
+        }
+
+        case NodeType::GROUP: {
+            run_sub_passes(ir, context);
+            break;
+        }
+
+        case NodeType::GROUP_IF: {
+            auto retval = run_main_pass(ir, context);
+            if (condition->evaluate(retval)) {
+                QL_IOUT("pass condition returned true, running sub-passes...");
+                run_sub_passes(ir, context);
+            } else {
+                QL_IOUT("pass condition returned false, skipping " << sub_pass_order.size() << " sub-pass(es)");
+            }
+            break;
+        }
+
+        case NodeType::GROUP_WHILE: {
+            QL_IOUT("entering loop pass loop...");
+            while (true) {
+                auto retval = run_main_pass(ir, context);
+                if (!condition->evaluate(retval)) {
+                    QL_IOUT("pass condition returned false, exiting loop");
+                    break;
+                } else {
+                    QL_IOUT("pass condition returned true, continuing loop...");
+                }
+                run_sub_passes(ir, context);
+            }
+            break;
+        }
+
+        case NodeType::GROUP_REPEAT_UNTIL_NOT: {
+            QL_IOUT("entering loop pass loop...");
+            while (true) {
+                run_sub_passes(ir, context);
+                auto retval = run_main_pass(ir, context);
+                if (!condition->evaluate(retval)) {
+                    QL_IOUT("pass condition returned false, exiting loop");
+                    break;
+                } else {
+                    QL_IOUT("pass condition returned true, continuing loop...");
+                }
+            }
+            break;
+        }
+
+        default: QL_ASSERT(false);
+    }
+}
+
+/**
+ * Wrapper around run_node() that takes the resulting program from the compile
+ * cache if it is there, and stores it in the cache otherwise.
+ */
+void Base::run_node_cached(
+    const ir::Ref &ir,
+    const Context &context
+) const {
+    cache::Store store;
+    if (!store.is_enabled() || ir->program.empty()) {
+        run_node(ir, context);
+        return;
+    }
+    auto key = make_cache_key(ir, cache::serialize(ir));
+
+    // Splice in the cached program if there is one.
+    utils::Int retval;
+    utils::Str data;
+    if (store.load(key, retval, data)) {
+        auto cached = cache::deserialize(ir, data);
+        if (!cached.empty()) {
+            QL_IOUT("using cached result for \"" << context.full_pass_name << "\"");
+            ir->program = cached->program;
+            return;
+        }
+    }
+
+    // Run the pass normally, and store the result if only the program was
+    // modified, in a way that can be reproduced exactly.
+    auto platform = cache::summarize_platform(ir);
+    run_node(ir, context);
+    if (ir->program.empty() || cache::summarize_platform(ir) != platform) {
+        QL_DOUT("not caching result of \"" << context.full_pass_name << "\": platform was modified");
+        return;
+    }
+    data = cache::serialize(ir);
+    if (cache::verify_round_trip(ir, data).empty()) {
+        QL_DOUT("not caching result of \"" << context.full_pass_name << "\": no exact cQASM representation");
+        return;
+    }
+    store.save(key, 0, data);
+}
+
 /**
  * Executes this pass or pass group on the given platform and program.
  */
@@ -1123,60 +1303,12 @@ void Base::compile(
     // Handle configured debugging actions before running the pass.
     handle_debugging(ir, context, false);
 
-    // Traverse our level of the pass tree based on our node type.
-    switch (node_type) {
-        case NodeType::NORMAL: {
-            run_main_pass(ir, context);
-            break;
-        }
-
-        case NodeType::GROUP: {
-            run_sub_passes(ir, context);
-            break;
-        }
-
-        case NodeType::GROUP_IF: {
-            auto retval = run_main_pass(ir, context);
-            if (condition->evaluate(retval)) {
-                QL_IOUT("pass condition returned true, running sub-passes...");
-                run_sub_passes(ir, context);
-            } else {
-                QL_IOUT("pass condition returned false, skipping " << sub_pass_order.size() << " sub-pass(es)");
-            }
-            break;
-        }
-
-        case NodeType::GROUP_WHILE: {
-            QL_IOUT("entering loop pass loop...");
-            while (true) {
-                auto retval = run_main_pass(ir, context);
-                if (!condition->evaluate(retval)) {
-                    QL_IOUT("pass condition returned false, exiting loop");
-                    break;
-                } else {
-                    QL_IOUT("pass condition returned true, continuing loop...");
-                }
-                run_sub_passes(ir, context);
-            }
-            break;
-        }
-
-        case NodeType::GROUP_REPEAT_UNTIL_NOT: {
-            QL_IOUT("entering loop pass loop...");
-            while (true) {
-                run_sub_passes(ir, context);
-                auto retval = run_main_pass(ir, context);
-                if (!condition->evaluate(retval)) {
-                    QL_IOUT("pass condition returned false, exiting loop");
-                    break;
-                } else {
-                    QL_IOUT("pass condition returned true, continuing loop...");
-                }
-            }
-            break;
-        }
-
-        default: QL_ASSERT(false);
+    // Traverse our level of the pass tree, possibly using the compile cache.
+    const auto &cache_opt = options["cache"].as_str();
+    if (cache_opt == "program" || (cache_opt == "kernel" && !is_group() && !is_kernel_local())) {
+        run_node_cached(ir, context);
+    } else {
+        run_node(ir, context);
     }
 
     // Handle configured debugging actions after running the pass.
@@ -5,8 +5,11 @@
 
 #include "ql/pmgr/pass_types/specializations.h"
 
+#include "ql/utils/list.h"
 #include "ql/ir/new_to_old.h"
 #include "ql/ir/old_to_new.h"
+#include "ql/pmgr/cache.h"
+#include "ql/pass/ana/statistics/annotations.h"
 
 namespace ql {
 namespace pmgr {
@@ -163,9 +166,16 @@ utils::Int KernelTransformation::run_internal(
     const Context &context
 ) const {
     auto program = ir::convert_new_to_old(ir);
+    utils::Bool cached = context.options["cache"].as_str() == "kernel";
     utils::Int accumulator = retval_initialize();
     for (const auto &kernel : program->kernels) {
-        accumulator = retval_accumulate(accumulator, run(program, kernel, context));
+        utils::Int retval;
+        if (cached && kernel->type == ir::compat::KernelType::STATIC) {
+            retval = run_cached(ir, program, kernel, context);
+        } else {
+            retval = run(program, kernel, context);
+        }
+        accumulator = retval_accumulate(accumulator, retval);
     }
     auto new_ir = ir::convert_old_to_new(program);
     ir->program = new_ir->program;
@@ -174,6 +184,166 @@ utils::Int KernelTransformation::run_internal(
     return accumulator;
 }
 
+/**
+ * Converts a single kernel of the given program to the new IR, as the only
+ * kernel of a program with the same register sizes. The program name is
+ * fixed, such that the cache key of a kernel does not depend on the program
+ * it appears in.
+ */
+static ir::Ref convert_kernel(
+    const ir::compat::ProgramRef &program,
+    const ir::compat::KernelRef &kernel
+) {
+    auto single = utils::make<ir::compat::Program>(
+        "kernel", program->platform,
+        program->qubit_count, program->creg_count, program->breg_count
+    );
+    single->add(kernel);
+    return ir::convert_old_to_new(single);
+}
+
+/**
+ * Returns the additional statistics lines of the given kernel.
+ */
+static utils::List<utils::Str> get_kernel_stats(const ir::compat::KernelRef &kernel) {
+    using pass::ana::statistics::AdditionalStats;
+    if (auto stats = kernel->get_annotation_ptr<AdditionalStats>()) {
+        return stats->stats;
+    }
+    return {};
+}
+
+/**
+ * Reads a line from the given cache data, starting at pos. pos is advanced
+ * past the newline. Returns false if there is no complete line.
+ */
+static utils::Bool read_line(
+    const utils::Str &data,
+    utils::UInt &pos,
+    utils::Str &line
+) {
+    auto end = data.find('\n', pos);
+    if (end == utils::Str::npos) {
+        return false;
+    }
+    line = data.substr(pos, end - pos);
+    pos = end + 1;
+    return true;
+}
+
+/**
+ * Parses the header of a per-kernel cache entry, written by
+ * KernelTransformation::run_cached(). pos is advanced to the start of the
+ * cQASM data. Returns false if the header is malformed.
+ */
+static utils::Bool parse_kernel_header(
+    const utils::Str &data,
+    utils::UInt &pos,
+    utils::Bool &cycles_valid,
+    utils::List<utils::Str> &stats
+) {
+    utils::Str line;
+    if (!read_line(data, pos, line) || (line != "0" && line != "1")) {
+        return false;
+    }
+    cycles_valid = line == "1";
+    utils::Bool ok = false;
+    if (!read_line(data, pos, line)) {
+        return false;
+    }
+    auto num_stats = utils::parse_uint(line, 0, &ok);
+    for (utils::UInt i = 0; ok && i < num_stats; i++) {
+        if (!read_line(data, pos, line)) {
+            return false;
+        }
+        auto length = utils::parse_uint(line, 0, &ok);
+        if (!ok || pos + length > data.size()) {
+            return false;
+        }
+        stats.push_back(data.substr(pos, length));
+        pos += length;
+    }
+    return ok;
+}
+
+/**
+ * Wrapper around run() for a single kernel that takes the resulting kernel
+ * from the compile cache if it is there, and stores it in the cache
+ * otherwise.
+ */
+utils::Int KernelTransformation::run_cached(
+    const ir::Ref &ir,
+    const ir::compat::ProgramRef &program,
+    const ir::compat::KernelRef &kernel,
+    const Context &context
+) const {
+    cache::Store store;
+    if (!store.is_enabled()) {
+        return run(program, kernel, context);
+    }
+    auto input = convert_kernel(program, kernel);
+    auto key = make_cache_key(ir, cache::serialize(input));
+
+    // Splice in the gates of the cached kernel if there is one. The data
+    // starts with a header recording whether the kernel was scheduled and
+    // the statistics the pass added to the kernel, each prefixed by its
+    // length, followed by the cQASM representation of the kernel.
+    utils::Int retval;
+    utils::Str data;
+    utils::UInt pos = 0;
+    utils::Bool cycles_valid = false;
+    utils::List<utils::Str> stats;
+    if (store.load(key, retval, data) && parse_kernel_header(data, pos, cycles_valid, stats)) {
+        auto cached = cache::deserialize(input, data.substr(pos));
+        if (!cached.empty()) {
+            auto cached_program = ir::convert_new_to_old(cached);
+            if (cached_program->kernels.size() == 1) {
+                QL_IOUT(
+                    "using cached result for \"" << context.full_pass_name
+                    << "\" on kernel " << kernel->name
+                );
+                kernel->gates = cached_program->kernels[0]->gates;
+                kernel->cycles_valid = cycles_valid;
+                for (const auto &stat : stats) {
+                    pass::ana::statistics::AdditionalStats::push(kernel, stat);
+                }
+                return retval;
+            }
+        }
+    }
+
+    // Run the pass normally, and store the result if it can be reproduced
+    // exactly.
+    auto platform = program->platform->platform_config.dump();
+    auto num_stats_before = get_kernel_stats(kernel).size();
+    retval = run(program, kernel, context);
+    if (program->platform->platform_config.dump() != platform) {
+        return retval;
+    }
+    auto output = convert_kernel(program, kernel);
+    data = cache::serialize(output);
+    auto round_trip = cache::verify_round_trip(output, data);
+    if (round_trip.empty() || ir::convert_new_to_old(round_trip)->kernels.size() != 1) {
+        QL_DOUT(
+            "not caching result of \"" << context.full_pass_name
+            << "\" on kernel " << kernel->name << ": no exact cQASM representation"
+        );
+        return retval;
+    }
+    stats = get_kernel_stats(kernel);
+    for (utils::UInt i = 0; i < num_stats_before; i++) {
+        stats.pop_front();
+    }
+    utils::StrStrm header;
+    header << (kernel->cycles_valid ? "1" : "0") << "\n";
+    header << stats.size() << "\n";
+    for (const auto &stat : stats) {
+        header << stat.size() << "\n" << stat;
+    }
+    store.save(key, retval, header.str() + data);
+    return retval;
+}
+
 /**
  * Returns that this is a legacy pass.
  */
@@ -181,6 +351,13 @@ utils::Bool KernelTransformation::is_legacy() const {
     return true;
 }
 
+/**
+ * Returns that this pass operates on each kernel independently.
+ */
+utils::Bool KernelTransformation::is_kernel_local() const {
+    return true;
+}
+
 /**
  * Constructs the pass. No error checking here; this is up to the parent
  * pass group.
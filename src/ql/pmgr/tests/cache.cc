@@ -0,0 +1,138 @@
+#include <sstream>
+
+#include "ql/utils/filesystem.h"
+#include "ql/ir/compat/compat.h"
+#include "ql/ir/old_to_new.h"
+#include "ql/ir/cqasm/write.h"
+#include "ql/com/options.h"
+#include "ql/pmgr/manager.h"
+
+using namespace ql;
+
+/**
+ * Builds a program with two kernels, of which the second one depends on the
+ * given parameter.
+ */
+static ir::compat::ProgramRef make_program(
+    const ir::compat::PlatformRef &plat,
+    utils::UInt param,
+    const utils::Str &name = "test_prog"
+) {
+    auto program = utils::make<ir::compat::Program>(name, plat, 7, 32, 10);
+    auto first = utils::make<ir::compat::Kernel>("first", plat, 7, 32, 10);
+    for (utils::UInt i = 0; i < 20; i++) {
+        first->x(i % 7);
+        first->cnot(i % 7, (i + 2) % 7);
+    }
+    program->add(first);
+    auto second = utils::make<ir::compat::Kernel>("second", plat, 7, 32, 10);
+    for (utils::UInt i = 0; i < 20; i++) {
+        second->y((i + param) % 7);
+        second->cz(i % 7, (i + 3) % 7);
+    }
+    program->add(second);
+    return program;
+}
+
+/**
+ * Schedules the given program with the given cache option and additional
+ * scheduler options, and returns the resulting cQASM. The number of cache
+ * hits is returned via hits.
+ */
+static utils::Str schedule(
+    const ir::compat::ProgramRef &program,
+    const utils::Str &cache,
+    utils::UInt &hits,
+    utils::Map<utils::Str, utils::Str> options = {}
+) {
+    std::ostringstream out, err;
+    pmgr::Manager manager;
+    options.set("cache") = cache;
+    manager.append_pass("sch.Schedule", "scheduler", options);
+    manager.set_log_streams(out, err);
+    manager.set_context_option("log_level", "LOG_INFO");
+    auto ir = ir::convert_old_to_new(program);
+    manager.compile(ir);
+
+    hits = 0;
+    std::istringstream lines(out.str());
+    utils::Str line;
+    while (std::getline(lines, line)) {
+        if (line.find("using cached result") != utils::Str::npos) {
+            hits++;
+        }
+    }
+
+    std::ostringstream ss;
+    ir::cqasm::write(ir, {}, ss);
+    return ss.str();
+}
+
+int main() {
+    auto plat = ir::compat::Platform::build("test_plat", utils::Str("cc_light"));
+    utils::Str dir = "test_output/compile_cache";
+    for (const auto &file : utils::list_files(dir)) {
+        utils::remove_file(file.path);
+    }
+    com::options::set("cache_dir", dir);
+
+    // The reference result, without caching.
+    utils::UInt hits;
+    auto reference = schedule(make_program(plat, 0), "no", hits);
+    QL_ASSERT_EQ(hits, 0u);
+
+    // Program-level caching: the first compilation stores the result, the
+    // second one reuses it, and both must be identical to the reference.
+    QL_ASSERT_EQ(schedule(make_program(plat, 0), "program", hits), reference);
+    QL_ASSERT_EQ(hits, 0u);
+    QL_ASSERT_EQ(utils::list_files(dir).size(), 1u);
+    QL_ASSERT_EQ(schedule(make_program(plat, 0), "program", hits), reference);
+    QL_ASSERT_EQ(hits, 1u);
+
+    // Kernel-level caching: when only the second kernel changes, the result
+    // for the first kernel is reused.
+    QL_ASSERT_EQ(schedule(make_program(plat, 0), "kernel", hits), reference);
+    QL_ASSERT_EQ(hits, 0u);
+    QL_ASSERT_EQ(schedule(make_program(plat, 0), "kernel", hits), reference);
+    QL_ASSERT_EQ(hits, 2u);
+    auto changed = schedule(make_program(plat, 1), "no", hits);
+    QL_ASSERT_EQ(schedule(make_program(plat, 1), "kernel", hits), changed);
+    QL_ASSERT_EQ(hits, 1u);
+
+    // The per-kernel result does not depend on the name of the program.
+    auto renamed = schedule(make_program(plat, 0, "other_prog"), "no", hits);
+    QL_ASSERT_EQ(schedule(make_program(plat, 0, "other_prog"), "kernel", hits), renamed);
+    QL_ASSERT_EQ(hits, 2u);
+
+    // Changing a pass option, a global option, or the platform results in a
+    // miss.
+    QL_ASSERT_EQ(schedule(make_program(plat, 0), "program", hits), reference);
+    QL_ASSERT_EQ(hits, 1u);
+    utils::Map<utils::Str, utils::Str> commute;
+    commute.set("commute_single_qubit") = "yes";
+    auto commuted = schedule(make_program(plat, 0), "no", hits, commute);
+    QL_ASSERT_EQ(schedule(make_program(plat, 0), "program", hits, commute), commuted);
+    QL_ASSERT_EQ(hits, 0u);
+    com::options::set("mapper", "minextend");
+    QL_ASSERT_EQ(schedule(make_program(plat, 0), "program", hits), reference);
+    QL_ASSERT_EQ(hits, 0u);
+    com::options::set("mapper", "no");
+    auto other_plat = ir::compat::Platform::build("test_plat", utils::Str("cc_light.s7"));
+    auto other = schedule(make_program(other_plat, 0), "no", hits);
+    QL_ASSERT_EQ(schedule(make_program(other_plat, 0), "program", hits), other);
+    QL_ASSERT_EQ(hits, 0u);
+
+    // With a size limit of zero, only the most recently stored entry is
+    // kept, so the first program misses again.
+    com::options::set("cache_size_limit", "0");
+    schedule(make_program(plat, 2), "program", hits);
+    QL_ASSERT_EQ(hits, 0u);
+    QL_ASSERT_EQ(utils::list_files(dir).size(), 1u);
+    QL_ASSERT_EQ(schedule(make_program(plat, 0), "program", hits), reference);
+    QL_ASSERT_EQ(hits, 0u);
+    QL_ASSERT_EQ(utils::list_files(dir).size(), 1u);
+    com::options::set("cache_size_limit", "1024");
+
+    com::options::set("cache_dir", "");
+    return 0;
+}
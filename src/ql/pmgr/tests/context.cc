@@ -0,0 +1,96 @@
+#include <thread>
+#include <sstream>
+
+#include "ql/ir/compat/compat.h"
+#include "ql/ir/old_to_new.h"
+#include "ql/com/options.h"
+#include "ql/pmgr/manager.h"
+
+using namespace ql;
+
+/**
+ * Builds a program with some gates to schedule.
+ */
+static ir::compat::ProgramRef make_program(const ir::compat::PlatformRef &plat) {
+    auto program = utils::make<ir::compat::Program>("test_prog", plat, 7, 32, 10);
+    auto kernel = utils::make<ir::compat::Kernel>("kernel", plat, 7, 32, 10);
+    for (utils::UInt i = 0; i < 50; i++) {
+        kernel->x(i % 7);
+        kernel->cnot(i % 7, (i + 2) % 7);
+    }
+    program->add(kernel);
+    return program;
+}
+
+/**
+ * Compiles programs repeatedly with the given pass manager.
+ */
+static void compile_many(pmgr::Manager &manager, const ir::compat::PlatformRef &plat) {
+    for (utils::UInt i = 0; i < 10; i++) {
+        manager.compile(ir::convert_old_to_new(make_program(plat)));
+    }
+}
+
+int main() {
+    auto plat = ir::compat::Platform::build("test_plat", utils::Str("cc_light"));
+
+    // Two pass managers with their own log levels and log streams, compiling
+    // concurrently.
+    std::ostringstream verbose_out, verbose_err, quiet_out, quiet_err;
+    pmgr::Manager verbose, quiet;
+    verbose.append_pass("sch.Schedule", "scheduler");
+    quiet.append_pass("sch.Schedule", "scheduler");
+    verbose.set_log_streams(verbose_out, verbose_err);
+    quiet.set_log_streams(quiet_out, quiet_err);
+    verbose.set_context_option("log_level", "LOG_DEBUG");
+    quiet.set_context_option("log_level", "LOG_NOTHING");
+
+    std::thread verbose_thread([&]() { compile_many(verbose, plat); });
+    std::thread quiet_thread([&]() { compile_many(quiet, plat); });
+    verbose_thread.join();
+    quiet_thread.join();
+
+    // Only the verbose pass manager should have logged anything, and the
+    // process-wide options should be untouched.
+    QL_ASSERT(!verbose_out.str().empty());
+    QL_ASSERT(quiet_out.str().empty());
+    QL_ASSERT(quiet_err.str().empty());
+    QL_ASSERT_EQ(verbose.get_context_option("log_level"), "LOG_DEBUG");
+    QL_ASSERT_EQ(quiet.get_context_option("log_level"), "LOG_NOTHING");
+    QL_ASSERT(com::options::global["log_level"].as_str() != "LOG_DEBUG");
+    QL_ASSERT(utils::logger::get_log_level() != utils::logger::LogLevel::LOG_DEBUG);
+
+    // Compatibility options set for the context of a pass manager after it
+    // was built must still reach its passes.
+    auto defaults = pmgr::Manager::from_defaults(plat);
+    defaults.set_context_option("scheduler", "ASAP");
+    defaults.construct();
+    utils::UInt schedulers = 0;
+    for (const auto &pass : defaults.get_passes()) {
+        if (pass->get_options().has_option("scheduler_target")) {
+            QL_ASSERT_EQ(pass->get_options()["scheduler_target"].as_str(), "asap");
+            schedulers++;
+        }
+    }
+    QL_ASSERT(schedulers > 0);
+    QL_ASSERT(com::options::global["scheduler"].as_str() != "ASAP");
+
+    // A scope without options or logging context keeps the enclosing one.
+    utils::Options outer_options = com::options::make_ql_options();
+    utils::logger::Context outer_context;
+    {
+        com::options::Scope outer_options_scope(&outer_options);
+        utils::logger::Scope outer_logger_scope(&outer_context);
+        {
+            com::options::Scope inner_options_scope(nullptr);
+            utils::logger::Scope inner_logger_scope(nullptr);
+            QL_ASSERT(&com::options::current() == &outer_options);
+            QL_ASSERT(utils::logger::get_context() == &outer_context);
+        }
+        QL_ASSERT(&com::options::current() == &outer_options);
+    }
+    QL_ASSERT(&com::options::current() == &com::options::global);
+    QL_ASSERT(utils::logger::get_context() == nullptr);
+
+    return 0;
+}
@@ -496,32 +496,27 @@ void InstrumentResource::on_initialize(rmgr::Direction direction) {
 }
 
 /**
- * Checks availability of and/or reserves a gate.
+ * Determines which instruments are affected by the given gate, and (if the
+ * instruments are not mutually exclusive) which function the gate needs them
+ * for. Returns false if the resource does not care about the gate at all.
  */
-utils::Bool InstrumentResource::on_gate(
-    utils::Int cycle,
+utils::Bool InstrumentResource::get_affected(
     const rmgr::resource_types::GateData &gate,
-    utils::Bool commit
+    utils::Set<Instrument> &affected,
+    Function &function
 ) {
-    QL_DOUT(
-        "instrument resource " << context->instance_name
-        << " got gate with name " << gate.name
-        << " and qubit operands " << gate.qubits
-        << " for cycle " << cycle
-        << " with commit set to " << commit
-    );
 
     // We don't do anything with gates that don't have qubit operands.
     if (gate.qubits.empty()) {
         QL_DOUT(" -> available: gate has no qubit operands");
-        return true;
+        return false;
     }
 
     // Fetch the JSON data for this gate.
     const auto &gate_json = *gate.data;
 
     // Check predicates. If the gate doesn't match, we don't care about it, so
-    // we can return true, such that it can be started in any cycle.
+    // it can be started in any cycle.
     auto op_count_pos = utils::min<utils::UInt>(gate.qubits.size() - 1, 2);
     for (const auto &predicate : config->predicates[op_count_pos]) {
         auto it = gate_json.find(predicate.first);
@@ -530,25 +525,24 @@ utils::Bool InstrumentResource::on_gate(
                 " -> available: gate does not match predicate "
                 << predicate.first << ": key does not exist"
             );
-            return true;
+            return false;
         } else if (!it->is_string()) {
             QL_DOUT(
                 " -> available: gate does not match predicate "
                 << predicate.first << ": key is not a string"
             );
-            return true;
+            return false;
         } else if (predicate.second.count(it->get<utils::Str>()) == 0) {
             QL_DOUT(
                 " -> available: gate does not match predicate "
                 << predicate.first << ": value " << it->get<utils::Str>()
                 << " not in " << predicate.second
             );
-            return true;
+            return false;
         }
     }
 
     // Check operands to see which instruments are affected.
-    utils::Set<Instrument> affected;
     switch (gate.qubits.size()) {
         case 1: {
             // Single-qubit gate.
@@ -590,6 +584,66 @@ utils::Bool InstrumentResource::on_gate(
     // If no instruments are affected, short-circuit here.
     if (affected.empty()) {
         QL_DOUT(" -> available: no instruments are affected");
+        return false;
+    }
+
+    // If function is set to exclusive, we don't care about the function value.
+    function = 0;
+    if (config->mutually_exclusive) {
+        return true;
+    }
+
+    // If not mutually exclusive, determine the function based on keys in
+    // the gate's JSON.
+    utils::Vec<utils::Str> function_key;
+    function_key.resize(config->function_keys.size());
+    for (utils::UInt i = 0; i < function_key.size(); i++) {
+        auto it = gate_json.find(config->function_keys[i]);
+        if (it != gate_json.end() && it->is_string()) {
+            function_key[i] = it->get<utils::Str>();
+        }
+    }
+    QL_DOUT("    function key = " << function_key);
+
+    // Because storing vectors of strings in the resource state is a bit
+    // ridiculous, we map these string tuples to unique integers. We just
+    // generate a new integer whenever we see a function that we haven't
+    // seen before. Note that this is fine even when resources are cloned
+    // (remember: config is NOT cloned!) because we only ever add indices
+    // here. Doing so doesn't affect the state. At worst, it may change
+    // *future* indices added by other clones of this resource.
+    auto it = config->function_map.find(function_key);
+    if (it == config->function_map.end()) {
+        function = config->function_map.size();
+        config->function_map.set(function_key) = function;
+    } else {
+        function = it->second;
+    }
+    QL_DOUT("    function index = " << function);
+
+    return true;
+}
+
+/**
+ * Checks availability of and/or reserves a gate.
+ */
+utils::Bool InstrumentResource::on_gate(
+    utils::Int cycle,
+    const rmgr::resource_types::GateData &gate,
+    utils::Bool commit
+) {
+    QL_DOUT(
+        "instrument resource " << context->instance_name
+        << " got gate with name " << gate.name
+        << " and qubit operands " << gate.qubits
+        << " for cycle " << cycle
+        << " with commit set to " << commit
+    );
+
+    // Figure out which instruments are affected and the function.
+    utils::Set<Instrument> affected;
+    Function function;
+    if (!get_affected(gate, affected, function)) {
         return true;
     }
 
@@ -602,51 +656,22 @@ utils::Bool InstrumentResource::on_gate(
     // If function is set to exclusive, just check/reserve the cycle range for
     // this gate for all affected instruments without caring about the function
     // value.
-    Function function = 0;
     if (config->mutually_exclusive) {
         for (auto index : affected) {
-            if (state[index].find(range).type != utils::RangeMatchType::NONE) {
+            if (state[index]->find(range).type != utils::RangeMatchType::NONE) {
                 QL_DOUT(" -> not available because of instrument " << config->instrument_names[index]);
                 return false;
             }
         }
     } else {
 
-        // If not mutually exclusive, determine the function based on keys in
-        // the gate's JSON.
-        utils::Vec<utils::Str> function_key;
-        function_key.resize(config->function_keys.size());
-        for (utils::UInt i = 0; i < function_key.size(); i++) {
-            auto it = gate_json.find(config->function_keys[i]);
-            if (it != gate_json.end() && it->is_string()) {
-                function_key[i] = it->get<utils::Str>();
-            }
-        }
-        QL_DOUT("    function key = " << function_key);
-
-        // Because storing vectors of strings in the resource state is a bit
-        // ridiculous, we map these string tuples to unique integers. We just
-        // generate a new integer whenever we see a function that we haven't
-        // seen before. Note that this is fine even when resources are cloned
-        // (remember: config is NOT cloned!) because we only ever add indices
-        // here. Doing so doesn't affect the state. At worst, it may change
-        // *future* indices added by other clones of this resource.
-        auto it = config->function_map.find(function_key);
-        if (it == config->function_map.end()) {
-            function = config->function_map.size();
-            config->function_map.set(function_key) = function;
-        } else {
-            function = it->second;
-        }
-        QL_DOUT("    function index = " << function);
-
         // Check the resources based on function index.
         for (auto index : affected) {
             QL_DOUT("    reservations for instrument " << config->instrument_names[index] << ":");
             QL_IF_LOG_DEBUG {
-                state[index].dump_state(std::cout, "      ");
+                state[index]->dump_state(std::cout, "      ");
             }
-            auto result = state[index].find(range);
+            auto result = state[index]->find(range);
             switch (result.type) {
                 case utils::RangeMatchType::NONE:
 
@@ -712,12 +737,13 @@ utils::Bool InstrumentResource::on_gate(
             << affected.size() << " instruments"
         );
         for (auto index : affected) {
+            auto &instrument_state = state[index].mut();
             if (config->direction == rmgr::Direction::FORWARD) {
-                state[index].erase({utils::MIN, range.first});
+                instrument_state.erase({utils::MIN, range.first});
             } else if (config->direction == rmgr::Direction::BACKWARD) {
-                state[index].erase({range.second, utils::MAX});
+                instrument_state.erase({range.second, utils::MAX});
             }
-            state[index].set(range, function);
+            instrument_state.set(range, function);
         }
     } else {
         QL_DOUT(
@@ -729,6 +755,92 @@ utils::Bool InstrumentResource::on_gate(
     return true;
 }
 
+/**
+ * Returns the nearest start cycle from the given cycle onward (or backward)
+ * for which the given instrument can be used for a gate with the given
+ * duration and function, or a cycle closer to that; the instrument is not
+ * available in any of the cycles in between.
+ */
+utils::Int InstrumentResource::find_free(
+    Instrument index,
+    utils::Int cycle,
+    utils::UInt duration,
+    Function function,
+    utils::Bool forward
+) const {
+    State::Range range = {cycle, cycle + duration};
+
+    // Without functions, we just need to find a gap in the reservations.
+    if (config->mutually_exclusive) {
+        return state[index]->find_free(range, forward);
+    }
+
+    // Otherwise, an exact overlap with a reservation for the same function is
+    // fine as well.
+    auto result = state[index]->find(range);
+    if (result.type == utils::RangeMatchType::NONE) {
+        return cycle;
+    } else if (result.type == utils::RangeMatchType::EXACT && result.begin->second == function) {
+        return cycle;
+    }
+
+    // Find the nearest cycle that is not blocked by any of the overlapping
+    // reservations. A reservation for a different function blocks all cycles
+    // for which the gate would overlap with it. A reservation for the same
+    // function only blocks anything if overlap is not allowed, and even then
+    // the gate could still start exactly in sync with it.
+    auto next = cycle;
+    for (auto it = result.begin; it != result.end; ++it) {
+        const auto &reserved = it->first;
+        auto in_sync = it->second == function && (utils::UInt)(reserved.second - reserved.first) == duration;
+        if (it->second == function && config->allow_overlap) {
+            continue;
+        }
+        if (forward) {
+            next = utils::max(next, in_sync && reserved.first > cycle ? reserved.first : reserved.second);
+        } else {
+            next = utils::min(next, in_sync && reserved.first < cycle ? reserved.first : reserved.first - (utils::Int)duration);
+        }
+    }
+    return next;
+}
+
+/**
+ * Returns the nearest cycle in which all affected instruments are free for
+ * the function of the given gate.
+ */
+utils::Int InstrumentResource::on_earliest_available(
+    utils::Int from_cycle,
+    const rmgr::resource_types::GateData &gate,
+    rmgr::Direction search_direction
+) {
+
+    // Figure out which instruments are affected and the function.
+    utils::Set<Instrument> affected_set;
+    Function function;
+    if (!get_affected(gate, affected_set, function)) {
+        return from_cycle;
+    }
+    utils::Vec<Instrument> affected(affected_set.begin(), affected_set.end());
+
+    // Iterate over the instruments until they all return the cycle they
+    // were asked about; a moved cycle is not confirmed until it is asked
+    // for again.
+    auto forward = search_direction == rmgr::Direction::FORWARD;
+    auto cycle = from_cycle;
+    utils::UInt agreeing = 0;
+    for (utils::UInt i = 0; agreeing < affected.size(); i = (i + 1) % affected.size()) {
+        auto next = find_free(affected[i], cycle, gate.duration_cycles, function, forward);
+        if (next == cycle) {
+            agreeing++;
+        } else {
+            cycle = next;
+            agreeing = 0;
+        }
+    }
+    return cycle;
+}
+
 /**
  * Dumps documentation for this resource.
  */
@@ -1282,7 +1394,7 @@ void InstrumentResource::on_dump_state(
     }
     for (utils::UInt i = 0; i < state.size(); i++) {
         os << line_prefix << "Instrument " << config->instrument_names[i] << ":\n";
-        state[i].dump_state(
+        state[i]->dump_state(
             os,
             line_prefix + "  ",
             [this](std::ostream &os, const utils::UInt &val) {
@@ -181,7 +181,7 @@ void InterCoreChannelResource::on_initialize(rmgr::Direction direction) {
     state.clear();
     state.resize(cfg->num_cores);
     for (auto &s : state) {
-        s.resize(cfg->num_channels);
+        s.mut().resize(cfg->num_channels);
     }
 
     // Print result if debug is enabled.
@@ -210,34 +210,26 @@ void InterCoreChannelResource::on_initialize(rmgr::Direction direction) {
 }
 
 /**
- * Checks availability of and/or reserves a gate.
+ * Determines which cores are affected by the given gate. Returns false if the
+ * resource does not care about the gate at all.
  */
-utils::Bool InterCoreChannelResource::on_gate(
-    utils::Int cycle,
+utils::Bool InterCoreChannelResource::get_affected(
     const rmgr::resource_types::GateData &gate,
-    utils::Bool commit
-) {
-    QL_DOUT(
-        "channel resource " << context->instance_name
-        << " got gate with name " << gate.name
-        << " and qubit operands " << gate.qubits
-        << " for cycle " << cycle
-        << " with commit set to " << commit
-    );
-
+    utils::Set<utils::UInt> &affected
+) const {
     const auto &grid = *context->platform->topology;
 
     // We don't do anything with gates that don't have qubit operands.
     if (gate.qubits.empty()) {
         QL_DOUT(" -> available: gate has no qubit operands");
-        return true;
+        return false;
     }
 
     // Fetch the JSON data for this gate.
     const auto &gate_json = *gate.data;
 
     // Check predicates. If the gate doesn't match, we don't care about it, so
-    // we can return true, such that it can be started in any cycle.
+    // it can be started in any cycle.
     auto op_count_pos = utils::min<utils::UInt>(gate.qubits.size() - 1, 2);
     for (const auto &predicate : config->predicates[op_count_pos]) {
         auto it = gate_json.find(predicate.first);
@@ -246,25 +238,24 @@ utils::Bool InterCoreChannelResource::on_gate(
                 " -> available: gate does not match predicate "
                 << predicate.first << ": key does not exist"
             );
-            return true;
+            return false;
         } else if (!it->is_string()) {
             QL_DOUT(
                 " -> available: gate does not match predicate "
                 << predicate.first << ": key is not a string"
             );
-            return true;
+            return false;
         } else if (predicate.second.count(it->get<utils::Str>()) == 0) {
             QL_DOUT(
                 " -> available: gate does not match predicate "
                 << predicate.first << ": value " << it->get<utils::Str>()
                 << " not in " << predicate.second
             );
-            return true;
+            return false;
         }
     }
 
     // Figure out which cores are affected.
-    utils::Set<utils::UInt> affected;
     for (auto qubit : gate.qubits) {
         if (!config->communication_qubit_only || grid.is_comm_qubit(qubit)) {
             affected.insert(grid.get_core_index(qubit));
@@ -275,6 +266,31 @@ utils::Bool InterCoreChannelResource::on_gate(
     // one core.
     if (config->inter_core_required && affected.size() < 2) {
         QL_DOUT(" -> available: gate does not match inter-core predicate");
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Checks availability of and/or reserves a gate.
+ */
+utils::Bool InterCoreChannelResource::on_gate(
+    utils::Int cycle,
+    const rmgr::resource_types::GateData &gate,
+    utils::Bool commit
+) {
+    QL_DOUT(
+        "channel resource " << context->instance_name
+        << " got gate with name " << gate.name
+        << " and qubit operands " << gate.qubits
+        << " for cycle " << cycle
+        << " with commit set to " << commit
+    );
+
+    // Figure out which cores are affected.
+    utils::Set<utils::UInt> affected;
+    if (!get_affected(gate, affected)) {
         return true;
     }
 
@@ -287,7 +303,7 @@ utils::Bool InterCoreChannelResource::on_gate(
     // Check availability.
     for (auto core : affected) {
         utils::Bool core_available = false;
-        for (auto &s : state[core]) {
+        for (const auto &s : *state[core]) {
             if (s.find(range).type == utils::RangeMatchType::NONE) {
                 core_available = true;
                 break;
@@ -308,7 +324,7 @@ utils::Bool InterCoreChannelResource::on_gate(
         );
         for (auto core : affected) {
             utils::Bool core_found = false;
-            for (auto &s : state[core]) {
+            for (auto &s : state[core].mut()) {
                 if (s.find(range).type == utils::RangeMatchType::NONE) {
                     if (config->optimize) {
                         s.clear();
@@ -329,6 +345,47 @@ utils::Bool InterCoreChannelResource::on_gate(
     return true;
 }
 
+/**
+ * Returns the nearest cycle in which all affected cores have a free channel.
+ */
+utils::Int InterCoreChannelResource::on_earliest_available(
+    utils::Int from_cycle,
+    const rmgr::resource_types::GateData &gate,
+    rmgr::Direction search_direction
+) {
+
+    // Figure out which cores are affected.
+    utils::Set<utils::UInt> affected_set;
+    if (!get_affected(gate, affected_set)) {
+        return from_cycle;
+    }
+    utils::Vec<utils::UInt> affected(affected_set.begin(), affected_set.end());
+
+    // Iterate over the cores until they all return the cycle they were asked
+    // about; a moved cycle is not confirmed until it is asked for again. A
+    // core is available as soon as any of its channels is.
+    auto forward = search_direction == rmgr::Direction::FORWARD;
+    auto never = forward ? utils::MAX : utils::MIN;
+    auto cycle = from_cycle;
+    utils::UInt agreeing = 0;
+    for (utils::UInt i = 0; agreeing < affected.size(); i = (i + 1) % affected.size()) {
+        auto next = never;
+        for (const auto &channel : *state[affected[i]]) {
+            auto free = channel.find_free({cycle, cycle + gate.duration_cycles}, forward);
+            next = forward ? utils::min(next, free) : utils::max(next, free);
+        }
+        if (next == never) {
+            return never;
+        } else if (next == cycle) {
+            agreeing++;
+        } else {
+            cycle = next;
+            agreeing = 0;
+        }
+    }
+    return cycle;
+}
+
 /**
  * Dumps documentation for this resource.
  */
@@ -456,7 +513,7 @@ void InterCoreChannelResource::on_dump_state(
     }
     for (utils::UInt core = 0; core < state.size(); core++) {
         os << line_prefix << "Core " << core << ":\n";
-        const auto &core_state = state[core];
+        const auto &core_state = *state[core];
         for (utils::UInt channel = 0; channel < core_state.size(); channel++) {
             os << line_prefix << "  Channel " << channel << ":\n";
             core_state[channel].dump_state(os, line_prefix + "    ");
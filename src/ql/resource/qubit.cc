@@ -13,7 +13,7 @@ namespace qubit {
  * Initializes this resource.
  */
 void QubitResource::on_initialize(rmgr::Direction direction) {
-    state = utils::Vec<State>(context->platform->qubit_count);
+    state = utils::Vec<utils::Cow<State>>(context->platform->qubit_count);
     optimize = direction != rmgr::Direction::UNDEFINED;
 }
 
@@ -34,7 +34,7 @@ utils::Bool QubitResource::on_gate(
 
     // Check qubit availability for all operands.
     for (auto qubit : gate.qubits) {
-        if (state[qubit].find(range).type != utils::RangeMatchType::NONE) {
+        if (state[qubit]->find(range).type != utils::RangeMatchType::NONE) {
             return false;
         }
     }
@@ -42,16 +42,40 @@ utils::Bool QubitResource::on_gate(
     // If we're committing, reserve for all operands.
     if (commit) {
         for (auto qubit : gate.qubits) {
+            auto &qubit_state = state[qubit].mut();
             if (optimize) {
-                state[qubit].clear();
+                qubit_state.clear();
             }
-            state[qubit].set(range);
+            qubit_state.set(range);
         }
     }
 
     return true;
 }
 
+/**
+ * Returns the nearest cycle in which all qubit operands are free.
+ */
+utils::Int QubitResource::on_earliest_available(
+    utils::Int from_cycle,
+    const rmgr::resource_types::GateData &gate,
+    rmgr::Direction search_direction
+) {
+    auto forward = search_direction == rmgr::Direction::FORWARD;
+    auto cycle = from_cycle;
+    utils::UInt agreeing = 0;
+    for (utils::UInt i = 0; agreeing < gate.qubits.size(); i = (i + 1) % gate.qubits.size()) {
+        auto next = state[gate.qubits[i]]->find_free({cycle, cycle + gate.duration_cycles}, forward);
+        if (next == cycle) {
+            agreeing++;
+        } else {
+            cycle = next;
+            agreeing = 1;
+        }
+    }
+    return cycle;
+}
+
 /**
  * Dumps documentation for this resource.
  */
@@ -94,7 +118,7 @@ void QubitResource::on_dump_state(
 ) const {
     for (utils::UInt q = 0; q < state.size(); q++) {
         os << line_prefix << "Qubit " << q << ":\n";
-        state[q].dump_state(os, line_prefix + "  ");
+        state[q]->dump_state(os, line_prefix + "  ");
     }
 }
 
@@ -32,6 +32,31 @@ void Base::on_initialize(Direction direction) {
     (void)direction;
 }
 
+/**
+ * Abstract implementation for earliest_available(). This must return
+ * from_cycle if the gate is available in that cycle. Otherwise, it must
+ * return a cycle further along in search_direction (which is either
+ * FORWARD or BACKWARD), such that the gate is not available in any of the
+ * cycles in between; the returned cycle itself need not be available.
+ * Return utils::MAX (forward) or utils::MIN (backward) if the gate will
+ * never be available. The default implementation just checks from_cycle
+ * using on_gate() and returns the next cycle if it's not available;
+ * resources should override this to skip over their reservations directly.
+ */
+utils::Int Base::on_earliest_available(
+    utils::Int from_cycle,
+    const GateData &gate,
+    Direction search_direction
+) {
+    if (on_gate(from_cycle, gate, false)) {
+        return from_cycle;
+    } else if (search_direction == Direction::FORWARD) {
+        return from_cycle + 1;
+    } else {
+        return from_cycle - 1;
+    }
+}
+
 /**
  * Returns the type name for this resource.
  */
@@ -143,16 +168,7 @@ utils::Bool Base::gate(
     if (!initialized) {
         throw utils::Exception("resource gate() called before initialization");
     }
-
-    // Convert to GateData wrapper.
-    GateData data;
-    data.gate = gate;
-    data.name = gate->name;
-    data.duration_cycles = utils::div_ceil(gate->duration, context->platform->cycle_time);
-    data.qubits = gate->operands;
-    data.data = &context->platform->find_instruction(gate->name);
-
-    return this->gate((utils::Int)cycle, data, commit);
+    return this->gate((utils::Int)cycle, get_gate_data(gate), commit);
 }
 
 /**
@@ -169,8 +185,30 @@ utils::Bool Base::gate(
     if (!initialized) {
         throw utils::Exception("resource gate() called before initialization");
     }
+    return this->gate(cycle, get_gate_data(statement), commit);
+}
 
-    // Convert to GateData wrapper.
+/**
+ * Converts the given old-IR gate to the gate data structure that gate() and
+ * earliest_available() operate on. This only depends on the platform, so
+ * it can be reused for all resources of the same manager.
+ */
+GateData Base::get_gate_data(const ir::compat::GateRef &gate) const {
+    GateData data;
+    data.gate = gate;
+    data.name = gate->name;
+    data.duration_cycles = utils::div_ceil(gate->duration, context->platform->cycle_time);
+    data.qubits = gate->operands;
+    data.data = &context->platform->find_instruction(gate->name);
+    return data;
+}
+
+/**
+ * Converts the given new-IR statement to the gate data structure that
+ * gate() and earliest_available() operate on. This only depends on the
+ * platform, so it can be reused for all resources of the same manager.
+ */
+GateData Base::get_gate_data(const ir::StatementRef &statement) const {
     static const utils::Json EMPTY = {};
     GateData data;
     data.statement = statement;
@@ -216,8 +254,65 @@ utils::Bool Base::gate(
             }
         }
     }
+    return data;
+}
+
+/**
+ * Returns the cycle nearest to from_cycle in search_direction (either
+ * FORWARD or BACKWARD, including from_cycle itself) in which the given gate
+ * data structure could be scheduled as far as this resource is concerned,
+ * or a cycle that is closer to it in case the resource cannot determine
+ * this directly. Either way, the gate is guaranteed to not be available in
+ * any of the cycles that were skipped over, so calling this until the
+ * returned value no longer changes yields the nearest available cycle.
+ * Returns utils::MAX (forward) or utils::MIN (backward) if the gate will
+ * never be available, for instance because the cycles in search_direction
+ * precede the last reservation in the scheduling direction.
+ */
+utils::Int Base::earliest_available(
+    utils::Int from_cycle,
+    const GateData &data,
+    Direction search_direction
+) {
+    if (!initialized) {
+        throw utils::Exception("resource earliest_available() called before initialization");
+    }
+    utils::Int never;
+    switch (search_direction) {
+        case Direction::FORWARD: never = utils::MAX; break;
+        case Direction::BACKWARD: never = utils::MIN; break;
+        default: throw utils::Exception("earliest_available() requires a search direction");
+    }
 
-    return this->gate(cycle, data, commit);
+    // Cycles that precede the previously committed cycle in the scheduling
+    // direction are never available (see gate()). When searching in the
+    // scheduling direction, we can just skip them; when searching in the
+    // opposite direction, we'll never find anything once we pass it.
+    utils::Bool reversed = false;
+    switch (direction) {
+        case Direction::FORWARD:
+            reversed = search_direction == Direction::BACKWARD;
+            if (from_cycle < prev_cycle) {
+                if (reversed) return never;
+                from_cycle = prev_cycle;
+            }
+            break;
+        case Direction::BACKWARD:
+            reversed = search_direction == Direction::FORWARD;
+            if (from_cycle > prev_cycle) {
+                if (reversed) return never;
+                from_cycle = prev_cycle;
+            }
+            break;
+        default: void();
+    }
+
+    // Run the resource implementation.
+    auto cycle = on_earliest_available(from_cycle, data, search_direction);
+    if (reversed && (direction == Direction::FORWARD ? cycle < prev_cycle : cycle > prev_cycle)) {
+        return never;
+    }
+    return cycle;
 }
 
 /**
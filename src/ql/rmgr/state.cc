@@ -18,26 +18,16 @@ State::State() : resources(), is_broken(false) {
 }
 
 /**
- * Copy constructor that clones the resource states.
+ * Clones the resources that are still shared with other copies of this
+ * state, such that they can be modified. Called before anything is
+ * reserved.
  */
-State::State(const State &src) {
-    resources.resize(src.resources.size());
-    for (utils::UInt i = 0; i < src.resources.size(); i++) {
-        resources[i] = src.resources[i].clone();
-    }
-    is_broken = src.is_broken;
-}
-
-/**
- * Copy assignment operator that clones the resource states.
- */
-State &State::operator=(const State &src) {
-    resources.resize(src.resources.size());
-    for (utils::UInt i = 0; i < src.resources.size(); i++) {
-        resources[i] = src.resources[i].clone();
+void State::make_unique() {
+    for (auto &resource : resources) {
+        if (resource.unwrap().use_count() > 1) {
+            resource = resource.clone();
+        }
     }
-    is_broken = src.is_broken;
-    return *this;
 }
 
 /**
@@ -78,6 +68,105 @@ utils::Bool State::available(
     return true;
 }
 
+/**
+ * Implementation for the earliest_available() overloads. Each resource
+ * reports the nearest cycle it might be available in, which the next
+ * resource then starts from, until all resources in a row (including the
+ * one that last moved the cycle) return the cycle they were asked about.
+ * Resources may return a cycle that they would still reject, so a moved
+ * cycle only counts as confirmed once it is asked for again.
+ */
+utils::Int State::earliest_available(
+    const utils::Vec<ResourceRef> &of,
+    utils::Int from_cycle,
+    const resource_types::GateData &data,
+    Direction direction
+) {
+    utils::Int never = direction == Direction::FORWARD ? utils::MAX : utils::MIN;
+    utils::Int cycle = from_cycle;
+    utils::UInt agreeing = 0;
+    for (utils::UInt i = 0; agreeing < of.size(); i = (i + 1) % of.size()) {
+        auto next = of[i]->earliest_available(cycle, data, direction);
+        if (next == never) {
+            return never;
+        } else if (next == cycle) {
+            agreeing++;
+        } else {
+            cycle = next;
+            agreeing = 0;
+        }
+    }
+    return cycle;
+}
+
+/**
+ * Returns the cycle nearest to from_cycle in the given search direction
+ * (either FORWARD or BACKWARD, including from_cycle itself) in which the
+ * given old-IR gate can be scheduled, i.e. the first cycle for which
+ * available() would return true. Returns utils::MAX (forward) or utils::MIN
+ * (backward) if there is no such cycle.
+ */
+utils::Int State::earliest_available(
+    utils::Int from_cycle,
+    const ir::compat::GateRef &gate,
+    Direction direction
+) const {
+    if (is_broken) {
+        throw utils::Exception("usage of resource state that was left in an undefined state");
+    }
+    if (resources.empty()) {
+        return from_cycle;
+    }
+    return earliest_available(resources, from_cycle, resources[0]->get_gate_data(gate), direction);
+}
+
+/**
+ * Like earliest_available() for old-IR gates, but only considers the
+ * resources for which the given predicate returns true. This can be used to
+ * determine how long a particular kind of resource alone would delay a gate.
+ */
+utils::Int State::earliest_available(
+    utils::Int from_cycle,
+    const ir::compat::GateRef &gate,
+    Direction direction,
+    const std::function<utils::Bool(const resource_types::Base &resource)> &filter
+) const {
+    if (is_broken) {
+        throw utils::Exception("usage of resource state that was left in an undefined state");
+    }
+    utils::Vec<ResourceRef> of;
+    for (const auto &resource : resources) {
+        if (filter(*resource)) {
+            of.push_back(resource);
+        }
+    }
+    if (of.empty()) {
+        return from_cycle;
+    }
+    return earliest_available(of, from_cycle, of[0]->get_gate_data(gate), direction);
+}
+
+/**
+ * Returns the cycle nearest to from_cycle in the given search direction
+ * (either FORWARD or BACKWARD, including from_cycle itself) in which the
+ * given new-IR statement can be scheduled, i.e. the first cycle for which
+ * available() would return true. Returns utils::MAX (forward) or utils::MIN
+ * (backward) if there is no such cycle.
+ */
+utils::Int State::earliest_available(
+    utils::Int from_cycle,
+    const ir::StatementRef &statement,
+    Direction direction
+) const {
+    if (is_broken) {
+        throw utils::Exception("usage of resource state that was left in an undefined state");
+    }
+    if (resources.empty()) {
+        return from_cycle;
+    }
+    return earliest_available(resources, from_cycle, resources[0]->get_gate_data(statement), direction);
+}
+
 /**
  * Schedules the given gate at the given (start) cycle. Throws an exception
  * if this is not possible. When an exception is thrown, the resulting state
@@ -90,6 +179,7 @@ void State::reserve(
     if (is_broken) {
         throw utils::Exception("usage of resource state that was left in an undefined state");
     }
+    make_unique();
     for (auto &resource : resources) {
         if (!resource->gate(cycle, gate, true)) {
             is_broken = true;
@@ -116,6 +206,7 @@ void State::reserve(
     if (is_broken) {
         throw utils::Exception("usage of resource state that was left in an undefined state");
     }
+    make_unique();
     for (auto &resource : resources) {
         if (!resource->gate(cycle, statement, true)) {
             is_broken = true;
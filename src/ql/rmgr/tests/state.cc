@@ -0,0 +1,120 @@
+#include <random>
+
+#include "ql/ir/compat/compat.h"
+#include "ql/rmgr/manager.h"
+
+using namespace ql;
+
+/**
+ * Returns the first cycle from the given cycle onward (or backward) in which
+ * the given gate is available, by trying all cycles.
+ */
+static utils::Int probe(
+    const rmgr::State &state,
+    utils::Int cycle,
+    const ir::compat::GateRef &gate,
+    utils::Bool forward
+) {
+    while (!state.available(cycle, gate)) {
+        cycle += forward ? 1 : -1;
+    }
+    return cycle;
+}
+
+/**
+ * Schedules random gates on the 17-qubit platform in the given direction,
+ * each at the first cycle in which the resources are available starting from
+ * a random cycle near the previous one, and checks that earliest_available()
+ * agrees with trying all cycles.
+ */
+static void check(const ir::compat::PlatformRef &plat, utils::Bool forward) {
+    auto state = rmgr::Manager::from_defaults(plat).build(
+        forward ? rmgr::Direction::FORWARD : rmgr::Direction::BACKWARD
+    );
+    auto kernel = utils::make<ir::compat::Kernel>("kernel", plat, 17, 32, 32);
+    std::mt19937 rng(42);
+    utils::Int cycle = forward ? 1 : 100000;
+    for (utils::UInt i = 0; i < 1000; i++) {
+        utils::UInt q = rng() % 17;
+        switch (rng() % 4) {
+            case 0: kernel->x(q); break;
+            case 1: kernel->y(q); break;
+            case 2: kernel->measure(q); break;
+            default: kernel->cz(q, (q + 1 + rng() % 16) % 17); break;
+        }
+        const auto &gate = kernel->gates.back();
+        auto from = cycle + (forward ? 1 : -1) * (utils::Int)(rng() % 3);
+        auto expected = probe(state, from, gate, forward);
+        auto actual = state.earliest_available(
+            from, gate, forward ? rmgr::Direction::FORWARD : rmgr::Direction::BACKWARD
+        );
+        QL_ASSERT_EQ(actual, expected);
+        state.reserve(actual, gate);
+        cycle = actual;
+    }
+}
+
+/**
+ * Checks the case in which the cycle an instrument first moves to is still
+ * blocked by a reservation that did not overlap with the original cycle, such
+ * that the instrument has to confirm the new cycle before the search may
+ * stop. x, y, and prepz are different functions on the same QWG, so they
+ * cannot overlap.
+ */
+static void check_moved_cycle(const ir::compat::PlatformRef &plat) {
+    auto state = rmgr::Manager::from_defaults(plat).build(rmgr::Direction::FORWARD);
+    auto kernel = utils::make<ir::compat::Kernel>("kernel", plat, 17, 32, 32);
+    kernel->x(1);
+    kernel->y(2);
+    kernel->y(2);
+    kernel->prepz(3);
+    state.reserve(10, kernel->gates[0]);
+    state.reserve(12, kernel->gates[1]);
+    state.reserve(43, kernel->gates[2]);
+
+    // The 31-cycle prepz gate is first moved past the x and y gates to cycle
+    // 13, where it would overlap with the y gate in cycle 43.
+    const auto &prepz = kernel->gates[3];
+    QL_ASSERT(!state.available(13, prepz));
+    QL_ASSERT_EQ(probe(state, 10, prepz, true), 44);
+    QL_ASSERT_EQ(state.earliest_available(10, prepz, rmgr::Direction::FORWARD), 44);
+    state.reserve(44, prepz);
+}
+
+/**
+ * Checks that copies of a state share nothing observable, even though they
+ * share the resource objects until either is modified.
+ */
+static void check_copies(const ir::compat::PlatformRef &plat) {
+    auto original = rmgr::Manager::from_defaults(plat).build(rmgr::Direction::FORWARD);
+    auto kernel = utils::make<ir::compat::Kernel>("kernel", plat, 17, 32, 32);
+    kernel->cz(0, 2);
+    kernel->measure(0);
+    kernel->x(16);
+    const auto &cz = kernel->gates[0];
+    const auto &measure = kernel->gates[1];
+    const auto &x = kernel->gates[2];
+
+    original.reserve(1, x);
+    auto copy = original;
+    copy.reserve(1, cz);
+    QL_ASSERT(original.available(1, cz));
+    QL_ASSERT(!copy.available(1, cz));
+
+    auto copy_of_copy = copy;
+    original.reserve(1, measure);
+    QL_ASSERT(!original.available(1, cz));
+    QL_ASSERT(!copy_of_copy.available(1, measure));
+    QL_ASSERT(copy_of_copy.available(10, measure));
+    copy_of_copy.reserve(10, measure);
+    QL_ASSERT(copy.available(10, measure));
+}
+
+int main() {
+    auto plat = ir::compat::Platform::build("test_plat", utils::Str("cc_light.s17"));
+    check(plat, true);
+    check(plat, false);
+    check_moved_cycle(plat);
+    check_copies(plat);
+    return 0;
+}
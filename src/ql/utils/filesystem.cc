@@ -9,9 +9,16 @@
 #include <cerrno>
 #include <algorithm>
 #include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <atomic>
 
 #ifdef _WIN32
 #include <direct.h>
+#include <io.h>
+#include <process.h>
+#define getpid _getpid
+#include <sys/utime.h>
 #define mkdir(path, mode) _mkdir(path)
 #define stat _stat
 #define S_IFDIR _S_IFDIR
@@ -20,6 +27,9 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <libgen.h>
+#include <dirent.h>
+#include <utime.h>
+#include <unistd.h>
 #endif
 
 namespace ql {
@@ -29,9 +39,11 @@ namespace {
 
 /**
  * Stack of working directories. Private; use push_working_directory(),
- * pop_working_directory(), and get_working_directory() to access.
+ * pop_working_directory(), and get_working_directory() to access. This is
+ * kept per thread, such that concurrent compilations don't see each other's
+ * working directories.
  */
-List<Str> working_directory_stack;
+thread_local List<Str> working_directory_stack;
 
 } // anonymous namespace
 
@@ -141,6 +153,27 @@ Str path_relative_to(const Str &base, const Str &path) {
 
 }
 
+/**
+ * Returns the given path as an absolute path. If path looks like a relative
+ * path, it is interpreted as relative to the current OpenQL working
+ * directory, which in turn is interpreted as relative to the working
+ * directory of the process if it is relative. The path is not normalized.
+ */
+Str get_absolute_path(const Str &path) {
+    auto processed_path = process_path(path);
+#ifdef _WIN32
+    char *cwd = _getcwd(nullptr, 0);
+#else
+    char *cwd = getcwd(nullptr, 0);
+#endif
+    if (!cwd) {
+        return processed_path;
+    }
+    auto result = path_relative_to(cwd, processed_path);
+    free(cwd);
+    return result;
+}
+
 /**
  * Returns the directory of the given path. On Linux and MacOS, this just maps
  * to dirname() from libgen.h. On Windows, the string is stripped from the last
@@ -204,6 +237,100 @@ void make_dirs(const Str &path) {
     make_dirs_raw(process_path(path));
 }
 
+/**
+ * Returns information about the regular files in the given directory. Hidden
+ * files and subdirectories are not listed. An empty list is returned if the
+ * directory does not exist or cannot be read. If path looks like a relative
+ * path, it is interpreted as relative to the current OpenQL working directory.
+ */
+Vec<FileInfo> list_files(const Str &path) {
+    auto processed_path = process_path(path);
+    Vec<Str> names;
+#ifdef _WIN32
+    struct _finddata_t data{};
+    auto handle = _findfirst((processed_path + "/*").c_str(), &data);
+    if (handle == -1) {
+        return {};
+    }
+    do {
+        names.emplace_back(data.name);
+    } while (_findnext(handle, &data) == 0);
+    _findclose(handle);
+#else
+    auto dir = opendir(processed_path.c_str());
+    if (!dir) {
+        return {};
+    }
+    while (auto entry = readdir(dir)) {
+        names.emplace_back(entry->d_name);
+    }
+    closedir(dir);
+#endif
+    Vec<FileInfo> files;
+    for (const auto &name : names) {
+        if (name.empty() || name[0] == '.') {
+            continue;
+        }
+        struct stat info{};
+        if (stat((processed_path + "/" + name).c_str(), &info) != 0) {
+            continue;
+        }
+        if ((info.st_mode & S_IFREG) == 0) {
+            continue;
+        }
+        files.push_back({path + "/" + name, (UInt)info.st_size, (Int)info.st_mtime});
+    }
+    return files;
+}
+
+/**
+ * Sets the modification time of the given file to the current time. Returns
+ * whether this succeeded. If path looks like a relative path, it is
+ * interpreted as relative to the current OpenQL working directory.
+ */
+Bool touch_file(const Str &path) {
+#ifdef _WIN32
+    return _utime(process_path(path).c_str(), nullptr) == 0;
+#else
+    return utime(process_path(path).c_str(), nullptr) == 0;
+#endif
+}
+
+/**
+ * Removes the given file. Returns whether this succeeded. If path looks like
+ * a relative path, it is interpreted as relative to the current OpenQL
+ * working directory.
+ */
+Bool remove_file(const Str &path) {
+    return std::remove(process_path(path).c_str()) == 0;
+}
+
+/**
+ * Renames the given file, replacing the destination if it already exists.
+ * Returns whether this succeeded. If the paths look like relative paths,
+ * they are interpreted as relative to the current OpenQL working directory.
+ */
+Bool rename_file(const Str &from, const Str &to) {
+    auto processed_to = process_path(to);
+#ifdef _WIN32
+    // Unlike POSIX rename(), the Windows implementation refuses to replace an
+    // existing file.
+    std::remove(processed_to.c_str());
+#endif
+    return std::rename(process_path(from).c_str(), processed_to.c_str()) == 0;
+}
+
+/**
+ * Returns a name for a temporary file next to the given path, to be renamed
+ * to it with rename_file() once complete. The name includes the process ID
+ * and a counter, such that concurrent writers in any number of processes and
+ * threads never use the same temporary file.
+ */
+Str get_temporary_path(const Str &path) {
+    static std::atomic<UInt> counter{0};
+    return path + "." + to_string((UInt)getpid()) + "." + to_string(counter++) + ".tmp";
+}
+
 /**
  * Tries to create a file (if it doesn't already exist) and opens it for
  * writing. If the directory that path is contained by does not exists, it is
@@ -1,19 +1,423 @@
 /** \file
- * Provides macros for logging and the global loglevel variable.
+ * Provides macros for logging, the global loglevel variable, per-thread
+ * logging contexts, and the backend that formats and writes log records.
  */
 
 #include "ql/utils/logger.h"
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include "ql/utils/exception.h"
+#include "ql/utils/json.h"
+#include "ql/utils/list.h"
+#include "ql/utils/set.h"
 
 namespace ql {
 namespace utils {
 namespace logger {
 
 /**
- * The current log level (verbosity).
+ * The process-wide log level (verbosity), used by threads that have no logging
+ * context.
  */
 LogLevel log_level;
 
+namespace {
+
+/**
+ * The process-wide log format, used by threads that have no logging context.
+ */
+LogFormat log_format = LogFormat::TEXT;
+
+/**
+ * Whether to log asynchronously for threads that have no logging context.
+ */
+Bool log_async = false;
+
+/**
+ * The logging context that is active for this thread, or nullptr to use the
+ * process-wide defaults.
+ */
+thread_local Context *active = nullptr;
+
+/**
+ * Mutex serializing writes to the log streams, taken by threads that log
+ * synchronously and by the background writer. Contexts may share a stream
+ * between threads, and std::ostream itself is not thread-safe.
+ */
+std::mutex stream_mutex;
+
+/**
+ * Number of bytes after which a per-thread buffer is handed over to the
+ * background writer.
+ */
+const UInt BUFFER_SIZE = 64 * 1024;
+
+/**
+ * Background thread that writes the records logged asynchronously to their
+ * streams. It receives complete per-thread buffers, such that the logging
+ * threads only need to take the lock once per buffer rather than once per
+ * record, and it flushes each stream once per batch of buffers rather than
+ * once per record.
+ */
+class Writer {
+private:
+
+    /**
+     * Mutex protecting the state below.
+     */
+    std::mutex mutex;
+
+    /**
+     * Signalled when buffers are queued or when the writer should stop.
+     */
+    std::condition_variable work_available;
+
+    /**
+     * Signalled when the writer finished writing a batch.
+     */
+    std::condition_variable work_done;
+
+    /**
+     * Buffers waiting to be written, along with the stream to write them to.
+     */
+    List<std::pair<std::ostream*, Str>> queue;
+
+    /**
+     * Whether the writer is currently writing a batch.
+     */
+    Bool busy = false;
+
+    /**
+     * Whether the writer should stop once the queue is empty.
+     */
+    Bool stop = false;
+
+    /**
+     * The writer thread, started when the first buffer is queued.
+     */
+    std::thread thread;
+
+    /**
+     * Main function of the writer thread.
+     */
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            work_available.wait(lock, [this]{ return stop || !queue.empty(); });
+            if (queue.empty()) {
+                break;
+            }
+            List<std::pair<std::ostream*, Str>> batch;
+            batch.swap(queue);
+            busy = true;
+            lock.unlock();
+            {
+                std::lock_guard<std::mutex> stream_lock(stream_mutex);
+                Set<std::ostream*> streams;
+                for (const auto &entry : batch) {
+                    *entry.first << entry.second;
+                    streams.insert(entry.first);
+                }
+                for (auto stream : streams) {
+                    stream->flush();
+                }
+            }
+            lock.lock();
+            busy = false;
+            work_done.notify_all();
+        }
+    }
+
+public:
+
+    /**
+     * Writes out all queued buffers and stops the writer thread.
+     */
+    ~Writer() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        work_available.notify_all();
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+
+    /**
+     * Queues the given buffer to be written to the given stream.
+     */
+    void submit(std::ostream *stream, Str &&text) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!thread.joinable()) {
+                thread = std::thread(&Writer::run, this);
+            }
+            queue.emplace_back(stream, std::move(text));
+        }
+        work_available.notify_one();
+    }
+
+    /**
+     * Waits until all queued buffers have been written.
+     */
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        work_done.wait(lock, [this]{ return queue.empty() && !busy; });
+    }
+
+};
+
+/**
+ * Returns the background writer.
+ */
+Writer &get_writer() {
+    static Writer writer;
+    return writer;
+}
+
+/**
+ * Per-thread buffer for records that are logged asynchronously. Records are
+ * appended to it until it is full, until a record for a different stream is
+ * logged, or until a warning or error is logged, after which the buffer is
+ * handed over to the background writer.
+ */
+struct Buffer {
+
+    /**
+     * The stream that the buffered records are to be written to.
+     */
+    std::ostream *stream = nullptr;
+
+    /**
+     * The buffered records.
+     */
+    Str text;
+
+    /**
+     * Whether records were handed over to the background writer since the
+     * last flush().
+     */
+    Bool pending = false;
+
+    /**
+     * Hands the buffered records over to the background writer.
+     */
+    void hand_over() {
+        if (!text.empty()) {
+            get_writer().submit(stream, std::move(text));
+            text.clear();
+            pending = true;
+        }
+    }
+
+    /**
+     * Hands over any remaining records when the thread exits.
+     */
+    ~Buffer() {
+        hand_over();
+    }
+
+};
+
+/**
+ * The asynchronous record buffer of this thread.
+ */
+thread_local Buffer buffer;
+
+/**
+ * Streams used for the messages of the records under construction by this
+ * thread. There is more than one when a log message is constructed using a
+ * function that itself logs something.
+ */
+thread_local std::vector<std::unique_ptr<StrStrm>> message_streams;
+
+/**
+ * Number of records under construction by this thread.
+ */
+thread_local UInt num_records = 0;
+
+/**
+ * Returns the name of the given log level for the JSON format.
+ */
+const char *log_level_name(LogLevel level) {
+    switch (level) {
+        case LogLevel::LOG_CRITICAL: return "critical";
+        case LogLevel::LOG_ERROR:    return "error";
+        case LogLevel::LOG_WARNING:  return "warning";
+        case LogLevel::LOG_INFO:     return "info";
+        case LogLevel::LOG_DEBUG:    return "debug";
+        default:                     return "output";
+    }
+}
+
+} // anonymous namespace
+
+/**
+ * Constructs a context with the current log level, format, and asynchronicity
+ * of the calling thread and the standard output streams.
+ */
+Context::Context() :
+    log_level(get_log_level()),
+    out(&std::cout),
+    err(&std::cerr),
+    format(active ? active->format : log_format),
+    async(active ? active->async : log_async)
+{ }
+
+/**
+ * Activates the given context for the calling thread.
+ */
+Scope::Scope(Context *context) : previous(active) {
+    if (context) {
+        active = context;
+    }
+}
+
+/**
+ * Restores the previously active context, after writing out all records
+ * logged asynchronously by the calling thread.
+ */
+Scope::~Scope() {
+    flush();
+    active = previous;
+}
+
+/**
+ * Starts constructing a log record.
+ */
+Record::Record(
+    LogLevel level,
+    const char *label,
+    const char *file,
+    int line
+) :
+    level(level),
+    label(label),
+    file(file),
+    line(line)
+{
+    if (message_streams.size() <= num_records) {
+        message_streams.emplace_back(new StrStrm());
+    }
+    message = message_streams[num_records].get();
+    num_records++;
+    message->str("");
+    message->clear();
+    message->copyfmt(std::ios(nullptr));
+}
+
+/**
+ * Releases the message stream for reuse.
+ */
+Record::~Record() {
+    num_records--;
+}
+
+/**
+ * Returns the stream that the message should be written to.
+ */
+std::ostream &Record::stream() {
+    return *message;
+}
+
+/**
+ * Formats the record and writes it out.
+ */
+void Record::commit() {
+    Bool is_error = level == LogLevel::LOG_CRITICAL
+                 || level == LogLevel::LOG_ERROR
+                 || level == LogLevel::LOG_WARNING;
+    std::ostream &os = is_error ? err() : out();
+
+    // Format the record.
+    Str text;
+    if ((active ? active->format : log_format) == LogFormat::JSON) {
+        Json record = {
+            {"level", log_level_name(level)},
+            {"file", file},
+            {"line", line},
+            {"message", message->str()}
+        };
+        text = record.dump(-1, ' ', false, Json::error_handler_t::replace) + "\n";
+    } else {
+        text = "[OPENQL] " + Str(file) + ":" + to_string(line) + label + message->str() + "\n";
+    }
+
+    // Write the record directly if we're not logging asynchronously. Only
+    // warnings and errors are flushed immediately.
+    if (!(active ? active->async : log_async)) {
+        std::lock_guard<std::mutex> lock(stream_mutex);
+        os << text;
+        if (is_error) {
+            os.flush();
+        }
+        return;
+    }
+
+    // Append the record to the buffer of this thread, handing it over to the
+    // background writer when it's full or when it's for a different stream.
+    // Warnings and errors are written out before we continue.
+    if (buffer.stream != &os) {
+        buffer.hand_over();
+        buffer.stream = &os;
+    }
+    buffer.text += text;
+    if (is_error) {
+        flush();
+    } else if (buffer.text.size() >= BUFFER_SIZE) {
+        buffer.hand_over();
+    }
+}
+
+/**
+ * Writes out all records that were logged asynchronously by the calling
+ * thread, and waits for the background writer to write them to their streams.
+ */
+void flush() {
+    buffer.hand_over();
+    if (buffer.pending) {
+        get_writer().wait();
+        buffer.pending = false;
+    }
+}
+
+/**
+ * Returns the logging context that is active for the calling thread, or
+ * nullptr if the process-wide defaults are used.
+ */
+Context *get_context() {
+    return active;
+}
+
+/**
+ * Returns the log level for the calling thread, i.e. that of its active
+ * context or the process-wide log level if there is none.
+ */
+LogLevel get_log_level() {
+    return active ? active->log_level : log_level;
+}
+
+/**
+ * Returns the stream that debug and info messages should be written to for
+ * the calling thread.
+ */
+std::ostream &out() {
+    return active ? *active->out : std::cout;
+}
+
+/**
+ * Returns the stream that warnings and errors should be written to for the
+ * calling thread.
+ */
+std::ostream &err() {
+    return active ? *active->err : std::cerr;
+}
+
 /**
  * Converts the string representation of a log level to a LogLevel enum variant.
  * Throws ql::exception if the string could not be converted.
@@ -37,10 +441,49 @@ LogLevel log_level_from_string(const Str &level) {
 }
 
 /**
- * Sets the current log level using its string representation.
+ * Sets the log level of the active context of the calling thread, or the
+ * process-wide log level if there is none, using its string representation.
  */
 void set_log_level(const Str &level) {
-    log_level = log_level_from_string(level);
+    if (active) {
+        active->log_level = log_level_from_string(level);
+    } else {
+        log_level = log_level_from_string(level);
+    }
+}
+
+/**
+ * Sets the log format of the active context of the calling thread, or the
+ * process-wide log format if there is none, using its string representation
+ * (text or json).
+ */
+void set_log_format(const Str &format) {
+    LogFormat value;
+    if (format == "text") {
+        value = LogFormat::TEXT;
+    } else if (format == "json") {
+        value = LogFormat::JSON;
+    } else {
+        throw Exception("unknown log format \"" + format + "\"");
+    }
+    if (active) {
+        active->format = value;
+    } else {
+        log_format = value;
+    }
+}
+
+/**
+ * Sets whether the active context of the calling thread, or the process as a
+ * whole if there is none, logs asynchronously.
+ */
+void set_log_async(Bool async) {
+    flush();
+    if (active) {
+        active->async = async;
+    } else {
+        log_async = async;
+    }
 }
 
 } // namespace logger
@@ -0,0 +1,43 @@
+/** \file
+ * Provides miscellaneous utilities.
+ */
+
+#include "ql/utils/misc.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace ql {
+namespace utils {
+
+/**
+ * Returns the peak resident set size of this process in bytes, i.e. the
+ * largest amount of physical memory it has used so far, or 0 if this is not
+ * known on this platform.
+ */
+UInt get_peak_memory_usage() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return 0;
+    }
+    return counters.PeakWorkingSetSize;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#ifdef __APPLE__
+    return usage.ru_maxrss;             // bytes on macOS
+#else
+    return (UInt)usage.ru_maxrss << 10; // kilobytes on Linux
+#endif
+#endif
+}
+
+} // namespace utils
+} // namespace ql
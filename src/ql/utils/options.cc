@@ -633,5 +633,39 @@ std::ostream &operator<<(std::ostream &os, const Options &options) {
     return os;
 }
 
+namespace {
+
+/**
+ * The options record that is active for this thread, or nullptr if there is
+ * none.
+ */
+thread_local Options *active = nullptr;
+
+} // anonymous namespace
+
+/**
+ * Returns the options record that is active for the calling thread (see
+ * OptionsScope), or nullptr if there is none.
+ */
+Options *get_active_options() {
+    return active;
+}
+
+/**
+ * Activates the given options record for the calling thread.
+ */
+OptionsScope::OptionsScope(Options *options) : previous(active) {
+    if (options) {
+        active = options;
+    }
+}
+
+/**
+ * Restores the previously active options record.
+ */
+OptionsScope::~OptionsScope() {
+    active = previous;
+}
+
 } // namespace utils
 } // namespace ql
@@ -0,0 +1,105 @@
+/** \file
+ * Provides a simple way to run independent tasks on a number of threads.
+ */
+
+#include "ql/utils/parallel.h"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <exception>
+#include "ql/utils/str.h"
+#include "ql/utils/vec.h"
+#include "ql/utils/logger.h"
+#include "ql/utils/options.h"
+
+namespace ql {
+namespace utils {
+
+/**
+ * Runs task(thread, index) for indices 0 to count-1 on the given number of
+ * threads, where thread identifies the thread running the task (0 being the
+ * calling thread). The tasks use the logging context and the options record
+ * that are active for the calling thread. When more than one thread is used,
+ * the records logged by each task are collected and written out in index
+ * order once all tasks are done, such that the log does not depend on how
+ * the tasks were distributed over the threads. The first exception thrown by
+ * a task is rethrown on the calling thread once all threads have stopped.
+ */
+void run_parallel(
+    UInt count,
+    UInt threads,
+    const std::function<void(UInt thread, UInt index)> &task
+) {
+
+    // Don't bother with threads if there's only one.
+    threads = min(threads, count);
+    if (threads <= 1) {
+        for (UInt index = 0; index < count; index++) {
+            task(0, index);
+        }
+        return;
+    }
+
+    Options *options = get_active_options();
+    logger::Context *context = logger::get_context();
+    Vec<StrStrm> outs(count);
+    Vec<StrStrm> errs(count);
+    std::atomic<UInt> next(0);
+    std::mutex error_mutex;
+    std::exception_ptr error;
+    auto worker = [&](UInt thread) {
+        OptionsScope options_scope(options);
+        logger::Scope outer_scope(context);
+        while (true) {
+            const UInt index = next++;
+            if (index >= count) return;
+
+            // Log to buffers private to this task. The context inherits the
+            // log level and format of the outer context.
+            logger::Context buffered;
+            buffered.out = &outs[index];
+            buffered.err = &errs[index];
+            buffered.async = false;
+            logger::Scope log_scope(&buffered);
+
+            try {
+                task(thread, index);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (!error) error = std::current_exception();
+                next = count;
+            }
+        }
+    };
+
+    Vec<std::thread> pool;
+    for (UInt thread = 1; thread < threads; thread++) {
+        pool.emplace_back(worker, thread);
+    }
+    worker(0);
+    for (auto &thread : pool) {
+        thread.join();
+    }
+
+    // Write out the logs of the tasks in order, after anything the calling
+    // thread logged before.
+    logger::flush();
+    for (UInt index = 0; index < count; index++) {
+        auto out = outs[index].str();
+        if (!out.empty()) {
+            logger::out() << out;
+        }
+        auto err = errs[index].str();
+        if (!err.empty()) {
+            logger::err() << err << std::flush;
+        }
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+} // namespace utils
+} // namespace ql
@@ -0,0 +1,57 @@
+#include "ql/utils/cow.h"
+#include "ql/utils/vec.h"
+
+using namespace ql::utils;
+
+int main() {
+    Cow<Vec<Int>> a(Vec<Int>({1, 2, 3}));
+    QL_ASSERT(!a.is_shared());
+
+    // Copies share the value until one of them is mutated.
+    auto b = a;
+    QL_ASSERT(a.is_shared());
+    QL_ASSERT(&a.get() == &b.get());
+    b.mut().push_back(4);
+    QL_ASSERT(!a.is_shared());
+    QL_ASSERT(!b.is_shared());
+    QL_ASSERT_EQ(a->size(), 3u);
+    QL_ASSERT_EQ(b->size(), 4u);
+
+    // Mutating an unshared value does not copy it.
+    const auto *before = &b.get();
+    b.mut()[0] = 5;
+    QL_ASSERT(&b.get() == before);
+    QL_ASSERT_EQ((*b)[0], 5);
+    QL_ASSERT_EQ((*a)[0], 1);
+
+    // Mutating the original leaves all of its copies unchanged, and the
+    // copies keep sharing their value with each other.
+    Cow<Vec<Vec<Int>>> c(Vec<Vec<Int>>({{1, 2}, {3}}));
+    auto d = c;
+    auto e = d;
+    c.mut()[0].push_back(4);
+    c.mut().push_back({5});
+    QL_ASSERT(!c.is_shared());
+    QL_ASSERT(d.is_shared());
+    QL_ASSERT(&d.get() == &e.get());
+    QL_ASSERT(*c == Vec<Vec<Int>>({{1, 2, 4}, {3}, {5}}));
+    QL_ASSERT(*d == Vec<Vec<Int>>({{1, 2}, {3}}));
+
+    // Mutating a copy of a copy leaves both the copy and the original
+    // unchanged.
+    auto f = e;
+    f.mut()[1][0] = 6;
+    QL_ASSERT(*f == Vec<Vec<Int>>({{1, 2}, {6}}));
+    QL_ASSERT(*e == Vec<Vec<Int>>({{1, 2}, {3}}));
+    QL_ASSERT(*d == Vec<Vec<Int>>({{1, 2}, {3}}));
+    QL_ASSERT(*c == Vec<Vec<Int>>({{1, 2, 4}, {3}, {5}}));
+
+    // Assigning a container makes it share the assigned value.
+    f = c;
+    QL_ASSERT(&f.get() == &c.get());
+    f.mut().clear();
+    QL_ASSERT(f->empty());
+    QL_ASSERT_EQ(c->size(), 3u);
+
+    return 0;
+}
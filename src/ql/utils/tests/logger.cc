@@ -0,0 +1,106 @@
+#include <sstream>
+#include <thread>
+
+#include "ql/utils/logger.h"
+#include "ql/utils/vec.h"
+#include "ql/utils/json.h"
+
+using namespace ql::utils;
+
+/**
+ * Returns a message that is itself constructed with logging.
+ */
+static Str nested() {
+    QL_IOUT("nested");
+    return "outer";
+}
+
+int main() {
+    std::ostringstream out, err;
+    logger::Context context;
+    context.log_level = logger::LogLevel::LOG_INFO;
+    context.out = &out;
+    context.err = &err;
+    context.format = logger::LogFormat::JSON;
+    context.async = true;
+
+    {
+        logger::Scope scope(&context);
+
+        // Records logged by another thread with the same context end up in the
+        // same stream once the thread exits.
+        std::thread thread([&context]() {
+            logger::Scope thread_scope(&context);
+            for (Int i = 0; i < 1000; i++) {
+                QL_IOUT("thread " << i);
+            }
+        });
+        for (Int i = 0; i < 1000; i++) {
+            QL_IOUT("main " << i);
+            QL_DOUT("not logged " << i);
+        }
+        thread.join();
+
+        // Warnings are written out before logging returns.
+        QL_WOUT("warning");
+        QL_ASSERT(!err.str().empty());
+
+        QL_IOUT(nested());
+    }
+
+    // All records must have been written when the scope ends, one valid JSON
+    // object per line, in order per thread.
+    std::istringstream lines(out.str());
+    Str line;
+    Int main_count = 0;
+    Int thread_count = 0;
+    Vec<Str> last;
+    while (std::getline(lines, line)) {
+        auto record = parse_json(line);
+        QL_ASSERT_EQ(record["level"].get<Str>(), "info");
+        auto message = record["message"].get<Str>();
+        if (message == "main " + to_string(main_count)) {
+            main_count++;
+        } else if (message == "thread " + to_string(thread_count)) {
+            thread_count++;
+        } else {
+            last.push_back(message);
+        }
+    }
+    QL_ASSERT_EQ(main_count, 1000);
+    QL_ASSERT_EQ(thread_count, 1000);
+    QL_ASSERT(last == Vec<Str>({"nested", "outer"}));
+
+    auto warning = parse_json(err.str());
+    QL_ASSERT_EQ(warning["level"].get<Str>(), "warning");
+    QL_ASSERT_EQ(warning["message"].get<Str>(), "warning");
+
+    // Records logged synchronously by several threads sharing a stream are
+    // written whole, never interleaved.
+    std::ostringstream sync_out;
+    context.out = &sync_out;
+    context.format = logger::LogFormat::TEXT;
+    context.async = false;
+    Vec<std::thread> threads;
+    for (Int t = 0; t < 4; t++) {
+        threads.emplace_back([&context]() {
+            logger::Scope thread_scope(&context);
+            for (Int i = 0; i < 1000; i++) {
+                QL_IOUT("sync " << i);
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    std::istringstream sync_lines(sync_out.str());
+    Int sync_count = 0;
+    while (std::getline(sync_lines, line)) {
+        QL_ASSERT(line.find("[OPENQL] ") == 0);
+        QL_ASSERT(line.find(" Info: sync ") != Str::npos);
+        sync_count++;
+    }
+    QL_ASSERT_EQ(sync_count, 4000);
+
+    return 0;
+}
@@ -0,0 +1,85 @@
+#include <sstream>
+#include <atomic>
+
+#include "ql/utils/parallel.h"
+#include "ql/utils/logger.h"
+#include "ql/utils/options.h"
+#include "ql/utils/vec.h"
+
+using namespace ql::utils;
+
+int main() {
+    std::ostringstream out, err;
+    logger::Context context;
+    context.log_level = logger::LogLevel::LOG_INFO;
+    context.out = &out;
+    context.err = &err;
+    context.format = logger::LogFormat::TEXT;
+    context.async = false;
+    Options options;
+
+    {
+        logger::Scope log_scope(&context);
+        OptionsScope options_scope(&options);
+
+        // Every task runs exactly once, with the options of the calling
+        // thread, and its log ends up in index order regardless of the thread
+        // that ran it.
+        Vec<Int> runs(100, 0);
+        std::atomic<Bool> scoped(true);
+        run_parallel(runs.size(), 4, [&](UInt thread, UInt index) {
+            QL_ASSERT(thread < 4);
+            runs[index]++;
+            if (get_active_options() != &options) {
+                scoped = false;
+            }
+            QL_IOUT("task " << index);
+            if (index % 10 == 0) {
+                QL_WOUT("warning " << index);
+            }
+            QL_DOUT("not logged " << index);
+        });
+        QL_ASSERT(runs == Vec<Int>(100, 1));
+        QL_ASSERT(scoped);
+
+        // The first exception is rethrown on the calling thread.
+        Bool caught = false;
+        try {
+            run_parallel(10, 3, [](UInt, UInt index) {
+                if (index == 5) {
+                    throw std::runtime_error("task failed");
+                }
+            });
+        } catch (std::runtime_error &e) {
+            caught = Str(e.what()) == "task failed";
+        }
+        QL_ASSERT(caught);
+    }
+
+    std::istringstream out_lines(out.str());
+    Str line;
+    UInt count = 0;
+    while (std::getline(out_lines, line)) {
+        QL_ASSERT(ends_with(line, " Info: task " + to_string(count)));
+        count++;
+    }
+    QL_ASSERT_EQ(count, 100u);
+
+    std::istringstream err_lines(err.str());
+    count = 0;
+    while (std::getline(err_lines, line)) {
+        QL_ASSERT(ends_with(line, " Warning: warning " + to_string(count * 10)));
+        count++;
+    }
+    QL_ASSERT_EQ(count, 10u);
+
+    // Without threads, the tasks run in order on the calling thread.
+    Vec<UInt> order;
+    run_parallel(5, 1, [&](UInt thread, UInt index) {
+        QL_ASSERT_EQ(thread, 0u);
+        order.push_back(index);
+    });
+    QL_ASSERT(order == Vec<UInt>({0, 1, 2, 3, 4}));
+
+    return 0;
+}
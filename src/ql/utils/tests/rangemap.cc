@@ -173,5 +173,14 @@ int main() {
     map.check_consistency();
     QL_ASSERT_EQ(map.to_string(), "{[10..13): 10, [17..21): 10}");
 
+    QL_ASSERT_EQ(map.find_free({13, 17}, true), 13);
+    QL_ASSERT_EQ(map.find_free({11, 14}, true), 13);
+    QL_ASSERT_EQ(map.find_free({11, 16}, true), 21);
+    QL_ASSERT_EQ(map.find_free({18, 20}, false), 15);
+    QL_ASSERT_EQ(map.find_free({14, 18}, false), 13);
+    QL_ASSERT_EQ(map.find_free({12, 16}, false), 6);
+    QL_ASSERT_EQ(map.find_free({12, 12}, true), 13);
+    QL_ASSERT_RAISES(map.find_free({20, 10}, true));
+
     return 0;
 }
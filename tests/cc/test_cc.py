@@ -506,6 +506,137 @@ class Test_central_controller(unittest.TestCase):
         ql.set_option('log_level', 'LOG_DEBUG') # override log level
         p.compile()
 
+    def test_kernel_threads(self):
+        platform = ql.Platform(platform_name, config_fn)
+
+        def compile_with_threads(threads):
+            p = ql.Program('test_kernel_threads', platform, num_qubits, num_cregs, num_bregs)
+            for i in range(6):
+                k = ql.Kernel('kernel_%d' % i, platform, num_qubits, num_cregs, num_bregs)
+                for j in range(i + 1):
+                    k.gate('x', [6 + (i + j) % 4])
+                    k.gate('y', [10 + j % 3])
+                k.gate('cz', [6, 7])
+                k.gate('measure', [6 + i % 4])
+                p.add_kernel(k)
+            p.get_compiler().set_option('codegen.kernel_threads', str(threads))
+            p.compile()
+
+            outputs = {}
+            for ext in ['.vq1asm', '.vcd']:
+                with open(os.path.join(output_dir, p.name + ext)) as f:
+                    outputs[ext] = f.read()
+            return outputs
+
+        # the generated files must not depend on the number of threads
+        reference = compile_with_threads(1)
+        for threads in [2, 4]:
+            outputs = compile_with_threads(threads)
+            for ext, data in reference.items():
+                self.assertEqual(outputs[ext], data, ext + ' differs for %d threads' % threads)
+
+    def test_loop_compression(self):
+        platform = ql.Platform(platform_name, os.path.join(curdir, 'cc_s5_direct_iq.json'))
+
+        def compile_with_compression(name, build, compression):
+            p = ql.Program(name, platform, 5, num_cregs, num_bregs)
+            k = ql.Kernel('kernel_0', platform, 5, num_cregs, num_bregs)
+            build(k)
+            p.add_for(k, 10)
+            p.get_compiler().set_option('codegen.loop_compression', compression)
+            p.compile()
+
+            outputs = {}
+            for ext in ['.vq1asm', '.vcd']:
+                with open(os.path.join(output_dir, p.name + ext)) as f:
+                    outputs[ext] = f.read()
+            return outputs
+
+        def repeated(k):
+            for i in range(6):
+                k.gate('x', [0])
+                k.gate('y', [1])
+            k.gate('measure', [0])
+
+        def with_pragma(k):
+            k.gate('measure_fb', [0])
+            for i in range(6):
+                k.gate('x', [0])
+                k.gate('if_1_break', [0])
+            k.gate('measure', [0])
+
+        def with_feedback(k):
+            for i in range(6):
+                k.gate('measure_fb', [0])
+            k.gate('measure', [1])
+
+        def with_condition(k):
+            k.gate('measure', [1])
+            for i in range(6):
+                k.gate('rx180', [0], 0, 0.0, [], 'COND_UNARY', [1])
+            k.gate('measure', [0])
+
+        def at_end(k):
+            for i in range(3):
+                k.gate('x', [0])
+
+        # repeated bundles are emitted once inside a loop, but the VCD still shows every iteration
+        uncompressed = compile_with_compression('test_loop_compression', repeated, 'no')
+        compressed = compile_with_compression('test_loop_compression', repeated, 'yes')
+        self.assertNotIn('R63', uncompressed['.vq1asm'])
+        self.assertIn('loop R63,@__repeat', compressed['.vq1asm'])
+        self.assertLess(len(compressed['.vq1asm'].splitlines()), len(uncompressed['.vq1asm'].splitlines()))
+        self.assertEqual(compressed['.vcd'], uncompressed['.vcd'])
+
+        # bundles with pragmas, feedback readouts or conditional gates, and the last bundle of a kernel, are never
+        # folded, so the output does not change
+        for build in [with_pragma, with_feedback, with_condition, at_end]:
+            name = 'test_loop_compression_' + build.__name__
+            uncompressed = compile_with_compression(name, build, 'no')
+            compressed = compile_with_compression(name, build, 'yes')
+            for ext, data in uncompressed.items():
+                self.assertEqual(compressed[ext], data, ext + ' differs for ' + build.__name__)
+
+    def test_vcd_idle_instruments(self):
+        platform = ql.Platform(platform_name, os.path.join(curdir, 'cc_s5_direct_iq.json'))
+
+        p = ql.Program('test_vcd_idle_instruments', platform, 5, num_cregs, num_bregs)
+        k = ql.Kernel('kernel_0', platform, 5, num_cregs, num_bregs)
+        for gate in ['x', 'y', 'x', 'measure', 'x']:
+            k.gate(gate, [0])
+        p.add_kernel(k)
+        p.compile()
+
+        # collect the changes of the codeword variables, in time order
+        names = {}
+        changes = {}
+        scope = None
+        with open(os.path.join(output_dir, p.name + '.vcd')) as f:
+            for line in f:
+                line = line.rstrip('\n')
+                if line.startswith('$scope'):
+                    scope = line.split()[2]
+                elif line.startswith('$var') and scope == 'codewords':
+                    fields = line.split()
+                    names[fields[3]] = fields[4]
+                    changes[fields[4]] = []
+                elif line.startswith('s'):
+                    value, var = line[1:].rsplit(' ', 1)
+                    if var in names:
+                        changes[names[var]].append(value)
+
+        # instruments without output never change their codeword, instead of getting an empty codeword at the
+        # start of every bundle
+        self.assertEqual(changes['ro_2'], [])
+        self.assertEqual(changes['flux_0'], [])
+
+        # the other instruments only end a codeword after starting one (a codeword may directly follow another one)
+        self.assertGreater(len(changes['ro_1']), 0)
+        for name, values in changes.items():
+            previous = ''
+            for value in values:
+                self.assertFalse(value == '' and previous == '', 'empty codeword change for ' + name)
+                previous = value
 
     # FIXME: add:
     # - qec_pipelined